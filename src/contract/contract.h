@@ -127,6 +127,19 @@ public:
      */
     virtual ~BaseContract() {}
 
+    /**
+     * Add the contract's state to a database batch, the same way it's saved on destruction.
+     * Derived classes should override it to add their own variables, calling their
+     * parent's dump() first (not necessarily this one, e.g. DEXV2Pair calls ERC20::dump()).
+     * @param batch The batch to add the state to.
+     */
+    virtual void dump(DBBatch& batch) const {
+      batch.push_back(Utils::stringToBytes("contractName"), Utils::stringToBytes(this->contractName), this->dbPrefix);
+      batch.push_back(Utils::stringToBytes("contractAddress"), this->contractAddress.view_const(), this->dbPrefix);
+      batch.push_back(Utils::stringToBytes("contractCreator"), this->contractCreator.view_const(), this->dbPrefix);
+      batch.push_back(Utils::stringToBytes("contractChainId"), Utils::uint64ToBytes(this->contractChainId), this->dbPrefix);
+    }
+
     /**
      * Invoke a contract function using a tuple of (from, to, gasLimit, gasPrice,
      * value, data). Should be overriden by derived classes.
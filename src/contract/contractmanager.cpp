@@ -23,6 +23,7 @@ ContractManager::ContractManager(State* state, const std::unique_ptr<DB>& db, co
       }
     }
   this->updateState(true);
+  this->clearChanged();
 }
 
 ContractManager::~ContractManager() {
@@ -37,6 +38,44 @@ ContractManager::~ContractManager() {
   this->db->putBatch(contractsBatch);
 }
 
+void ContractManager::dump(DBBatch& batch) const {
+  BaseContract::dump(batch);
+  for (const auto& [contractAddress, contract] : this->contracts) {
+    batch.push_back(
+      Bytes(contractAddress.asBytes()),
+      Utils::stringToBytes(contract->getContractName()),
+      DBPrefix::contractManager
+    );
+    contract->dump(batch);
+  }
+}
+
+void ContractManager::dumpChanged(DBBatch& batch) const {
+  for (const Address& contractAddress : this->changedContracts) {
+    auto it = this->contracts.find(contractAddress);
+    if (it == this->contracts.end()) continue;
+    batch.push_back(
+      Bytes(contractAddress.asBytes()),
+      Utils::stringToBytes(it->second->getContractName()),
+      DBPrefix::contractManager
+    );
+    // Saved entries the contract doesn't have anymore (e.g. erased from a map) are
+    // deleted, so the database holds exactly the contract's dump
+    const uint64_t putsBefore = batch.getPuts().size();
+    it->second->dump(batch);
+    std::unordered_set<Bytes, SafeHash> dumped;
+    for (uint64_t i = putsBefore; i < batch.getPuts().size(); i++) dumped.emplace(batch.getPuts()[i].key);
+    const Bytes& prefix = it->second->getDBPrefix();
+    for (const DBEntry& entry : this->db->getBatch(prefix)) {
+      Bytes key = prefix;
+      Utils::appendBytes(key, entry.key);
+      if (!dumped.contains(key)) batch.delete_key(key, Bytes());
+    }
+  }
+}
+
+void ContractManager::clearChanged() { this->changedContracts.clear(); }
+
 Address ContractManager::deriveContractAddress() const {
   // Contract address = sha3(rlp(tx.from() + tx.nonce()).substr(12);
   uint8_t rlpSize = 0xc0;
@@ -55,6 +94,8 @@ void ContractManager::updateState(const bool commitToState) {
     for (auto rbegin = usedVariables.rbegin(); rbegin != usedVariables.rend(); ++rbegin) {
       rbegin->get().commit();
     }
+    this->changedContracts.insert(this->usedContracts.begin(), this->usedContracts.end());
+    this->changedContracts.insert(this->recentlyCreatedContracts.begin(), this->recentlyCreatedContracts.end());
   } else {
     for (auto rbegin = usedVariables.rbegin(); rbegin != usedVariables.rend(); ++rbegin) {
       rbegin->get().revert();
@@ -64,6 +105,7 @@ void ContractManager::updateState(const bool commitToState) {
     }
   }
   this->recentlyCreatedContracts.clear();
+  this->usedContracts.clear();
   usedVariables.clear();
 }
 
@@ -290,7 +332,7 @@ void ContractManagerInterface::populateBalance(const Address &address) const {
   if (!this->contractManager.balances.contains(address)) {
     auto it = this->contractManager.state->accounts.find(address);
     if (it != this->contractManager.state->accounts.end()) {
-      this->contractManager.balances[address] = it->second.balance;
+      this->contractManager.balances[address] = it->second.balance.toBoost();
     } else {
       this->contractManager.balances[address] = 0;
     }
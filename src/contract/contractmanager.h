@@ -70,6 +70,12 @@ class ContractManager : BaseContract {
     /// Vector of variables that were used by contracts called by CM.
     std::vector<std::reference_wrapper<SafeBase>> usedVariables;
 
+    /// Set of contracts that own the variables in usedVariables.
+    std::unordered_set<Address, SafeHash> usedContracts;
+
+    /// Set of contracts changed by committed calls that weren't saved yet, see dumpChanged().
+    std::unordered_set<Address, SafeHash> changedContracts;
+
     /// Mutex that manages read/write access to the contracts.
     mutable std::shared_mutex contractsMutex;
 
@@ -361,6 +367,26 @@ class ContractManager : BaseContract {
     /// Destructor. Automatically saves contracts to the database before wiping them.
     ~ContractManager() override;
 
+    /**
+     * Add the contract registry and the state of every deployed contract to a
+     * database batch, the same way they're saved on destruction. Together they
+     * are everything needed to load the contracts back (e.g. on another node).
+     * @param batch The batch to add the state to.
+     */
+    void dump(DBBatch& batch) const override;
+
+    /**
+     * Add the registry entry and the state of every contract changed (or created)
+     * since the last clearChanged() to a database batch, along with the deletion of
+     * their saved entries that aren't in their state anymore.
+     * Used by the State to save contracts along with the block that changed them.
+     * @param batch The batch to add the state to.
+     */
+    void dumpChanged(DBBatch& batch) const;
+
+    /// Forget the changed contracts, once their state from dumpChanged() was saved.
+    void clearChanged();
+
     /**
      * Override the default contract function call.
      * ContractManager processes things in a non-standard way (you cannot use
@@ -448,9 +474,13 @@ class ContractManagerInterface {
 
     /**
      * Register a variable that was used a given contract.
+     * @param contract Address of the contract that owns the variable.
      * @param variable Reference to the variable.
      */
-    inline void registerVariableUse(SafeBase& variable) { this->contractManager.usedVariables.emplace_back(variable); }
+    inline void registerVariableUse(const Address& contract, SafeBase& variable) {
+      this->contractManager.usedVariables.emplace_back(variable);
+      this->contractManager.usedContracts.insert(contract);
+    }
 
     /// Populate a given address with its balance from the State.
     void populateBalance(const Address& address) const;
@@ -40,11 +40,17 @@ DEXV2Factory::DEXV2Factory(
 
 DEXV2Factory::~DEXV2Factory() {
   DBBatch batchOperations;
-  batchOperations.push_back(Utils::stringToBytes("feeTo_"), this->feeTo_.get().view_const(), this->getDBPrefix());
-  batchOperations.push_back(Utils::stringToBytes("feeToSetter_"), this->feeToSetter_.get().view_const(), this->getDBPrefix());
+  this->dump(batchOperations);
+  this->db->putBatch(batchOperations);
+}
+
+void DEXV2Factory::dump(DBBatch& batch) const {
+  BaseContract::dump(batch);
+  batch.push_back(Utils::stringToBytes("feeTo_"), this->feeTo_.get().view_const(), this->getDBPrefix());
+  batch.push_back(Utils::stringToBytes("feeToSetter_"), this->feeToSetter_.get().view_const(), this->getDBPrefix());
   uint32_t index = 0;
   for (const auto& address : this->allPairs_.get()) {
-    batchOperations.push_back(Utils::uint32ToBytes(index), address.view_const(), this->getNewPrefix("allPairs_"));
+    batch.push_back(Utils::uint32ToBytes(index), address.view_const(), this->getNewPrefix("allPairs_"));
   }
 
   for (auto tokenA = this->getPair_.cbegin(); tokenA != this->getPair_.cend(); ++tokenA) {
@@ -52,11 +58,9 @@ DEXV2Factory::~DEXV2Factory() {
       const auto& key = tokenA->first.get();
       Bytes value = tokenB->first.asBytes();
       Utils::appendBytes(value, tokenB->second.asBytes());
-      batchOperations.push_back(key, value, this->getNewPrefix("getPair_"));
+      batch.push_back(key, value, this->getNewPrefix("getPair_"));
     }
   }
-
-  this->db->putBatch(batchOperations);
 }
 
 void DEXV2Factory::registerContractFunctions() {
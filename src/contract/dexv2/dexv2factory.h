@@ -63,6 +63,12 @@ class DEXV2Factory : public DynamicContract {
     // Destructor.
     ~DEXV2Factory() override;
 
+    /**
+     * Add the contract's state to a database batch, see BaseContract::dump().
+     * @param batch The batch to add the state to.
+     */
+    void dump(DBBatch& batch) const override;
+
     /**
      * Get the feeTo address of the DEXV2Factory.
      */
@@ -113,6 +113,13 @@ class DEXV2Pair : public ERC20 {
     /// Destructor.
     ~DEXV2Pair() override;
 
+    /**
+     * Add the contract's state to a database batch, its ERC20 token included,
+     * see BaseContract::dump().
+     * @param batch The batch to add the state to.
+     */
+    void dump(DBBatch& batch) const override;
+
 
     /**
      * Initialize the contract
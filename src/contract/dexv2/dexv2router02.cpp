@@ -28,11 +28,16 @@ DEXV2Router02::DEXV2Router02(
 
 DEXV2Router02::~DEXV2Router02() {
   DBBatch batchOperations;
-  batchOperations.push_back(Utils::stringToBytes("factory_"), this->factory_.get().view_const(), this->getDBPrefix());
-  batchOperations.push_back(Utils::stringToBytes("wrappedNative_"), this->wrappedNative_.get().view_const(), this->getDBPrefix());
+  this->dump(batchOperations);
   this->db->putBatch(batchOperations);
 }
 
+void DEXV2Router02::dump(DBBatch& batch) const {
+  BaseContract::dump(batch);
+  batch.push_back(Utils::stringToBytes("factory_"), this->factory_.get().view_const(), this->getDBPrefix());
+  batch.push_back(Utils::stringToBytes("wrappedNative_"), this->wrappedNative_.get().view_const(), this->getDBPrefix());
+}
+
 void DEXV2Router02::registerContractFunctions() {
   registerContract();
   this->registerMemberFunction("factory", &DEXV2Router02::factory, this);
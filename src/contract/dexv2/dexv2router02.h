@@ -100,6 +100,12 @@ class DEXV2Router02 : public DynamicContract {
     // Destructor.
     ~DEXV2Router02() override;
 
+    /**
+     * Add the contract's state to a database batch, see BaseContract::dump().
+     * @param batch The batch to add the state to.
+     */
+    void dump(DBBatch& batch) const override;
+
     /// Getter for the factory_ variable.
     Address factory() const;
 
@@ -61,7 +61,7 @@ class DynamicContract : public BaseContract {
      * Register a variable that was used by the contract.
      * @param variable Reference to the variable.
      */
-    inline void registerVariableUse(SafeBase& variable) { interface.registerVariableUse(variable); }
+    inline void registerVariableUse(SafeBase& variable) { interface.registerVariableUse(this->getContractAddress(), variable); }
 
   protected:
     /// Reference to the contract manager interface.
@@ -65,19 +65,22 @@ ERC20::ERC20(
 
 
 ERC20::~ERC20() {
-
   DBBatch batchOperations;
+  this->dump(batchOperations);
+  this->db->putBatch(batchOperations);
+}
 
-  
-  this->db->put(std::string("_name"), _name.get(), this->getDBPrefix());
-  this->db->put(std::string("_symbol"), _symbol.get(), this->getDBPrefix());
-  this->db->put(std::string("_decimals"), Utils::uint8ToBytes(_decimals.get()), this->getDBPrefix());
-  this->db->put(std::string("_totalSupply"), Utils::uint256ToBytes(_totalSupply.get()), this->getDBPrefix());
+void ERC20::dump(DBBatch& batch) const {
+  BaseContract::dump(batch);
+  batch.push_back(Utils::stringToBytes("_name"), Utils::stringToBytes(_name.get()), this->getDBPrefix());
+  batch.push_back(Utils::stringToBytes("_symbol"), Utils::stringToBytes(_symbol.get()), this->getDBPrefix());
+  batch.push_back(Utils::stringToBytes("_decimals"), Utils::uint8ToBytes(_decimals.get()), this->getDBPrefix());
+  batch.push_back(Utils::stringToBytes("_totalSupply"), Utils::uint256ToBytes(_totalSupply.get()), this->getDBPrefix());
 
   for (auto it = _balances.cbegin(); it != _balances.cend(); ++it) {
     const auto& key = it->first.get();
     Bytes value = Utils::uintToBytes(it->second);
-    batchOperations.push_back(key, value, this->getNewPrefix("_balances"));
+    batch.push_back(key, value, this->getNewPrefix("_balances"));
   }
 
   for (auto it = _allowed.cbegin(); it != _allowed.cend(); ++it) {
@@ -85,10 +88,9 @@ ERC20::~ERC20() {
       const auto& key = it->first.get();
       Bytes value = it2->first.asBytes();
       Utils::appendBytes(value, Utils::uintToBytes(it2->second));
-      batchOperations.push_back(key, value, this->getNewPrefix("_allowed"));
+      batch.push_back(key, value, this->getNewPrefix("_allowed"));
     }
   }
-  this->db->putBatch(batchOperations);
 }
 
 void ERC20::registerContractFunctions() {
@@ -102,6 +102,12 @@ class ERC20 : public DynamicContract {
     /// Destructor.
     ~ERC20() override;
 
+    /**
+     * Add the contract's state to a database batch, see BaseContract::dump().
+     * @param batch The batch to add the state to.
+     */
+    void dump(DBBatch& batch) const override;
+
     /**
      * Get the name of the ERC20 token. Solidity counterpart:
      * function name() public view returns (string memory) { return _name; }
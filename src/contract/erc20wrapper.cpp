@@ -24,17 +24,21 @@ ERC20Wrapper::ERC20Wrapper(
 }
 
 ERC20Wrapper::~ERC20Wrapper() {
-  DBBatch tokensAndBalancesBatch;
+  DBBatch batchOperations;
+  this->dump(batchOperations);
+  this->db->putBatch(batchOperations);
+}
+
+void ERC20Wrapper::dump(DBBatch& batch) const {
+  BaseContract::dump(batch);
   for (auto it = _tokensAndBalances.cbegin(); it != _tokensAndBalances.cend(); ++it) {
     for (auto it2 = it->second.cbegin(); it2 != it->second.cend(); ++it2) {
       const auto& key = it->first.get();
       Bytes value = it2->first.asBytes();
       Utils::appendBytes(value, Utils::uintToBytes(it2->second));
-      tokensAndBalancesBatch.push_back(key, value, this->getNewPrefix("_tokensAndBalances"));
+      batch.push_back(key, value, this->getNewPrefix("_tokensAndBalances"));
     }
   }
-
-  this->db->putBatch(tokensAndBalancesBatch);
 }
 
 void ERC20Wrapper::registerContractFunctions() {
@@ -75,6 +75,12 @@ class ERC20Wrapper : public DynamicContract {
     /// Destructor.
     ~ERC20Wrapper() override;
 
+    /**
+     * Add the contract's state to a database batch, see BaseContract::dump().
+     * @param batch The batch to add the state to.
+     */
+    void dump(DBBatch& batch) const override;
+
     /**
      * Get the balance of the contract for a specific token. Solidity counterpart:
      * function getContractBalance(address _token) public view returns (uint256) { return _tokensAndBalances[_token][address(this)]; }
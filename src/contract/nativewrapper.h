@@ -84,6 +84,12 @@ class NativeWrapper : public DynamicContract {
     /// Destructor.
     ~NativeWrapper() override;
 
+    /**
+     * Add the contract's state to a database batch, see BaseContract::dump().
+     * @param batch The batch to add the state to.
+     */
+    void dump(DBBatch& batch) const override;
+
     /**
      * Get the name of the token. Solidity counterpart:
      * function name() public view returns (string memory) { return _name; }
@@ -13,7 +13,7 @@ Blockchain::Blockchain(std::string blockchainPath) :
 
 void Blockchain::start() { p2p->start(); http->start(); syncer->start(); }
 
-void Blockchain::stop() { syncer->stop(); http->stop(); p2p->stop(); }
+void Blockchain::stop() { syncer->stop(); http->stop(); state->stopTxAdmission(); p2p->stop(); }
 
 const std::atomic<bool>& Blockchain::isSynced() const { return this->syncer->isSynced(); }
 
@@ -63,22 +63,27 @@ void Syncer::updateCurrentlyConnectedNodes() {
 bool Syncer::checkLatestBlock() { return (this->latestBlock != this->blockchain.storage->latest()); }
 
 void Syncer::doSync() {
-  // TODO: Fully implement Sync
   this->latestBlock = blockchain.storage->latest();
   // Get the list of currently connected nodes and their current height
   this->updateCurrentlyConnectedNodes();
-  std::pair<P2P::NodeID, uint64_t> highestNode = {P2P::NodeID(), 0};
 
-  // Get the highest node.
-  for (auto& [nodeId, nodeInfo] : this->currentlyConnectedNodes) {
-    if (nodeInfo.latestBlockHeight > highestNode.second) {
-      highestNode = {nodeId, nodeInfo.latestBlockHeight};
-    }
+  // A new node starts from the state snapshot most peers agree on, if they're far enough
+  // ahead for it to be worth it, and only syncs the blocks after it
+  if (blockchain.storage->latest()->getNHeight() == 0) {
+    SnapshotSync snapshotSync(blockchain.p2p, blockchain.storage, blockchain.state);
+    if (snapshotSync.sync(this->currentlyConnectedNodes, this->stopSyncer) != 0) this->updateCurrentlyConnectedNodes();
   }
 
-  // Sync from the best node.
-  if (highestNode.second > this->latestBlock->getNHeight()) {
-    // TODO: currently we are starting all the nodes from genesis (0)
+  // Sync from every node ahead of us at once, until none is or we stop getting anywhere
+  BlockSync blockSync(blockchain.p2p, blockchain.storage, blockchain.state, blockchain.options);
+  while (!this->stopSyncer) {
+    uint64_t highest = 0;
+    for (auto& [nodeId, nodeInfo] : this->currentlyConnectedNodes) {
+      highest = std::max(highest, nodeInfo.latestBlockHeight);
+    }
+    if (highest <= blockchain.storage->latest()->getNHeight()) break;
+    if (blockSync.sync(this->currentlyConnectedNodes, this->stopSyncer) == 0) break;
+    this->updateCurrentlyConnectedNodes();
   }
 
   this->latestBlock = blockchain.storage->latest();
@@ -87,82 +92,103 @@ void Syncer::doSync() {
 }
 
 void Syncer::doValidatorBlock() {
-  // TODO: Improve this somehow.
-  // Wait until we have enough transactions in the rdpos mempool.
-  while (this->blockchain.rdpos->getMempool().size() < rdPoS::minValidators * 2) {
-    if (this->stopSyncer) return;
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-  }
-
-  // Wait until we have at least one transaction in the state mempool.
-  while (this->blockchain.state->getMempoolSize() < 1) {
-    if (this->stopSyncer) return;
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-  }
+  using Clock = std::chrono::steady_clock;
+  auto elapsed = [](const Clock::time_point& from, const Clock::time_point& to) {
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+  };
+  const Clock::time_point tipSeen = Clock::now();
+  const std::shared_ptr<const Block> latestBlock = this->blockchain.storage->latest();
+  BlockBuilder builder(latestBlock->hash(), latestBlock->getTimestamp(), latestBlock->getNHeight() + 1);
+  BlockRoundLatency latency;
+  latency.height = builder.getNHeight();
 
-  // Create the block.
-  if (this->stopSyncer) return;
-  auto mempool = this->blockchain.rdpos->getMempool();
-  auto randomList = this->blockchain.rdpos->getRandomList();
-
-  // Order the transactions in the proper manner.
-  std::vector<TxValidator> randomHashTxs;
-  std::vector<TxValidator> randomnessTxs;
-  uint64_t i = 1;
-  while (randomHashTxs.size() != rdPoS::minValidators) {
-    for (const auto [txHash, tx]: mempool) {
-      if (this->stopSyncer) return;
-      if (tx.getFrom() == randomList[i]) {
-        if (tx.getFunctor() == Hex::toBytes("0xcfffe746")) {
-          randomHashTxs.emplace_back(tx);
-          i++;
-          break;
-        }
-      }
-    }
-  }
-  i = 1;
-  while (randomnessTxs.size() != rdPoS::minValidators) {
-    for (const auto [txHash, tx]: mempool) {
-      if (tx.getFrom() == randomList[i]) {
-        if (tx.getFunctor() == Hex::toBytes("0x6fc5a2d6")) {
-          randomnessTxs.emplace_back(tx);
-          i++;
-          break;
-        }
-      }
+  // Fill the block from the mempool while the Validator transactions come in, leaving room for them.
+  // Nothing else can change the state until we create this block.
+  auto fillFuture = std::async(std::launch::async, [&]() -> std::optional<BlockFillReport> {
+    // Wait until we have at least one executable transaction in the state mempool.
+    while (this->blockchain.state->getMempoolPendingCount() < 1) {
+      if (this->stopSyncer) return std::nullopt;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
-  }
-  if (this->stopSyncer) return;
+    const Clock::time_point fillStart = Clock::now();
+    BlockFillReport report = this->blockchain.state->fillBlockWithTransactions(
+      builder, rdPoS::minValidators * 2 * rdPoS::maxTxValidatorSize
+    );
+    latency.fill = elapsed(fillStart, Clock::now());
+    return report;
+  });
 
-  // Create the block and append to all chains, we can use any storage for latest block.
-  const std::shared_ptr<const Block> latestBlock = this->blockchain.storage->latest();
-  Block block(latestBlock->hash(), latestBlock->getTimestamp(), latestBlock->getNHeight() + 1);
+  // Wait until we have every transaction for the block in the rdpos mempool.
+  // They come already ordered by slot.
+  std::optional<std::vector<TxValidator>> txValidators;
+  while (!(txValidators = this->blockchain.rdpos->getBlockTxValidators())) {
+    if (this->stopSyncer) { fillFuture.wait(); return; }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  const Clock::time_point txValidatorsIn = Clock::now();
+  latency.waitTxValidators = elapsed(tipSeen, txValidatorsIn);
 
-  // Append transactions towards block.
-  for (const auto& tx: randomHashTxs) block.appendTxValidator(tx);
-  for (const auto& tx: randomnessTxs) block.appendTxValidator(tx);
-  if (this->stopSyncer) return;
+  // Append the Validator transactions once the fill is done, both change the builder.
+  std::optional<BlockFillReport> report = fillFuture.get();
+  if (!report || this->stopSyncer) return;
+  for (auto& tx: *txValidators) builder.appendTxValidator(std::move(tx));
+  const Clock::time_point assembled = Clock::now();
+  latency.assemble = elapsed(txValidatorsIn, assembled);
+  ConsensusTrace& trace = this->blockchain.rdpos->getTrace();
+  trace.record(latency.height, ConsensusEvent::BlockAssembled);
 
-  // Add transactions from state, sign, validate and process the block.
-  this->blockchain.state->fillBlockWithTransactions(block);
-  this->blockchain.rdpos->signBlock(block);
-  if (!this->blockchain.state->validateNextBlock(block)) {
+  // Sign, then validate and process the block in a single pass.
+  // It is broadcast once it's saved, before the mempool refresh.
+  Block block = this->blockchain.rdpos->signBlock(std::move(builder));
+  const Clock::time_point signedAt = Clock::now();
+  latency.sign = elapsed(assembled, signedAt);
+  trace.record(latency.height, ConsensusEvent::BlockSigned);
+  Hash latestBlockHash = block.hash();
+  Clock::time_point broadcastStart, broadcastEnd;
+  bool processed = this->blockchain.state->tryProcessNextBlock(std::move(block), [&](const Block& saved) {
+    broadcastStart = Clock::now();
+    this->blockchain.p2p->broadcastBlock(saved);
+    broadcastEnd = Clock::now();
+  });
+  if (!processed) {
     Logger::logToDebug(LogType::ERROR, Log::syncer, __func__, "Block is not valid!");
     throw std::runtime_error("Block is not valid!");
   }
-  if (this->stopSyncer) return;
-  Hash latestBlockHash = block.hash();
-  this->blockchain.state->processNextBlock(std::move(block));
   if (this->blockchain.storage->latest()->hash() != latestBlockHash) {
     Logger::logToDebug(LogType::ERROR, Log::syncer, __func__, "Block is not valid!");
     throw std::runtime_error("Block is not valid!");
   }
+  const Clock::time_point committed = Clock::now();
+  latency.process = elapsed(signedAt, broadcastStart);
+  latency.broadcast = elapsed(broadcastStart, broadcastEnd);
+  latency.finish = elapsed(broadcastEnd, committed);
+  latency.total = elapsed(tipSeen, committed);
+  {
+    std::lock_guard lock(this->lastBlockRoundMutex);
+    this->lastBlockRound = latency;
+  }
 
-  // Broadcast the block through P2P
-  if (this->stopSyncer) return;
-  this->blockchain.p2p->broadcastBlock(this->blockchain.storage->latest());
-  return;
+  // Logging is left for when the block is already out.
+  if (report->leftOut > 0) {
+    Logger::logToDebug(LogType::INFO, Log::syncer, __func__,
+      "Block filled with " + std::to_string(report->included) + " txs (" + std::to_string(report->bytes)
+      + " bytes, ~" + std::to_string(report->execTime) + "us), left " + std::to_string(report->leftOut) + " pending txs out."
+      + " Senders skipped by size: " + std::to_string(report->count(BlockSkip::Bytes))
+      + ", tx count: " + std::to_string(report->count(BlockSkip::TxCount))
+      + ", exec time: " + std::to_string(report->count(BlockSkip::ExecTime))
+      + ", balance: " + std::to_string(report->count(BlockSkip::Balance))
+    );
+  }
+  Logger::logToDebug(LogType::INFO, Log::syncer, __func__,
+    "Block " + std::to_string(latency.height) + " round took " + std::to_string(latency.total) + "us:"
+    + " waiting for TxValidators " + std::to_string(latency.waitTxValidators) + "us"
+    + " (filling " + std::to_string(latency.fill) + "us meanwhile)"
+    + ", assembling " + std::to_string(latency.assemble) + "us"
+    + ", signing " + std::to_string(latency.sign) + "us"
+    + ", processing " + std::to_string(latency.process) + "us"
+    + ", broadcasting " + std::to_string(latency.broadcast) + "us"
+    + ", finishing " + std::to_string(latency.finish) + "us"
+  );
 }
 
 void Syncer::doValidatorTx() {
@@ -178,7 +204,7 @@ void Syncer::validatorLoop() {
     // Check if validator is within the current validator list.
     const auto currentRandomList = this->blockchain.rdpos->getRandomList();
     bool isBlockCreator = false;
-    if (currentRandomList[0] == me) {
+    if ((*currentRandomList)[0] == me) {
       isBlockCreator = true;
       this->doValidatorBlock();
     }
@@ -4,6 +4,8 @@
 #include "storage.h"
 #include "rdpos.h"
 #include "state.h"
+#include "blocksync.h"
+#include "snapshotsync.h"
 #include "../net/p2p/managerbase.h"
 #include "../net/http/httpserver.h"
 #include "../utils/options.h"
@@ -83,6 +85,19 @@ class Blockchain {
     friend class Syncer;
 };
 
+/// Time spent in each phase of a round in which we created the block, in microseconds.
+struct BlockRoundLatency {
+  uint64_t height = 0;            ///< Height of the block.
+  uint64_t waitTxValidators = 0;  ///< From seeing the new tip until every Validator transaction was in.
+  uint64_t fill = 0;              ///< Filling the block from the mempool (overlaps the wait above).
+  uint64_t assemble = 0;          ///< Waiting for the fill to end and appending the Validator transactions.
+  uint64_t sign = 0;              ///< Finalizing and signing the block.
+  uint64_t process = 0;           ///< Validating, executing and saving the block, up until it is broadcast.
+  uint64_t broadcast = 0;         ///< Broadcasting the block.
+  uint64_t finish = 0;            ///< Refreshing the mempool and logging the block, after the broadcast.
+  uint64_t total = 0;             ///< From seeing the new tip until the block is appended to the chain.
+};
+
 /**
  * Helper class that syncs the node with the network.
  * This is where the magic happens between the nodes on the network, as the
@@ -109,14 +124,22 @@ class Syncer {
     /// Check latest block (used by validatorLoop()).
     bool checkLatestBlock();
 
-    /// Do the syncing.
+    /// Do the syncing, downloading from every node ahead of us at once (see BlockSync).
     void doSync();
 
+    /// Phase breakdown of the latest block we created.
+    BlockRoundLatency lastBlockRound;
+
+    /// Mutex for managing read/write access to `lastBlockRound`.
+    mutable std::mutex lastBlockRoundMutex;
+
     /**
      * Create and broadcast a Validator block (called by validatorLoop()).
      * If the node is a Validator and it has to create a new block,
      * this function will be called, the new block will be created based on the
      * current State and rdPoS objects, and then it will be broadcasted.
+     * The block is filled from the mempool while the Validator transactions
+     * come in, and broadcast as soon as it is executed, before it's committed locally.
      * @throw std::runtime_error if block is invalid.
      */
     void doValidatorBlock();
@@ -162,6 +185,9 @@ class Syncer {
     /// Getter for `synced`.
     const std::atomic<bool>& isSynced() const { return this->synced; }
 
+    /// Getter for `lastBlockRound`.
+    BlockRoundLatency getLastBlockRound() const { std::lock_guard lock(this->lastBlockRoundMutex); return this->lastBlockRound; }
+
     /// Start the syncer routine loop.
     void start();
 
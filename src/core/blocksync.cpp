@@ -0,0 +1,265 @@
+#include "blocksync.h"
+#include "storage.h"
+#include "state.h"
+
+void BlockSync::fetchHeaderChain(const std::shared_ptr<const Block>& latest) {
+  std::vector<uint64_t> byHeight(this->peers.size());
+  for (uint64_t i = 0; i < byHeight.size(); i++) byHeight[i] = i;
+  std::sort(byHeight.begin(), byHeight.end(), [&](const uint64_t& a, const uint64_t& b) {
+    return this->peers[a].height > this->peers[b].height;
+  });
+
+  Hash lastHash = latest->hash();
+  for (const uint64_t& index : byHeight) {
+    Peer& peer = this->peers[index];
+    uint64_t from = this->base + this->headerChain.size();
+    while (peer.alive && from <= peer.height) {
+      auto headers = this->p2p->requestHeaders(peer.id, from,
+        std::min(P2P::ManagerNormal::maxHeadersPerRequest, peer.height - from + 1)
+      );
+      if (headers.empty()) break;  // Try the next peer from here
+      for (const P2P::BlockHeaderInfo& header : headers) {
+        if (header.height != from || header.prevHash != lastHash) {
+          Logger::logToDebug(LogType::WARNING, Log::syncer, __func__,
+            "Headers from " + peer.id.first.to_string() + ":" + std::to_string(peer.id.second)
+            + " don't link up at height " + std::to_string(from) + ", dropping peer"
+          );
+          this->dropPeer(peer);
+          break;
+        }
+        this->headerChain.emplace_back(header.hash);
+        this->headerSources.emplace_back(index);
+        lastHash = header.hash;
+        from++;
+      }
+    }
+  }
+}
+
+bool BlockSync::crossCheckHeaderChain() {
+  const std::unordered_set<uint64_t> sources(this->headerSources.begin(), this->headerSources.end());
+  const uint64_t last = this->base + this->headerChain.size() - 1;
+  uint64_t agree = 1;
+  std::vector<uint64_t> disagree;
+  for (uint64_t i = 0; i < this->peers.size(); i++) {
+    const Peer& peer = this->peers[i];
+    if (!peer.alive || sources.contains(i)) continue;
+    const uint64_t height = std::min(peer.height, last);
+    auto headers = this->p2p->requestHeaders(peer.id, height, 1);
+    if (headers.empty()) continue;  // Can't tell, its blocks are still checked against the chain
+    if (headers[0].height == height && headers[0].hash == this->headerChain[height - this->base]) {
+      agree++;
+    } else {
+      disagree.emplace_back(i);
+    }
+  }
+
+  if (disagree.size() > agree) {
+    for (const uint64_t& index : sources) {
+      Peer& peer = this->peers[index];
+      Logger::logToDebug(LogType::WARNING, Log::syncer, __func__,
+        "Header chain from " + peer.id.first.to_string() + ":" + std::to_string(peer.id.second)
+        + " is disputed by " + std::to_string(disagree.size()) + " peers, dropping peer"
+      );
+      this->dropPeer(peer);
+    }
+    this->headerChain.clear();
+    this->headerSources.clear();
+    return false;
+  }
+  for (const uint64_t& index : disagree) {
+    Peer& peer = this->peers[index];
+    Logger::logToDebug(LogType::WARNING, Log::syncer, __func__,
+      "Peer " + peer.id.first.to_string() + ":" + std::to_string(peer.id.second)
+      + " is not on the header chain, dropping peer"
+    );
+    this->dropPeer(peer);
+  }
+  return true;
+}
+
+std::optional<std::pair<uint64_t, uint64_t>> BlockSync::takeRange(const Peer& peer) {
+  for (auto it = this->retries.begin(); it != this->retries.end(); it++) {
+    auto& [first, count] = *it;
+    if (first > peer.height) continue;
+    uint64_t taken = std::min({count, peer.window, peer.height - first + 1});
+    std::pair<uint64_t, uint64_t> range = {first, taken};
+    if (taken == count) {
+      this->retries.erase(it);
+    } else {
+      first += taken;
+      count -= taken;
+    }
+    return range;
+  }
+  const uint64_t aheadLimit = this->nextApply + maxBlocksAhead;
+  if (this->nextRange > this->target || this->nextRange > peer.height || this->nextRange >= aheadLimit) {
+    return std::nullopt;
+  }
+  uint64_t taken = std::min({
+    peer.window, this->target - this->nextRange + 1, peer.height - this->nextRange + 1, aheadLimit - this->nextRange
+  });
+  std::pair<uint64_t, uint64_t> range = {this->nextRange, taken};
+  this->nextRange += taken;
+  return range;
+}
+
+void BlockSync::dropPeer(Peer& peer) {
+  if (!peer.alive) return;
+  peer.alive = false;
+  this->alivePeers--;
+  uint64_t reach = 0;
+  for (const Peer& other : this->peers) if (other.alive) reach = std::max(reach, other.height);
+  if (reach >= this->target) return;
+
+  // Nobody left can get us to the end, settle for what they can
+  this->target = std::max(reach, this->base - 1);
+  for (auto it = this->retries.begin(); it != this->retries.end();) {
+    if (it->first > this->target) { it = this->retries.erase(it); continue; }
+    it->second = std::min(it->second, this->target - it->first + 1);
+    it++;
+  }
+}
+
+void BlockSync::peerLoop(const uint64_t index, const std::atomic<bool>& stop) {
+  using Clock = std::chrono::steady_clock;
+  using Range = std::pair<uint64_t, uint64_t>;
+  const uint64_t chainId = this->options->getChainID();
+  const P2P::NodeID nodeId = this->peers[index].id;
+  Clock::duration took;
+  runSyncWorker(this->mutex, this->cv, stop,
+    [&]() { return this->finished; },
+    [&]() { return this->takeRange(this->peers[index]); },
+    [&](const Range& range) {
+      const auto& [first, count] = range;
+      // Check the blocks against the header chain before paying for their
+      // signatures, the header (what the block hash is made of) sits right
+      // after the validator signature
+      const Clock::time_point requested = Clock::now();
+      std::vector<Bytes> raw = this->p2p->requestBlocks(nodeId, first, count);
+      took = Clock::now() - requested;
+      std::vector<Block> blocks;
+      try {
+        if (raw.size() > count) throw std::runtime_error("got more blocks than requested");
+        blocks.reserve(raw.size());
+        for (uint64_t i = 0; i < raw.size(); i++) {
+          if (raw[i].size() < 209) throw std::runtime_error("block too short");
+          if (Utils::sha3(BytesArrView(raw[i]).subspan(65, 144)) != this->headerChain[first + i - this->base]) {
+            throw std::runtime_error("block " + std::to_string(first + i) + " is not the one in the header chain");
+          }
+          blocks.emplace_back(raw[i], chainId);
+        }
+      } catch (const std::exception& e) {
+        Logger::logToDebug(LogType::WARNING, Log::syncer, __func__,
+          "Invalid blocks from " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + ": " + e.what()
+        );
+        blocks.clear();
+      }
+      return blocks;
+    },
+    [&](const Range& range, std::vector<Block>&& blocks) {
+      const auto& [first, count] = range;
+      Peer& peer = this->peers[index];
+      if (blocks.empty()) {
+        this->retries.emplace_back(range);
+        peer.window = std::max<uint64_t>(peer.window / 2, 1);
+        if (peer.failed()) this->dropPeer(peer);
+      } else {
+        if (blocks.size() < count) this->retries.emplace_back(first + blocks.size(), count - blocks.size());
+        if (blocks.size() == count && took < targetLatency) peer.window = std::min(peer.window * 2, maxWindow);
+        peer.delivered(blocks.size());
+        for (uint64_t i = 0; i < blocks.size(); i++) this->ready.emplace(first + i, std::move(blocks[i]));
+      }
+      return peer.alive;
+    }
+  );
+}
+
+uint64_t BlockSync::sync(
+  const std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash>& nodes,
+  const std::atomic<bool>& stop
+) {
+  const std::shared_ptr<const Block> latest = this->storage->latest();
+  this->peers.clear();
+  this->headerChain.clear();
+  this->headerSources.clear();
+  this->retries.clear();
+  this->ready.clear();
+  this->finished = false;
+  this->base = latest->getNHeight() + 1;
+  for (const auto& [nodeId, nodeInfo] : nodes) {
+    if (nodeInfo.latestBlockHeight >= this->base) {
+      this->peers.push_back({SyncPeer(nodeId), nodeInfo.latestBlockHeight, initialWindow});
+    }
+  }
+  this->alivePeers = this->peers.size();
+  if (this->peers.empty()) return 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  this->target = this->base - 1;  // Nothing to sync until we know the header chain
+  // Every chain that gets disputed drops at least one peer, so this ends
+  this->fetchHeaderChain(latest);
+  while (!this->headerChain.empty() && !this->crossCheckHeaderChain()) this->fetchHeaderChain(latest);
+  if (this->headerChain.empty()) {
+    Logger::logToDebug(LogType::WARNING, Log::syncer, __func__, "Could not get the header chain from any peer");
+    return 0;
+  }
+  this->target = this->base + this->headerChain.size() - 1;
+  this->nextRange = this->base;
+  this->nextApply = this->base;
+  // Peers past the header chain are capped to it, what they have beyond it wasn't checked
+  for (Peer& peer : this->peers) peer.height = std::min(peer.height, this->target);
+  Logger::logToDebug(LogType::INFO, Log::syncer, __func__,
+    "Syncing blocks " + std::to_string(this->base) + " to " + std::to_string(this->target)
+    + " from " + std::to_string(this->alivePeers) + " peers"
+  );
+
+  std::vector<std::future<void>> workers;
+  for (uint64_t i = 0; i < this->peers.size(); i++) {
+    if (this->peers[i].alive) workers.emplace_back(std::async(std::launch::async, &BlockSync::peerLoop, this, i, std::ref(stop)));
+  }
+
+  // Apply verified blocks in order as they come in
+  while (!stop) {
+    std::unique_lock lock(this->mutex);
+    this->cv.wait_for(lock, std::chrono::milliseconds(100), [&]() {
+      return this->ready.contains(this->nextApply) || this->nextApply > this->target || this->alivePeers == 0;
+    });
+    auto it = this->ready.find(this->nextApply);
+    if (it == this->ready.end()) {
+      if (this->nextApply > this->target || this->alivePeers == 0) break;
+      continue;
+    }
+    Block block = std::move(it->second);
+    this->ready.erase(it);
+    lock.unlock();
+    if (!this->state->tryProcessNextBlock(std::move(block))) {
+      // It matched the header chain and its signatures check out, so the chain itself is bad
+      const Peer& source = this->peers[this->headerSources[this->nextApply - this->base]];
+      Logger::logToDebug(LogType::ERROR, Log::syncer, __func__,
+        "Block " + std::to_string(this->nextApply) + " from the header chain (supplied by "
+        + source.id.first.to_string() + ":" + std::to_string(source.id.second) + ") is invalid, stopping sync"
+      );
+      break;
+    }
+    lock.lock();
+    this->nextApply++;
+    lock.unlock();
+    this->cv.notify_all();  // Peers might be waiting on `maxBlocksAhead`
+  }
+
+  {
+    std::unique_lock lock(this->mutex);
+    this->finished = true;
+  }
+  this->cv.notify_all();
+  for (auto& worker : workers) worker.get();
+
+  const uint64_t applied = this->nextApply - this->base;
+  Logger::logToDebug(LogType::INFO, Log::syncer, __func__,
+    "Applied " + std::to_string(applied) + " blocks in " + std::to_string(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+    ) + "ms, blocks per peer:" + SyncPeer::describe(this->peers)
+  );
+  return applied;
+}
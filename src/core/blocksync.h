@@ -0,0 +1,153 @@
+#ifndef BLOCKSYNC_H
+#define BLOCKSYNC_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+
+#include "../net/p2p/managernormal.h"
+#include "../utils/block.h"
+#include "../utils/options.h"
+#include "../utils/utils.h"
+#include "syncpeer.h"
+
+// Forward declarations.
+class Storage;
+class State;
+
+/**
+ * Downloads and applies the blocks we're missing, from several peers at once.
+ *
+ * A sync goes as follows:
+ * 1. the header chain from our latest block up to the highest peer is fetched
+ *    (`RequestHeaders`) and checked to link up, so every block that arrives
+ *    afterwards can be matched against the hash expected at its height, no
+ *    matter which peer sent it or in which order it arrived. Headers aren't
+ *    signed, so the chain is then cross-checked with every other peer (see
+ *    crossCheckHeaderChain()) before any peer is judged by it;
+ * 2. each peer gets a worker that keeps requesting block ranges (`RequestBlocks`)
+ *    sized by a window of its own: doubled when the peer answers in full and
+ *    quickly, halved when it fails. Downloaded blocks are decoded (which checks
+ *    every signature) by the worker that got them, so verification runs in
+ *    parallel with the other downloads and with the blocks being applied;
+ * 3. verified blocks are applied in order through State::tryProcessNextBlock().
+ *
+ * Ranges a peer fails to deliver are handed to the next free peer. A peer that
+ * fails SyncPeer::maxFailures times in a row is dropped, and the sync stops short
+ * if no peer is left that reaches the remaining blocks. Not thread-safe, one
+ * sync at a time.
+ */
+class BlockSync {
+  public:
+    /// Window (in blocks) every peer starts with.
+    static constexpr uint64_t initialWindow = 16;
+
+    /// Largest window a peer can get to.
+    static constexpr uint64_t maxWindow = P2P::ManagerNormal::maxBlocksPerRequest;
+
+    /// Maximum number of blocks downloaded ahead of the next one to be applied.
+    static constexpr uint64_t maxBlocksAhead = 2048;
+
+    /// A peer only gets a bigger window if it answered within this time.
+    static constexpr std::chrono::milliseconds targetLatency{1000};
+
+  private:
+    /// A peer blocks are downloaded from.
+    struct Peer : SyncPeer {
+      uint64_t height;            ///< Height of the peer's latest block.
+      uint64_t window;            ///< Number of blocks asked from it at once.
+    };
+
+    const std::unique_ptr<P2P::ManagerNormal>& p2p;   ///< Reference to the P2P connection manager.
+    const std::unique_ptr<Storage>& storage;          ///< Reference to the blockchain's storage.
+    const std::unique_ptr<State>& state;              ///< Reference to the blockchain's state.
+    const std::unique_ptr<Options>& options;          ///< Reference to the options singleton.
+
+    std::vector<Peer> peers;                            ///< Peers of the current sync.
+    uint64_t alivePeers = 0;                            ///< Number of peers still used.
+    std::vector<Hash> headerChain;                      ///< Expected block hashes, from `base` on.
+    std::vector<uint64_t> headerSources;                ///< Index in `peers` of the peer each header came from.
+    uint64_t base = 0;                                  ///< Height of the first block to sync.
+    uint64_t target = 0;                                ///< Height of the last block to sync.
+    uint64_t nextRange = 0;                             ///< Height of the first block not yet handed to a peer.
+    uint64_t nextApply = 0;                             ///< Height of the next block to be applied.
+    std::deque<std::pair<uint64_t, uint64_t>> retries;  ///< Ranges (first height and count) to be handed again.
+    std::map<uint64_t, Block> ready;                    ///< Verified blocks waiting to be applied, by height.
+    bool finished = false;                              ///< Whether the current sync is over.
+    std::mutex mutex;                                   ///< Mutex for managing access to the sync state above.
+    std::condition_variable cv;                         ///< Signals changes to the sync state above.
+
+    /**
+     * Fetch and check the header chain from our latest block on.
+     * Peers are tried from the highest, picking up where the last one stopped.
+     * Peers whose headers don't link up are dropped.
+     * @param latest Our latest block.
+     */
+    void fetchHeaderChain(const std::shared_ptr<const Block>& latest);
+
+    /**
+     * Cross-check the header chain with the peers that didn't supply it, by
+     * asking each one for its header at the last height both reach (a header
+     * hash commits to every header before it). Peers that don't answer don't count.
+     * If more peers disagree than agree (the chain itself counting as one vote),
+     * the peers that supplied it are dropped and the chain is cleared, to be
+     * fetched again from the others. Otherwise the peers that disagree are
+     * dropped, as they can't serve the blocks of this chain.
+     * @return `true` if the chain was kept, `false` if it was cleared.
+     */
+    bool crossCheckHeaderChain();
+
+    /**
+     * Hand a range of blocks to a peer, previously failed ranges first. Caller must hold `mutex`.
+     * @param peer The peer.
+     * @return The range (first height and count), or an empty optional if there's nothing the peer can do now.
+     */
+    std::optional<std::pair<uint64_t, uint64_t>> takeRange(const Peer& peer);
+
+    /**
+     * Stop using a peer. Caller must hold `mutex`.
+     * If the remaining peers don't reach `target` anymore, it's lowered to what they reach.
+     * @param peer The peer.
+     */
+    void dropPeer(Peer& peer);
+
+    /**
+     * Download and verify blocks from a peer until the sync is over or the peer is dropped (see runSyncWorker()).
+     * @param index Index of the peer in `peers`.
+     * @param stop Flag for stopping early.
+     */
+    void peerLoop(const uint64_t index, const std::atomic<bool>& stop);
+
+  public:
+    /**
+     * Constructor.
+     * @param p2p Reference to the P2P connection manager.
+     * @param storage Reference to the blockchain's storage.
+     * @param state Reference to the blockchain's state.
+     * @param options Reference to the options singleton.
+     */
+    BlockSync(
+      const std::unique_ptr<P2P::ManagerNormal>& p2p,
+      const std::unique_ptr<Storage>& storage,
+      const std::unique_ptr<State>& state,
+      const std::unique_ptr<Options>& options
+    ) : p2p(p2p), storage(storage), state(state), options(options) {}
+
+    /**
+     * Sync with the given peers, up to the highest of them.
+     * @param nodes The peers to sync from and their info.
+     * @param stop Flag for stopping early.
+     * @return The number of blocks applied.
+     */
+    uint64_t sync(
+      const std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash>& nodes,
+      const std::atomic<bool>& stop
+    );
+};
+
+#endif  // BLOCKSYNC_H
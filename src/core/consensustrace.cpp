@@ -0,0 +1,119 @@
+#include "consensustrace.h"
+
+ConsensusTrace::ConsensusTrace(const uint64_t& capacity) : capacity(std::max<uint64_t>(capacity, 1)) {
+  this->entries.reserve(this->capacity);
+}
+
+void ConsensusTrace::record(const uint64_t& height, const ConsensusEvent& event, const Address& validator) {
+  uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()
+  ).count();
+  std::lock_guard lock(this->mutex);
+  if (this->entries.size() < this->capacity) {
+    this->entries.push_back({height, event, validator, timestamp});
+    return;
+  }
+  this->entries[this->next] = {height, event, validator, timestamp};
+  this->next = (this->next + 1) % this->capacity;
+}
+
+std::vector<ConsensusTrace::Entry> ConsensusTrace::getEntries(const uint64_t& fromHeight) const {
+  std::vector<Entry> ret;
+  std::lock_guard lock(this->mutex);
+  ret.reserve(this->entries.size());
+  // Once full, the oldest event is the one to be overwritten next
+  for (uint64_t i = 0; i < this->entries.size(); i++) {
+    const Entry& entry = this->entries[(this->next + i) % this->entries.size()];
+    if (entry.height >= fromHeight) ret.push_back(entry);
+  }
+  return ret;
+}
+
+std::string ConsensusTrace::eventName(const ConsensusEvent& event) {
+  switch (event) {
+    case ConsensusEvent::TipSeen: return "tipSeen";
+    case ConsensusEvent::RandomHashSent: return "randomHashSent";
+    case ConsensusEvent::RandomHashReceived: return "randomHashReceived";
+    case ConsensusEvent::SeedSent: return "seedSent";
+    case ConsensusEvent::SeedReceived: return "seedReceived";
+    case ConsensusEvent::SeedsComplete: return "seedsComplete";
+    case ConsensusEvent::BlockAssembled: return "blockAssembled";
+    case ConsensusEvent::BlockSigned: return "blockSigned";
+    case ConsensusEvent::BlockValidated: return "blockValidated";
+    case ConsensusEvent::BlockProcessed: return "blockProcessed";
+    case ConsensusEvent::BlockBroadcast: return "blockBroadcast";
+    case ConsensusEvent::BlockReceived: return "blockReceived";
+    case ConsensusEvent::BlockRelayed: return "blockRelayed";
+  }
+  return "unknown";
+}
+
+json ConsensusTrace::toJSON(const uint64_t& fromHeight) const {
+  std::map<uint64_t, std::vector<Entry>> rounds;
+  for (Entry& entry : this->getEntries(fromHeight)) rounds[entry.height].push_back(std::move(entry));
+  json ret = json::array();
+  for (const auto& [height, events] : rounds) {
+    // Events are recorded by different threads, so they may be slightly out of order
+    uint64_t start = events.front().timestamp;
+    uint64_t end = events.front().timestamp;
+    for (const Entry& entry : events) {
+      start = std::min(start, entry.timestamp);
+      end = std::max(end, entry.timestamp);
+    }
+    json round;
+    round["height"] = height;
+    round["start"] = start;
+    round["duration"] = end - start;
+    round["events"] = json::array();
+    for (const Entry& entry : events) {
+      json event;
+      event["event"] = eventName(entry.event);
+      event["timestamp"] = entry.timestamp;
+      event["elapsed"] = entry.timestamp - start;
+      if (entry.validator != Address()) event["validator"] = entry.validator.hex(true).get();
+      round["events"].push_back(std::move(event));
+    }
+    ret.push_back(std::move(round));
+  }
+  return ret;
+}
+
+json ConsensusTrace::toChromeTrace(const uint64_t& fromHeight) const {
+  json traceEvents = json::array();
+  // Track 0 holds the rounds and our own events, each validator gets the next free one
+  std::unordered_map<Address, uint64_t, SafeHash> tracks;
+  auto trackOf = [&](const Address& validator) -> uint64_t {
+    if (validator == Address()) return 0;
+    auto [it, inserted] = tracks.try_emplace(validator, tracks.size() + 1);
+    if (inserted) {
+      traceEvents.push_back({
+        {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", it->second},
+        {"args", {{"name", "Validator " + validator.hex(true).get()}}}
+      });
+    }
+    return it->second;
+  };
+  traceEvents.push_back({
+    {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 0}, {"args", {{"name", "Rounds"}}}
+  });
+
+  for (const json& round : this->toJSON(fromHeight)) {
+    uint64_t height = round["height"];
+    traceEvents.push_back({
+      {"name", "Block " + std::to_string(height)}, {"cat", "round"}, {"ph", "X"},
+      {"ts", round["start"]}, {"dur", round["duration"]}, {"pid", 1}, {"tid", 0},
+      {"args", {{"height", height}}}
+    });
+    for (const json& event : round["events"]) {
+      Address validator = event.contains("validator")
+        ? Address(Hex::toBytes(event["validator"].get<std::string>())) : Address();
+      json args = {{"height", height}};
+      if (event.contains("validator")) args["validator"] = event["validator"];
+      traceEvents.push_back({
+        {"name", event["event"]}, {"cat", "consensus"}, {"ph", "i"}, {"s", "t"},
+        {"ts", event["timestamp"]}, {"pid", 1}, {"tid", trackOf(validator)}, {"args", std::move(args)}
+      });
+    }
+  }
+  return {{"traceEvents", std::move(traceEvents)}, {"displayTimeUnit", "ms"}};
+}
@@ -0,0 +1,105 @@
+#ifndef CONSENSUSTRACE_H
+#define CONSENSUSTRACE_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../utils/safehash.h"
+#include "../utils/utils.h"
+
+/// Enum for the milestones of a consensus round, as seen by a node.
+enum class ConsensusEvent {
+  TipSeen,              ///< The round started (previous block is the new tip).
+  RandomHashSent,       ///< We broadcast our randomHash transaction.
+  RandomHashReceived,   ///< A randomHash transaction got into our mempool (ours included).
+  SeedSent,             ///< We broadcast our randomSeed transaction.
+  SeedReceived,         ///< A randomSeed transaction got into our mempool (ours included).
+  SeedsComplete,        ///< Every Validator transaction for the block is in our mempool.
+  BlockAssembled,       ///< We assembled the block (as its creator).
+  BlockSigned,          ///< We signed the block (as its creator).
+  BlockValidated,       ///< The block header passed validation.
+  BlockProcessed,       ///< The block was executed and appended to the chain.
+  BlockBroadcast,       ///< We broadcast the block (as its creator).
+  BlockReceived,        ///< The block arrived from a peer.
+  BlockRelayed          ///< We rebroadcast a block received from a peer.
+};
+
+/**
+ * Timeline of the latest consensus rounds, for finding the slow phase or the slow validator.
+ *
+ * The rdPoS worker, the Syncer, State and the P2P manager record timestamped
+ * events per block height, which are kept in a fixed-size ring buffer (the oldest
+ * ones are dropped first). Timestamps are wall-clock, so timelines exported by
+ * different nodes can be lined up. Thread-safe.
+ */
+class ConsensusTrace {
+  public:
+    /// A recorded event.
+    struct Entry {
+      uint64_t height;        ///< Height of the block the round is for.
+      ConsensusEvent event;   ///< What happened.
+      Address validator;      ///< Validator the event is about (e.g. sender of a transaction), if any.
+      uint64_t timestamp;     ///< Epoch timestamp of the event, in microseconds.
+    };
+
+    /// Default number of events kept.
+    static constexpr uint64_t defaultCapacity = 4096;
+
+  private:
+    const uint64_t capacity;        ///< Maximum number of events kept.
+    std::vector<Entry> entries;     ///< The ring buffer.
+    uint64_t next = 0;              ///< Position of the next event in `entries` once it's full.
+    mutable std::mutex mutex;       ///< Mutex for managing read/write access to `entries` and `next`.
+
+  public:
+    /**
+     * Constructor.
+     * @param capacity Maximum number of events kept.
+     */
+    explicit ConsensusTrace(const uint64_t& capacity = defaultCapacity);
+
+    /**
+     * Record an event, timestamped now.
+     * @param height Height of the block the round is for.
+     * @param event What happened.
+     * @param validator Validator the event is about, if any.
+     */
+    void record(const uint64_t& height, const ConsensusEvent& event, const Address& validator = Address());
+
+    /**
+     * Get the recorded events, oldest first.
+     * @param fromHeight Leave out events of lower heights.
+     * @return The events.
+     */
+    std::vector<Entry> getEntries(const uint64_t& fromHeight = 0) const;
+
+    /**
+     * Get the name of an event.
+     * @param event The event.
+     * @return The name (e.g. "randomHashReceived").
+     */
+    static std::string eventName(const ConsensusEvent& event);
+
+    /**
+     * Export the timeline as JSON, grouped by height, oldest first.
+     * Each event carries its time since the first event of its height.
+     * @param fromHeight Leave out events of lower heights.
+     * @return `[{"height": n, "start": ts, "duration": us, "events": [{"event",
+     *         "timestamp", "elapsed", "validator"?}, ...]}, ...]`.
+     */
+    json toJSON(const uint64_t& fromHeight = 0) const;
+
+    /**
+     * Export the timeline in the Chrome trace event format (chrome://tracing, Perfetto).
+     * Each height becomes a span, and each event an instant. Events about a
+     * validator go to a track of their own, named after it.
+     * @param fromHeight Leave out events of lower heights.
+     * @return The trace, as `{"traceEvents": [...], "displayTimeUnit": "ms"}`.
+     */
+    json toChromeTrace(const uint64_t& fromHeight = 0) const;
+};
+
+#endif  // CONSENSUSTRACE_H
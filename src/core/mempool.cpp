@@ -0,0 +1,172 @@
+#include "mempool.h"
+
+#include <queue>
+
+uint64_t Mempool::countPending(const SenderQueue& queue) {
+  uint64_t expected = queue.nonce;
+  for (const auto& [nonce, hash] : queue.txs) {
+    if (nonce != expected) break;
+    expected++;
+  }
+  return expected - queue.nonce;
+}
+
+void Mempool::erase(FlatHashMap<Hash, TxBlock>::iterator it) {
+  const TxBlock& tx = it->second;
+  this->byFee.erase(FeeKey(effectiveFee(tx), it->first));
+  this->totalBytes -= tx.rlpSize();
+  auto senderIt = this->senders.find(tx.getFrom());
+  if (senderIt != this->senders.end()) senderIt->second.txs.erase(uint64_t(tx.getNonceU256()));
+  this->txs.erase(it);
+  this->version++;
+}
+
+void Mempool::refreshSender(FlatHashMap<Address, SenderQueue>::iterator it) {
+  SenderQueue& queue = it->second;
+  this->pendingCount -= queue.pending;
+  if (queue.txs.empty()) {
+    this->senders.erase(it);
+    return;
+  }
+  queue.pending = countPending(queue);
+  this->pendingCount += queue.pending;
+}
+
+void Mempool::eraseFrom(const Address& from, uint64_t nonce) {
+  auto senderIt = this->senders.find(from);
+  if (senderIt == this->senders.end()) return;
+  std::vector<Hash> hashes;
+  auto& queue = senderIt->second.txs;
+  for (auto it = queue.lower_bound(nonce); it != queue.end(); it++) hashes.emplace_back(it->second);
+  for (const Hash& hash : hashes) this->erase(this->txs.find(hash));
+  this->refreshSender(senderIt);
+}
+
+const TxBlock* Mempool::find(const Hash& txHash) const {
+  auto it = this->txs.find(txHash);
+  return (it != this->txs.end()) ? &it->second : nullptr;
+}
+
+TxInvalid Mempool::add(TxBlock&& tx, const Hash& txHash, const uint64_t& accountNonce) {
+  if (this->txs.contains(txHash)) return TxInvalid::NotInvalid;
+  if (!tx.getNonceU256().fitsUint64()) return TxInvalid::InvalidNonce;
+  const uint64_t nonce = uint64_t(tx.getNonceU256());
+  const Address from = tx.getFrom();
+  const U256 fee = effectiveFee(tx);
+  const uint64_t txSize = tx.rlpSize();
+  auto senderIt = this->senders.find(from);
+  const uint64_t baseNonce = (senderIt != this->senders.end()) ? senderIt->second.nonce : accountNonce;
+  if (nonce < baseNonce || nonce - baseNonce > this->maxNonceGap) return TxInvalid::InvalidNonce;
+
+  // Same sender and nonce can only be replaced by a higher fee
+  auto findReplaced = [&]() -> FlatHashMap<Hash, TxBlock>::iterator {
+    auto sIt = this->senders.find(from);
+    if (sIt == this->senders.end()) return this->txs.end();
+    auto nIt = sIt->second.txs.find(nonce);
+    if (nIt == sIt->second.txs.end()) return this->txs.end();
+    return this->txs.find(nIt->second);
+  };
+  auto replaced = findReplaced();
+  if (replaced != this->txs.end() && fee <= effectiveFee(replaced->second)) return TxInvalid::Underpriced;
+
+  // Evict the cheapest transactions until the new one fits, as long as it pays more than them.
+  // Eviction may remove the replaced transaction as well, so look it up again every time.
+  while (true) {
+    replaced = findReplaced();
+    bool replacing = (replaced != this->txs.end());
+    uint64_t count = this->txs.size() + (replacing ? 0 : 1);
+    uint64_t bytes = this->totalBytes + txSize - (replacing ? replaced->second.rlpSize() : 0);
+    if (count <= this->maxTxs && bytes <= this->maxBytes) break;
+    if (this->byFee.empty() || this->byFee.begin()->first >= fee) return TxInvalid::Underpriced;
+    const TxBlock& lowest = this->txs.find(this->byFee.begin()->second)->second;
+    const Address lowestFrom = lowest.getFrom();
+    this->eraseFrom(lowestFrom, uint64_t(lowest.getNonceU256()));
+  }
+  if (replaced != this->txs.end()) {
+    this->erase(replaced);
+    senderIt = this->senders.find(from);
+    if (senderIt != this->senders.end()) this->refreshSender(senderIt);
+  }
+
+  // Insert into every index
+  senderIt = this->senders.find(from);
+  if (senderIt == this->senders.end()) {
+    senderIt = this->senders.emplace(from, SenderQueue()).first;
+    senderIt->second.nonce = accountNonce;
+  }
+  senderIt->second.txs.emplace(nonce, txHash);
+  this->byFee.emplace(fee, txHash);
+  this->totalBytes += txSize;
+  this->txs.emplace(txHash, std::move(tx));
+  this->version++;
+  this->refreshSender(senderIt);
+  return TxInvalid::NotInvalid;
+}
+
+bool Mempool::remove(const Hash& txHash) {
+  auto it = this->txs.find(txHash);
+  if (it == this->txs.end()) return false;
+  const Address from = it->second.getFrom();
+  this->erase(it);
+  auto senderIt = this->senders.find(from);
+  if (senderIt != this->senders.end()) this->refreshSender(senderIt);
+  return true;
+}
+
+uint64_t Mempool::updateSender(const Address& from, const uint64_t& accountNonce, const U256& balance) {
+  auto senderIt = this->senders.find(from);
+  if (senderIt == this->senders.end()) return 0;
+  senderIt->second.nonce = accountNonce;
+  std::vector<Hash> dropped;
+  for (const auto& [nonce, hash] : senderIt->second.txs) {
+    if (nonce < accountNonce) { dropped.emplace_back(hash); continue; }
+    try {
+      if (this->txs.find(hash)->second.getMaxCost() > balance) dropped.emplace_back(hash);
+    } catch (const std::overflow_error&) {
+      dropped.emplace_back(hash);
+    }
+  }
+  for (const Hash& hash : dropped) this->erase(this->txs.find(hash));
+  this->refreshSender(senderIt);
+  return dropped.size();
+}
+
+std::vector<Address> Mempool::getSenders() const {
+  std::vector<Address> ret;
+  ret.reserve(this->senders.size());
+  for (const auto& [from, queue] : this->senders) ret.emplace_back(from);
+  return ret;
+}
+
+void Mempool::pick(const std::function<Pick(const TxBlock&)>& visitor) const {
+  // Heap of the next executable transaction of each sender, best fee on top
+  struct Head {
+    U256 fee;
+    Hash hash;
+    std::map<uint64_t, Hash>::const_iterator it;
+    uint64_t left;
+  };
+  auto worse = [](const Head& a, const Head& b) {
+    return (a.fee != b.fee) ? (a.fee < b.fee) : (a.hash > b.hash);
+  };
+  std::priority_queue<Head, std::vector<Head>, decltype(worse)> heads(worse);
+  for (const auto& [from, queue] : this->senders) {
+    if (queue.pending == 0) continue;
+    auto it = queue.txs.cbegin();
+    heads.push(Head{effectiveFee(this->txs.find(it->second)->second), it->second, it, queue.pending});
+  }
+
+  while (!heads.empty()) {
+    Head head = heads.top();
+    heads.pop();
+    Pick pick = visitor(this->txs.find(head.hash)->second);
+    if (pick == Pick::Stop) return;
+    if (pick == Pick::SkipSender) continue;
+    // Only the next nonce of the same sender becomes available, if it is pending too
+    if (--head.left == 0) continue;
+    head.it++;
+    head.hash = head.it->second;
+    head.fee = effectiveFee(this->txs.find(head.hash)->second);
+    heads.push(head);
+  }
+}
@@ -0,0 +1,212 @@
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#include <functional>
+#include <map>
+#include <set>
+
+#include "../utils/flathashmap.h"
+#include "../utils/safehash.h"
+#include "../utils/strings.h"
+#include "../utils/tx.h"
+#include "../utils/utils.h"
+
+// TODO: We could possibly change the bool functions
+// into a enum function, to be able to properly return each error case
+// We need this in order to slash invalid rdPoS blocks.
+/// Enum for labeling transaction validity.
+enum TxInvalid { NotInvalid, InvalidNonce, InvalidBalance, Underpriced };
+
+/**
+ * Pool of block transactions waiting to be included in a block.
+ *
+ * Transactions are kept in one queue per sender, ordered by nonce.
+ * Transactions that follow the sender's account nonce without gaps are
+ * "pending" (executable right now), the rest are "future" (waiting for the
+ * missing nonces to arrive). A global index orders every transaction by its
+ * effective fee (maxFeePerGas, as that is what State charges), which is used
+ * both for eviction when the pool is full and for block building.
+ *
+ * Insertion and removal are O(log n). Does NOT validate transactions
+ * against the State nor lock anything, that is up to the State.
+ */
+class Mempool {
+  public:
+    /// Enum for what a block building visitor wants to do with the transaction it was given. See pick().
+    enum class Pick {
+      Take,         ///< Take the transaction and move on to the sender's next nonce.
+      SkipSender,   ///< Don't take it, nor any other transaction from the same sender.
+      Stop          ///< Stop picking transactions.
+    };
+
+    /// Default maximum number of transactions in the pool.
+    static const uint64_t defaultMaxTxs = 65536;
+
+    /// Default maximum size of the pool (sum of RLP-serialized transactions), in bytes.
+    static const uint64_t defaultMaxBytes = 64 * 1024 * 1024;
+
+    /// Default maximum distance between a transaction's nonce and its sender's account nonce.
+    static const uint64_t defaultMaxNonceGap = 64;
+
+  private:
+    /// Nonce-ordered queue of transactions from a single sender.
+    struct SenderQueue {
+      uint64_t nonce = 0;               ///< Current account nonce of the sender.
+      uint64_t pending = 0;             ///< Number of transactions right after `nonce` without gaps.
+      std::map<uint64_t, Hash> txs;     ///< Transaction hashes by nonce.
+    };
+
+    /// Entry for the fee index. Ordered by fee, then hash (for determinism).
+    typedef std::pair<U256, Hash> FeeKey;
+
+    /// All transactions in the pool, by hash.
+    FlatHashMap<Hash, TxBlock> txs;
+
+    /// Per-sender nonce queues.
+    FlatHashMap<Address, SenderQueue> senders;
+
+    /// Every transaction in the pool, ordered by effective fee (lowest first).
+    std::set<FeeKey> byFee;
+
+    /// Sum of the RLP-serialized size of every transaction in the pool, in bytes.
+    uint64_t totalBytes = 0;
+
+    /// Number of times a transaction was added to or removed from the pool.
+    uint64_t version = 0;
+
+    /// Sum of the pending transactions across all senders.
+    uint64_t pendingCount = 0;
+
+    const uint64_t maxTxs;        ///< Maximum number of transactions in the pool.
+    const uint64_t maxBytes;      ///< Maximum size of the pool, in bytes.
+    const uint64_t maxNonceGap;   ///< Maximum distance between a tx nonce and its sender's account nonce.
+
+    /**
+     * Get the effective fee of a transaction, used for ordering.
+     * @param tx The transaction.
+     * @return The transaction's effective fee per gas.
+     */
+    static U256 effectiveFee(const TxBlock& tx) { return tx.getMaxFeePerGasU256(); }
+
+    /**
+     * Count how many transactions follow a sender's nonce without gaps.
+     * @param queue The sender's queue.
+     * @return The number of pending transactions.
+     */
+    static uint64_t countPending(const SenderQueue& queue);
+
+    /**
+     * Remove a transaction from every index, including its sender's queue.
+     * The caller must call refreshSender() afterwards.
+     * @param it Iterator to the transaction in `txs`.
+     */
+    void erase(FlatHashMap<Hash, TxBlock>::iterator it);
+
+    /**
+     * Recount a sender's pending transactions, and drop its queue if empty.
+     * @param it Iterator to the sender in `senders`.
+     */
+    void refreshSender(FlatHashMap<Address, SenderQueue>::iterator it);
+
+    /**
+     * Remove a transaction from a sender's queue and every higher nonce after it.
+     * Used for eviction, as higher nonces can't be executed without it anyway.
+     * @param from The sender.
+     * @param nonce The nonce to start removing from.
+     */
+    void eraseFrom(const Address& from, uint64_t nonce);
+
+  public:
+    /**
+     * Constructor.
+     * @param maxTxs (optional) Maximum number of transactions in the pool.
+     * @param maxBytes (optional) Maximum size of the pool, in bytes.
+     * @param maxNonceGap (optional) Maximum distance between a tx nonce and its sender's account nonce.
+     */
+    Mempool(
+      const uint64_t& maxTxs = defaultMaxTxs,
+      const uint64_t& maxBytes = defaultMaxBytes,
+      const uint64_t& maxNonceGap = defaultMaxNonceGap
+    ) : maxTxs(maxTxs), maxBytes(maxBytes), maxNonceGap(maxNonceGap) {}
+
+    /// Getter for `txs`.
+    inline const FlatHashMap<Hash, TxBlock>& getTxs() const { return this->txs; }
+
+    /// Get the number of transactions in the pool.
+    inline uint64_t size() const { return this->txs.size(); }
+
+    /// Getter for `totalBytes`.
+    inline uint64_t getBytes() const { return this->totalBytes; }
+
+    /// Getter for `pendingCount`.
+    inline uint64_t getPendingCount() const { return this->pendingCount; }
+
+    /// Get the number of future (not yet executable) transactions.
+    inline uint64_t getFutureCount() const { return this->txs.size() - this->pendingCount; }
+
+    /// Getter for `maxNonceGap`.
+    inline uint64_t getMaxNonceGap() const { return this->maxNonceGap; }
+
+    /// Getter for `version`. Tells whether `txs` changed between two calls.
+    inline uint64_t getVersion() const { return this->version; }
+
+    /**
+     * Check if a transaction is in the pool.
+     * @param txHash The transaction hash.
+     * @return `true` if the transaction is in the pool, `false` otherwise.
+     */
+    inline bool contains(const Hash& txHash) const { return this->txs.contains(txHash); }
+
+    /**
+     * Get a transaction from the pool.
+     * @param txHash The transaction hash.
+     * @return A pointer to the transaction, or `nullptr` if not found.
+     */
+    const TxBlock* find(const Hash& txHash) const;
+
+    /**
+     * Add a transaction to the pool.
+     * A transaction with the same sender and nonce as an existing one replaces it
+     * only if it pays a higher fee. If the pool is full, the lowest-fee transactions
+     * (and the higher nonces of their senders) are evicted to make room, but only if
+     * the new transaction pays more than them.
+     * @param tx The transaction to add. Will be moved only if accepted.
+     * @param txHash The transaction hash.
+     * @param accountNonce The current account nonce of the sender.
+     * @return `NotInvalid` if added, `InvalidNonce` if the nonce is stale or too far
+     *         ahead, `Underpriced` if the fee isn't enough to replace or evict.
+     */
+    TxInvalid add(TxBlock&& tx, const Hash& txHash, const uint64_t& accountNonce);
+
+    /**
+     * Remove a single transaction from the pool.
+     * Higher nonces from the same sender become future transactions.
+     * @param txHash The transaction hash.
+     * @return `true` if the transaction was removed, `false` if not found.
+     */
+    bool remove(const Hash& txHash);
+
+    /**
+     * Update a sender's queue after its account changed (e.g. after a block).
+     * Drops transactions with nonces below the new account nonce and
+     * transactions the sender can no longer afford on their own.
+     * @param from The sender.
+     * @param accountNonce The new account nonce.
+     * @param balance The new account balance.
+     * @return The number of dropped transactions.
+     */
+    uint64_t updateSender(const Address& from, const uint64_t& accountNonce, const U256& balance);
+
+    /// Get the list of senders with transactions in the pool.
+    std::vector<Address> getSenders() const;
+
+    /**
+     * Visit pending transactions from the best to the worst effective fee,
+     * while keeping each sender's transactions in nonce order (a sender's
+     * next nonce only becomes available after the previous one is taken).
+     * @param visitor Function called for each transaction, telling what to do next.
+     */
+    void pick(const std::function<Pick(const TxBlock&)>& visitor) const;
+};
+
+#endif  // MEMPOOL_H
@@ -3,6 +3,7 @@
 #include "state.h"
 #include "../contract/contractmanager.h"
 #include "../utils/block.h"
+#include "../utils/blockbuilder.h"
 
 rdPoS::rdPoS(const std::unique_ptr<DB>& db,
   const std::unique_ptr<Storage>& storage,
@@ -47,6 +48,9 @@ rdPoS::rdPoS(const std::unique_ptr<DB>& db,
   randomGen.setSeed(bestRandomSeed);
   this->randomList = std::vector<Validator>(this->validators.begin(), this->validators.end());
   randomGen.shuffle(randomList);
+  this->startRound();
+  this->publishValidators();
+  this->publishMempool();
 }
 
 rdPoS::~rdPoS() {
@@ -222,9 +226,48 @@ Hash rdPoS::processBlock(const Block& block) {
   this->bestRandomSeed = block.getBlockRandomness();
   randomGen.setSeed(bestRandomSeed);
   randomGen.shuffle(randomList);
+  this->startRound();
+  this->publishValidators();
+  this->publishMempool();
   return this->bestRandomSeed;
 }
 
+void rdPoS::reset(const std::set<Validator>& validators, const Block& block) {
+  std::unique_lock lock(this->mutex);
+  if (!block.isFinalized()) {
+    Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "Block is not finalized.");
+    throw std::runtime_error("Block is not finalized.");
+  }
+  this->validators = validators;
+  validatorMempool.clear();
+  this->randomList = std::vector<Validator>(this->validators.begin(), this->validators.end());
+  this->bestRandomSeed = block.getBlockRandomness();
+  randomGen.setSeed(bestRandomSeed);
+  randomGen.shuffle(randomList);
+  this->startRound();
+  this->publishValidators();
+  this->publishMempool();
+}
+
+void rdPoS::startRound() {
+  this->participantSlots.clear();
+  for (uint64_t slot = 0; slot < this->minValidators && slot + 1 < this->randomList.size(); slot++) {
+    this->participantSlots.emplace(this->randomList[slot + 1], slot);
+  }
+  this->slotTxs.assign(this->minValidators, {});
+}
+
+void rdPoS::publishValidators() {
+  this->validatorsSnapshot.store(std::make_shared<const std::set<Validator>>(this->validators));
+  this->randomListSnapshot.store(std::make_shared<const std::vector<Validator>>(this->randomList));
+}
+
+void rdPoS::publishMempool() {
+  this->mempoolSnapshot.store(
+    std::make_shared<const std::unordered_map<Hash, TxValidator, SafeHash>>(this->validatorMempool)
+  );
+}
+
 void rdPoS::signBlock(Block &block) {
   uint64_t newTimestamp = std::chrono::duration_cast<std::chrono::microseconds>(
     std::chrono::high_resolution_clock::now().time_since_epoch()
@@ -233,6 +276,15 @@ void rdPoS::signBlock(Block &block) {
   this->worker->blockCreated();
 }
 
+Block rdPoS::signBlock(BlockBuilder&& builder) {
+  uint64_t newTimestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::high_resolution_clock::now().time_since_epoch()
+  ).count();
+  Block block = builder.finalize(this->validatorKey, newTimestamp);
+  this->worker->blockCreated();
+  return block;
+}
+
 bool rdPoS::addValidatorTx(const TxValidator& tx) {
   std::unique_lock lock(this->mutex);
   if (this->validatorMempool.contains(tx.hash())) {
@@ -249,15 +301,9 @@ bool rdPoS::addValidatorTx(const TxValidator& tx) {
     return false;
   }
 
-  // Check if sender is a validator and can participate in this rdPoS round (check from existance in randomList)
-  bool participates = false;
-  for (uint64_t i = 1; i < this->minValidators + 1; ++i) {
-    if (Validator(tx.getFrom()) == randomList[i]) {
-      participates = true;
-      break;
-    }
-  }
-  if (!participates) {
+  // Check if sender is a validator and can participate in this rdPoS round (has a slot in it)
+  auto slot = this->participantSlots.find(tx.getFrom());
+  if (slot == this->participantSlots.end()) {
     Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__,
       "TxValidator sender is not a validator or is not participating in this rdPoS round."
     );
@@ -265,28 +311,42 @@ bool rdPoS::addValidatorTx(const TxValidator& tx) {
   }
 
   // Do not allow duplicate transactions for the same function, we only have two functions (2 TxValidator per validator per block)
-  std::vector<TxValidator> txs;
-  for (auto const& [key, value] : validatorMempool) {
-    if (value.getFrom() == tx.getFrom()) txs.push_back(value);
+  TxValidatorFunction function = this->getTxValidatorFunction(tx);
+  if (function == TxValidatorFunction::INVALID) {
+    Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "TxValidator function is invalid.");
+    return false;
   }
-
-  if (txs.size() == 0) { // No transactions from this sender yet, add it.
-    validatorMempool.emplace(tx.hash(), tx);
-    return true;
-  } else if (txs.size() == 1) { // We already have one transaction from this sender, check if it is the same function.
-    if (txs[0].getFunctor() == tx.getFunctor()) {
-      Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "TxValidator sender already has a transaction for this function.");
-      return false;
-    }
-    validatorMempool.emplace(tx.hash(), tx);
-  } else { // We already have two transactions from this sender, it is the max we can have per validator.
-    Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "TxValidator sender already has two transactions.");
+  std::optional<Hash>& slotTx = this->slotTxs[slot->second][(function == TxValidatorFunction::RANDOMHASH) ? 0 : 1];
+  if (slotTx) {
+    Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "TxValidator sender already has a transaction for this function.");
     return false;
   }
-
+  slotTx = tx.hash();
+  this->validatorMempool.emplace(tx.hash(), tx);
+  this->publishMempool();
+  this->trace.record(tx.getNHeight(), (function == TxValidatorFunction::RANDOMHASH)
+    ? ConsensusEvent::RandomHashReceived : ConsensusEvent::SeedReceived, tx.getFrom()
+  );
+  if (std::all_of(this->slotTxs.begin(), this->slotTxs.end(), [](const auto& slot) { return slot[0] && slot[1]; })) {
+    this->trace.record(tx.getNHeight(), ConsensusEvent::SeedsComplete);
+  }
+  this->worker->notify();
   return true;
 }
 
+std::optional<std::vector<TxValidator>> rdPoS::getBlockTxValidators() const {
+  std::shared_lock lock(this->mutex);
+  std::vector<TxValidator> txs;
+  txs.reserve(this->minValidators * 2);
+  for (uint64_t function = 0; function < 2; function++) {
+    for (const auto& slot : this->slotTxs) {
+      if (!slot[function]) return std::nullopt;
+      txs.emplace_back(this->validatorMempool.at(*slot[function]));
+    }
+  }
+  return txs;
+}
+
 void rdPoS::initializeBlockchain() {
   auto validatorsDb = db->getBatch(DBPrefix::rdPoS);
   if (validatorsDb.size() == 0) {
@@ -344,6 +404,8 @@ void rdPoS::startrdPoSWorker() { this->worker->start(); }
 
 void rdPoS::stoprdPoSWorker() { this->worker->stop(); }
 
+void rdPoS::notifyWorker() { this->worker->notify(); }
+
 bool rdPoSWorker::checkLatestBlock() {
   if (this->latestBlock == nullptr) {
     this->latestBlock = this->rdpos.storage->latest();
@@ -353,59 +415,64 @@ bool rdPoSWorker::checkLatestBlock() {
   return false;
 }
 
+bool rdPoSWorker::waitFor(const std::function<bool()>& ready) {
+  std::unique_lock lock(this->eventMutex);
+  bool met = this->eventCv.wait_for(lock, this->pullInterval, [&]() { return this->stopWorker || ready(); });
+  return met && !this->stopWorker;
+}
+
+void rdPoSWorker::notify() {
+  // Lock before notifying, so the worker can't miss it between checking its condition and waiting
+  { std::lock_guard lock(this->eventMutex); }
+  this->eventCv.notify_all();
+}
+
+void rdPoSWorker::pullValidatorTxs() {
+  auto connectedNodesList = this->rdpos.p2p->getSessionsIDs();
+  for (auto const& nodeId : connectedNodesList) {
+    if (this->checkLatestBlock() || this->stopWorker) break;
+    auto txList = this->rdpos.p2p->requestValidatorTxs(nodeId);
+    if (this->checkLatestBlock() || this->stopWorker) break;
+    for (auto const& tx : txList) this->rdpos.state->addValidatorTx(tx);
+  }
+}
+
 bool rdPoSWorker::workerLoop() {
   Validator me(Secp256k1::toAddress(Secp256k1::toUPub(this->rdpos.validatorKey)));
   this->latestBlock = this->rdpos.storage->latest();
   while (!this->stopWorker) {
+    this->rdpos.trace.record(this->latestBlock->getNHeight() + 1, ConsensusEvent::TipSeen);
     // Check if we are the validator required for signing the block.
     bool isBlockCreator = false;
-    // Scope for unique_lock.
-    {
-      std::unique_lock checkValidatorsList(this->rdpos.mutex);
-      if (me == this->rdpos.randomList[0]) {
-        isBlockCreator = true;
-        checkValidatorsList.unlock();
-        doBlockCreation();
-      }
+    const auto randomList = this->rdpos.getRandomList();
+    if (me == (*randomList)[0]) {
+      isBlockCreator = true;
+      doBlockCreation();
+    }
 
-      // Check if we are one of the rdPoS that need to create random transactions.
-      if (!isBlockCreator) {
-        for (uint64_t i = 1; i <= this->rdpos.minValidators; ++i) {
-          if (me == this->rdpos.randomList[i]) {
-            checkValidatorsList.unlock();
-            doTxCreation(latestBlock->getNHeight() + 1, me);
-          }
-        }
+    // Check if we are one of the rdPoS that need to create random transactions.
+    if (!isBlockCreator) {
+      for (uint64_t i = 1; i <= this->rdpos.minValidators; ++i) {
+        if (me == (*randomList)[i]) doTxCreation(latestBlock->getNHeight() + 1, me);
       }
     }
 
-    // After processing everything. wait until the new block is appended to the chain.
-    while (!this->checkLatestBlock() && !this->stopWorker) {
+    // Sign our transactions for the next round while we wait, in case we're picked for it.
+    this->prepareTxs(latestBlock->getNHeight() + 2, me);
+
+    // After processing everything, wait until the new block is appended to the chain.
+    while (!this->waitFor([&]() { return this->checkLatestBlock(); }) && !this->stopWorker) {
       Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
         "Waiting for new block to be appended to the chain. (Height: "
         + std::to_string(latestBlock->getNHeight()) + ")" + " latest height: "
         + std::to_string(this->rdpos.storage->latest()->getNHeight())
       );
+      uint64_t mempoolSize = this->rdpos.getMempool()->size();
       Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
-        "Currently has " + std::to_string(this->rdpos.validatorMempool.size())
-        + " transactions in mempool."
+        "Currently has " + std::to_string(mempoolSize) + " transactions in mempool."
       );
-      std::unique_lock mempoolSizeLock(this->rdpos.mutex);
-      uint64_t mempoolSize = this->rdpos.validatorMempool.size();
-      if (mempoolSize < this->rdpos.minValidators) { // Always try to fill the mempool to 8 transactions
-        mempoolSizeLock.unlock();
-        // Try to get more transactions from other nodes within the network
-        auto connectedNodesList = this->rdpos.p2p->getSessionsIDs();
-        for (auto const& nodeId : connectedNodesList) {
-          if (this->checkLatestBlock() || this->stopWorker) break;
-          auto txList = this->rdpos.p2p->requestValidatorTxs(nodeId);
-          if (this->checkLatestBlock() || this->stopWorker) break;
-          for (auto const& tx : txList) this->rdpos.state->addValidatorTx(tx);
-        }
-      } else {
-        mempoolSizeLock.unlock();
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(25));
+      // Always try to fill the mempool to 8 transactions
+      if (mempoolSize < this->rdpos.minValidators) this->pullValidatorTxs();
     }
     // Update latest block if necessary.
     if (isBlockCreator) this->canCreateBlock = false;
@@ -415,37 +482,24 @@ bool rdPoSWorker::workerLoop() {
 }
 
 void rdPoSWorker::doBlockCreation() {
-  // TODO: add requesting transactions to other nodes when mempool is not filled up
   Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Block creator: waiting for txs");
-  uint64_t validatorMempoolSize = 0;
-  while (validatorMempoolSize != this->rdpos.minValidators * 2 && !this->stopWorker)
-  {
+  while (!this->waitFor([&]() { return this->rdpos.getMempool()->size() >= this->rdpos.minValidators * 2; })) {
+    if (this->stopWorker) return;
     Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
-      "Block creator has: " + std::to_string(validatorMempoolSize) + " transactions in mempool"
+      "Block creator has: " + std::to_string(this->rdpos.getMempool()->size()) + " transactions in mempool"
     );
-    // Scope for lock.
-    {
-      std::unique_lock mempoolSizeLock(this->rdpos.mutex);
-      validatorMempoolSize = this->rdpos.validatorMempool.size();
-    }
-    // Try to get more transactions from other nodes within the network
-    auto connectedNodesList = this->rdpos.p2p->getSessionsIDs();
-    for (auto const& nodeId : connectedNodesList) {
-      auto txList = this->rdpos.p2p->requestValidatorTxs(nodeId);
-      if (this->stopWorker) return;
-      for (auto const& tx : txList) this->rdpos.state->addValidatorTx(tx);
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    this->pullValidatorTxs();
   }
   Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Validator ready to create a block");
   // After processing everything, we can let everybody know that we are ready to create a block
   this->canCreateBlock = true;
 }
 
-void rdPoSWorker::doTxCreation(const uint64_t& nHeight, const Validator& me) {
+std::optional<std::pair<TxValidator, TxValidator>> rdPoSWorker::createTxPair(
+  const uint64_t& nHeight, const Validator& me
+) const {
   Hash randomness = Hash::random();
   Hash randomHash = Utils::sha3(randomness.get());
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Creating random Hash transaction");
   Bytes randomHashBytes = Hex::toBytes("0xcfffe746");
   randomHashBytes.insert(randomHashBytes.end(), randomHash.get().begin(), randomHash.get().end());
   TxValidator randomHashTx(
@@ -471,41 +525,62 @@ void rdPoSWorker::doTxCreation(const uint64_t& nHeight, const Validator& me) {
   BytesArrView randomSeedTxView(seedTx.getData());
   if (Utils::sha3(randomSeedTxView.subspan(4)) != randomHashTxView.subspan(4)) {
     Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "RandomHash transaction is not valid!!!");
-    return;
+    return std::nullopt;
   }
+  return std::make_pair(std::move(randomHashTx), std::move(seedTx));
+}
+
+void rdPoSWorker::prepareTxs(const uint64_t& nHeight, const Validator& me) {
+  if (this->preparedTxs && this->preparedTxs->first.getNHeight() == nHeight) return;
+  this->preparedTxs = this->createTxPair(nHeight, me);
+}
+
+void rdPoSWorker::doTxCreation(const uint64_t& nHeight, const Validator& me) {
+  using Clock = std::chrono::steady_clock;
+  auto elapsed = [](const Clock::time_point& from, const Clock::time_point& to) {
+    return std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+  };
+  const Clock::time_point start = Clock::now();
+  std::optional<std::pair<TxValidator, TxValidator>> txs;
+  bool prepared = (this->preparedTxs && this->preparedTxs->first.getNHeight() == nHeight);
+  if (prepared) {
+    txs.swap(this->preparedTxs);
+  } else {
+    Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Creating random Hash transaction");
+    txs = this->createTxPair(nHeight, me);
+  }
+  if (!txs) return;
+  auto& [randomHashTx, seedTx] = *txs;
 
   // Append to mempool and broadcast the transaction across all nodes.
   Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Broadcasting randomHash transaction");
   this->rdpos.state->addValidatorTx(randomHashTx);
   this->rdpos.p2p->broadcastTxValidator(randomHashTx);
+  const Clock::time_point hashSent = Clock::now();
 
   // Wait until we received all randomHash transactions to broadcast the randomness transaction
   Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Waiting for randomHash transactions to be broadcasted");
-  uint64_t validatorMempoolSize = 0;
-  while (validatorMempoolSize < this->rdpos.minValidators && !this->stopWorker) {
+  while (!this->waitFor([&]() { return this->rdpos.getMempool()->size() >= this->rdpos.minValidators; })) {
+    if (this->stopWorker) return;
     Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
-      "Validator has: " + std::to_string(validatorMempoolSize) + " transactions in mempool"
+      "Validator has: " + std::to_string(this->rdpos.getMempool()->size()) + " transactions in mempool"
     );
-    // Scope for lock
-    {
-      std::unique_lock mempoolSizeLock(this->rdpos.mutex);
-      validatorMempoolSize = this->rdpos.validatorMempool.size();
-    }
-    // Try to get more transactions from other nodes within the network
-    auto connectedNodesList = this->rdpos.p2p->getSessionsIDs();
-    for (auto const& nodeId : connectedNodesList) {
-      if (this->stopWorker) return;
-      auto txList = this->rdpos.p2p->requestValidatorTxs(nodeId);
-      for (auto const& tx : txList) this->rdpos.state->addValidatorTx(tx);
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    this->pullValidatorTxs();
   }
+  const Clock::time_point hashesIn = Clock::now();
 
   Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Broadcasting random transaction");
   // Append and broadcast the randomness transaction.
   this->rdpos.state->addValidatorTx(seedTx);
   this->rdpos.p2p->broadcastTxValidator(seedTx);
+  const Clock::time_point seedSent = Clock::now();
+  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
+    "Block " + std::to_string(nHeight) + " round: randomHash sent after " + elapsed(start, hashSent) + "us"
+    + (prepared ? " (signed ahead)" : "") + ", every randomHash in after " + elapsed(hashSent, hashesIn) + "us"
+    + ", seed sent after " + elapsed(hashesIn, seedSent) + "us"
+  );
 }
+
 void rdPoSWorker::start() {
   if (this->rdpos.isValidator && !this->workerFuture.valid()) {
     this->workerFuture = std::async(std::launch::async, &rdPoSWorker::workerLoop, this);
@@ -515,6 +590,7 @@ void rdPoSWorker::start() {
 void rdPoSWorker::stop() {
   if (this->workerFuture.valid()) {
     this->stopWorker = true;
+    this->notify();
     this->workerFuture.wait();
     this->workerFuture.get();
   }
@@ -8,7 +8,14 @@
 #include "../utils/randomgen.h"
 #include "../utils/options.h"
 #include "../net/p2p/managernormal.h"
-
+#include "consensustrace.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <shared_mutex>
 
@@ -16,6 +23,7 @@
 class rdPoSWorker;
 class Storage;
 class Block;
+class BlockBuilder;
 class State;
 
 // "0x6fc5a2d6" -> Function for random tx
@@ -81,6 +89,15 @@ class rdPoS : public BaseContract {
     /// Mempool for validator transactions.
     std::unordered_map<Hash, TxValidator, SafeHash> validatorMempool;
 
+    /// Slot of each validator participating in the current round (`randomList[slot + 1]`).
+    std::unordered_map<Address, uint64_t, SafeHash> participantSlots;
+
+    /**
+     * Index of `validatorMempool` by (slot, function): hashes of the randomHash
+     * (`[slot][0]`) and randomSeed (`[slot][1]`) transactions of each participant.
+     */
+    std::vector<std::array<std::optional<Hash>, 2>> slotTxs;
+
     /// Private key for operating a validator.
     const PrivKey validatorKey;
 
@@ -96,6 +113,27 @@ class rdPoS : public BaseContract {
     /// Mutex for managing read/write access to the class members.
     mutable std::shared_mutex mutex;
 
+    /// Timeline of the latest consensus rounds. Thread-safe on its own.
+    ConsensusTrace trace;
+
+    /// Immutable copy of `validators`, republished whenever it changes. See getValidators().
+    std::atomic<std::shared_ptr<const std::set<Validator>>> validatorsSnapshot;
+
+    /// Immutable copy of `randomList`, republished whenever it changes. See getRandomList().
+    std::atomic<std::shared_ptr<const std::vector<Validator>>> randomListSnapshot;
+
+    /// Immutable copy of `validatorMempool`, republished whenever it changes. See getMempool().
+    std::atomic<std::shared_ptr<const std::unordered_map<Hash, TxValidator, SafeHash>>> mempoolSnapshot;
+
+    /// Republish `validatorsSnapshot` and `randomListSnapshot`. Mutex must be locked by the caller.
+    void publishValidators();
+
+    /// Republish `mempoolSnapshot`. Mutex must be locked by the caller.
+    void publishMempool();
+
+    /// Rebuild `participantSlots` from `randomList` and empty `slotTxs`. Mutex must be locked by the caller.
+    void startRound();
+
     /**
      * Initializes the blockchain with the default information for rdPoS.
      * Called by the constructor if no previous blockchain is found.
@@ -130,14 +168,28 @@ class rdPoS : public BaseContract {
     /// Minimum number of required Validators for creating and signing blocks.
     static const uint32_t minValidators = 4;
 
-    /// Getter for `validators`. Not a reference because the inner set can be changed.
-    const std::set<Validator> getValidators() const { std::shared_lock lock(this->mutex); return validators; }
+    /**
+     * Upper bound of the size of a Validator transaction within a block (RLP plus size prefix),
+     * in bytes. Used to leave room for them when a block is filled before they're all in.
+     */
+    static const uint64_t maxTxValidatorSize = 256;
+
+    /**
+     * Getter for `validators`. Lock-free and allocation-free: returns an immutable
+     * snapshot, which stays the same for as long as the caller holds it.
+     */
+    std::shared_ptr<const std::set<Validator>> getValidators() const { return this->validatorsSnapshot.load(); }
 
-    /// Getter for `randomList`. Not a reference because the inner vector can be changed.
-    const std::vector<Validator> getRandomList() const { std::shared_lock lock(this->mutex); return randomList; }
+    /// Getter for `randomList`. Returns an immutable snapshot, see getValidators().
+    std::shared_ptr<const std::vector<Validator>> getRandomList() const { return this->randomListSnapshot.load(); }
 
-    /// Getter for `mempool`. Not a reference because the inner map can be changed.
-    const std::unordered_map<Hash, TxValidator, SafeHash> getMempool() const { std::shared_lock lock(this->mutex); return validatorMempool; }
+    /// Getter for `validatorMempool`. Returns an immutable snapshot, see getValidators().
+    std::shared_ptr<const std::unordered_map<Hash, TxValidator, SafeHash>> getMempool() const {
+      return this->mempoolSnapshot.load();
+    }
+
+    /// Getter for `trace`, used by every component taking part in a round to record its milestones.
+    ConsensusTrace& getTrace() { return this->trace; }
 
     /// Getter for `bestRandomSeed`.
     const Hash getBestRandomSeed() const { std::shared_lock lock(this->mutex); return bestRandomSeed; }
@@ -156,7 +208,19 @@ class rdPoS : public BaseContract {
     const bool isValidatorAddress(const Address& add) const { std::shared_lock lock(this->mutex); return validators.contains(Validator(add)); }
 
     /// Clear the mempool.
-    void clearMempool() { std::unique_lock lock(this->mutex); validatorMempool.clear(); }
+    void clearMempool() {
+      std::unique_lock lock(this->mutex);
+      this->validatorMempool.clear();
+      for (auto& slot : this->slotTxs) slot.fill(std::nullopt);
+      this->publishMempool();
+    }
+
+    /**
+     * Get the Validator transactions for the next block, in the order it expects them:
+     * every randomHash transaction, then every randomSeed transaction, both by slot.
+     * @return The transactions, or `std::nullopt` if any of them is still missing.
+     */
+    std::optional<std::vector<TxValidator>> getBlockTxValidators() const;
 
     /**
      * Validate a block.
@@ -174,12 +238,29 @@ class rdPoS : public BaseContract {
      */
     Hash processBlock(const Block& block);
 
+    /**
+     * Replace the validator set and start the next round from a block that doesn't
+     * follow the latest one (e.g. the block a state snapshot was taken at).
+     * Should be called from State, together with Storage::resetTo().
+     * @param validators The new validator set.
+     * @param block The block to start from.
+     * @throw std::runtime_error if block is not finalized.
+     */
+    void reset(const std::set<Validator>& validators, const Block& block);
+
     /**
      * Sign a block using the Validator's private key.
      * @param block The block to sign.
      */
     void signBlock(Block& block);
 
+    /**
+     * Finalize a block from a builder and sign it using the Validator's private key.
+     * @param builder The builder holding the block's contents. Will be moved.
+     * @return The finalized block.
+     */
+    Block signBlock(BlockBuilder&& builder);
+
     /**
      * Add a Validator transaction to the mempool.
      * Should ONLY be called by the State, as it locks the current state mutex,
@@ -217,6 +298,13 @@ class rdPoS : public BaseContract {
     /// Stop the rdPoSWorker.
     void stoprdPoSWorker();
 
+    /**
+     * Wake the rdPoSWorker up to recheck the chain tip and the mempool.
+     * Called on every accepted validator transaction, and by State once a
+     * processed block is appended to storage.
+     */
+    void notifyWorker();
+
     /// Worker class is a friend.
     friend rdPoSWorker;
 };
@@ -245,6 +333,28 @@ class rdPoSWorker {
     /// Pointer to the latest block.
     std::shared_ptr<const Block> latestBlock;
 
+    /// Mutex for `eventCv`.
+    std::mutex eventMutex;
+
+    /// Signals that the chain tip or the mempool changed, or that the worker is stopping. See notify().
+    std::condition_variable eventCv;
+
+    /**
+     * Wait until a condition is met, the worker is stopped, or `pullInterval`
+     * passes without any event meeting it.
+     * @param ready The condition. Checked again on every event.
+     * @return `true` if the condition is met, `false` otherwise.
+     */
+    bool waitFor(const std::function<bool()>& ready);
+
+    /**
+     * Ask every connected node for the validator transactions we may have
+     * missed. Only a fallback, as they're broadcast as soon as created.
+     * Each request carries the hashes we already have (including the ones
+     * just pulled from previous nodes), so only the missing ones come back.
+     */
+    void pullValidatorTxs();
+
     /**
      * Check if the latest block has updated.
      * Does NOT update latestBlock per se, this is done by workerLoop().
@@ -267,12 +377,39 @@ class rdPoSWorker {
 
     /**
      * Create a transaction by rdPoS consensus and broadcast it to the network.
+     * Uses the pair from prepareTxs() if there is one for the height.
      * @param nHeight The block height for the transaction.
      * @param me The Validator that will create the transaction.
      */
     void doTxCreation(const uint64_t& nHeight, const Validator& me);
 
+    /// randomHash and randomSeed transactions signed ahead of their round. See prepareTxs().
+    std::optional<std::pair<TxValidator, TxValidator>> preparedTxs;
+
+    /**
+     * Create and sign a new randomHash/randomSeed transaction pair.
+     * @param nHeight The block height for the transactions.
+     * @param me The Validator that will create the transactions.
+     * @return The pair, or `std::nullopt` if the randomHash doesn't match the seed.
+     */
+    std::optional<std::pair<TxValidator, TxValidator>> createTxPair(const uint64_t& nHeight, const Validator& me) const;
+
+    /**
+     * Create and sign the transaction pair of a future round while waiting
+     * for the current one to end, so it's ready to broadcast as soon as the
+     * round starts. Wasted if we end up not being picked for that round.
+     * @param nHeight The block height of that round.
+     * @param me The Validator that will create the transactions.
+     */
+    void prepareTxs(const uint64_t& nHeight, const Validator& me);
+
   public:
+    /**
+     * How long the worker waits for an event before pulling validator
+     * transactions from other nodes. Events (not this) drive the rounds.
+     */
+    static constexpr std::chrono::milliseconds pullInterval{100};
+
     /**
      * Constructor.
      * @param rdpos Reference to the parent rdPoS object.
@@ -291,6 +428,9 @@ class rdPoSWorker {
     /// Setter for `canCreateBlock`.
     void blockCreated() { canCreateBlock = false; }
 
+    /// Wake the worker up to recheck whatever it's waiting for.
+    void notify();
+
     /**
      * Start workerFuture and workerLoop.
      * Should only be called after node is synced.
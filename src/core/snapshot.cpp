@@ -0,0 +1,109 @@
+#include "snapshot.h"
+
+Bytes StateSnapshot::Manifest::serialize() const {
+  Bytes ret;
+  ret.reserve(8 + 32 + 4 + this->block.size() + 4 + (this->chunkHashes.size() * 32));
+  Utils::appendBytes(ret, Utils::uint64ToBytes(this->height));
+  Utils::appendBytes(ret, this->stateRoot);
+  Utils::appendBytes(ret, Utils::uint32ToBytes(this->block.size()));
+  Utils::appendBytes(ret, this->block);
+  Utils::appendBytes(ret, Utils::uint32ToBytes(this->chunkHashes.size()));
+  for (const Hash& chunkHash : this->chunkHashes) Utils::appendBytes(ret, chunkHash);
+  return ret;
+}
+
+std::optional<StateSnapshot::Manifest> StateSnapshot::Manifest::deserialize(const BytesArrView data) {
+  if (data.size() < 8 + 32 + 4) return std::nullopt;
+  Manifest ret;
+  ret.height = Utils::bytesToUint64(data.subspan(0, 8));
+  ret.stateRoot = Hash(data.subspan(8, 32));
+  uint64_t blockSize = Utils::bytesToUint32(data.subspan(40, 4));
+  if (data.size() < 44 + blockSize + 4) return std::nullopt;
+  ret.block = Bytes(data.begin() + 44, data.begin() + 44 + blockSize);
+  uint64_t index = 44 + blockSize;
+  uint64_t chunkCount = Utils::bytesToUint32(data.subspan(index, 4));
+  index += 4;
+  if (chunkCount > maxChunks || data.size() != index + (chunkCount * 32)) return std::nullopt;
+  ret.chunkHashes.reserve(chunkCount);
+  for (uint64_t i = 0; i < chunkCount; i++) ret.chunkHashes.emplace_back(data.subspan(index + (i * 32), 32));
+  return ret;
+}
+
+std::vector<Bytes> StateSnapshot::makeChunks(const std::map<Bytes, Bytes>& entries) {
+  // Each entry is 4 bytes (key size) + key + 4 bytes (value size) + value
+  std::vector<Bytes> ret;
+  Bytes chunk;
+  for (const auto& [key, value] : entries) {
+    Utils::appendBytes(chunk, Utils::uint32ToBytes(key.size()));
+    Utils::appendBytes(chunk, key);
+    Utils::appendBytes(chunk, Utils::uint32ToBytes(value.size()));
+    Utils::appendBytes(chunk, value);
+    if (chunk.size() >= chunkSize) {
+      ret.emplace_back(std::move(chunk));
+      chunk = Bytes();
+    }
+  }
+  if (!chunk.empty() || ret.empty()) ret.emplace_back(std::move(chunk));
+  if (ret.size() > maxChunks) {
+    throw std::runtime_error("Snapshot has too many chunks: " + std::to_string(ret.size()));
+  }
+  return ret;
+}
+
+StateSnapshot::Manifest StateSnapshot::makeManifest(
+  const uint64_t& height, Bytes&& block, const Hash& stateRoot, const std::vector<Bytes>& chunks
+) {
+  Manifest ret;
+  ret.height = height;
+  ret.block = std::move(block);
+  ret.stateRoot = stateRoot;
+  ret.chunkHashes.reserve(chunks.size());
+  for (const Bytes& chunk : chunks) ret.chunkHashes.emplace_back(Utils::sha3(chunk));
+  return ret;
+}
+
+StateSnapshot::StateSnapshot(
+  const uint64_t& height, Bytes block, const Hash& stateRoot, const std::map<Bytes, Bytes>& entries
+) : chunks(makeChunks(entries)),
+  manifest(makeManifest(height, std::move(block), stateRoot, this->chunks)),
+  manifestHash(Utils::sha3(this->manifest.serialize()))
+{}
+
+const Bytes* StateSnapshot::getChunk(const uint64_t& index) const {
+  if (index >= this->chunks.size()) return nullptr;
+  return &this->chunks[index];
+}
+
+bool StateSnapshot::isSnapshotKey(const BytesArrView key) {
+  if (key.size() <= 2) return false;
+  for (const Bytes& prefix : {
+    DBPrefix::nativeAccounts, DBPrefix::rdPoS, DBPrefix::contractManager, DBPrefix::contracts
+  }) {
+    if (std::equal(prefix.cbegin(), prefix.cend(), key.begin())) return true;
+  }
+  return false;
+}
+
+std::vector<DBEntry> StateSnapshot::decodeChunk(const BytesArrView chunk) {
+  std::vector<DBEntry> ret;
+  uint64_t index = 0;
+  // Reads a size-prefixed field, checking it's all there
+  auto readField = [&]() -> Bytes {
+    if (chunk.size() - index < 4) throw std::runtime_error("Snapshot chunk is truncated");
+    uint64_t size = Utils::bytesToUint32(chunk.subspan(index, 4));
+    index += 4;
+    if (chunk.size() - index < size) throw std::runtime_error("Snapshot chunk is truncated");
+    Bytes field(chunk.begin() + index, chunk.begin() + index + size);
+    index += size;
+    return field;
+  };
+  while (index < chunk.size()) {
+    Bytes key = readField();
+    if (!isSnapshotKey(key)) {
+      throw std::runtime_error("Snapshot chunk has a key outside of the state: " + Hex::fromBytes(key).get());
+    }
+    Bytes value = readField();
+    ret.emplace_back(std::move(key), std::move(value));
+  }
+  return ret;
+}
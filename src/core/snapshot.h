@@ -0,0 +1,126 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <map>
+#include <optional>
+
+#include "../utils/db.h"
+#include "../utils/utils.h"
+
+/**
+ * Snapshot of the state at a given block, for bootstrapping new nodes without
+ * replaying the whole chain.
+ *
+ * A snapshot holds the database entries the state is loaded from (native accounts,
+ * the rdPoS validator set, the contract registry and every contract's variables),
+ * sorted by key and split into chunks of about `chunkSize` bytes, so nodes with the
+ * same state produce the same chunks. The manifest describes the snapshot: the
+ * block it was taken at, the state root at that block (see StateTree) and the hash
+ * of every chunk. A node downloads the manifest and the chunks from its peers (see
+ * SnapshotSync), checks each chunk against the manifest and loads them with
+ * State::applySnapshot(). Immutable once built, so it's safe to share between threads.
+ */
+class StateSnapshot {
+  public:
+    /// Target size of a chunk, in bytes. Entries aren't split, so a chunk can go slightly over it.
+    static constexpr uint64_t chunkSize = 1024 * 1024;
+
+    /// Maximum number of chunks in a snapshot.
+    static constexpr uint64_t maxChunks = 65536;
+
+    /// Description of a snapshot.
+    struct Manifest {
+      uint64_t height = 0;              ///< Height of the block the snapshot was taken at.
+      Bytes block;                      ///< The serialized block the snapshot was taken at.
+      Hash stateRoot;                   ///< State root at that block.
+      std::vector<Hash> chunkHashes;    ///< Hash of every chunk, in order.
+
+      /**
+       * Serialize the manifest.
+       * @return 8 bytes (height) + 32 bytes (state root) + 4 bytes (block size) +
+       *         block + 4 bytes (chunk count) + 32 bytes per chunk hash.
+       */
+      Bytes serialize() const;
+
+      /**
+       * Deserialize a manifest.
+       * @param data The serialized manifest.
+       * @return The manifest, or an empty optional if it's malformed.
+       */
+      static std::optional<Manifest> deserialize(const BytesArrView data);
+    };
+
+  private:
+    const std::vector<Bytes> chunks;  ///< The snapshot's chunks.
+    const Manifest manifest;          ///< The snapshot's manifest.
+    const Hash manifestHash;          ///< Hash of the serialized manifest.
+
+    /**
+     * Encode database entries into chunks.
+     * @param entries The entries (full keys, prefix included), sorted by key.
+     * @return The chunks.
+     */
+    static std::vector<Bytes> makeChunks(const std::map<Bytes, Bytes>& entries);
+
+    /**
+     * Build the manifest of a set of chunks.
+     * @param height Height of the block the snapshot is taken at.
+     * @param block The serialized block the snapshot is taken at.
+     * @param stateRoot State root at that block.
+     * @param chunks The chunks.
+     * @return The manifest.
+     */
+    static Manifest makeManifest(
+      const uint64_t& height, Bytes&& block, const Hash& stateRoot, const std::vector<Bytes>& chunks
+    );
+
+  public:
+    /**
+     * Constructor. Builds the chunks and the manifest.
+     * @param height Height of the block the snapshot is taken at.
+     * @param block The serialized block the snapshot is taken at.
+     * @param stateRoot State root at that block.
+     * @param entries The state's database entries (full keys, prefix included).
+     *                Keys must pass isSnapshotKey().
+     * @throw std::runtime_error if the snapshot would have more than `maxChunks` chunks.
+     */
+    StateSnapshot(
+      const uint64_t& height, Bytes block, const Hash& stateRoot, const std::map<Bytes, Bytes>& entries
+    );
+
+    /// Getter for `manifest`.
+    const Manifest& getManifest() const { return this->manifest; }
+
+    /// Getter for `manifestHash`.
+    const Hash& getManifestHash() const { return this->manifestHash; }
+
+    /// Get the height of the block the snapshot was taken at.
+    const uint64_t& getHeight() const { return this->manifest.height; }
+
+    /// Get the number of chunks in the snapshot.
+    uint64_t getChunkCount() const { return this->chunks.size(); }
+
+    /**
+     * Get a chunk.
+     * @param index The chunk's index.
+     * @return The chunk, or `nullptr` if the index is out of range.
+     */
+    const Bytes* getChunk(const uint64_t& index) const;
+
+    /**
+     * Check if a database key belongs to the state a snapshot carries.
+     * @param key The full key, prefix included.
+     * @return `true` if it's under the native accounts, rdPoS, contract manager or contracts prefix.
+     */
+    static bool isSnapshotKey(const BytesArrView key);
+
+    /**
+     * Decode the entries of a chunk.
+     * @param chunk The chunk.
+     * @return The entries (full keys, prefix included), in order.
+     * @throw std::runtime_error if the chunk is malformed or has a key that isn't a snapshot key.
+     */
+    static std::vector<DBEntry> decodeChunk(const BytesArrView chunk);
+};
+
+#endif  // SNAPSHOT_H
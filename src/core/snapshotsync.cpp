@@ -0,0 +1,165 @@
+#include "snapshotsync.h"
+#include "storage.h"
+#include "state.h"
+
+bool SnapshotSync::pickManifest(
+  const std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash>& nodes,
+  const uint64_t& minHeight, const uint64_t& quorum
+) {
+  // Ask everyone at once, each request waits for its own answer
+  std::vector<std::pair<P2P::NodeID, std::future<Bytes>>> requests;
+  for (const auto& [nodeId, nodeInfo] : nodes) {
+    if (nodeInfo.latestBlockHeight < minHeight) continue;
+    requests.emplace_back(nodeId, std::async(std::launch::async,
+      &P2P::ManagerNormal::requestSnapshotManifest, this->p2p.get(), nodeId
+    ));
+  }
+
+  // Group the peers by the manifest they offer
+  std::unordered_map<Hash, std::pair<StateSnapshot::Manifest, std::vector<P2P::NodeID>>, SafeHash> offers;
+  for (auto& [nodeId, request] : requests) {
+    Bytes raw = request.get();
+    if (raw.empty()) continue;  // No snapshot, or the request failed
+    auto manifest = StateSnapshot::Manifest::deserialize(raw);
+    if (!manifest) {
+      Logger::logToDebug(LogType::WARNING, Log::syncer, __func__,
+        "Invalid snapshot manifest from " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second)
+      );
+      continue;
+    }
+    if (manifest->height < minHeight) continue;
+    auto& offer = offers.try_emplace(Utils::sha3(raw), std::move(*manifest), std::vector<P2P::NodeID>()).first->second;
+    offer.second.emplace_back(nodeId);
+  }
+
+  // Only a manifest enough peers agree on and with a block one of our validators signed is trusted
+  const std::pair<StateSnapshot::Manifest, std::vector<P2P::NodeID>>* best = nullptr;
+  for (const auto& [manifestHash, offer] : offers) {
+    if (offer.second.size() < quorum) continue;
+    if (best != nullptr && (offer.second.size() < best->second.size() ||
+      (offer.second.size() == best->second.size() && offer.first.height <= best->first.height)
+    )) continue;
+    if (!this->state->checkSnapshotBlock(offer.first)) continue;
+    best = &offer;
+  }
+  if (best == nullptr) {
+    if (!offers.empty()) {
+      Logger::logToDebug(LogType::WARNING, Log::syncer, __func__,
+        "None of the " + std::to_string(offers.size()) + " snapshots offered is valid and offered by "
+        + std::to_string(quorum) + " peers or more"
+      );
+    }
+    return false;
+  }
+  this->manifest = best->first;
+  this->peers.clear();
+  for (const P2P::NodeID& nodeId : best->second) this->peers.emplace_back(nodeId);
+  Logger::logToDebug(LogType::INFO, Log::syncer, __func__,
+    "Picked the snapshot of block " + std::to_string(this->manifest.height) + " ("
+    + std::to_string(this->manifest.chunkHashes.size()) + " chunks), offered by "
+    + std::to_string(this->peers.size()) + " of " + std::to_string(requests.size()) + " peers, "
+    + std::to_string(offers.size()) + " different snapshots offered"
+  );
+  return true;
+}
+
+void SnapshotSync::peerLoop(const uint64_t index, const std::atomic<bool>& stop) {
+  const P2P::NodeID nodeId = this->peers[index].id;
+  runSyncWorker(this->mutex, this->cv, stop,
+    [&]() { return this->remaining == 0; },
+    [&]() -> std::optional<uint64_t> {
+      if (this->pending.empty()) return std::nullopt;
+      uint64_t chunkIndex = this->pending.front();
+      this->pending.pop_front();
+      return chunkIndex;
+    },
+    [&](const uint64_t& chunkIndex) -> std::optional<std::vector<DBEntry>> {
+      // Check the chunk against the manifest before decoding it
+      Bytes chunk = this->p2p->requestSnapshotChunk(nodeId, this->manifest.height, chunkIndex);
+      try {
+        if (chunk.empty()) throw std::runtime_error("peer doesn't have it");
+        if (Utils::sha3(chunk) != this->manifest.chunkHashes[chunkIndex]) {
+          throw std::runtime_error("it doesn't match the manifest");
+        }
+        return StateSnapshot::decodeChunk(chunk);
+      } catch (const std::exception& e) {
+        Logger::logToDebug(LogType::WARNING, Log::syncer, __func__,
+          "Could not get snapshot chunk " + std::to_string(chunkIndex) + " from "
+          + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + ": " + e.what()
+        );
+        return std::nullopt;
+      }
+    },
+    [&](const uint64_t& chunkIndex, std::optional<std::vector<DBEntry>>&& chunkEntries) {
+      SyncPeer& peer = this->peers[index];
+      if (!chunkEntries) {
+        this->pending.emplace_back(chunkIndex);
+        if (peer.failed()) {
+          peer.alive = false;
+          this->alivePeers--;
+        }
+      } else {
+        peer.delivered(1);
+        this->entries[chunkIndex] = std::move(*chunkEntries);
+        this->remaining--;
+      }
+      return peer.alive;
+    }
+  );
+}
+
+uint64_t SnapshotSync::sync(
+  const std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash>& nodes,
+  const std::atomic<bool>& stop, const uint64_t& minAhead, const uint64_t& quorum
+) {
+  const uint64_t minHeight = this->storage->latest()->getNHeight() + std::max<uint64_t>(minAhead, 1);
+  if (!this->pickManifest(nodes, minHeight, std::max<uint64_t>(quorum, 1))) return 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  const uint64_t chunkCount = this->manifest.chunkHashes.size();
+  this->pending.clear();
+  for (uint64_t i = 0; i < chunkCount; i++) this->pending.emplace_back(i);
+  this->entries.assign(chunkCount, {});
+  this->remaining = chunkCount;
+  this->alivePeers = this->peers.size();
+
+  std::vector<std::future<void>> workers;
+  for (uint64_t i = 0; i < this->peers.size(); i++) {
+    workers.emplace_back(std::async(std::launch::async, &SnapshotSync::peerLoop, this, i, std::ref(stop)));
+  }
+  {
+    std::unique_lock lock(this->mutex);
+    while (!stop && this->remaining > 0 && this->alivePeers > 0) {
+      this->cv.wait_for(lock, std::chrono::milliseconds(100));
+    }
+  }
+  this->cv.notify_all();
+  for (auto& worker : workers) worker.get();
+
+  const std::string perPeer = SyncPeer::describe(this->peers);
+  if (this->remaining > 0) {
+    Logger::logToDebug(LogType::WARNING, Log::syncer, __func__,
+      "Could not download " + std::to_string(this->remaining) + " of " + std::to_string(chunkCount)
+      + " snapshot chunks, chunks per peer:" + perPeer
+    );
+    return 0;
+  }
+
+  std::vector<DBEntry> all;
+  for (auto& chunkEntries : this->entries) {
+    for (DBEntry& entry : chunkEntries) all.emplace_back(std::move(entry));
+  }
+  this->entries.clear();
+  if (!this->state->applySnapshot(this->manifest, all)) {
+    Logger::logToDebug(LogType::ERROR, Log::syncer, __func__,
+      "Snapshot of block " + std::to_string(this->manifest.height) + " is invalid, not applied"
+    );
+    return 0;
+  }
+  Logger::logToDebug(LogType::INFO, Log::syncer, __func__,
+    "Applied the snapshot of block " + std::to_string(this->manifest.height) + " in " + std::to_string(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+    ) + "ms, chunks per peer:" + perPeer
+  );
+  return this->manifest.height;
+}
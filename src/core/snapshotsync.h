@@ -0,0 +1,112 @@
+#ifndef SNAPSHOTSYNC_H
+#define SNAPSHOTSYNC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "../net/p2p/managernormal.h"
+#include "../utils/utils.h"
+#include "snapshot.h"
+#include "syncpeer.h"
+
+// Forward declarations.
+class Storage;
+class State;
+
+/**
+ * Bootstraps a new node from a state snapshot served by its peers, instead of
+ * replaying every block since genesis. Blocks after the snapshot are left to BlockSync.
+ *
+ * A sync goes as follows:
+ * 1. every peer ahead of us is asked for the manifest of its latest snapshot
+ *    (`RequestSnapshotManifest`). Manifests whose block isn't signed by one of our
+ *    validators are discarded, and of those offered by at least `quorum` peers, the
+ *    one offered by the most is picked (the highest one on a tie). Honest peers with
+ *    the same state build the same snapshot, so it's the one enough of them agree on
+ *    that is trusted;
+ * 2. each peer offering it gets a worker that keeps requesting chunks
+ *    (`RequestSnapshotChunk`). Every chunk is checked against its hash in the
+ *    manifest and decoded by the worker that got it, so verification runs in
+ *    parallel with the other downloads;
+ * 3. once every chunk is in, the snapshot is applied through State::applySnapshot(),
+ *    which checks the block again and every entry against the manifest state root.
+ *
+ * Peers are handled like BlockSync's (see runSyncWorker()): chunks a peer fails to
+ * deliver are handed to the next free peer, a peer that fails SyncPeer::maxFailures
+ * times in a row is dropped, and the sync fails if no peer is left. Only one sync
+ * can run at a time.
+ */
+class SnapshotSync {
+  public:
+    /// By default, a snapshot is only worth it if it's at least this many blocks ahead of us.
+    static constexpr uint64_t minBlocksAhead = 1000;
+
+    /// By default, minimum number of peers that must offer the same manifest.
+    static constexpr uint64_t defaultQuorum = 3;
+
+  private:
+    const std::unique_ptr<P2P::ManagerNormal>& p2p;   ///< Reference to the P2P connection manager.
+    const std::unique_ptr<Storage>& storage;          ///< Reference to the blockchain's storage.
+    const std::unique_ptr<State>& state;              ///< Reference to the blockchain's state.
+
+    StateSnapshot::Manifest manifest;                 ///< Manifest of the snapshot being synced.
+    std::vector<SyncPeer> peers;                      ///< Peers offering it.
+    uint64_t alivePeers = 0;                          ///< Number of peers still used.
+    std::deque<uint64_t> pending;                     ///< Indexes of the chunks not yet handed to a peer.
+    std::vector<std::vector<DBEntry>> entries;        ///< Entries of every chunk, by index.
+    uint64_t remaining = 0;                           ///< Number of chunks not yet downloaded.
+    std::mutex mutex;                                 ///< Mutex for managing access to the sync state above.
+    std::condition_variable cv;                       ///< Signals changes to the sync state above.
+
+    /**
+     * Ask the peers for the manifests of their snapshots and pick the one most of them offer.
+     * Sets `manifest` and `peers`.
+     * @param nodes The peers and their info.
+     * @param minHeight Lowest snapshot height worth syncing.
+     * @param quorum Minimum number of peers that must offer the manifest.
+     * @return `true` if a manifest was picked, `false` if no valid snapshot high
+     *         enough is offered by `quorum` peers.
+     */
+    bool pickManifest(
+      const std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash>& nodes,
+      const uint64_t& minHeight, const uint64_t& quorum
+    );
+
+    /**
+     * Download and verify chunks from a peer until there are none left or the peer is dropped (see runSyncWorker()).
+     * @param index Index of the peer in `peers`.
+     * @param stop Flag for stopping early.
+     */
+    void peerLoop(const uint64_t index, const std::atomic<bool>& stop);
+
+  public:
+    /**
+     * Constructor.
+     * @param p2p Reference to the P2P connection manager.
+     * @param storage Reference to the blockchain's storage.
+     * @param state Reference to the blockchain's state.
+     */
+    SnapshotSync(
+      const std::unique_ptr<P2P::ManagerNormal>& p2p,
+      const std::unique_ptr<Storage>& storage,
+      const std::unique_ptr<State>& state
+    ) : p2p(p2p), storage(storage), state(state) {}
+
+    /**
+     * Download and apply the snapshot most of the given peers agree on, if enough of them do.
+     * @param nodes The peers to sync from and their info.
+     * @param stop Flag for stopping early.
+     * @param minAhead Only snapshots at least this many blocks ahead of our latest block are synced.
+     * @param quorum Only snapshots offered by at least this many peers are synced.
+     * @return The height of the applied snapshot, or 0 if none was applied.
+     */
+    uint64_t sync(
+      const std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash>& nodes,
+      const std::atomic<bool>& stop, const uint64_t& minAhead = minBlocksAhead,
+      const uint64_t& quorum = defaultQuorum
+    );
+};
+
+#endif  // SNAPSHOTSYNC_H
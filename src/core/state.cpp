@@ -14,28 +14,32 @@ contractManager(std::make_unique<ContractManager>(this, db, rdpos, options))
   if (accountsFromDB.empty()) {
     // Initialize with 0x00dead00665771855a34155f5e7405489df2c3c6 with nonce 0.
     Address dev1(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6"));
-    // See ~State for encoding
-    uint256_t desiredBalance("1000000000000000000000");
-    Bytes value = Utils::uintToBytes(Utils::bytesRequired(desiredBalance));
-    Utils::appendBytes(value,Utils::uintToBytes(desiredBalance));
-    value.insert(value.end(), 0x00);
-    db->put(dev1.get(), value, DBPrefix::nativeAccounts);
+    Account devAccount(U256(uint256_t("1000000000000000000000")), 0);
+    db->put(dev1.get(), devAccount.serialize(), DBPrefix::nativeAccounts);
     accountsFromDB = db->getBatch(DBPrefix::nativeAccounts);
   }
 
-  for (auto const dbEntry : accountsFromDB) {
+  for (auto const& dbEntry : accountsFromDB) {
     BytesArrView data(dbEntry.value);
     if (dbEntry.key.size() != 20) {
       Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Error when loading State from DB, address from DB size mismatch");
       throw std::runtime_error("Error when loading State from DB, address from DB size mismatch");
     }
+    // Accounts are stored in a fixed-width encoding (see Account::serialize()).
+    // Older databases used a variable-width one, which is still read and
+    // replaced by the fixed-width one the next time the account changes.
+    if (data.size() == Account::serializedSize) {
+      this->accounts.insert({Address(dbEntry.key), Account(data)});
+      continue;
+    }
+    /// Value == 1 Byte (Balance Size) + N Bytes (Balance) + 1 Byte (Nonce Size) + N Bytes (Nonce).
     uint8_t balanceSize = Utils::fromBigEndian<uint8_t>(data.subspan(0,1));
-    if (data.size() + 1 < data.size()) {
+    if (data.size() < 2 + uint64_t(balanceSize)) {
       Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Error when loading State from DB, value from DB doesn't size mismatch on balanceSize");
       throw std::runtime_error("Error when loading State from DB, value from DB size mismatch on balanceSize");
     }
 
-    uint256_t balance = Utils::fromBigEndian<uint256_t>(data.subspan(1, balanceSize));
+    U256 balance = U256::fromBigEndian(data.subspan(1, balanceSize));
     uint8_t nonceSize = Utils::fromBigEndian<uint8_t>(data.subspan(1 + balanceSize, 1));
 
     if (2 + balanceSize + nonceSize != data.size()) {
@@ -44,47 +48,75 @@ contractManager(std::make_unique<ContractManager>(this, db, rdpos, options))
     }
     uint64_t nonce = Utils::fromBigEndian<uint64_t>(data.subspan(2 + balanceSize, nonceSize));
 
-    this->accounts.insert({Address(dbEntry.key), Account(std::move(balance), std::move(nonce))});
+    this->accounts.insert({Address(dbEntry.key), Account(balance, nonce)});
   }
-}
+  uint64_t latestHeight = this->storage->latest()->getNHeight();
+  this->view.store(std::make_shared<const StateView>(
+    latestHeight, std::make_shared<const StateView::Accounts>(this->accounts)
+  ));
 
-State::~State() {
-  /// DB is stored as following
-  /// Under the DBPrefix::nativeAccounts
-  /// Each key == Address
-  /// Each Value == Balance + uint256_t (not exact bytes)
-  /// Value == 1 Byte (Balance Size) + N Bytes (Balance) + 1 Byte (Nonce Size) + N Bytes (Nonce).
-  /// Max size for Value = 32 Bytes, Max Size for Nonce = 8 Bytes.
-  /// If the nonce equals to 0, it will be *empty*
-  DBBatch accountsBatch;
-  std::unique_lock lock(this->stateMutex);
-  for (const auto& [address, account] : this->accounts) {
-    // Serialize Balance.
-    Bytes serializedBytes;
-    if (account.balance == 0) {
-      serializedBytes = Bytes(1, 0x00);
-    } else {
-      serializedBytes = Utils::uintToBytes(Utils::bytesRequired(account.balance));
-      Utils::appendBytes(serializedBytes, Utils::uintToBytes(account.balance));
+  // The oldest entry of the history index is the oldest queryable block.
+  // If there's no history yet, start it from the current block.
+  auto oldestIndex = db->getCeiling(Utils::uint64ToBytes(0), DBPrefix::nativeAccountHistoryIndex);
+  if (oldestIndex) {
+    this->historyStart = Utils::bytesToUint64(oldestIndex->key);
+  } else {
+    DBBatch batch;
+    for (const auto& [address, account] : this->accounts) {
+      batch.push_back(historyKey(address, latestHeight), account.serialize(), DBPrefix::nativeAccountHistory);
     }
-    // Serialize Account.
-    if (account.nonce == 0) {
-      Utils::appendBytes(serializedBytes, Bytes(1, 0x00));
-    } else {
-      Utils::appendBytes(serializedBytes, Utils::uintToBytes(Utils::bytesRequired(account.nonce)));
-      Utils::appendBytes(serializedBytes, Utils::uintToBytes(account.nonce));
+    batch.push_back(Utils::uint64ToBytes(latestHeight), Bytes(), DBPrefix::nativeAccountHistoryIndex);
+    if (!db->putBatch(batch)) {
+      Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Failed to start the account history");
+      throw std::runtime_error("Failed to start the account history");
     }
-    accountsBatch.push_back(address.get(), serializedBytes, DBPrefix::nativeAccounts);
+    this->historyStart = latestHeight;
   }
 
-  this->db->putBatch(accountsBatch);
+  // Load the state tree and check it against the root saved for the latest block,
+  // as both are saved together. If the node stopped before the last update was
+  // saved (it's saved after the block), the tree is rebuilt from the whole state,
+  // which must still match the saved root if there's one.
+  this->stateTree = std::make_unique<StateTree>(*db);
+  Bytes savedRoot = db->get(Utils::uint64ToBytes(latestHeight), DBPrefix::stateRoots);
+  if (savedRoot.empty() || Hash(savedRoot) != this->stateTree->getRoot()) {
+    DBBatch others;
+    this->dumpValidatorsAndContracts(others);
+    this->stateTree = std::make_unique<StateTree>(stateEntries(this->accounts, others));
+    if (!savedRoot.empty() && Hash(savedRoot) != this->stateTree->getRoot()) {
+      Logger::logToDebug(LogType::ERROR, Log::state, __func__,
+        "State root mismatch at block " + std::to_string(latestHeight) + ": saved "
+        + Hash(savedRoot).hex().get() + ", rebuilt " + this->stateTree->getRoot().hex().get()
+      );
+      throw std::runtime_error("State root mismatch when loading State from DB");
+    }
+    DBBatch batch;
+    StateTree::erase(*db, batch);
+    this->stateTree->dump(batch);
+    batch.push_back(Utils::uint64ToBytes(latestHeight), this->stateTree->getRoot().get(), DBPrefix::stateRoots);
+    if (!db->putBatch(batch)) {
+      Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Failed to save the rebuilt state tree");
+      throw std::runtime_error("Failed to save the rebuilt state tree");
+    }
+  }
+  this->txAdmission = std::make_unique<TxAdmission>(*this, p2pManager, options);
+}
+
+State::~State() {
+  // Accounts are saved along with every block (see saveBlockToDB()) and by
+  // addBalance(), so there's only the admission pipeline to stop and the last
+  // snapshot and state root to wait for.
+  this->txAdmission->stop();
+  if (this->snapshotBuild.valid()) this->snapshotBuild.wait();
+  this->waitStateTree();
 }
 
 TxInvalid State::validateTransactionInternal(const TxBlock& tx) const {
   /**
    * Rules for a transaction to be accepted within the current state:
    * Transaction value + txFee (gas * gasPrice) needs to be lower than account balance
-   * Transaction nonce must match account nonce
+   * Transaction nonce must not be lower than the account nonce, nor too far ahead of it
+   * (higher nonces wait in the mempool as future transactions)
    */
 
   /// Verify if transaction already exists within the mempool, if on mempool, it has been validated previously.
@@ -99,24 +131,105 @@ TxInvalid State::validateTransactionInternal(const TxBlock& tx) const {
   }
   const auto& accBalance = accountIt->second.balance;
   const auto& accNonce = accountIt->second.nonce;
-  uint256_t txWithFees = tx.getValue() + (tx.getGasLimit() * tx.getMaxFeePerGas());
+  U256 txWithFees;
+  try {
+    txWithFees = tx.getMaxCost();
+  } catch (const std::overflow_error&) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__,
+                      "Transaction: " + tx.hash().hex().get() + " cost overflows 256 bits");
+    return TxInvalid::InvalidBalance;
+  }
   if (txWithFees > accBalance) {
     Logger::logToDebug(LogType::ERROR, Log::state, __func__,
                       "Transaction sender: " + tx.getFrom().hex().get() + " doesn't have balance to send transaction"
                       + " expected: " + txWithFees.str() + " has: " + accBalance.str());
     return TxInvalid::InvalidBalance;
   }
-  // TODO: The blockchain is able to store higher nonce transactions until they are valid
-  // Handle this case.
-  if (accNonce != tx.getNonce()) {
-    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction: " + tx.hash().hex().get() + " nonce mismatch, expected: " + std::to_string(accNonce)
-                                            + " got: " + tx.getNonce().str());
+  if (tx.getNonceU256() < accNonce || tx.getNonceU256() - accNonce > this->mempool.getMaxNonceGap()) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction: " + tx.hash().hex().get() + " nonce out of range, expected: " + std::to_string(accNonce)
+                                            + " to " + std::to_string(accNonce + this->mempool.getMaxNonceGap()) + " got: " + tx.getNonceU256().str());
     return TxInvalid::InvalidNonce;
   }
+  return TxInvalid::NotInvalid;
+}
+
+bool State::validateBlockTx(const TxBlock& tx, Account& sender) const {
+  if (tx.getChainId() != this->options->getChainID()) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction " + tx.hash().hex().get() + " within block is invalid, chain ID mismatch, expected: "
+                      + std::to_string(this->options->getChainID()) + " got: " + std::to_string(tx.getChainId()));
+    return false;
+  }
+  if (tx.getNonceU256() != sender.nonce) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction " + tx.hash().hex().get() + " within block is invalid, nonce mismatch, expected: "
+                      + std::to_string(sender.nonce) + " got: " + tx.getNonceU256().str());
+    return false;
+  }
+  try {
+    U256 cost = tx.getMaxCost();
+    if (cost > sender.balance) throw std::underflow_error("insufficient balance");
+    sender.balance -= cost;
+  } catch (const std::exception&) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction " + tx.hash().hex().get() + " within block is invalid, sender can't afford it");
+    return false;
+  }
+  sender.nonce++;
+  return true;
+}
 
+bool State::validateSenderTxs(const std::vector<const TxBlock*>& txs) const {
+  // Every tx here has the same sender, in block order. Nonces must be exactly
+  // sequential from the account nonce, and the sender must afford all of them.
+  auto accountIt = this->accounts.find(txs.front()->getFrom());
+  if (accountIt == this->accounts.end()) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction " + txs.front()->hash().hex().get() + " within block is invalid, sender doesn't exist");
+    return false;
+  }
+  Account sender = accountIt->second;
+  for (const TxBlock* tx : txs) if (!this->validateBlockTx(*tx, sender)) return false;
+  return true;
+}
 
+BlockFillReport State::pickBlockTransactions(
+  const uint64_t& blockSize, const std::function<void(const TxBlock&)>& append
+) const {
+  BlockFillReport report;
+  report.bytes = blockSize;
+  // Balances left after the sender's previous txs in the block
+  std::unordered_map<Address, U256, SafeHash> balances;
+  this->mempool.pick([&](const TxBlock& tx) {
+    // Senders left out keep their later nonces in the mempool as well
+    auto skip = [&](BlockSkip reason) {
+      report.skipped.emplace_back(tx.hash(), reason);
+      return Mempool::Pick::SkipSender;
+    };
+    // Once the tx count is reached nothing else fits, but keep visiting to report every sender
+    if (report.included >= this->blockLimits.maxTxs) return skip(BlockSkip::TxCount);
+    uint64_t txSize = BlockBuilder::txBlockSize(tx);
+    if (report.bytes + txSize > this->blockLimits.maxBytes) return skip(BlockSkip::Bytes);
+    uint64_t txExecTime = BlockLimits::estimateExecTime(tx);
+    if (txExecTime > this->blockLimits.maxExecTime - report.execTime) return skip(BlockSkip::ExecTime);
 
-  return TxInvalid::NotInvalid;
+    auto balanceIt = balances.find(tx.getFrom());
+    if (balanceIt == balances.end()) {
+      auto accountIt = this->accounts.find(tx.getFrom());
+      if (accountIt == this->accounts.end()) return skip(BlockSkip::Balance);
+      balanceIt = balances.emplace(tx.getFrom(), accountIt->second.balance).first;
+    }
+    try {
+      U256 cost = tx.getMaxCost();
+      if (cost > balanceIt->second) return skip(BlockSkip::Balance);
+      balanceIt->second -= cost;
+    } catch (const std::overflow_error&) {
+      return skip(BlockSkip::Balance);
+    }
+    append(tx);
+    report.included++;
+    report.bytes += txSize;
+    report.execTime += txExecTime;
+    return Mempool::Pick::Take;
+  });
+  report.leftOut = this->mempool.getPendingCount() - report.included;
+  return report;
 }
 
 void State::processTransaction(const TxBlock& tx) {
@@ -124,15 +237,14 @@ void State::processTransaction(const TxBlock& tx) {
   // processNextBlock already calls validateTransaction in every tx, as it
   // calls validateNextBlock as a sanity check.
   // TODO: Contract calling, including "payable" functions.
-  auto accountIt = this->accounts.find(tx.getFrom());
-  auto& balance = accountIt->second.balance;
-  auto& nonce = accountIt->second.nonce;
+  // The sender is never held by reference across a contract call: payable calls
+  // can pay addresses that don't exist yet (see processContractPayable()), and
+  // inserting them may grow `accounts` and move every entry.
+  auto sender = [&]() -> Account& { return this->accounts.find(tx.getFrom())->second; };
   try {
-    uint256_t txValueWithFees = tx.getValue() + (
-      tx.getGasLimit() * tx.getMaxFeePerGas()
-    ); // This needs to change with payable contract functions
-    balance -= txValueWithFees;
-    this->accounts[tx.getTo()].balance += tx.getValue();
+    U256 txValueWithFees = tx.getMaxCost(); // This needs to change with payable contract functions
+    sender().balance -= txValueWithFees;
+    this->accounts[tx.getTo()].balance += tx.getValueU256();
     if (this->contractManager->isContractCall(tx)) {
       Utils::safePrint(std::string("Processing transaction call txid: ") + tx.hash().hex().get());
       if (this->contractManager->isPayable(tx.txToCallInfo())) this->processingPayable = true;
@@ -144,73 +256,375 @@ void State::processTransaction(const TxBlock& tx) {
       "Transaction: " + tx.hash().hex().get() + " failed to process, reason: " + e.what()
     );
     if(this->processingPayable) {
-      balance += tx.getValue();
-      this->accounts[tx.getTo()].balance -= tx.getValue();
+      sender().balance += tx.getValueU256();
+      this->accounts[tx.getTo()].balance -= tx.getValueU256();
       this->processingPayable = false;
     }
-    balance += tx.getValue();
+    sender().balance += tx.getValueU256();
+  }
+  sender().nonce++;
+}
+
+void State::processNativeTransfers(const std::vector<TxBlock>& txs, const uint64_t& begin, const uint64_t& end) {
+  // If we have up to X txs or only one physical thread
+  // for some reason, process normally.
+  // Otherwise, parallelize into threads/asyncs.
+  unsigned int thrNum = std::thread::hardware_concurrency();
+  if (thrNum <= 1 || end - begin <= 2000) {
+    for (uint64_t i = begin; i < end; i++) this->processTransaction(txs[i]);
+    return;
+  }
+
+  // Join txs that share an account (sender or recipient) into the same group (union-find).
+  // Groups share no account, so they can run at the same time, each one in block order.
+  std::unordered_map<Address, uint64_t, SafeHash> accountIds;
+  std::vector<uint64_t> parent;
+  auto find = [&](uint64_t id) {
+    while (parent[id] != id) id = parent[id] = parent[parent[id]];
+    return id;
+  };
+  auto idOf = [&](const Address& address) {
+    auto [it, inserted] = accountIds.try_emplace(address, parent.size());
+    if (inserted) parent.push_back(it->second);
+    return it->second;
+  };
+  for (uint64_t i = begin; i < end; i++) {
+    uint64_t from = find(idOf(txs[i].getFrom()));
+    uint64_t to = find(idOf(txs[i].getTo()));
+    if (from != to) parent[from] = to;
+  }
+  std::unordered_map<uint64_t, std::vector<uint64_t>> groupsByRoot;
+  for (uint64_t i = begin; i < end; i++) groupsByRoot[find(accountIds.at(txs[i].getFrom()))].push_back(i);
+  std::vector<std::vector<uint64_t>> groups;
+  groups.reserve(groupsByRoot.size());
+  for (auto& [root, group] : groupsByRoot) groups.emplace_back(std::move(group));
+
+  // Logically divide groups equally into one-time hardware threads/asyncs.
+  // Division reminder always goes to the LAST thread (e.g. 11/4 = 2+2+2+5)
+  thrNum = std::min<uint64_t>(thrNum, groups.size());
+  std::vector<uint64_t> groupsPerThr(thrNum, groups.size() / thrNum);
+  groupsPerThr.back() += groups.size() % thrNum;
+  std::vector<std::future<void>> f;
+  f.reserve(thrNum);
+  uint64_t thrOff = 0;
+  for (const uint64_t& nGroups : groupsPerThr) {
+    f.emplace_back(std::async(std::launch::async, [&, thrOff, nGroups](){
+      for (uint64_t i = thrOff; i < thrOff + nGroups; i++) {
+        for (const uint64_t& txIdx : groups[i]) this->processTransaction(txs[txIdx]);
+      }
+    }));
+    thrOff += nGroups;
+  }
+  for (auto& future : f) future.get();
+}
+
+bool State::processTransactions(const std::vector<TxBlock>& txs) {
+  // Lock is already called by tryProcessNextBlock.
+  // Validate every tx against its sender as it is at that point of the block
+  // (pre-block account minus the sender's previous txs), journal every account
+  // before it's changed, and create the recipients beforehand, so parallel groups
+  // only change existing entries and the map is never rehashed while they run.
+  std::unordered_map<Address, Account, SafeHash> senders;
+  std::vector<bool> isContractCall(txs.size());
+  for (uint64_t i = 0; i < txs.size(); i++) {
+    const TxBlock& tx = txs[i];
+    auto senderIt = senders.find(tx.getFrom());
+    if (senderIt == senders.end()) {
+      auto accountIt = this->accounts.find(tx.getFrom());
+      if (accountIt == this->accounts.end()) {
+        Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction " + tx.hash().hex().get() + " within block is invalid, sender doesn't exist");
+        this->revertBlockJournal();
+        return false;
+      }
+      senderIt = senders.emplace(tx.getFrom(), accountIt->second).first;
+    }
+    if (!this->validateBlockTx(tx, senderIt->second)) {
+      this->revertBlockJournal();
+      return false;
+    }
+    isContractCall[i] = this->contractManager->isContractCall(tx);
+    this->journalAccount(tx.getFrom());
+    this->journalAccount(tx.getTo());
+    this->accounts.try_emplace(tx.getTo());
+  }
+
+  // Contract calls run alone, in block order. Runs of native transfers between them
+  // can be split by account, as they can't see anything but balances and nonces.
+  uint64_t i = 0;
+  while (i < txs.size()) {
+    if (isContractCall[i]) {
+      this->processTransaction(txs[i]);
+      i++;
+      continue;
+    }
+    uint64_t end = i;
+    while (end < txs.size() && !isContractCall[end]) end++;
+    this->processNativeTransfers(txs, i, end);
+    i = end;
   }
-  nonce++;
+  return true;
+}
+
+void State::refreshMempool() {
+  /// No need to lock stateMutex as function caller (this->processNextBlock) already lock mutex.
+  std::unique_lock lock(this->mempoolMutex);
+  /// Update only the sender queues of accounts changed by the block, with the account
+  /// as it is now, dropping stale nonces and transactions that can't be afforded anymore.
+  for (const auto& [address, before] : this->blockJournal) {
+    auto accountIt = this->accounts.find(address);
+    if (accountIt == this->accounts.end()) {
+      this->mempool.updateSender(address, 0, U256(0));
+    } else {
+      this->mempool.updateSender(address, accountIt->second.nonce, accountIt->second.balance);
+    }
+  }
+  this->blockJournal.clear();
+}
+
+StateTree::Changes State::saveBlockToDB(const Block& block) {
+  DBBatch batch;
+  StateTree::Changes changes;
+  Storage::batchBlock(block, batch, true);
+  std::vector<Address> changed;
+  changed.reserve(this->blockJournal.size());
+  for (const auto& [address, before] : this->blockJournal) {
+    auto accountIt = this->accounts.find(address);
+    if (accountIt != this->accounts.end()) {
+      BytesArr<Account::serializedSize> serialized = accountIt->second.serialize();
+      batch.push_back(address.get(), serialized, DBPrefix::nativeAccounts);
+      changes.emplace_back(StateTree::accountKey(address), Bytes(serialized.cbegin(), serialized.cend()));
+      changed.emplace_back(address);
+    }
+  }
+  this->batchHistory(block.getNHeight(), changed, batch);
+  // Contract entries are saved under their full key, as the state tree has them
+  const uint64_t putsBefore = batch.getPuts().size();
+  const uint64_t delsBefore = batch.getDels().size();
+  this->contractManager->dumpChanged(batch);
+  for (uint64_t i = putsBefore; i < batch.getPuts().size(); i++) {
+    changes.emplace_back(batch.getPuts()[i].key, batch.getPuts()[i].value);
+  }
+  for (uint64_t i = delsBefore; i < batch.getDels().size(); i++) changes.emplace_back(batch.getDels()[i], std::nullopt);
+  uint64_t newStart = this->historyStart;
+  if (block.getNHeight() > this->historyRetention && block.getNHeight() - this->historyRetention > newStart) {
+    newStart = block.getNHeight() - this->historyRetention;
+    this->pruneHistory(newStart, batch);
+  }
+  // Moved before the pruned entries are deleted, see getHistoricalAccount()
+  const uint64_t oldStart = this->historyStart.exchange(newStart);
+  if (!this->db->putBatch(batch)) {
+    this->historyStart = oldStart;
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Failed to save block " + block.hash().hex().get() + " to DB");
+    throw std::runtime_error("Failed to save block " + block.hash().hex().get() + " to DB");
+  }
+  this->contractManager->clearChanged();
+  return changes;
+}
+
+Bytes State::historyKey(const Address& address, const uint64_t& height) {
+  Bytes key(address.cbegin(), address.cend());
+  Utils::appendBytes(key, Utils::uint64ToBytes(height));
+  return key;
+}
+
+void State::batchHistory(const uint64_t& height, const std::vector<Address>& addresses, DBBatch& batch) const {
+  Bytes index;
+  index.reserve(addresses.size() * 20);
+  for (const Address& address : addresses) {
+    batch.push_back(historyKey(address, height), this->accounts.at(address).serialize(), DBPrefix::nativeAccountHistory);
+    Utils::appendBytes(index, address);
+  }
+  batch.push_back(Utils::uint64ToBytes(height), std::move(index), DBPrefix::nativeAccountHistoryIndex);
+}
+
+void State::pruneHistory(const uint64_t& newStart, DBBatch& batch) {
+  for (uint64_t height = this->historyStart + 1; height <= newStart; height++) {
+    // Accounts changed at the new start don't need their previous entry anymore
+    Bytes index = this->db->get(Utils::uint64ToBytes(height), DBPrefix::nativeAccountHistoryIndex);
+    for (uint64_t i = 0; i + 20 <= index.size(); i += 20) {
+      Address address(BytesArrView(index).subspan(i, 20));
+      auto previous = this->db->getFloor(historyKey(address, height - 1), DBPrefix::nativeAccountHistory);
+      if (previous && std::equal(address.cbegin(), address.cend(), previous->key.cbegin())) {
+        batch.delete_key(previous->key, DBPrefix::nativeAccountHistory);
+      }
+    }
+    batch.delete_key(Utils::uint64ToBytes(height - 1), DBPrefix::nativeAccountHistoryIndex);
+  }
+}
+
+Account State::getHistoricalAccount(const Address& addr, const uint64_t& height) const {
+  std::shared_ptr<const StateView> latest = this->getView();
+  if (height == latest->getHeight()) {
+    const Account* account = latest->find(addr);
+    return (account != nullptr) ? *account : Account();
+  }
+  auto outOfRange = [&]() {
+    return std::runtime_error("Block " + std::to_string(height) + " is outside of the retained history ("
+      + std::to_string(this->historyStart) + " to " + std::to_string(latest->getHeight()) + ")"
+    );
+  };
+  if (height > latest->getHeight() || height < this->historyStart) throw outOfRange();
+  auto entry = this->db->getFloor(historyKey(addr, height), DBPrefix::nativeAccountHistory);
+  // The history may have been pruned during the lookup. The start is moved
+  // before the entries are deleted (see saveBlockToDB()), so checking it again
+  // tells a pruned entry from an account that didn't exist yet.
+  if (height < this->historyStart) throw outOfRange();
+  if (!entry || !std::equal(addr.cbegin(), addr.cend(), entry->key.cbegin())) return Account();
+  return Account(BytesArrView(entry->value));
+}
+
+void State::publishView(const uint64_t& height, const std::vector<Address>& changed) {
+  StateView::Accounts changes;
+  changes.reserve(changed.size());
+  for (const Address& address : changed) {
+    auto accountIt = this->accounts.find(address);
+    if (accountIt != this->accounts.end()) changes.insert_or_assign(address, accountIt->second);
+  }
+  this->view.store(this->view.load()->next(height, std::move(changes), this->accounts));
 }
 
-void State::refreshMempool(const Block& block) {
-  /// No need to lock mutex as function caller (this->processNextBlock) already lock mutex.
-  /// Remove all transactions within the block that exists on the unordered_map.
-  for (const auto& tx : block.getTxs()) {
-    const auto it = this->mempool.find(tx.hash());
-    if (it != this->mempool.end()) {
-      this->mempool.erase(it);
+void State::updateStateTree(const uint64_t& height, StateTree::Changes&& changes) {
+  // Updates are only started here, under the state mutex, so no other can start meanwhile.
+  // The previous one is usually long done, as it takes less than a block's interval.
+  this->waitStateTree();
+  std::lock_guard treeLock(this->stateTreeMutex);
+  this->stateTreeUpdate = std::async(std::launch::async, [this, height, changes = std::move(changes)]() {
+    std::lock_guard treeLock(this->stateTreeMutex);
+    // The changed nodes are saved with the root, so the saved tree is always the one
+    // of the saved root. If a save failed, the next one saves the whole tree again.
+    DBBatch batch;
+    if (this->stateTreeUnsaved) {
+      this->stateTree->update(changes);
+      StateTree::erase(*this->db, batch);
+      this->stateTree->dump(batch);
+    } else {
+      this->stateTree->update(changes, batch);
+    }
+    batch.push_back(Utils::uint64ToBytes(height), this->stateTree->getRoot().get(), DBPrefix::stateRoots);
+    this->stateTreeUnsaved = !this->db->putBatch(batch);
+    if (this->stateTreeUnsaved) {
+      Logger::logToDebug(LogType::ERROR, Log::state, __func__,
+        "Failed to save the state tree of block " + std::to_string(height)
+      );
     }
+  }).share();
+}
+
+void State::waitStateTree() const {
+  std::shared_future<void> pending;
+  {
+    std::lock_guard treeLock(this->stateTreeMutex);
+    pending = this->stateTreeUpdate;
   }
+  if (pending.valid()) pending.wait();
+}
 
-  /// Copy mempool over
-  auto mempoolCopy = this->mempool;
-  this->mempool.clear();
+void State::journalAccount(const Address& address) {
+  if (this->blockJournal.contains(address)) return;
+  auto accountIt = this->accounts.find(address);
+  this->blockJournal.emplace(address, (accountIt != this->accounts.end())
+    ? std::optional<Account>(accountIt->second) : std::nullopt
+  );
+}
 
-  /// Verify if the transactions within the old mempool
-  /// not added to the block are valid given the current state
-  for (const auto& [hash, tx] : mempoolCopy) {
-    /// Calls internal function which doesn't lock mutex.
-    if (!this->validateTransactionInternal(tx)) {
-      this->mempool.insert({hash, tx});
+void State::revertBlockJournal() {
+  for (const auto& [address, before] : this->blockJournal) {
+    if (before) {
+      this->accounts[address] = *before;
+    } else {
+      this->accounts.erase(address);
     }
   }
+  this->blockJournal.clear();
 }
 
 const uint256_t State::getNativeBalance(const Address &addr) const {
-  std::shared_lock lock(this->stateMutex);
-  auto it = this->accounts.find(addr);
-  if (it == this->accounts.end()) return 0;
-  return it->second.balance;
+  return this->getView()->getNativeBalance(addr);
 }
 
 
 const uint64_t State::getNativeNonce(const Address& addr) const {
-  std::shared_lock lock(this->stateMutex);
-  auto it = this->accounts.find(addr);
-  if (it == this->accounts.end()) return 0;
-  return it->second.nonce;
+  return this->getView()->getNativeNonce(addr);
 }
 
-const std::unordered_map<Address, Account, SafeHash> State::getAccounts() const {
+const uint256_t State::getNativeBalance(const Address& addr, const uint64_t& height) const {
+  return this->getHistoricalAccount(addr, height).balance.toBoost();
+}
+
+const uint64_t State::getNativeNonce(const Address& addr, const uint64_t& height) const {
+  return this->getHistoricalAccount(addr, height).nonce;
+}
+
+const uint64_t State::getHistoryRetention() const {
   std::shared_lock lock(this->stateMutex);
-  return this->accounts;
+  return this->historyRetention;
+}
+
+void State::setHistoryRetention(const uint64_t& blocks) {
+  std::unique_lock lock(this->stateMutex);
+  this->historyRetention = std::max(blocks, uint64_t(1));
+}
+
+const Hash State::getStateRoot() const {
+  this->waitStateTree();
+  std::lock_guard treeLock(this->stateTreeMutex);
+  return this->stateTree->getRoot();
+}
+
+const Hash State::getStateRoot(const uint64_t& height) const {
+  this->waitStateTree();
+  Bytes root = this->db->get(Utils::uint64ToBytes(height), DBPrefix::stateRoots);
+  if (root.size() != 32) {
+    throw std::runtime_error("No state root for block " + std::to_string(height));
+  }
+  return Hash(root);
+}
+
+std::optional<StateTree::Proof> State::getAccountProof(const Address& addr) const {
+  return this->getStateProof(StateTree::accountKey(addr));
 }
 
-const std::unordered_map<Hash, TxBlock, SafeHash> State::getMempool() const {
+std::optional<StateTree::Proof> State::getStateProof(const Bytes& key) const {
+  this->waitStateTree();
+  std::lock_guard treeLock(this->stateTreeMutex);
+  return this->stateTree->getProof(key);
+}
+
+std::shared_ptr<const FlatHashMap<Address, Account>> State::getAccounts() const {
+  // Every change to the accounts publishes a new view, so the snapshot is
+  // still good as long as the view is the same, no need to wait for the state.
+  std::lock_guard snapshotLock(this->accountsSnapshotMutex);
+  if (this->accountsSnapshotView == this->view.load()) return this->accountsSnapshot;
   std::shared_lock lock(this->stateMutex);
-  return this->mempool;
+  this->accountsSnapshot = std::make_shared<const FlatHashMap<Address, Account>>(this->accounts);
+  this->accountsSnapshotView = this->view.load();
+  return this->accountsSnapshot;
 }
 
-bool State::validateNextBlock(const Block& block) const {
+std::shared_ptr<const FlatHashMap<Hash, TxBlock>> State::getMempool() const {
+  std::shared_lock lock(this->mempoolMutex);
+  std::lock_guard snapshotLock(this->mempoolSnapshotMutex);
+  if (!this->mempoolSnapshot || this->mempoolSnapshotVersion != this->mempool.getVersion()) {
+    this->mempoolSnapshot = std::make_shared<const FlatHashMap<Hash, TxBlock>>(this->mempool.getTxs());
+    this->mempoolSnapshotVersion = this->mempool.getVersion();
+  }
+  return this->mempoolSnapshot;
+}
+
+const uint64_t State::getMempoolPendingCount() const {
+  std::shared_lock lock(this->mempoolMutex);
+  return this->mempool.getPendingCount();
+}
+
+bool State::validateBlockHeader(const Block& block) const {
   /**
    * Rules for a block to be accepted within the current state
    * Block nHeight must match latest nHeight + 1
    * Block nPrevHash must match latest hash
    * Block nTimestamp must be higher than latest block
    * Block has valid rdPoS transaction and signature based on current state.
-   * All transactions within Block are valid (does not return false on validateTransaction)
    * Block constructor already checks if merkle roots within a block are valid.
+   * Transactions are checked separately (see validateNextBlock and processTransactions).
    */
 
   auto latestBlock = this->storage->latest();
@@ -236,13 +650,48 @@ bool State::validateNextBlock(const Block& block) const {
     Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Invalid rdPoS in block");
     return false;
   }
+  return true;
+}
 
+bool State::validateNextBlock(const Block& block) const {
+  if (!this->validateBlockHeader(block)) return false;
+
+  // A sender can have several txs in the same block, so they are grouped by
+  // sender (keeping block order within each group). Groups don't depend on each
+  // other, so they're checked in parallel, then the results are joined.
   std::shared_lock verifyingBlockTxs(this->stateMutex);
-  for (const auto& tx : block.getTxs()) {
-    if (this->validateTransactionInternal(tx)) {
-      Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction " + tx.hash().hex().get() + " within block is invalid");
-      return false;
+  std::unordered_map<Address, std::vector<const TxBlock*>, SafeHash> bySender;
+  for (const auto& tx : block.getTxs()) bySender[tx.getFrom()].push_back(&tx);
+  std::vector<const std::vector<const TxBlock*>*> groups;
+  groups.reserve(bySender.size());
+  for (const auto& [from, txs] : bySender) groups.push_back(&txs);
+
+  // If we have up to X block txs or only one physical thread
+  // for some reason, validate normally.
+  // Otherwise, parallelize into threads/asyncs.
+  unsigned int thrNum = std::thread::hardware_concurrency();
+  if (thrNum <= 1 || block.getTxs().size() <= 2000) {
+    for (const auto& group : groups) if (!this->validateSenderTxs(*group)) return false;
+  } else {
+    // Logically divide sender groups equally into one-time hardware threads/asyncs.
+    // Division reminder always goes to the LAST thread (e.g. 11/4 = 2+2+2+5)
+    thrNum = std::min<uint64_t>(thrNum, groups.size());
+    std::vector<uint64_t> groupsPerThr(thrNum, groups.size() / thrNum);
+    groupsPerThr.back() += groups.size() % thrNum;
+    std::atomic<bool> invalid = false;
+    std::vector<std::future<void>> f;
+    f.reserve(thrNum);
+    uint64_t thrOff = 0;
+    for (const uint64_t& nGroups : groupsPerThr) {
+      f.emplace_back(std::async(std::launch::async, [&, thrOff, nGroups](){
+        for (uint64_t i = thrOff; i < thrOff + nGroups && !invalid; i++) {
+          if (!this->validateSenderTxs(*groups[i])) invalid = true;
+        }
+      }));
+      thrOff += nGroups;
     }
+    for (auto& future : f) future.wait();
+    if (invalid) return false;
   }
 
   Logger::logToDebug(LogType::INFO, Log::state, __func__, "Block " + block.hash().hex().get() + " is valid. (Sanity Check Passed)");
@@ -250,55 +699,150 @@ bool State::validateNextBlock(const Block& block) const {
 }
 
 void State::processNextBlock(Block&& block) {
-  /// Sanity Check.
-  if (!this->validateNextBlock(block)) {
+  if (!this->tryProcessNextBlock(std::move(block))) {
     Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Sanity check failed, blockchain is trying to append a invalid block, throwing.");
     throw std::runtime_error("Invalid block detected during processNextBlock sanity check.");
   }
+}
 
+bool State::tryProcessNextBlock(Block&& block, const std::function<void(const Block&)>& onProcessed) {
+  /// Validation and processing happen in the same pass, under the same lock.
   std::unique_lock lock(this->stateMutex);
+  if (!this->validateBlockHeader(block)) return false;
+  const uint64_t height = block.getNHeight();
+  this->rdpos->getTrace().record(height, ConsensusEvent::BlockValidated);
+
   /// Process transactions of the block within the current state.
-  for (auto const& tx : block.getTxs()) {
-    this->processTransaction(tx);
+  try {
+    if (!this->processTransactions(block.getTxs())) return false;
+  } catch (const std::exception& e) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, std::string("Block processing failed, rolling back: ") + e.what());
+    this->revertBlockJournal();
+    throw;
+  }
+
+  /// Save the block with the accounts and contracts it changed, before the journal
+  /// is cleared and before rdPoS moves on. If the write fails the accounts are
+  /// rolled back, so the block is neither saved nor applied.
+  StateTree::Changes changes;
+  try {
+    changes = this->saveBlockToDB(block);
+  } catch (const std::exception& e) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, std::string("Block saving failed, rolling back: ") + e.what());
+    this->revertBlockJournal();
+    throw;
   }
 
   /// Process rdPoS State
   this->rdpos->processBlock(block);
 
-  /// Refresh the mempool based on the block transactions;
-  this->refreshMempool(block);
+  /// Publish the new accounts to readers.
+  std::vector<Address> changed;
+  changed.reserve(this->blockJournal.size());
+  for (const auto& [address, before] : this->blockJournal) changed.emplace_back(address);
+  this->publishView(block.getNHeight(), changed);
+  this->updateStateTree(block.getNHeight(), std::move(changes));
+
+  /// Move block to storage. It is valid, executed and saved, so it goes out
+  /// before the local post-processing below (mempool refresh, snapshot).
+  this->storage->pushBack(std::move(block));
+  const std::shared_ptr<const Block> processed = this->storage->latest();
+  this->rdpos->getTrace().record(height, ConsensusEvent::BlockProcessed);
+  if (onProcessed) onProcessed(*processed);
+
+  /// Refresh the mempool based on the accounts the block changed.
+  this->refreshMempool();
+
+  /// Take a snapshot every `snapshotInterval` blocks. Only the validators and contracts,
+  /// which have no immutable copy, are dumped here. The accounts are collected from the
+  /// view of this block in the background, along with chunking and hashing, after the
+  /// previous build (if it's still running) and the state root.
+  if (height % snapshotInterval == 0) {
+    DBBatch others;
+    this->dumpValidatorsAndContracts(others);
+    this->snapshotBuild = std::async(std::launch::async, [
+      this, height, blockBytes = processed->serializeBlock(), view = this->getView(),
+      others = std::move(others), previous = std::move(this->snapshotBuild)
+    ]() mutable {
+      if (previous.valid()) previous.wait();
+      try {
+        this->storeSnapshot(
+          height, std::move(blockBytes), this->getStateRoot(height), stateEntries(view->collect(), others)
+        );
+      } catch (const std::exception& e) {
+        Logger::logToDebug(LogType::ERROR, Log::state, __func__,
+          "Failed to take the snapshot of block " + std::to_string(height) + ": " + e.what()
+        );
+      }
+    });
+  }
+
+  /// Let the rdPoS worker know about the new tip.
+  this->rdpos->notifyWorker();
+  lock.unlock();
 
-  Logger::logToDebug(LogType::INFO, Log::state, __func__, "Block " + block.hash().hex().get() + " processed successfully.) block bytes: " + Hex::fromBytes(block.serializeBlock()).get());
-  Utils::safePrint("Block: " + block.hash().hex().get() + " height: " + std::to_string(block.getNHeight()) + " was added to the blockchain");
-  for (const auto& tx : block.getTxs()) {
+  Logger::logToDebug(LogType::INFO, Log::state, __func__, "Block " + processed->hash().hex().get() + " processed successfully. (" + std::to_string(processed->getTxs().size()) + " txs)");
+  Utils::safePrint("Block: " + processed->hash().hex().get() + " height: " + std::to_string(height) + " was added to the blockchain");
+  for (const auto& tx : processed->getTxs()) {
     Utils::safePrint("Transaction: " + tx.hash().hex().get() + " was accepted in the blockchain");
   }
-  /// Move block to storage.
-  this->storage->pushBack(std::move(block));
-  return;
+  return true;
 }
 
-void State::fillBlockWithTransactions(Block& block) const {
+BlockFillReport State::fillBlockWithTransactions(Block& block) const {
   std::shared_lock lock(this->stateMutex);
-  for (const auto& [hash, tx] : this->mempool) {
-    block.appendTx(tx);
-  }
-  return;
+  std::shared_lock mempoolLock(this->mempoolMutex);
+  return this->pickBlockTransactions(block.serializedSize(), [&](const TxBlock& tx) { block.appendTx(tx); });
+}
+
+BlockFillReport State::fillBlockWithTransactions(BlockBuilder& builder, const uint64_t& reservedBytes) const {
+  std::shared_lock lock(this->stateMutex);
+  std::shared_lock mempoolLock(this->mempoolMutex);
+  BlockFillReport report = this->pickBlockTransactions(
+    builder.getSerializedSize() + reservedBytes, [&](const TxBlock& tx) { builder.appendTx(TxBlock(tx)); }
+  );
+  report.bytes -= reservedBytes;
+  return report;
+}
+
+const BlockLimits State::getBlockLimits() const {
+  std::shared_lock lock(this->stateMutex);
+  return this->blockLimits;
+}
+
+void State::setBlockLimits(const BlockLimits& limits) {
+  std::unique_lock lock(this->stateMutex);
+  this->blockLimits = limits;
 }
 
 TxInvalid State::validateTransaction(const TxBlock& tx) const {
   std::shared_lock lock(this->stateMutex);
+  std::shared_lock mempoolLock(this->mempoolMutex);
   return this->validateTransactionInternal(tx);
 }
 
 TxInvalid State::addTx(TxBlock&& tx) {
-  auto TxInvalid = this->validateTransaction(tx);
-  if (TxInvalid) return TxInvalid;
-  std::unique_lock lock(this->stateMutex);
-  auto txHash = tx.hash();
-  this->mempool.insert({txHash, std::move(tx)});
-  Utils::safePrint("Transaction: " + tx.hash().hex().get() + " was added to the mempool");
-  return TxInvalid;
+  std::vector<TxBlock> txs;
+  txs.emplace_back(std::move(tx));
+  return this->addTxs(txs).front();
+}
+
+std::vector<TxInvalid> State::addTxs(const std::vector<TxBlock>& txs) {
+  std::vector<TxInvalid> ret(txs.size(), TxInvalid::NotInvalid);
+  std::shared_lock lock(this->stateMutex);
+  std::unique_lock mempoolLock(this->mempoolMutex);
+  for (uint64_t i = 0; i < txs.size(); i++) {
+    const TxBlock& tx = txs[i];
+    ret[i] = this->validateTransactionInternal(tx);
+    if (ret[i]) continue;
+    auto txHash = tx.hash();
+    auto accountIt = this->accounts.find(tx.getFrom());
+    uint64_t accountNonce = (accountIt != this->accounts.end()) ? accountIt->second.nonce : 0;
+    ret[i] = this->mempool.add(TxBlock(tx), txHash, accountNonce);
+    if (ret[i]) continue;
+    Utils::safePrint("Transaction: " + txHash.hex().get() + " was added to the mempool");
+  }
+  return ret;
 }
 
 bool State::addValidatorTx(const TxValidator& tx) {
@@ -307,20 +851,49 @@ bool State::addValidatorTx(const TxValidator& tx) {
 }
 
 bool State::isTxInMempool(const Hash& txHash) const {
-  std::shared_lock lock(this->stateMutex);
+  std::shared_lock lock(this->mempoolMutex);
   return this->mempool.contains(txHash);
 }
 
+std::vector<bool> State::areTxsInMempool(const std::vector<Hash>& txHashes) const {
+  std::vector<bool> ret;
+  ret.reserve(txHashes.size());
+  std::shared_lock lock(this->mempoolMutex);
+  for (const Hash& txHash : txHashes) ret.emplace_back(this->mempool.contains(txHash));
+  return ret;
+}
+
 std::unique_ptr<TxBlock> State::getTxFromMempool(const Hash &txHash) const {
-  std::shared_lock lock(this->stateMutex);
-  auto it = this->mempool.find(txHash);
-  if (it == this->mempool.end()) return nullptr;
-  return std::make_unique<TxBlock>(it->second);
+  std::shared_lock lock(this->mempoolMutex);
+  const TxBlock* tx = this->mempool.find(txHash);
+  if (tx == nullptr) return nullptr;
+  return std::make_unique<TxBlock>(*tx);
 }
 
 void State::addBalance(const Address& addr) {
   std::unique_lock lock(this->stateMutex);
-  this->accounts[addr].balance += uint256_t("1000000000000000000000");
+  auto it = this->accounts.find(addr);
+  const std::optional<Account> before = (it != this->accounts.end()) ? std::optional<Account>(it->second) : std::nullopt;
+  Account& account = this->accounts[addr];
+  account.balance += U256(uint256_t("1000000000000000000000"));
+  uint64_t height = this->getView()->getHeight();
+  BytesArr<Account::serializedSize> serialized = account.serialize();
+  DBBatch batch;
+  batch.push_back(addr.get(), serialized, DBPrefix::nativeAccounts);
+  batch.push_back(historyKey(addr, height), serialized, DBPrefix::nativeAccountHistory);
+  Bytes index = this->db->get(Utils::uint64ToBytes(height), DBPrefix::nativeAccountHistoryIndex);
+  Utils::appendBytes(index, addr);
+  batch.push_back(Utils::uint64ToBytes(height), std::move(index), DBPrefix::nativeAccountHistoryIndex);
+  if (!this->db->putBatch(batch)) {
+    // Nothing was saved, so the account goes back to what it was
+    if (before) account = *before; else this->accounts.erase(addr);
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Failed to save the balance of " + addr.hex().get() + " to DB");
+    throw std::runtime_error("Failed to save the balance of " + addr.hex().get() + " to DB");
+  }
+  this->publishView(height, {addr});
+  StateTree::Changes changes;
+  changes.emplace_back(StateTree::accountKey(addr), Bytes(serialized.cbegin(), serialized.cend()));
+  this->updateStateTree(height, std::move(changes));
 }
 
 Bytes State::ethCall(const ethCallInfo& callInfo) {
@@ -346,7 +919,7 @@ bool State::estimateGas(const ethCallInfo& callInfo) {
       }
       auto it = this->accounts.find(from);
       if (it == this->accounts.end()) return false;
-      if (it->second.balance < value + totalGas) return false;
+      if (it->second.balance.toBoost() < value + totalGas) return false;
     }
   }
 
@@ -362,7 +935,10 @@ void State::processContractPayable(std::unordered_map<Address, uint256_t, SafeHa
   if (!this->processingPayable) throw std::runtime_error(
     "Uh oh, contracts are going haywire! Cannot change State while not processing a payable contract."
   );
-  for (const auto& [address, amount] : payableMap) this->accounts[address].balance = amount;
+  for (const auto& [address, amount] : payableMap) {
+    this->journalAccount(address);
+    this->accounts[address].balance = U256(amount);
+  }
 }
 
 std::vector<std::pair<std::string, Address>> State::getContracts() const {
@@ -370,3 +946,215 @@ std::vector<std::pair<std::string, Address>> State::getContracts() const {
   return this->contractManager->getContracts();
 }
 
+void State::dumpValidatorsAndContracts(DBBatch& batch) const {
+  uint64_t index = 0;
+  for (const Validator& validator : *this->rdpos->getValidators()) {
+    batch.push_back(Utils::uint64ToBytes(index), validator.get(), DBPrefix::rdPoS);
+    index++;
+  }
+  this->contractManager->dump(batch);
+}
+
+std::map<Bytes, Bytes> State::stateEntries(const StateView::Accounts& accounts, const DBBatch& others) {
+  // Same keys and values the state is loaded from (see the constructors of State,
+  // rdPoS and ContractManager), so a snapshot can be written to the database as is.
+  std::map<Bytes, Bytes> entries;
+  for (const auto& [address, account] : accounts) {
+    BytesArr<Account::serializedSize> serialized = account.serialize();
+    entries.insert_or_assign(StateTree::accountKey(address), Bytes(serialized.cbegin(), serialized.cend()));
+  }
+  for (const DBEntry& entry : others.getPuts()) entries.insert_or_assign(entry.key, entry.value);
+  return entries;
+}
+
+std::shared_ptr<const StateSnapshot> State::storeSnapshot(
+  const uint64_t& height, Bytes&& block, const Hash& stateRoot, const std::map<Bytes, Bytes>& entries
+) {
+  auto snapshot = std::make_shared<const StateSnapshot>(height, std::move(block), stateRoot, entries);
+  {
+    // Kept in height order, a snapshot taken again at the same height replaces the old one
+    std::lock_guard lock(this->snapshotsMutex);
+    std::erase_if(this->snapshots, [&](const auto& kept) { return kept->getHeight() == height; });
+    auto it = std::find_if(this->snapshots.begin(), this->snapshots.end(),
+      [&](const auto& kept) { return kept->getHeight() > height; }
+    );
+    this->snapshots.insert(it, snapshot);
+    while (this->snapshots.size() > keptSnapshots) this->snapshots.pop_front();
+  }
+  Logger::logToDebug(LogType::INFO, Log::state, __func__,
+    "Took snapshot of block " + std::to_string(height) + ": " + std::to_string(entries.size()) + " entries in "
+    + std::to_string(snapshot->getChunkCount()) + " chunks, manifest " + snapshot->getManifestHash().hex().get()
+  );
+  return snapshot;
+}
+
+std::shared_ptr<const StateSnapshot> State::takeSnapshot() {
+  uint64_t height;
+  Bytes block;
+  Hash stateRoot;
+  std::shared_ptr<const StateView> view;
+  DBBatch others;
+  {
+    // No block can be processed meanwhile, so the root and the view are the ones of the latest block
+    std::shared_lock lock(this->stateMutex);
+    auto latest = this->storage->latest();
+    height = latest->getNHeight();
+    block = latest->serializeBlock();
+    stateRoot = this->getStateRoot();
+    view = this->getView();
+    this->dumpValidatorsAndContracts(others);
+  }
+  return this->storeSnapshot(height, std::move(block), stateRoot, stateEntries(view->collect(), others));
+}
+
+std::shared_ptr<const StateSnapshot> State::getSnapshot() const {
+  std::lock_guard lock(this->snapshotsMutex);
+  return (this->snapshots.empty()) ? nullptr : this->snapshots.back();
+}
+
+std::shared_ptr<const StateSnapshot> State::getSnapshot(const uint64_t& height) const {
+  std::lock_guard lock(this->snapshotsMutex);
+  for (const auto& snapshot : this->snapshots) if (snapshot->getHeight() == height) return snapshot;
+  return nullptr;
+}
+
+std::optional<Block> State::checkSnapshotBlock(const StateSnapshot::Manifest& manifest) const {
+  std::optional<Block> block;
+  try {
+    block.emplace(manifest.block, this->options->getChainID());
+  } catch (const std::exception& e) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, std::string("Invalid snapshot block: ") + e.what());
+    return std::nullopt;
+  }
+  if (block->getNHeight() != manifest.height) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Snapshot block is not at the snapshot height");
+    return std::nullopt;
+  }
+  // Validators don't change with blocks, so one we know must have signed it
+  if (!this->rdpos->getValidators()->contains(Validator(Secp256k1::toAddress(block->getValidatorPubKey())))) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Snapshot block is not signed by a validator");
+    return std::nullopt;
+  }
+  return block;
+}
+
+bool State::applySnapshot(const StateSnapshot::Manifest& manifest, const std::vector<DBEntry>& entries) {
+  // Check everything before touching anything
+  std::optional<Block> block = this->checkSnapshotBlock(manifest);
+  if (!block) return false;
+  const std::shared_ptr<const std::set<Validator>> validators = this->rdpos->getValidators();
+  FlatHashMap<Address, Account> newAccounts;
+  std::set<Validator> newValidators;
+  std::map<Bytes, Bytes> newEntries;
+  for (const DBEntry& entry : entries) {
+    if (!StateSnapshot::isSnapshotKey(entry.key)) {
+      Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Snapshot has a key outside of the state");
+      return false;
+    }
+    newEntries.insert_or_assign(entry.key, entry.value);
+    BytesArrView prefix = BytesArrView(entry.key).subspan(0, 2);
+    BytesArrView key = BytesArrView(entry.key).subspan(2);
+    if (std::equal(prefix.begin(), prefix.end(), DBPrefix::nativeAccounts.cbegin())) {
+      if (key.size() != 20 || entry.value.size() != Account::serializedSize) {
+        Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Snapshot has a malformed account");
+        return false;
+      }
+      newAccounts.insert_or_assign(Address(key), Account(entry.value));
+    } else if (std::equal(prefix.begin(), prefix.end(), DBPrefix::rdPoS.cbegin())) {
+      if (entry.value.size() != 20) {
+        Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Snapshot has a malformed validator");
+        return false;
+      }
+      newValidators.emplace(Address(entry.value));
+    }
+  }
+  if (newValidators != *validators) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Snapshot validators are not ours");
+    return false;
+  }
+  // The root commits to every entry, accounts, validators and contracts alike
+  StateTree newTree(newEntries);
+  if (newTree.getRoot() != manifest.stateRoot) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__,
+      "Snapshot entries don't match its state root: expected " + manifest.stateRoot.hex().get()
+      + ", got " + newTree.getRoot().hex().get()
+    );
+    return false;
+  }
+
+  std::unique_lock lock(this->stateMutex);
+  const uint64_t height = manifest.height;
+  if (height <= this->storage->latest()->getNHeight()) {
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__,
+      "Snapshot of block " + std::to_string(height) + " is not ahead of our latest block"
+    );
+    return false;
+  }
+  if (this->snapshotBuild.valid()) this->snapshotBuild.wait();
+  this->waitStateTree();
+
+  // Contracts save themselves on destruction, so the old ones go before their keys are replaced
+  std::vector<DBEntry> oldContracts = this->db->getBatch(DBPrefix::contractManager);
+  this->contractManager.reset();
+
+  // Replace the state in the database, along with the block, in a single atomic batch.
+  // Deletions are applied before insertions, so keys in both end up with the new value.
+  DBBatch batch;
+  for (const Bytes& prefix : {
+    DBPrefix::nativeAccounts, DBPrefix::rdPoS, DBPrefix::contractManager,
+    DBPrefix::nativeAccountHistory, DBPrefix::nativeAccountHistoryIndex
+  }) {
+    for (const DBEntry& entry : this->db->getBatch(prefix)) batch.delete_key(entry.key, prefix);
+  }
+  for (const DBEntry& contract : oldContracts) {
+    Bytes prefix = DBPrefix::contracts;
+    Utils::appendBytes(prefix, contract.key);
+    for (const DBEntry& entry : this->db->getBatch(prefix)) batch.delete_key(entry.key, prefix);
+  }
+  for (const DBEntry& entry : entries) batch.push_back(entry.key, entry.value, Bytes());
+  for (const auto& [address, account] : newAccounts) {
+    batch.push_back(historyKey(address, height), account.serialize(), DBPrefix::nativeAccountHistory);
+  }
+  batch.push_back(Utils::uint64ToBytes(height), Bytes(), DBPrefix::nativeAccountHistoryIndex);
+  batch.push_back(Utils::uint64ToBytes(height), manifest.stateRoot.get(), DBPrefix::stateRoots);
+  StateTree::erase(*this->db, batch);
+  newTree.dump(batch);
+  Storage::batchBlock(*block, batch, true);
+  if (!this->db->putBatch(batch)) {
+    this->contractManager = std::make_unique<ContractManager>(this, this->db, this->rdpos, this->options);
+    Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Failed to save snapshot of block " + std::to_string(height) + " to DB");
+    throw std::runtime_error("Failed to save snapshot of block " + std::to_string(height) + " to DB");
+  }
+
+  // Then in memory. Nothing in the mempool can be trusted against the new accounts.
+  this->accounts = std::move(newAccounts);
+  this->blockJournal.clear();
+  {
+    std::unique_lock mempoolLock(this->mempoolMutex);
+    std::vector<Hash> txHashes;
+    txHashes.reserve(this->mempool.size());
+    for (const auto& [txHash, tx] : this->mempool.getTxs()) txHashes.emplace_back(txHash);
+    for (const Hash& txHash : txHashes) this->mempool.remove(txHash);
+  }
+  this->view.store(std::make_shared<const StateView>(
+    height, std::make_shared<const StateView::Accounts>(this->accounts)
+  ));
+  this->historyStart = height;
+  {
+    std::lock_guard treeLock(this->stateTreeMutex);
+    this->stateTree = std::make_unique<StateTree>(std::move(newTree));
+    this->stateTreeUnsaved = false;
+  }
+  this->contractManager = std::make_unique<ContractManager>(this, this->db, this->rdpos, this->options);
+  {
+    std::lock_guard snapshotsLock(this->snapshotsMutex);
+    this->snapshots.clear();
+  }
+  this->rdpos->reset(newValidators, *block);
+  Logger::logToDebug(LogType::INFO, Log::state, __func__,
+    "Applied snapshot of block " + std::to_string(height) + " (" + std::to_string(entries.size()) + " entries)"
+  );
+  this->storage->resetTo(std::move(*block));
+  this->rdpos->notifyWorker();
+  return true;
+}
@@ -4,14 +4,15 @@
 #include "../contract/contractmanager.h"
 #include "../utils/utils.h"
 #include "../utils/db.h"
+#include "../utils/blockbuilder.h"
+#include "../utils/flathashmap.h"
 #include "storage.h"
 #include "rdpos.h"
-
-// TODO: We could possibly change the bool functions
-// into a enum function, to be able to properly return each error case
-// We need this in order to slash invalid rdPoS blocks.
-/// Enum for labeling transaction validity.
-enum TxInvalid { NotInvalid, InvalidNonce, InvalidBalance };
+#include "mempool.h"
+#include "stateview.h"
+#include "statetree.h"
+#include "snapshot.h"
+#include "txadmission.h"
 
 /**
  * Abstraction of the blockchain's state.
@@ -34,20 +35,129 @@ class State {
     /// Pointer to the options singleton.
     const std::unique_ptr<Options>& options;
 
-    /// Pointer to the contract manager.
-    const std::unique_ptr<ContractManager> contractManager;
+    /// Pointer to the contract manager. Only replaced by applySnapshot().
+    std::unique_ptr<ContractManager> contractManager;
 
     // TODO: Add contract functionality to State after ContractManager is ready.
 
     /// Map with information about blockchain accounts (Address -> Account).
-    std::unordered_map<Address, Account, SafeHash> accounts;
+    FlatHashMap<Address, Account> accounts;
 
     /// TxBlock mempool.
-    std::unordered_map<Hash, TxBlock, SafeHash> mempool;
+    Mempool mempool;
+
+    /// Caps for blocks filled from the mempool.
+    BlockLimits blockLimits;
+
+    /// Number of past blocks whose account state can be queried. See getNativeBalance(addr, height).
+    uint64_t historyRetention = defaultHistoryRetention;
+
+    /// Oldest block height whose account state can be queried.
+    std::atomic<uint64_t> historyStart = 0;
+
+    /**
+     * Undo journal of the block being processed: every account the block touched,
+     * as it was before the block (`std::nullopt` if it didn't exist).
+     * Used to roll the accounts back if the block turns out to be invalid,
+     * and to know which mempool queues to refresh after it.
+     */
+    std::unordered_map<Address, std::optional<Account>, SafeHash> blockJournal;
 
     /// Mutex for managing read/write access to the state object.
     mutable std::shared_mutex stateMutex;
 
+    /**
+     * Mutex for managing read/write access to the mempool.
+     * Always locked after `stateMutex` when both are needed, and held only
+     * for as long as the mempool is used, so mempool queries don't wait for
+     * a whole block to be processed.
+     */
+    mutable std::shared_mutex mempoolMutex;
+
+    /// Latest published read view of the accounts. See getView().
+    std::atomic<std::shared_ptr<const StateView>> view;
+
+    /// Commitment to the state entries, see getStateRoot(). Lags behind while `stateTreeUpdate` is pending.
+    std::unique_ptr<StateTree> stateTree;
+
+    /// Mutex for managing access to `stateTree`, `stateTreeUpdate` and `stateTreeUnsaved`.
+    mutable std::mutex stateTreeMutex;
+
+    /**
+     * Pending update of `stateTree` with the last block's changes.
+     * Hashing runs in the background so block processing doesn't wait for it,
+     * and only readers of the root do. Updates run one at a time, in block order.
+     */
+    std::shared_future<void> stateTreeUpdate;
+
+    /// Whether the last state tree update failed to be saved, so the next one saves the whole tree.
+    bool stateTreeUnsaved = false;
+
+    /// Copy of `accounts` as of `accountsSnapshotView`, made on demand by getAccounts().
+    mutable std::shared_ptr<const FlatHashMap<Address, Account>> accountsSnapshot;
+
+    /// The view `accountsSnapshot` was taken at. A new view means the accounts changed.
+    mutable std::shared_ptr<const StateView> accountsSnapshotView;
+
+    /// Mutex for managing access to `accountsSnapshot` and `accountsSnapshotView`.
+    mutable std::mutex accountsSnapshotMutex;
+
+    /// Copy of the mempool's transactions as of `mempoolSnapshotVersion`, made on demand by getMempool().
+    mutable std::shared_ptr<const FlatHashMap<Hash, TxBlock>> mempoolSnapshot;
+
+    /// The mempool version `mempoolSnapshot` was taken at (see Mempool::getVersion()).
+    mutable uint64_t mempoolSnapshotVersion = 0;
+
+    /// Mutex for managing access to `mempoolSnapshot` and `mempoolSnapshotVersion`.
+    mutable std::mutex mempoolSnapshotMutex;
+
+    /// Admission pipeline for transactions from RPC and peers. See submitTx().
+    std::unique_ptr<TxAdmission> txAdmission;
+
+    /// Latest state snapshots served to peers, oldest first. See getSnapshot().
+    std::deque<std::shared_ptr<const StateSnapshot>> snapshots;
+
+    /// Mutex for managing access to `snapshots`.
+    mutable std::mutex snapshotsMutex;
+
+    /**
+     * Pending build of the snapshot taken at the last `snapshotInterval` block.
+     * Collecting the accounts, chunking and hashing run in the background, like
+     * state tree updates. A build waits for the previous one, so they finish in order.
+     * Only started under `stateMutex`, waited for under it or on destruction.
+     */
+    std::future<void> snapshotBuild;
+
+    /**
+     * Add the entries of the rdPoS validator set and of every contract to a database
+     * batch: everything in the state but the accounts, which have immutable views.
+     * Mutex must be locked by the caller.
+     * @param batch The batch to add the entries to.
+     */
+    void dumpValidatorsAndContracts(DBBatch& batch) const;
+
+    /**
+     * Collect the database entries of a state: the ones the state tree commits to
+     * and a snapshot carries (see StateTree and StateSnapshot). Doesn't need the state mutex.
+     * @param accounts The state's accounts.
+     * @param others The state's other entries (see dumpValidatorsAndContracts()).
+     * @return The entries (full keys, prefix included), sorted by key.
+     */
+    static std::map<Bytes, Bytes> stateEntries(const StateView::Accounts& accounts, const DBBatch& others);
+
+    /**
+     * Build a snapshot from collected entries and keep it, dropping the oldest
+     * one past `keptSnapshots`. Doesn't need the state mutex.
+     * @param height Height of the block the entries were collected at.
+     * @param block The serialized block the entries were collected at.
+     * @param stateRoot The state root at that block.
+     * @param entries The entries (see stateEntries()).
+     * @return The snapshot.
+     */
+    std::shared_ptr<const StateSnapshot> storeSnapshot(
+      const uint64_t& height, Bytes&& block, const Hash& stateRoot, const std::map<Bytes, Bytes>& entries
+    );
+
     /**
      * Verify if a transaction can be accepted within the current state.
      * @param tx The transaction to check.
@@ -55,6 +165,136 @@ class State {
      */
     TxInvalid validateTransactionInternal(const TxBlock& tx) const;
 
+    /**
+     * Validate a block transaction against its sender's account as it is at
+     * that point of the block, and advance that account past it.
+     * Checks chain ID, exact nonce, and cost (value + max fees, overflow included).
+     * @param tx The transaction to check.
+     * @param sender The sender's account after their previous txs in the block.
+     *               Nonce and balance are updated if the tx is valid.
+     * @return `true` if the transaction is valid, `false` otherwise.
+     */
+    bool validateBlockTx(const TxBlock& tx, Account& sender) const;
+
+    /**
+     * Publish a new read view with the current value of the given accounts.
+     * Caller must hold `stateMutex` exclusively.
+     * @param height Height of the block the view reflects.
+     * @param changed The accounts changed since the previous view.
+     */
+    void publishView(const uint64_t& height, const std::vector<Address>& changed);
+
+    /**
+     * Update the state tree with the given changes in the background, and save the
+     * changed nodes with the new root for the given block once it's done.
+     * Waits for the previous update first. Caller must hold `stateMutex` exclusively.
+     * @param height Height of the block the update reflects.
+     * @param changes The state entries changed since the previous update.
+     */
+    void updateStateTree(const uint64_t& height, StateTree::Changes&& changes);
+
+    /// Wait for the pending state tree update, if any.
+    void waitStateTree() const;
+
+    /**
+     * Validate everything in a block but its transactions (height, previous hash,
+     * timestamp and rdPoS). Doesn't need the state mutex.
+     * @param block The block to validate.
+     * @return `true` if the block header is valid, `false` otherwise.
+     */
+    bool validateBlockHeader(const Block& block) const;
+
+    /**
+     * Record an account in `blockJournal` before it's changed for the first time in a block.
+     * Mutex must be locked by the caller.
+     * @param address The account to record.
+     */
+    void journalAccount(const Address& address);
+
+    /**
+     * Save a processed block to the database, together with every account
+     * (see `blockJournal`) and contract (see ContractManager::dumpChanged()) it
+     * changed, in a single atomic batch. Keeps accounts, contracts and blocks in
+     * the database in sync, so a restart after a crash is consistent (rdPoS
+     * validators don't change with blocks, they're saved on shutdown).
+     * Also records the accounts' new values in the account history, and prunes
+     * the history that fell out of the retention window.
+     * Mutex must be locked by the caller.
+     * @param block The processed block.
+     * @return The state entries the block changed, for the state tree (see updateStateTree()).
+     * @throw std::runtime_error if the batch can't be written.
+     */
+    StateTree::Changes saveBlockToDB(const Block& block);
+
+    /**
+     * Get the database key of an account's history entry.
+     * History entries hold the account as it was right after the given block,
+     * and are only written for blocks that changed it.
+     * @param address The account's address.
+     * @param height The block height.
+     * @return The key (address + big-endian height).
+     */
+    static Bytes historyKey(const Address& address, const uint64_t& height);
+
+    /**
+     * Add the history entries of a block to a batch: one per changed account,
+     * plus the block's index entry (the list of accounts it changed).
+     * @param height The block height.
+     * @param addresses The accounts the block changed. Must exist.
+     * @param batch The batch to add the entries to.
+     */
+    void batchHistory(const uint64_t& height, const std::vector<Address>& addresses, DBBatch& batch) const;
+
+    /**
+     * Add to a batch the deletion of every history entry no longer needed to answer
+     * queries inside the retention window, if the window started at a given block
+     * height. For each account, only the newest entry at or before the window
+     * start is kept. Doesn't move `historyStart`. Mutex must be locked by the caller.
+     * @param newStart The new oldest queryable block height.
+     * @param batch The batch to add the deletions to.
+     */
+    void pruneHistory(const uint64_t& newStart, DBBatch& batch);
+
+    /**
+     * Get an account as it was right after a given block.
+     * @param addr The account's address.
+     * @param height The block height.
+     * @return The account (default-constructed if it didn't exist).
+     * @throw std::runtime_error if the height is outside of the retention window
+     *        (including when it was pruned during the lookup).
+     */
+    Account getHistoricalAccount(const Address& addr, const uint64_t& height) const;
+
+    /**
+     * Roll every account touched by the current block back to how it was before it,
+     * and clear `blockJournal`. Mutex must be locked by the caller.
+     */
+    void revertBlockJournal();
+
+    /**
+     * Validate the transactions of a single sender within a block.
+     * Checks chain ID, exact nonce sequence from the account nonce and cumulative
+     * spend (value + max fees, overflow included) against the account balance.
+     * Only reads the state, so different senders can be checked in parallel.
+     * Mutex must be locked by the caller.
+     * @param txs The sender's transactions, in block order. Must not be empty.
+     * @return `true` if all of them are valid, `false` otherwise.
+     */
+    bool validateSenderTxs(const std::vector<const TxBlock*>& txs) const;
+
+    /**
+     * Pick the best executable transactions from the mempool for a new block,
+     * within `blockLimits`. Keeps each sender's nonce order and skips senders
+     * whose next transaction doesn't fit in the block or can't be afforded
+     * after their previous ones. Mutex must be locked by the caller.
+     * @param blockSize The current size of the serialized block, in bytes.
+     * @param append Function called for each picked transaction, in block order.
+     * @return A report of what was included and what was left out.
+     */
+    BlockFillReport pickBlockTransactions(
+      const uint64_t& blockSize, const std::function<void(const TxBlock&)>& append
+    ) const;
+
     /**
      * Process a transaction within a block. Called by processNextBlock().
      * If the process fails, any state change that this transaction would cause has to be reverted.
@@ -63,20 +303,53 @@ class State {
     void processTransaction(const TxBlock& tx);
 
     /**
-     * Update the mempool, removing transactions that are in the given block,
-     * and leaving only valid transactions in it.
-     * Called by processNewBlock(), used to filter the current mempool based
-     * on transactions that have been accepted on the block, and verify if
-     * transactions on the mempool are valid given the new state after processing
-     * the block itself.
-     * @param block The block to use for pruning transactions from the mempool.
+     * Process a run of consecutive native transfers (no contract calls) within a block.
+     * Transfers that share no account (sender or recipient) can't affect each other,
+     * so big runs are split into account-disjoint groups, processed in parallel,
+     * each one in block order. Result is the same as processing them one by one.
+     * @param txs The block transactions.
+     * @param begin Index of the first transaction of the run.
+     * @param end Index after the last transaction of the run.
      */
-    void refreshMempool(const Block& block);
+    void processNativeTransfers(const std::vector<TxBlock>& txs, const uint64_t& begin, const uint64_t& end);
+
+    /**
+     * Validate and process every transaction within a block. Called by tryProcessNextBlock().
+     * Transactions are validated in the same pass that journals and prepares their
+     * accounts, before anything runs, so an invalid block never reaches contracts
+     * (whose changes can't be undone) and is rolled back through `blockJournal`.
+     * Contract calls are processed one at a time, in block order, as contracts
+     * keep their call context and SafeVariables as shared single-version state.
+     * Native transfers between them are processed with processNativeTransfers().
+     * @param txs The block transactions.
+     * @return `true` if every transaction was valid and processed, `false` if
+     *         the block is invalid (accounts are left as they were).
+     */
+    bool processTransactions(const std::vector<TxBlock>& txs);
+
+    /**
+     * Update the mempool after a block, leaving only valid transactions in it.
+     * Called by processNextBlock(). Only the queues of the accounts the block
+     * touched (see `blockJournal`) are revalidated, as no other account
+     * changed. Transactions in the block are dropped along the way, as their
+     * senders' nonces moved past them.
+     * Cost depends on the block, not on the size of the mempool.
+     */
+    void refreshMempool();
 
     /// Flag indicating whether the state is currently processing a payable contract function
     bool processingPayable = false;
 
   public:
+    /// Default number of past blocks whose account state can be queried.
+    static const uint64_t defaultHistoryRetention = 65536;
+
+    /// A snapshot is taken automatically every this many blocks.
+    static constexpr uint64_t snapshotInterval = 1000;
+
+    /// Number of snapshots kept, so peers downloading the previous one can finish.
+    static constexpr uint64_t keptSnapshots = 2;
+
     /**
      * Constructor.
      * @param db Pointer to the database.
@@ -111,14 +384,102 @@ class State {
      */
     const uint64_t getNativeNonce(const Address& addr) const;
 
-    /// Getter for `accounts`. Returns a copy.
-    const std::unordered_map<Address, Account, SafeHash> getAccounts() const;
+    /**
+     * Get the native balance of an account as it was right after a given block.
+     * Doesn't lock the state mutex.
+     * @param addr The address of the account to check.
+     * @param height The block height. Must be within the retention window.
+     * @return The native account balance of the given address at that height.
+     * @throw std::runtime_error if the height is outside of the retention window.
+     */
+    const uint256_t getNativeBalance(const Address& addr, const uint64_t& height) const;
+
+    /**
+     * Get the native nonce of an account as it was right after a given block.
+     * Doesn't lock the state mutex.
+     * @param addr The address of the account to check.
+     * @param height The block height. Must be within the retention window.
+     * @return The native account nonce of the given address at that height.
+     * @throw std::runtime_error if the height is outside of the retention window.
+     */
+    const uint64_t getNativeNonce(const Address& addr, const uint64_t& height) const;
 
-    /// Getter for `mempool`. Returns a copy.
-    const std::unordered_map<Hash, TxBlock, SafeHash> getMempool() const;
+    /// Getter for `historyStart`.
+    const uint64_t getHistoryStart() const { return this->historyStart.load(); }
+
+    /// Getter for the consensus timeline recorded by rdPoS (and the components around it).
+    const ConsensusTrace& getConsensusTrace() const { return this->rdpos->getTrace(); }
+
+    /// Getter for `historyRetention`.
+    const uint64_t getHistoryRetention() const;
+
+    /**
+     * Set how many past blocks of account state are kept. Older history is
+     * pruned as the next blocks are processed.
+     * @param blocks The number of blocks. At least 1.
+     */
+    void setHistoryRetention(const uint64_t& blocks);
+
+    /**
+     * Get the latest read view of the accounts, as of the last processed block.
+     * Lock-free: never waits for block processing, and the view stays the same
+     * for as long as the caller holds it, no matter how many blocks come after.
+     * @return The latest view.
+     */
+    std::shared_ptr<const StateView> getView() const { return this->view.load(); }
+
+    /**
+     * Get the state root as of the last processed block: the root of the
+     * state tree (see StateTree), which commits to every native account, the
+     * rdPoS validator set and every contract's variables.
+     * Waits for the last block's tree update if it's still running.
+     * @return The state root.
+     */
+    const Hash getStateRoot() const;
+
+    /**
+     * Get the state root as it was right after a given block.
+     * @param height The block height.
+     * @return The state root at that height.
+     * @throw std::runtime_error if there's no root saved for that height.
+     */
+    const Hash getStateRoot(const uint64_t& height) const;
+
+    /**
+     * Get the inclusion proof of an account against the current state root.
+     * Check it with StateTree::verify().
+     * @param addr The account's address.
+     * @return The proof, or `std::nullopt` if the account doesn't exist.
+     */
+    std::optional<StateTree::Proof> getAccountProof(const Address& addr) const;
+
+    /**
+     * Get the inclusion proof of any state entry against the current state root.
+     * Check it with StateTree::verify().
+     * @param key The entry's full database key (e.g. a contract variable's).
+     * @return The proof, or `std::nullopt` if the entry doesn't exist.
+     */
+    std::optional<StateTree::Proof> getStateProof(const Bytes& key) const;
+
+    /**
+     * Getter for `accounts`. Returns an immutable snapshot, which stays the same
+     * for as long as the caller holds it. It's copied at most once per block,
+     * the first time it's asked for, and shared by every caller until the next one.
+     * For single accounts, prefer getView() which never copies anything.
+     */
+    std::shared_ptr<const FlatHashMap<Address, Account>> getAccounts() const;
+
+    /**
+     * Getter for the mempool's transactions. Returns an immutable snapshot,
+     * copied at most once per mempool change, see getAccounts().
+     */
+    std::shared_ptr<const FlatHashMap<Hash, TxBlock>> getMempool() const;
+
+    /// Get the number of executable (pending) transactions in the mempool.
+    const uint64_t getMempoolPendingCount() const;
 
     /// Get the mempool's current size.
-    inline const size_t getMempoolSize() const { std::shared_lock (this->stateMutex); return mempool.size(); }
+    inline const size_t getMempoolSize() const { std::shared_lock lock(this->mempoolMutex); return mempool.size(); }
 
     /**
      * Validate the next block given the current state and its transactions.
@@ -140,11 +501,47 @@ class State {
     void processNextBlock(Block&& block);
 
     /**
-     * Fill a block with all transactions currently in the mempool.
+     * Validate and process the next block in a single pass, under a single lock.
+     * DOES update the state if the block is valid, and appends it to Storage.
+     * No need to call validateNextBlock() before it.
+     * @param block The block to process. Only moved if valid.
+     * @param onProcessed Called with the block once it's validated, executed, saved and
+     *                    appended, before the mempool is refreshed (e.g. to broadcast
+     *                    a block we created). Runs under the state lock, so it must
+     *                    not call back into the state.
+     * @return `true` if the block was valid and processed, `false` if it was invalid
+     *         (nothing is changed).
+     * @throw std::runtime_error if the block can't be saved (accounts are rolled back).
+     */
+    bool tryProcessNextBlock(Block&& block, const std::function<void(const Block&)>& onProcessed = nullptr);
+
+    /**
+     * Fill a block with the executable transactions currently in the mempool,
+     * best fee first, keeping each sender's nonce order, up to the block limits.
      * DOES NOT FINALIZE THE BLOCK.
      * @param block The block to fill.
+     * @return A report of what was included and what was left out.
+     */
+    BlockFillReport fillBlockWithTransactions(Block& block) const;
+
+    /**
+     * Fill a block builder with the executable transactions currently in the mempool,
+     * best fee first, keeping each sender's nonce order, up to the block limits.
+     * @param builder The builder to fill.
+     * @param reservedBytes Room to leave for what is still to be appended to the
+     *                      builder (e.g. Validator transactions that aren't in yet).
+     * @return A report of what was included and what was left out.
+     */
+    BlockFillReport fillBlockWithTransactions(BlockBuilder& builder, const uint64_t& reservedBytes = 0) const;
+
+    /// Getter for `blockLimits`.
+    const BlockLimits getBlockLimits() const;
+
+    /**
+     * Set the caps for blocks filled from the mempool.
+     * @param limits The new limits.
      */
-    void fillBlockWithTransactions(Block& block) const;
+    void setBlockLimits(const BlockLimits& limits);
 
     /**
      * Verify if a transaction can be accepted within the current state.
@@ -156,11 +553,41 @@ class State {
 
     /**
      * Add a transaction to the mempool, if valid.
+     * Transactions with nonces ahead of the account nonce are kept as future
+     * transactions until the missing nonces arrive.
      * @param tx The transaction to add.
      * @return An enum telling if the transaction is valid or not.
      */
     TxInvalid addTx(TxBlock&& tx);
 
+    /**
+     * Add several transactions to the mempool, each if valid, locking the
+     * state and the mempool only once for all of them.
+     * @param txs The transactions to add, in order.
+     * @return An enum telling if each transaction is valid or not, in the same order.
+     */
+    std::vector<TxInvalid> addTxs(const std::vector<TxBlock>& txs);
+
+    /**
+     * Submit a raw transaction (e.g. from RPC) to the admission pipeline.
+     * @param rlp The raw signed transaction.
+     * @return A future for its hash and validity, ready as soon as its batch is
+     *         admitted. Throws std::runtime_error if it can't be decoded.
+     */
+    std::future<TxAdmission::Result> submitTx(Bytes&& rlp) { return this->txAdmission->submit(std::move(rlp)); }
+
+    /**
+     * Submit a raw transaction gossiped by a peer to the admission pipeline.
+     * @param rlp The raw signed transaction.
+     * @param onMalformed Called with the reason if it can't be decoded.
+     */
+    void submitPeerTx(Bytes&& rlp, std::function<void(const std::string&)> onMalformed) {
+      this->txAdmission->submitFromPeer(std::move(rlp), std::move(onMalformed));
+    }
+
+    /// Stop the admission pipeline, after admitting everything still queued. Must be done before P2P stops.
+    void stopTxAdmission() { this->txAdmission->stop(); }
+
     /**
      * Add a Validator transaction to the rdPoS mempool, if valid.
      * @param tx The transaction to add.
@@ -175,6 +602,13 @@ class State {
      */
     bool isTxInMempool(const Hash& txHash) const;
 
+    /**
+     * Check if several transactions are in the mempool, locking it only once.
+     * @param txHashes The transaction hashes to check.
+     * @return Whether each transaction is in the mempool, in the same order.
+     */
+    std::vector<bool> areTxsInMempool(const std::vector<Hash>& txHashes) const;
+
     /**
      * Get a transaction from the mempool.
      * @param txHash The transaction Hash.
@@ -194,6 +628,7 @@ class State {
      * IF CALLING THIS FUNCTION WITHIN A MULTI-NODE NETWORK, YOU HAVE TO CALL
      * IT ON ALL NODES IN ORDER TO BE VALID.
      * @param addr The address to add balance to.
+     * @throw std::runtime_error if the database can't be written (the balance is left unchanged).
      */
     void addBalance(const Address& addr);
 
@@ -222,6 +657,51 @@ class State {
     /// Get a list of contract addresses and names.
     std::vector<std::pair<std::string, Address>> getContracts() const;
 
+    /**
+     * Take a snapshot of the state at the latest block and keep it, replacing the
+     * oldest one. Done automatically every `snapshotInterval` blocks, this is for
+     * doing it right away (e.g. when starting to serve snapshots).
+     * @return The snapshot.
+     */
+    std::shared_ptr<const StateSnapshot> takeSnapshot();
+
+    /**
+     * Get the latest snapshot of the state.
+     * @return The snapshot, or `nullptr` if none was taken yet.
+     */
+    std::shared_ptr<const StateSnapshot> getSnapshot() const;
+
+    /**
+     * Get one of the kept snapshots of the state.
+     * @param height Height of the block the snapshot was taken at.
+     * @return The snapshot, or `nullptr` if there's none at that height.
+     */
+    std::shared_ptr<const StateSnapshot> getSnapshot(const uint64_t& height) const;
+
+    /**
+     * Check the block of a snapshot, before downloading or applying it.
+     * @param manifest The snapshot's manifest.
+     * @return The decoded block, or `std::nullopt` if it can't be decoded, isn't
+     *         at the manifest height or isn't signed by one of our validators.
+     */
+    std::optional<Block> checkSnapshotBlock(const StateSnapshot::Manifest& manifest) const;
+
+    /**
+     * Replace the whole state with a snapshot downloaded from peers, and make its
+     * block the latest one (see Storage::resetTo() and rdPoS::reset()). Meant for
+     * bootstrapping a node, blocks between our latest one and the snapshot are never
+     * synced. The account history and the mempool start over from the snapshot.
+     * Nothing is changed if the snapshot is invalid: its block doesn't pass
+     * checkSnapshotBlock(), an entry is malformed or outside of the state, its
+     * validators aren't ours, or the entries don't match the manifest state root.
+     * @param manifest The snapshot's manifest.
+     * @param entries Every entry of the snapshot's chunks (see StateSnapshot::decodeChunk()).
+     * @return `true` if the snapshot was applied, `false` if it's invalid or not
+     *         ahead of our latest block.
+     * @throw std::runtime_error if the database can't be written.
+     */
+    bool applySnapshot(const StateSnapshot::Manifest& manifest, const std::vector<DBEntry>& entries);
+
     /// the Manager Interface cannot use getNativeBalance. as it will call a lock with the mutex.
     friend class ContractManagerInterface;
 };
@@ -0,0 +1,279 @@
+#include "statetree.h"
+
+StateTree::StateTree() : levels(depth + 1) {
+  // An empty bucket hashes to zero, empty subtrees above it hash their two children
+  this->defaults[0] = Hash();
+  for (uint64_t i = 1; i <= depth; i++) {
+    BytesArr<64> pair;
+    std::copy(this->defaults[i - 1].cbegin(), this->defaults[i - 1].cend(), pair.begin());
+    std::copy(this->defaults[i - 1].cbegin(), this->defaults[i - 1].cend(), pair.begin() + 32);
+    this->defaults[i] = Utils::sha3(pair);
+  }
+}
+
+StateTree::StateTree(const std::map<Bytes, Bytes>& entries) : StateTree() {
+  Changes changes;
+  changes.reserve(entries.size());
+  for (const auto& [key, value] : entries) changes.emplace_back(key, value);
+  this->update(changes);
+}
+
+StateTree::StateTree(const DB& db) : StateTree() {
+  // Leaf keys start with their bucket and are read in key order, so buckets come out sorted
+  for (const DBEntry& entry : db.getBatch(DBPrefix::stateTreeLeaves)) {
+    if (entry.key.size() < 4 || entry.value.size() != 32) {
+      Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Malformed state tree leaf in DB");
+      throw std::runtime_error("Malformed state tree leaf in DB");
+    }
+    uint64_t bucketIdx = Utils::bytesToUint32(BytesArrView(entry.key).subspan(0, 4));
+    this->buckets[bucketIdx].emplace_back(Bytes(entry.key.begin() + 4, entry.key.end()), Hash(entry.value));
+  }
+  for (const DBEntry& entry : db.getBatch(DBPrefix::stateTreeNodes)) {
+    if (entry.key.size() != 5 || entry.key[0] > depth || entry.value.size() != 32) {
+      Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Malformed state tree node in DB");
+      throw std::runtime_error("Malformed state tree node in DB");
+    }
+    this->levels[entry.key[0]][Utils::bytesToUint32(BytesArrView(entry.key).subspan(1, 4))] = Hash(entry.value);
+  }
+}
+
+uint64_t StateTree::bucketOf(const BytesArrView key) {
+  Hash hash = Utils::sha3(key);
+  return ((uint64_t(hash[0]) << 16) | (uint64_t(hash[1]) << 8) | uint64_t(hash[2])) >> (24 - depth);
+}
+
+Hash StateTree::leafHash(const BytesArrView key, const BytesArrView value) {
+  Bytes input;
+  input.reserve(4 + key.size() + value.size());
+  Utils::appendBytes(input, Utils::uint32ToBytes(key.size()));
+  input.insert(input.end(), key.begin(), key.end());
+  input.insert(input.end(), value.begin(), value.end());
+  return Utils::sha3(input);
+}
+
+Bytes StateTree::accountKey(const Address& address) {
+  Bytes key = DBPrefix::nativeAccounts;
+  Utils::appendBytes(key, address);
+  return key;
+}
+
+Bytes StateTree::nodeKey(const uint64_t& level, const uint64_t& index) {
+  Bytes key = { uint8_t(level) };
+  Utils::appendBytes(key, Utils::uint32ToBytes(index));
+  return key;
+}
+
+Bytes StateTree::leafKey(const uint64_t& bucket, const BytesArrView key) {
+  Bytes ret;
+  ret.reserve(4 + key.size());
+  Utils::appendBytes(ret, Utils::uint32ToBytes(bucket));
+  ret.insert(ret.end(), key.begin(), key.end());
+  return ret;
+}
+
+const Hash& StateTree::getNode(const uint64_t& level, const uint64_t& index) const {
+  auto it = this->levels[level].find(index);
+  return (it != this->levels[level].end()) ? it->second : this->defaults[level];
+}
+
+void StateTree::hashBatch(std::span<const BytesArrView> inputs, std::span<Hash> out) {
+  unsigned int thrNum = std::thread::hardware_concurrency();
+  if (thrNum <= 1 || inputs.size() < StateTree::parallelHashThreshold) {
+    Utils::sha3Batch(inputs, out);
+    return;
+  }
+  // Logically divide inputs equally into one-time hardware threads/asyncs.
+  // Division reminder always goes to the LAST thread (e.g. 11/4 = 2+2+2+5)
+  uint64_t perThr = inputs.size() / thrNum;
+  std::vector<std::future<void>> f;
+  f.reserve(thrNum);
+  for (uint64_t i = 0; i < thrNum; i++) {
+    uint64_t begin = i * perThr;
+    uint64_t count = (i == thrNum - 1) ? inputs.size() - begin : perThr;
+    f.emplace_back(std::async(std::launch::async, [inputs, out, begin, count]() {
+      Utils::sha3Batch(inputs.subspan(begin, count), out.subspan(begin, count));
+    }));
+  }
+  for (auto& future : f) future.get();
+}
+
+void StateTree::apply(const Changes& changes, DBBatch* batch) {
+  if (changes.empty()) return;
+
+  // Hash every new leaf and every key (for its bucket) in two batches
+  std::vector<Bytes> leafInputs;
+  std::vector<BytesArrView> leafViews, keyViews;
+  leafInputs.reserve(changes.size());
+  leafViews.reserve(changes.size());
+  keyViews.reserve(changes.size());
+  for (const auto& [key, value] : changes) {
+    keyViews.emplace_back(key);
+    if (!value) continue;
+    Bytes& input = leafInputs.emplace_back();
+    input.reserve(4 + key.size() + value->size());
+    Utils::appendBytes(input, Utils::uint32ToBytes(key.size()));
+    Utils::appendBytes(input, key);
+    Utils::appendBytes(input, *value);
+  }
+  for (const Bytes& input : leafInputs) leafViews.emplace_back(input);
+  std::vector<Hash> leaves(leafViews.size()), keyHashes(keyViews.size());
+  hashBatch(leafViews, leaves);
+  hashBatch(keyViews, keyHashes);
+
+  // Apply the changes to their buckets. Entries saved again with the same value
+  // (e.g. a contract's untouched variables) leave their bucket as it is.
+  std::vector<uint64_t> dirty;
+  dirty.reserve(changes.size());
+  uint64_t leafIdx = 0;
+  for (uint64_t i = 0; i < changes.size(); i++) {
+    const auto& [key, value] = changes[i];
+    const Hash& keyHash = keyHashes[i];
+    uint64_t bucketIdx = ((uint64_t(keyHash[0]) << 16) | (uint64_t(keyHash[1]) << 8)
+      | uint64_t(keyHash[2])) >> (24 - depth);
+    auto& bucket = this->buckets[bucketIdx];
+    auto it = std::lower_bound(bucket.begin(), bucket.end(), key,
+      [](const std::pair<Bytes, Hash>& entry, const Bytes& k) { return entry.first < k; }
+    );
+    bool found = (it != bucket.end() && it->first == key);
+    bool changed = false;
+    if (value) {
+      const Hash& leaf = leaves[leafIdx++];
+      if (!found) {
+        bucket.emplace(it, key, leaf);
+        changed = true;
+      } else if (it->second != leaf) {
+        it->second = leaf;
+        changed = true;
+      }
+      if (changed && batch != nullptr) batch->push_back(leafKey(bucketIdx, key), leaf.view_const(), DBPrefix::stateTreeLeaves);
+    } else if (found) {
+      bucket.erase(it);
+      changed = true;
+      if (batch != nullptr) batch->delete_key(leafKey(bucketIdx, key), DBPrefix::stateTreeLeaves);
+    }
+    if (bucket.empty()) this->buckets.erase(bucketIdx);
+    if (changed) dirty.emplace_back(bucketIdx);
+  }
+  std::sort(dirty.begin(), dirty.end());
+  dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+  this->rehash(std::move(dirty), batch);
+}
+
+void StateTree::rehash(std::vector<uint64_t>&& dirty, DBBatch* batch) {
+  // Buckets: hash of their leaves, concatenated
+  std::vector<Bytes> bucketInputs;
+  std::vector<BytesArrView> views;
+  std::vector<Hash> hashes;
+  bucketInputs.reserve(dirty.size());
+  for (const uint64_t& bucketIdx : dirty) {
+    Bytes& input = bucketInputs.emplace_back();
+    auto it = this->buckets.find(bucketIdx);
+    if (it == this->buckets.end()) continue;
+    input.reserve(it->second.size() * 32);
+    for (const auto& [key, leaf] : it->second) Utils::appendBytes(input, leaf);
+  }
+  for (const Bytes& input : bucketInputs) views.emplace_back(input);
+  hashes.resize(views.size());
+  hashBatch(views, hashes);
+  for (uint64_t i = 0; i < dirty.size(); i++) {
+    if (bucketInputs[i].empty()) {
+      this->levels[0].erase(dirty[i]);
+      if (batch != nullptr) batch->delete_key(nodeKey(0, dirty[i]), DBPrefix::stateTreeNodes);
+    } else {
+      this->levels[0][dirty[i]] = hashes[i];
+      if (batch != nullptr) batch->push_back(nodeKey(0, dirty[i]), hashes[i].view_const(), DBPrefix::stateTreeNodes);
+    }
+  }
+
+  // Every level above: hash of both children, one batch per level
+  std::vector<BytesArr<64>> pairs;
+  for (uint64_t level = 0; level < depth; level++) {
+    std::vector<uint64_t> parents;
+    parents.reserve(dirty.size());
+    for (const uint64_t& idx : dirty) if (parents.empty() || parents.back() != (idx >> 1)) parents.emplace_back(idx >> 1);
+    pairs.resize(parents.size());
+    views.clear();
+    for (uint64_t i = 0; i < parents.size(); i++) {
+      const Hash& left = this->getNode(level, parents[i] << 1);
+      const Hash& right = this->getNode(level, (parents[i] << 1) | 1);
+      std::copy(left.cbegin(), left.cend(), pairs[i].begin());
+      std::copy(right.cbegin(), right.cend(), pairs[i].begin() + 32);
+      views.emplace_back(pairs[i]);
+    }
+    hashes.resize(views.size());
+    hashBatch(views, hashes);
+    for (uint64_t i = 0; i < parents.size(); i++) {
+      if (hashes[i] == this->defaults[level + 1]) {
+        this->levels[level + 1].erase(parents[i]);
+        if (batch != nullptr) batch->delete_key(nodeKey(level + 1, parents[i]), DBPrefix::stateTreeNodes);
+      } else {
+        this->levels[level + 1][parents[i]] = hashes[i];
+        if (batch != nullptr) batch->push_back(nodeKey(level + 1, parents[i]), hashes[i].view_const(), DBPrefix::stateTreeNodes);
+      }
+    }
+    dirty = std::move(parents);
+  }
+}
+
+void StateTree::dump(DBBatch& batch) const {
+  for (const auto& [bucketIdx, bucket] : this->buckets) {
+    for (const auto& [key, leaf] : bucket) batch.push_back(leafKey(bucketIdx, key), leaf.view_const(), DBPrefix::stateTreeLeaves);
+  }
+  for (uint64_t level = 0; level <= depth; level++) {
+    for (const auto& [index, hash] : this->levels[level]) batch.push_back(nodeKey(level, index), hash.view_const(), DBPrefix::stateTreeNodes);
+  }
+}
+
+void StateTree::erase(const DB& db, DBBatch& batch) {
+  for (const Bytes& prefix : {DBPrefix::stateTreeLeaves, DBPrefix::stateTreeNodes}) {
+    for (const DBEntry& entry : db.getBatch(prefix)) batch.delete_key(entry.key, prefix);
+  }
+}
+
+uint64_t StateTree::size() const {
+  uint64_t ret = 0;
+  for (const auto& [idx, bucket] : this->buckets) ret += bucket.size();
+  return ret;
+}
+
+std::optional<StateTree::Proof> StateTree::getProof(const BytesArrView key) const {
+  uint64_t bucketIdx = bucketOf(key);
+  auto bucketIt = this->buckets.find(bucketIdx);
+  if (bucketIt == this->buckets.end()) return std::nullopt;
+  Proof proof;
+  bool found = false;
+  for (const auto& [k, leaf] : bucketIt->second) {
+    if (std::equal(k.cbegin(), k.cend(), key.begin(), key.end())) { proof.leafIndex = proof.bucket.size(); found = true; }
+    proof.bucket.emplace_back(leaf);
+  }
+  if (!found) return std::nullopt;
+  uint64_t idx = bucketIdx;
+  for (uint64_t level = 0; level < depth; level++) {
+    proof.siblings.emplace_back(this->getNode(level, idx ^ 1));
+    idx >>= 1;
+  }
+  return proof;
+}
+
+bool StateTree::verify(const Proof& proof, const BytesArrView key, const BytesArrView value, const Hash& root) {
+  if (proof.siblings.size() != depth || proof.leafIndex >= proof.bucket.size()) return false;
+  if (proof.bucket[proof.leafIndex] != leafHash(key, value)) return false;
+  Bytes bucketInput;
+  for (const Hash& leaf : proof.bucket) Utils::appendBytes(bucketInput, leaf);
+  Hash node = Utils::sha3(bucketInput);
+  uint64_t idx = bucketOf(key);
+  for (const Hash& sibling : proof.siblings) {
+    BytesArr<64> pair;
+    const Hash& left = (idx & 1) ? sibling : node;
+    const Hash& right = (idx & 1) ? node : sibling;
+    std::copy(left.cbegin(), left.cend(), pair.begin());
+    std::copy(right.cbegin(), right.cend(), pair.begin() + 32);
+    node = Utils::sha3(pair);
+    idx >>= 1;
+  }
+  return node == root;
+}
+
+bool StateTree::verify(const Proof& proof, const Address& address, const Account& account, const Hash& root) {
+  return verify(proof, accountKey(address), account.serialize(), root);
+}
@@ -0,0 +1,209 @@
+#ifndef STATETREE_H
+#define STATETREE_H
+
+#include <array>
+#include <future>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "../utils/db.h"
+#include "../utils/flathashmap.h"
+#include "../utils/utils.h"
+
+/**
+ * Authenticated commitment to the state, updated incrementally block by block.
+ *
+ * The tree commits to database entries, keyed by their full database key (prefix
+ * included): the native accounts, the rdPoS validator set, the contract registry and
+ * every contract's variables, as State saves them and a snapshot carries them.
+ * Entries are spread over 2^`depth` buckets by the first bits of the Keccak hash
+ * of their key. A bucket's hash is the hash of its entries' leaf hashes
+ * (`sha3(keySize + key + value)`), ordered by key. Buckets are the leaves of a sparse
+ * binary tree of fixed depth, whose root commits to every entry. Empty buckets and
+ * subtrees take precomputed default hashes and aren't stored, so memory only grows
+ * with the number of entries.
+ *
+ * Updating k entries rehashes at most k buckets and k paths of `depth` nodes.
+ * Every level is hashed as one batch (multi-lane Keccak, in parallel if big enough).
+ * Leaf hashes and nodes are persisted (DBPrefix::stateTreeLeaves and
+ * DBPrefix::stateTreeNodes) along with every update, so the tree is loaded on
+ * startup instead of being rebuilt from the whole state.
+ *
+ * Not thread-safe, the caller must serialize access.
+ */
+class StateTree {
+  public:
+    /// Number of levels above the buckets (2^depth buckets).
+    static constexpr uint64_t depth = 20;
+
+    /// Minimum number of hashes in a batch before it is hashed across multiple threads.
+    static constexpr uint64_t parallelHashThreshold = 2000;
+
+    /// Changed entries, as (full key, new value), the value being `std::nullopt` if the entry was removed.
+    using Changes = std::vector<std::pair<Bytes, std::optional<Bytes>>>;
+
+    /// Inclusion proof of an entry.
+    struct Proof {
+      std::vector<Hash> bucket;     ///< Leaf hashes of every entry in the same bucket, ordered by key.
+      uint64_t leafIndex = 0;       ///< Position of the entry's leaf within `bucket`.
+      std::vector<Hash> siblings;   ///< Sibling hash at each level, from the bucket up to the root.
+    };
+
+  private:
+    /// Entries of each non-empty bucket, as (key, leaf hash), ordered by key.
+    FlatHashMap<uint64_t, std::vector<std::pair<Bytes, Hash>>> buckets;
+
+    /// Hashes of non-default nodes, per level. `levels[0]` are the buckets, `levels[depth]` is the root.
+    std::vector<FlatHashMap<uint64_t, Hash>> levels;
+
+    /// Hash of an empty subtree at each level.
+    std::array<Hash, depth + 1> defaults;
+
+    /**
+     * Get the hash of a node.
+     * @param level The node's level (0 for buckets).
+     * @param index The node's index within its level.
+     * @return The hash, or the level's default if the subtree is empty.
+     */
+    const Hash& getNode(const uint64_t& level, const uint64_t& index) const;
+
+    /**
+     * Get the database key of a node.
+     * @param level The node's level.
+     * @param index The node's index within its level.
+     * @return 1 byte (level) + 4 bytes (index).
+     */
+    static Bytes nodeKey(const uint64_t& level, const uint64_t& index);
+
+    /**
+     * Get the database key of a leaf.
+     * @param bucket The leaf's bucket.
+     * @param key The entry's key.
+     * @return 4 bytes (bucket) + key, so a bucket's leaves are stored together and in order.
+     */
+    static Bytes leafKey(const uint64_t& bucket, const BytesArrView key);
+
+    /**
+     * Hash several inputs in one batch, in parallel if there are enough of them.
+     * @param inputs The inputs.
+     * @param out The output hashes, in the same order as `inputs`.
+     */
+    static void hashBatch(std::span<const BytesArrView> inputs, std::span<Hash> out);
+
+    /**
+     * Apply changes to the tree.
+     * @param changes The changes. Each key must appear only once.
+     * @param batch The batch to add the changed leaves and nodes to, or `nullptr` to not persist them.
+     */
+    void apply(const Changes& changes, DBBatch* batch);
+
+    /**
+     * Rehash the given buckets and every node above them.
+     * @param dirty The buckets that changed. Sorted and unique.
+     * @param batch The batch to add the changed nodes to, or `nullptr` to not persist them.
+     */
+    void rehash(std::vector<uint64_t>&& dirty, DBBatch* batch);
+
+  public:
+    /// Constructor for an empty tree.
+    StateTree();
+
+    /**
+     * Constructor.
+     * @param entries The entries to commit to, by full key.
+     */
+    explicit StateTree(const std::map<Bytes, Bytes>& entries);
+
+    /**
+     * Constructor. Loads the tree persisted in the database.
+     * @param db The database.
+     * @throw std::runtime_error if a persisted leaf or node is malformed.
+     */
+    explicit StateTree(const DB& db);
+
+    /**
+     * Get the bucket of a key.
+     * @param key The key.
+     * @return The bucket index (first `depth` bits of the key's hash).
+     */
+    static uint64_t bucketOf(const BytesArrView key);
+
+    /**
+     * Get the leaf hash of an entry.
+     * @param key The entry's key.
+     * @param value The entry's value.
+     * @return `sha3(keySize + key + value)`, the key's size being 4 bytes.
+     */
+    static Hash leafHash(const BytesArrView key, const BytesArrView value);
+
+    /**
+     * Get the key of an account's entry.
+     * @param address The account's address.
+     * @return DBPrefix::nativeAccounts + address.
+     */
+    static Bytes accountKey(const Address& address);
+
+    /**
+     * Apply changes to the tree, without persisting them.
+     * @param changes The changes. Each key must appear only once.
+     */
+    void update(const Changes& changes) { this->apply(changes, nullptr); }
+
+    /**
+     * Apply changes to the tree.
+     * @param changes The changes. Each key must appear only once.
+     * @param batch The batch to add the changed leaves and nodes to.
+     */
+    void update(const Changes& changes, DBBatch& batch) { this->apply(changes, &batch); }
+
+    /**
+     * Add the whole tree to a database batch, e.g. after rebuilding it.
+     * Persisted leaves and nodes that aren't in the tree anymore must be deleted by the caller.
+     * @param batch The batch to add the leaves and nodes to.
+     */
+    void dump(DBBatch& batch) const;
+
+    /**
+     * Add the deletion of the whole persisted tree to a database batch, e.g. before dumping a rebuilt one.
+     * @param db The database.
+     * @param batch The batch to add the deletions to.
+     */
+    static void erase(const DB& db, DBBatch& batch);
+
+    /// Get the root hash.
+    const Hash& getRoot() const { return this->getNode(depth, 0); }
+
+    /// Get the number of entries in the tree.
+    uint64_t size() const;
+
+    /**
+     * Get the inclusion proof of an entry.
+     * @param key The entry's key.
+     * @return The proof, or `std::nullopt` if the entry isn't in the tree.
+     */
+    std::optional<Proof> getProof(const BytesArrView key) const;
+
+    /**
+     * Check an inclusion proof against a root.
+     * @param proof The proof.
+     * @param key The entry's key.
+     * @param value The entry's claimed value.
+     * @param root The root to check against.
+     * @return `true` if the entry with that value is committed to by the root, `false` otherwise.
+     */
+    static bool verify(const Proof& proof, const BytesArrView key, const BytesArrView value, const Hash& root);
+
+    /**
+     * Check an inclusion proof of an account against a root.
+     * @param proof The proof.
+     * @param address The account's address.
+     * @param account The account's claimed value.
+     * @param root The root to check against.
+     * @return `true` if the account with that value is committed to by the root, `false` otherwise.
+     */
+    static bool verify(const Proof& proof, const Address& address, const Account& account, const Hash& root);
+};
+
+#endif  // STATETREE_H
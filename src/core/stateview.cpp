@@ -0,0 +1,52 @@
+#include "stateview.h"
+
+const Account* StateView::find(const Address& address) const {
+  for (auto layer = this->layers.rbegin(); layer != this->layers.rend(); layer++) {
+    auto it = (*layer)->find(address);
+    if (it != (*layer)->end()) return &it->second;
+  }
+  auto it = this->base->find(address);
+  return (it != this->base->end()) ? &it->second : nullptr;
+}
+
+uint256_t StateView::getNativeBalance(const Address& address) const {
+  const Account* account = this->find(address);
+  return (account != nullptr) ? account->balance.toBoost() : uint256_t(0);
+}
+
+uint64_t StateView::getNativeNonce(const Address& address) const {
+  const Account* account = this->find(address);
+  return (account != nullptr) ? account->nonce : 0;
+}
+
+StateView::Accounts StateView::collect() const {
+  Accounts ret = *this->base;
+  for (const auto& layer : this->layers) {
+    for (const auto& [address, account] : *layer) ret.insert_or_assign(address, account);
+  }
+  return ret;
+}
+
+std::shared_ptr<const StateView> StateView::next(
+  const uint64_t& height, Accounts&& changes, const Accounts& current
+) const {
+  std::vector<std::shared_ptr<const Accounts>> newLayers = this->layers;
+  if (!changes.empty()) newLayers.emplace_back(std::make_shared<const Accounts>(std::move(changes)));
+  if (newLayers.size() <= maxLayers) {
+    return std::make_shared<const StateView>(height, this->base, std::move(newLayers));
+  }
+
+  // Too many layers, merge them into one (newer values win)
+  Accounts merged;
+  for (const auto& layer : newLayers) {
+    for (const auto& [address, account] : *layer) merged.insert_or_assign(address, account);
+  }
+
+  // Changes add up to a good part of the base, it's cheaper to start over from the live map
+  if (merged.size() >= minRebuildSize && merged.size() >= this->base->size() / 8) {
+    return std::make_shared<const StateView>(height, std::make_shared<const Accounts>(current));
+  }
+  newLayers.clear();
+  newLayers.emplace_back(std::make_shared<const Accounts>(std::move(merged)));
+  return std::make_shared<const StateView>(height, this->base, std::move(newLayers));
+}
@@ -0,0 +1,101 @@
+#ifndef STATEVIEW_H
+#define STATEVIEW_H
+
+#include <memory>
+#include <vector>
+
+#include "../utils/flathashmap.h"
+#include "../utils/utils.h"
+
+/**
+ * Immutable read view of the native accounts as they were right after a given block.
+ *
+ * State publishes a new view after every block it commits, and readers (RPC)
+ * pin the latest one with a single atomic load, so they never wait on the state
+ * mutex nor see a block half-applied. A view is never changed after being
+ * published, so it can be read from any number of threads without locking.
+ *
+ * To avoid copying every account on every block, a view is a full copy of the
+ * accounts taken at some earlier block (the "base"), plus a short stack of
+ * layers holding only the accounts changed since then (newest last).
+ * Consecutive views share the base and the layers they have in common.
+ * Layers are merged together once there are too many of them, and the base is
+ * rebuilt once the merged layers get too big compared to it, so lookups stay
+ * cheap and the cost of a new view stays proportional to what blocks change.
+ */
+class StateView {
+  public:
+    /// Typedef for the accounts map.
+    using Accounts = FlatHashMap<Address, Account>;
+
+    /// Maximum number of layers on top of the base before they're merged into one.
+    static const uint64_t maxLayers = 16;
+
+    /// Minimum number of accounts in the merged layers before the base is rebuilt.
+    static const uint64_t minRebuildSize = 4096;
+
+  private:
+    const uint64_t height;                                        ///< Height of the block this view reflects.
+    const std::shared_ptr<const Accounts> base;                   ///< Every account as of an earlier block.
+    const std::vector<std::shared_ptr<const Accounts>> layers;    ///< Accounts changed since the base, oldest first.
+
+  public:
+    /**
+     * Constructor.
+     * @param height Height of the block the view reflects.
+     * @param base Every account as of `height` or an earlier block.
+     * @param layers Accounts changed since the base, oldest first.
+     */
+    StateView(
+      const uint64_t& height, std::shared_ptr<const Accounts> base,
+      std::vector<std::shared_ptr<const Accounts>> layers = {}
+    ) : height(height), base(std::move(base)), layers(std::move(layers)) {}
+
+    /// Getter for `height`.
+    const uint64_t& getHeight() const { return this->height; }
+
+    /// Get the number of layers on top of the base.
+    size_t getLayerCount() const { return this->layers.size(); }
+
+    /**
+     * Find an account.
+     * @param address The account's address.
+     * @return A pointer to the account, or `nullptr` if it doesn't exist.
+     *         Valid for as long as the view is.
+     */
+    const Account* find(const Address& address) const;
+
+    /**
+     * Get the native balance of an account.
+     * @param address The account's address.
+     * @return The balance, or 0 if the account doesn't exist.
+     */
+    uint256_t getNativeBalance(const Address& address) const;
+
+    /**
+     * Get the native nonce of an account.
+     * @param address The account's address.
+     * @return The nonce, or 0 if the account doesn't exist.
+     */
+    uint64_t getNativeNonce(const Address& address) const;
+
+    /**
+     * Copy every account of the view into a single map.
+     * @return The accounts.
+     */
+    Accounts collect() const;
+
+    /**
+     * Build the view of a following block.
+     * @param height Height of the new block.
+     * @param changes The accounts the new block changed, with their new values.
+     * @param current Every account as of the new block (the state's live map),
+     *                copied only if the base has to be rebuilt.
+     * @return The new view.
+     */
+    std::shared_ptr<const StateView> next(
+      const uint64_t& height, Accounts&& changes, const Accounts& current
+    ) const;
+};
+
+#endif  // STATEVIEW_H
@@ -32,14 +32,16 @@ Storage::Storage(const std::unique_ptr<DB>& db, const std::unique_ptr<Options>&
     this->blockHeightByHash.insert({Hash(map.value), Utils::bytesToUint64(map.key)});
   }
 
-  // Append up to 500 most recent blocks from DB to chain
+  // Append up to 500 most recent blocks from DB to chain. Nodes bootstrapped
+  // from a state snapshot have no blocks below it, so stop at the first gap.
   Logger::logToDebug(LogType::INFO, Log::storage, __func__, "Appending recent blocks");
   for (uint64_t i = 0; i <= 500 && i <= depth; i++) {
+    auto hashIt = this->blockHashByHeight.find(depth - i);
+    if (hashIt == this->blockHashByHeight.end()) break;
     Logger::logToDebug(LogType::DEBUG, Log::storage, __func__,
-      std::string("Height: ") + std::to_string(depth - i) + ", Hash: "
-      + this->blockHashByHeight[depth - i].hex().get()
+      std::string("Height: ") + std::to_string(depth - i) + ", Hash: " + hashIt->second.hex().get()
     );
-    Block block(this->db->get(this->blockHashByHeight[depth - i].get(), DBPrefix::blocks), this->options->getChainID());
+    Block block(this->db->get(hashIt->second.get(), DBPrefix::blocks), this->options->getChainID());
     this->pushFrontInternal(std::move(block));
   }
 
@@ -56,20 +58,10 @@ Storage::~Storage() {
       // Batch block to be saved to the database.
       // We can't call this->popBack() because of the mutex
       std::shared_ptr<const Block> block = this->chain.front();
-      batchedOperations.push_back(block->hash().get(), block->serializeBlock(), DBPrefix::blocks);
-      batchedOperations.push_back(Utils::uint64ToBytes(block->getNHeight()), block->hash().get(), DBPrefix::blockHeightMaps);
-
-      // Batch txs to be saved to the database and delete them from the mappings
-      auto Txs = block->getTxs();
-      for (uint32_t i = 0; i < Txs.size(); i++) {
-        const auto TxHash = Txs[i].hash();
-        Bytes value = block->hash().asBytes();
-        value.reserve(value.size() + 4 + 8);
-        Utils::appendBytes(value, Utils::uint32ToBytes(i));
-        Utils::appendBytes(value, Utils::uint64ToBytes(block->getNHeight()));
-        batchedOperations.push_back(TxHash.get(), value, DBPrefix::txToBlocks);
-        this->txByHash.erase(TxHash);
-      }
+      Storage::batchBlock(*block, batchedOperations);
+
+      // Delete txs from the mappings
+      for (const auto& tx : block->getTxs()) this->txByHash.erase(tx.hash());
 
       // Delete block from internal mappings and the chain
       this->blockByHash.erase(block->hash());
@@ -82,6 +74,24 @@ Storage::~Storage() {
   this->db->put(std::string("latest"), latest->serializeBlock(), DBPrefix::blocks);
 }
 
+void Storage::batchBlock(const Block& block, DBBatch& batch, bool asLatest) {
+  const Hash blockHash = block.hash();
+  Bytes blockBytes = block.serializeBlock();
+  if (asLatest) batch.push_back(Utils::stringToBytes("latest"), blockBytes, DBPrefix::blocks);
+  batch.push_back(blockHash.get(), std::move(blockBytes), DBPrefix::blocks);
+  batch.push_back(Utils::uint64ToBytes(block.getNHeight()), blockHash.get(), DBPrefix::blockHeightMaps);
+
+  // Batch txs to be saved to the database
+  const auto& txs = block.getTxs();
+  for (uint32_t i = 0; i < txs.size(); i++) {
+    Bytes value = blockHash.asBytes();
+    value.reserve(value.size() + 4 + 8);
+    Utils::appendBytes(value, Utils::uint32ToBytes(i));
+    Utils::appendBytes(value, Utils::uint64ToBytes(block.getNHeight()));
+    batch.push_back(txs[i].hash().get(), std::move(value), DBPrefix::txToBlocks);
+  }
+}
+
 void Storage::initializeBlockchain() {
   if (!this->db->has(std::string("latest"), DBPrefix::blocks)) {
     // Create a new genesis block if one doesn't exist (fresh new blockchain)
@@ -92,9 +102,10 @@ void Storage::initializeBlockchain() {
     // Private: 0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867
     // Address: 0x00dead00665771855a34155f5e7405489df2c3c6
     genesis.finalize(PrivKey(Hex::toBytes("0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867")), 1656356646000000);
-    this->db->put(std::string("latest"), genesis.serializeBlock(), DBPrefix::blocks);
+    Bytes genesisBytes = genesis.serializeBlock();
+    this->db->put(std::string("latest"), genesisBytes, DBPrefix::blocks);
     this->db->put(Utils::uint64ToBytes(genesis.getNHeight()), genesis.hash().get(), DBPrefix::blockHeightMaps);
-    this->db->put(genesis.hash().get(), genesis.serializeBlock(), DBPrefix::blocks);
+    this->db->put(genesis.hash().get(), genesisBytes, DBPrefix::blocks);
     Logger::logToDebug(LogType::INFO, Log::storage, __func__,
       std::string("Created genesis block: ") + Hex::fromBytes(genesis.hash().get()).get()
     );
@@ -197,6 +208,15 @@ void Storage::popFront() {
   this->chain.pop_front();
 }
 
+void Storage::resetTo(Block&& block) {
+  std::unique_lock<std::shared_mutex> lock(this->chainLock);
+  this->chain.clear();
+  this->blockByHash.clear();
+  this->txByHash.clear();
+  this->blockHashByHeight.erase(block.getNHeight());
+  this->pushBackInternal(std::move(block));
+}
+
 StorageStatus Storage::blockExists(const Hash& hash) {
   // Check chain first, then cache, then database
   std::shared_lock<std::shared_mutex> lock(this->chainLock);
@@ -7,6 +7,7 @@
 #include "../utils/db.h"
 #include "../utils/ecdsa.h"
 #include "../utils/randomgen.h"
+#include "../utils/flathashmap.h"
 #include "../utils/safehash.h"
 #include "../utils/utils.h"
 #include "../utils/options.h"
@@ -39,10 +40,10 @@ class Storage {
     std::deque<std::shared_ptr<const Block>> chain;
 
     /// Map that indexes blocks in memory by their respective hashes.
-    std::unordered_map<Hash, const std::shared_ptr<const Block>, SafeHash> blockByHash;
+    FlatHashMap<Hash, const std::shared_ptr<const Block>> blockByHash;
 
     /// Map that indexes Tx, blockHash, blockIndex and blockHeight by their respective hashes
-    std::unordered_map<Hash, const std::tuple<const Hash,const uint64_t,const uint64_t>, SafeHash> txByHash;
+    FlatHashMap<Hash, const std::tuple<const Hash,const uint64_t,const uint64_t>> txByHash;
 
     /// Map that indexes all block heights in the chain by their respective hashes.
     std::unordered_map<Hash, const uint64_t, SafeHash> blockHeightByHash;
@@ -120,6 +121,15 @@ class Storage {
      */
     ~Storage();
 
+    /**
+     * Add a block, its height mapping and its tx mappings to a database batch,
+     * the same way the chain is saved on destruction.
+     * @param block The block to save.
+     * @param batch The batch to add the block to.
+     * @param asLatest (optional) If `true`, also save the block as the latest one.
+     */
+    static void batchBlock(const Block& block, DBBatch& batch, bool asLatest = false);
+
     /// Wrapper for `pushBackInternal()`. Use this as it properly locks `chainLock`.
     void pushBack(Block&& block);
 
@@ -132,6 +142,16 @@ class Storage {
     /// Remove a block from the start of the chain.
     void popFront();
 
+    /**
+     * Drop the chain kept in memory and start it over from a block that doesn't
+     * follow the latest one (e.g. the block a state snapshot was taken at).
+     * Blocks in the database are still found by height and hash, those never
+     * synced (below a snapshot) are simply not found.
+     * @param block The new latest block. Must already be saved to the database
+     *              as the latest one (see batchBlock()).
+     */
+    void resetTo(Block&& block);
+
     /**
      * Check if a block exists anywhere in storage (memory/chain, then cache, then database).
      * @param hash The block hash to search.
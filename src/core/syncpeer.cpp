@@ -0,0 +1,6 @@
+#include "syncpeer.h"
+
+std::string SyncPeer::describe() const {
+  return this->id.first.to_string() + ":" + std::to_string(this->id.second)
+    + "=" + std::to_string(this->downloaded) + (this->alive ? "" : "(dropped)");
+}
@@ -0,0 +1,99 @@
+#ifndef SYNCPEER_H
+#define SYNCPEER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../net/p2p/encoding.h"
+
+/**
+ * A peer a sync (BlockSync, SnapshotSync) downloads from, with the bookkeeping
+ * every sync needs: failures in a row, what it delivered, and whether it's still used.
+ * Syncs derive their own peer type from it to add what they need to know about it.
+ */
+struct SyncPeer {
+  /// Number of failures in a row before a peer is dropped.
+  static constexpr uint64_t maxFailures = 3;
+
+  P2P::NodeID id;             ///< ID of the peer.
+  uint64_t failures = 0;      ///< Failures in a row.
+  uint64_t downloaded = 0;    ///< Items (blocks, chunks) it delivered.
+  bool alive = true;          ///< Whether it's still used.
+
+  /**
+   * Constructor.
+   * @param id ID of the peer.
+   */
+  explicit SyncPeer(const P2P::NodeID& id) : id(id) {}
+
+  /**
+   * Record a successful download.
+   * @param count Number of items delivered.
+   */
+  void delivered(const uint64_t& count) { this->failures = 0; this->downloaded += count; }
+
+  /**
+   * Record a failed download.
+   * @return `true` if the peer failed `maxFailures` times in a row and should be dropped.
+   */
+  bool failed() { return ++this->failures >= maxFailures; }
+
+  /// Get the peer's address and number of items delivered, for logging (e.g. "127.0.0.1:8080=12(dropped)").
+  std::string describe() const;
+
+  /**
+   * Describe every peer of a sync, for logging.
+   * @param peers The peers.
+   * @return The description of each peer, each one preceded by a space.
+   */
+  template <typename Peer> static std::string describe(const std::vector<Peer>& peers) {
+    std::string ret;
+    for (const SyncPeer& peer : peers) ret += " " + peer.describe();
+    return ret;
+  }
+};
+
+/**
+ * Run the worker of a sync peer: take a job, run it, report its result, until
+ * there's nothing left to do or the peer is dropped. Jobs are taken and results
+ * reported under the sync's mutex, jobs are run without it, so workers download
+ * and verify in parallel. Other workers are notified of every result.
+ * @param mutex The sync's mutex.
+ * @param cv The sync's condition variable, notified on every result.
+ * @param stop Flag for stopping early.
+ * @param over Tells whether the sync is over. Called under `mutex`.
+ * @param take Returns the next job for the peer, or `std::nullopt` if there's none now. Called under `mutex`.
+ * @param run Runs a job and returns its result. Called without `mutex`.
+ * @param report Handles a job's result (e.g. handing a failed job back, see SyncPeer::failed()),
+ *               returns `false` if the peer was dropped. Called under `mutex`.
+ */
+template <typename Over, typename Take, typename Run, typename Report> void runSyncWorker(
+  std::mutex& mutex, std::condition_variable& cv, const std::atomic<bool>& stop,
+  Over&& over, Take&& take, Run&& run, Report&& report
+) {
+  using Job = typename std::invoke_result_t<Take>::value_type;
+  while (true) {
+    std::optional<Job> job;
+    {
+      std::unique_lock lock(mutex);
+      while (!stop && !over() && !(job = take())) cv.wait_for(lock, std::chrono::milliseconds(100));
+      if (!job) return;
+    }
+    auto result = run(*job);
+    bool alive;
+    {
+      std::unique_lock lock(mutex);
+      alive = report(*job, std::move(result));
+    }
+    cv.notify_all();
+    if (!alive) return;
+  }
+}
+
+#endif  // SYNCPEER_H
@@ -0,0 +1,204 @@
+#include "txadmission.h"
+#include "state.h"
+
+TxAdmission::TxAdmission(
+  State& state,
+  const std::unique_ptr<P2P::ManagerNormal>& p2pManager,
+  const std::unique_ptr<Options>& options
+) : state(state), p2pManager(p2pManager), options(options) {
+  this->admissionLoopFuture = std::async(std::launch::async, &TxAdmission::admissionLoop, this);
+  this->gossipLoopFuture = std::async(std::launch::async, &TxAdmission::gossipLoop, this);
+}
+
+void TxAdmission::admissionLoop() {
+  while (true) {
+    std::vector<Pending> batch;
+    {
+      std::unique_lock lock(this->queueMutex);
+      this->queueCv.wait(lock, [&]() { return this->stopped || !this->queue.empty(); });
+      if (this->queue.empty()) return;
+      while (!this->queue.empty() && batch.size() < maxBatchSize) {
+        this->queueBytes -= this->queue.front().rlp.size();
+        batch.emplace_back(std::move(this->queue.front()));
+        this->queue.pop_front();
+      }
+    }
+    try {
+      this->admitBatch(batch);
+    } catch (const std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::state, __func__,
+        std::string("Failed to admit a batch of transactions: ") + e.what()
+      );
+      // Let every RPC caller still waiting know, instead of leaving a broken promise
+      for (Pending& pending : batch) {
+        if (!pending.result) continue;
+        try {
+          pending.result->set_exception(std::current_exception());
+        } catch (const std::future_error&) {}  // Result was already handed out
+      }
+    }
+  }
+}
+
+void TxAdmission::gossipLoop() {
+  while (true) {
+    std::deque<TxBlock> txs;
+    {
+      std::unique_lock lock(this->gossipMutex);
+      this->gossipCv.wait(lock, [&]() { return this->gossipStopped || !this->gossipQueue.empty(); });
+      if (this->gossipQueue.empty()) return;
+      txs.swap(this->gossipQueue);
+    }
+    if (!this->p2pManager) continue;
+    for (const TxBlock& tx : txs) this->p2pManager->broadcastTxBlock(tx);
+  }
+}
+
+void TxAdmission::admitBatch(std::vector<Pending>& batch) {
+  // Hash the raw transactions, a canonically encoded tx hashes the same once decoded
+  std::vector<BytesArrView> views;
+  views.reserve(batch.size());
+  for (const Pending& pending : batch) views.emplace_back(pending.rlp);
+  std::vector<Hash> hashes(batch.size());
+  Utils::sha3Batch(views, hashes);
+
+  // Duplicates take the outcome of their first copy, and txs already in
+  // the mempool are accepted as is, neither gets decoded again.
+  // Mempool keys are tx hashes, so known raw hashes are already the tx hash.
+  std::vector<uint64_t> firstCopy(batch.size());
+  std::vector<std::optional<TxInvalid>> status(batch.size());
+  std::vector<std::string> errors(batch.size());
+  std::vector<uint64_t> toDecode;
+  FlatHashMap<Hash, uint64_t> seen;
+  seen.reserve(batch.size());
+  std::vector<bool> known = this->state.areTxsInMempool(hashes);
+  for (uint64_t i = 0; i < batch.size(); i++) {
+    auto [it, inserted] = seen.try_emplace(hashes[i], i);
+    firstCopy[i] = it->second;
+    if (!inserted) continue;
+    if (known[i]) { status[i] = TxInvalid::NotInvalid; continue; }
+    toDecode.emplace_back(i);
+  }
+
+  // Decode the rest, recovering senders across multiple threads if there are enough of them.
+  // Division reminder always goes to the LAST thread (e.g. 11/4 = 2+2+2+5)
+  const uint64_t chainId = this->options->getChainID();
+  std::vector<std::optional<TxBlock>> decoded(toDecode.size());
+  auto decodeRange = [&](const uint64_t begin, const uint64_t end) {
+    for (uint64_t j = begin; j < end; j++) {
+      try {
+        decoded[j].emplace(batch[toDecode[j]].rlp, chainId);
+      } catch (const std::exception& e) {
+        errors[toDecode[j]] = e.what();
+      }
+    }
+  };
+  unsigned int thrNum = std::thread::hardware_concurrency();
+  if (thrNum <= 1 || toDecode.size() < parallelDecodeThreshold) {
+    decodeRange(0, toDecode.size());
+  } else {
+    uint64_t perThr = toDecode.size() / thrNum;
+    std::vector<std::future<void>> f;
+    f.reserve(thrNum);
+    for (uint64_t i = 0; i < thrNum; i++) {
+      uint64_t begin = i * perThr;
+      uint64_t end = (i == thrNum - 1) ? toDecode.size() : begin + perThr;
+      f.emplace_back(std::async(std::launch::async, decodeRange, begin, end));
+    }
+    for (auto& future : f) future.get();
+  }
+
+  // Validate and insert every decoded tx in one go
+  std::vector<TxBlock> txs;
+  std::vector<uint64_t> txIndexes;
+  txs.reserve(toDecode.size());
+  txIndexes.reserve(toDecode.size());
+  for (uint64_t j = 0; j < toDecode.size(); j++) {
+    if (!decoded[j]) continue;
+    txs.emplace_back(std::move(*decoded[j]));
+    txIndexes.emplace_back(toDecode[j]);
+  }
+  std::vector<TxInvalid> results = this->state.addTxs(txs);
+  std::vector<TxBlock> accepted;
+  for (uint64_t k = 0; k < txs.size(); k++) {
+    hashes[txIndexes[k]] = txs[k].hash();
+    status[txIndexes[k]] = results[k];
+    if (!results[k]) accepted.emplace_back(std::move(txs[k]));
+  }
+  if (!accepted.empty()) {
+    std::unique_lock lock(this->gossipMutex);
+    for (TxBlock& tx : accepted) this->gossipQueue.emplace_back(std::move(tx));
+    lock.unlock();
+    this->gossipCv.notify_one();
+  }
+
+  // Hand out the results
+  for (uint64_t i = 0; i < batch.size(); i++) {
+    Pending& pending = batch[i];
+    const uint64_t& first = firstCopy[i];
+    if (status[first]) {
+      if (pending.result) {
+        bool isKnown = (first != i || known[i]) && *status[first] == TxInvalid::NotInvalid;
+        pending.result->set_value({hashes[first], *status[first], isKnown});
+      }
+      continue;
+    }
+    if (pending.result) {
+      pending.result->set_exception(std::make_exception_ptr(
+        std::runtime_error("Error while decoding transaction: " + errors[first])
+      ));
+    }
+    if (pending.onMalformed) pending.onMalformed(errors[first]);
+  }
+}
+
+void TxAdmission::enqueue(Pending&& pending) {
+  std::unique_lock lock(this->queueMutex);
+  if (this->stopped) {
+    lock.unlock();
+    if (pending.result) {
+      pending.result->set_exception(std::make_exception_ptr(std::runtime_error("Transaction admission is stopped")));
+    }
+    return;
+  }
+  // Checked before anything is decoded, so a flood can't grow the queue without bound
+  if (this->queue.size() >= maxQueueSize || this->queueBytes + pending.rlp.size() > maxQueueBytes) {
+    lock.unlock();
+    Logger::logToDebug(LogType::WARNING, Log::state, __func__, "Transaction admission queue is full, rejecting transaction");
+    if (pending.result) {
+      pending.result->set_exception(std::make_exception_ptr(std::runtime_error("Transaction admission queue is full")));
+    }
+    return;
+  }
+  this->queueBytes += pending.rlp.size();
+  this->queue.emplace_back(std::move(pending));
+  lock.unlock();
+  this->queueCv.notify_one();
+}
+
+std::future<TxAdmission::Result> TxAdmission::submit(Bytes&& rlp) {
+  Pending pending{std::move(rlp), std::promise<Result>(), nullptr};
+  std::future<Result> ret = pending.result->get_future();
+  this->enqueue(std::move(pending));
+  return ret;
+}
+
+void TxAdmission::submitFromPeer(Bytes&& rlp, std::function<void(const std::string&)> onMalformed) {
+  this->enqueue(Pending{std::move(rlp), std::nullopt, std::move(onMalformed)});
+}
+
+void TxAdmission::stop() {
+  // Admission goes first, as it may still queue transactions for gossip
+  {
+    std::unique_lock lock(this->queueMutex);
+    this->stopped = true;
+  }
+  this->queueCv.notify_all();
+  if (this->admissionLoopFuture.valid()) this->admissionLoopFuture.get();
+  {
+    std::unique_lock lock(this->gossipMutex);
+    this->gossipStopped = true;
+  }
+  this->gossipCv.notify_all();
+  if (this->gossipLoopFuture.valid()) this->gossipLoopFuture.get();
+}
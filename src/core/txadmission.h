@@ -0,0 +1,140 @@
+#ifndef TXADMISSION_H
+#define TXADMISSION_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+
+#include "../utils/tx.h"
+#include "../utils/utils.h"
+#include "mempool.h"
+
+// Forward declarations.
+class State;
+class Options;
+namespace P2P { class ManagerNormal; }
+
+/**
+ * Admission pipeline for block transactions coming from RPC and from peers.
+ *
+ * Submitted raw transactions are queued, and a worker takes whatever piled up
+ * while it was busy as one micro-batch. Each batch is:
+ * 1. deduplicated by hash, within itself and against the mempool (known
+ *    transactions aren't decoded again);
+ * 2. decoded, recovering the senders in parallel if the batch is big enough;
+ * 3. validated and inserted into the mempool under a single lock acquisition
+ *    (see State::addTxs());
+ * 4. handed to a second worker that gossips the accepted transactions to
+ *    peers, so admission never waits on the network.
+ *
+ * RPC callers get their result as soon as their batch is admitted.
+ * The queue is bounded (`maxQueueSize`, `maxQueueBytes`), so a flood of
+ * transactions is turned away before any of them is decoded.
+ */
+class TxAdmission {
+  public:
+    /// Maximum number of transactions admitted in a single batch.
+    static const uint64_t maxBatchSize = 1024;
+
+    /// Maximum number of transactions waiting to be admitted.
+    static const uint64_t maxQueueSize = 16 * maxBatchSize;
+
+    /// Maximum total size (in bytes) of the transactions waiting to be admitted.
+    static const uint64_t maxQueueBytes = 64 * 1024 * 1024;
+
+    /// Minimum number of transactions in a batch before they're decoded across multiple threads.
+    static const uint64_t parallelDecodeThreshold = 32;
+
+    /// Result of an admitted transaction.
+    struct Result {
+      Hash hash;            ///< Hash of the transaction.
+      TxInvalid status;     ///< Whether it was accepted, or why not.
+      bool known = false;   ///< Whether it was accepted before (in the mempool, or earlier in its batch), so nothing was added.
+    };
+
+  private:
+    /// A transaction waiting to be admitted.
+    struct Pending {
+      Bytes rlp;                                              ///< The raw signed transaction.
+      std::optional<std::promise<Result>> result;             ///< Where to put the result (RPC).
+      std::function<void(const std::string&)> onMalformed;    ///< Called if it can't be decoded (peers).
+    };
+
+    State& state;                                           ///< Reference to the state.
+    const std::unique_ptr<P2P::ManagerNormal>& p2pManager;  ///< Reference to the P2P connection manager.
+    const std::unique_ptr<Options>& options;                ///< Reference to the options singleton.
+
+    std::deque<Pending> queue;          ///< Transactions waiting to be admitted.
+    uint64_t queueBytes = 0;            ///< Total size of the transactions in `queue`.
+    std::mutex queueMutex;              ///< Mutex for managing access to `queue`.
+    std::condition_variable queueCv;    ///< Signals new transactions in `queue`.
+
+    std::deque<TxBlock> gossipQueue;    ///< Accepted transactions waiting to be gossiped.
+    std::mutex gossipMutex;             ///< Mutex for managing access to `gossipQueue`.
+    std::condition_variable gossipCv;   ///< Signals new transactions in `gossipQueue`.
+
+    bool stopped = false;                   ///< Flag for stopping the admission worker. Guarded by `queueMutex`.
+    bool gossipStopped = false;             ///< Flag for stopping the gossip worker. Guarded by `gossipMutex`.
+    std::future<void> admissionLoopFuture;  ///< Future object holding the thread for the admission loop.
+    std::future<void> gossipLoopFuture;     ///< Future object holding the thread for the gossip loop.
+
+    /// Admit batches from `queue` until stopped. Whatever is still queued when stopping is admitted first.
+    void admissionLoop();
+
+    /// Gossip transactions from `gossipQueue` until stopped. Whatever is still queued when stopping is gossiped first.
+    void gossipLoop();
+
+    /**
+     * Admit a batch of transactions.
+     * If it throws, results that weren't handed out yet are left to the caller.
+     * @param batch The transactions.
+     */
+    void admitBatch(std::vector<Pending>& batch);
+
+    /**
+     * Queue a transaction for admission. It's rejected (its result, if any, being
+     * an error) if admission is stopped or the queue is full.
+     * @param pending The transaction.
+     */
+    void enqueue(Pending&& pending);
+
+  public:
+    /**
+     * Constructor. Starts the workers.
+     * @param state Reference to the state.
+     * @param p2pManager Reference to the P2P connection manager.
+     * @param options Reference to the options singleton.
+     */
+    TxAdmission(
+      State& state,
+      const std::unique_ptr<P2P::ManagerNormal>& p2pManager,
+      const std::unique_ptr<Options>& options
+    );
+
+    /// Destructor. Stops the workers.
+    ~TxAdmission() { this->stop(); }
+
+    /**
+     * Submit a transaction (e.g. from RPC).
+     * @param rlp The raw signed transaction.
+     * @return A future for the result. Throws std::runtime_error if the transaction can't be
+     *         decoded, or if it was rejected because the admission queue is full.
+     */
+    std::future<Result> submit(Bytes&& rlp);
+
+    /**
+     * Submit a transaction gossiped by a peer. Doesn't wait for the result.
+     * Dropped if the admission queue is full.
+     * @param rlp The raw signed transaction.
+     * @param onMalformed Called with the reason if the transaction can't be decoded.
+     */
+    void submitFromPeer(Bytes&& rlp, std::function<void(const std::string&)> onMalformed);
+
+    /// Stop the workers, after admitting and gossiping everything still queued.
+    void stop();
+};
+
+#endif  // TXADMISSION_H
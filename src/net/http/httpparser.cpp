@@ -115,8 +115,7 @@ std::string parseJsonRpcRequest(
         break;
       case JsonRPC::Methods::eth_sendRawTransaction:
         ret = JsonRPC::Encoding::eth_sendRawTransaction(
-          JsonRPC::Decoding::eth_sendRawTransaction(request, options->getChainID()),
-          state, p2p
+          JsonRPC::Decoding::eth_sendRawTransaction(request), state
         );
         break;
       case JsonRPC::Methods::eth_getTransactionByHash:
@@ -141,6 +140,11 @@ std::string parseJsonRpcRequest(
           JsonRPC::Decoding::eth_getTransactionReceipt(request), storage
         );
         break;
+      case JsonRPC::Methods::debug_getConsensusTrace:
+        ret = JsonRPC::Encoding::debug_getConsensusTrace(
+          JsonRPC::Decoding::debug_getConsensusTrace(request), state
+        );
+        break;
       default:
         ret["error"]["code"] = -32601;
         ret["error"]["message"] = "Method not found";
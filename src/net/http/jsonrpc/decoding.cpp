@@ -418,23 +418,21 @@ namespace JsonRPC {
       }
     }
 
-    Address eth_getBalance(const json& request, const std::unique_ptr<Storage>& storage) {
+    std::pair<Address, uint64_t> eth_getBalance(const json& request, const std::unique_ptr<Storage>& storage) {
       static const std::regex addFilter("^0x[0-9,a-f,A-F]{40}$");
       static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
       try {
         const auto address = request["params"].at(0).get<std::string>();
         const auto block = request["params"].at(1).get<std::string>();
-        if (block != "latest") {
-          if (!std::regex_match(block, numFilter)) throw std::runtime_error(
-            "Invalid block number"
-          );
-          uint64_t blockNum = uint64_t(Hex(block).getUint());
-          if (blockNum != storage->latest()->getNHeight()) throw std::runtime_error(
-            "Only latest block is supported"
-          );
-        }
         if (!std::regex_match(address, addFilter)) throw std::runtime_error("Invalid address hex");
-        return Address(Hex::toBytes(address));
+        uint64_t blockNum = 0;
+        if (block == "latest") {
+          blockNum = storage->latest()->getNHeight();
+        } else if (block != "earliest") {
+          if (!std::regex_match(block, numFilter)) throw std::runtime_error("Invalid block number");
+          blockNum = uint64_t(Hex(block).getUint());
+        }
+        return std::make_pair(Address(Hex::toBytes(address)), blockNum);
       } catch (std::exception& e) {
         Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
           std::string("Error while decoding eth_getBalance: ") + e.what()
@@ -443,23 +441,21 @@ namespace JsonRPC {
       }
     }
 
-    Address eth_getTransactionCount(const json& request, const std::unique_ptr<Storage>& storage) {
+    std::pair<Address, uint64_t> eth_getTransactionCount(const json& request, const std::unique_ptr<Storage>& storage) {
       static const std::regex addFilter("^0x[0-9,a-f,A-F]{40}$");
       static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
       try {
         const auto address = request["params"].at(0).get<std::string>();
         const auto block = request["params"].at(1).get<std::string>();
-        if (block != "latest") {
-          if (!std::regex_match(block, numFilter)) throw std::runtime_error(
-            "Invalid block number"
-          );
-          uint64_t blockNum = uint64_t(Hex(block).getUint());
-          if (blockNum != storage->latest()->getNHeight()) throw std::runtime_error(
-            "Only latest block is supported"
-          );
-        }
         if (!std::regex_match(address, addFilter)) throw std::runtime_error("Invalid address hex");
-        return Address(Hex::toBytes(address));
+        uint64_t blockNum = 0;
+        if (block == "latest") {
+          blockNum = storage->latest()->getNHeight();
+        } else if (block != "earliest") {
+          if (!std::regex_match(block, numFilter)) throw std::runtime_error("Invalid block number");
+          blockNum = uint64_t(Hex(block).getUint());
+        }
+        return std::make_pair(Address(Hex::toBytes(address)), blockNum);
       } catch (std::exception& e) {
         Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
           std::string("Error while decoding eth_getTransactionCount: ") + e.what()
@@ -493,11 +489,11 @@ namespace JsonRPC {
       }
     }
 
-    TxBlock eth_sendRawTransaction(const json& request, const uint64_t& requiredChainId) {
+    Bytes eth_sendRawTransaction(const json& request) {
       try {
         const auto txHex = request["params"].at(0).get<std::string>();
         if (!Hex::isValid(txHex, true)) throw std::runtime_error("Invalid transaction hex");
-        return TxBlock(Hex::toBytes(txHex), requiredChainId);
+        return Hex::toBytes(txHex);
       } catch (std::exception& e) {
         Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
           std::string("Error while decoding eth_sendRawTransaction: ") + e.what()
@@ -579,6 +575,33 @@ namespace JsonRPC {
         );
       }
     }
+
+    std::pair<uint64_t,bool> debug_getConsensusTrace(const json& request) {
+      static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
+      try {
+        uint64_t fromHeight = 0;
+        bool chromeTrace = false;
+        if (request["params"].size() > 2) throw std::runtime_error("Too many params");
+        if (request["params"].size() >= 1) {
+          std::string height = request["params"].at(0).get<std::string>();
+          if (!std::regex_match(height, numFilter)) throw std::runtime_error("Invalid block height hex");
+          fromHeight = uint64_t(Hex(height).getUint());
+        }
+        if (request["params"].size() == 2) {
+          std::string format = request["params"].at(1).get<std::string>();
+          if (format != "json" && format != "chrome") throw std::runtime_error("Invalid format: " + format);
+          chromeTrace = (format == "chrome");
+        }
+        return std::make_pair(fromHeight, chromeTrace);
+      } catch (std::exception& e) {
+        Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+          std::string("Error while decoding debug_getConsensusTrace: ") + e.what()
+        );
+        throw std::runtime_error(
+          "Error while decoding debug_getConsensusTrace: " + std::string(e.what())
+        );
+      }
+    }
   }
 }
 
@@ -151,20 +151,20 @@ namespace JsonRPC {
     void eth_gasPrice(const json& request);
 
     /**
-     * Parse an `eth_getBalance` address and check if it is valid.
+     * Parse an `eth_getBalance` address and block, and check if they are valid.
      * @param request The request object.
-     * @param storage Pointer to the blockchain's storage.
-     * @return The requested address.
+     * @param storage Pointer to the blockchain's storage (in case of "latest" block).
+     * @return A pair with the requested address and block height.
      */
-    Address eth_getBalance(const json& request, const std::unique_ptr<Storage>& storage);
+    std::pair<Address, uint64_t> eth_getBalance(const json& request, const std::unique_ptr<Storage>& storage);
 
     /**
-     * Parse an `eth_getTransactionCount` address and check if it is valid.
+     * Parse an `eth_getTransactionCount` address and block, and check if they are valid.
      * @param request The request object.
-     * @param storage Pointer to the blockchain's storage.
-     * @return The requested address.
+     * @param storage Pointer to the blockchain's storage (in case of "latest" block).
+     * @return A pair with the requested address and block height.
      */
-    Address eth_getTransactionCount(const json& request, const std::unique_ptr<Storage>& storage);
+    std::pair<Address, uint64_t> eth_getTransactionCount(const json& request, const std::unique_ptr<Storage>& storage);
 
     /**
      * Parse an `eth_getCode` address and check if it is valid.
@@ -175,12 +175,12 @@ namespace JsonRPC {
     Address eth_getCode(const json& request, const std::unique_ptr<Storage>& storage);
 
     /**
-     * Parse a `eth_sendRawTransaction` tx and check if it is valid.
+     * Parse a `eth_sendRawTransaction` raw tx and check if it is valid hex.
+     * The transaction itself is decoded and checked when admitted (see TxAdmission).
      * @param request The request object.
-     * @param requiredChainId The chain ID that the transaction will be sent to.
-     * @return The built transaction object.
+     * @return The raw signed transaction.
      */
-    TxBlock eth_sendRawTransaction(const json& request, const uint64_t& requiredChainId);
+    Bytes eth_sendRawTransaction(const json& request);
 
     /**
      * Parse a `eth_getTransactionByHash` transaction hash and check if it is valid.
@@ -212,6 +212,15 @@ namespace JsonRPC {
      * @return The build transaction hash object.
      */
     Hash eth_getTransactionReceipt(const json& request);
+
+    /**
+     * Parse a `debug_getConsensusTrace` request and check if it is valid.
+     * Both params are optional: the lowest block height to include
+     * (hex, defaults to all) and the format ("json", default, or "chrome").
+     * @param request The request object.
+     * @return A pair of lowest height and whether to use the Chrome trace format.
+     */
+    std::pair<uint64_t,bool> debug_getConsensusTrace(const json& request);
   }
 }
 
@@ -30,7 +30,7 @@ namespace JsonRPC {
         ret["result"]["baseFeePerGas"] = "0x9502f900";
         ret["result"]["withdrawRoot"] = Hash().hex(true); // No withdrawRoot.
         // TODO: to get a block you have to serialize it entirely, this can be expensive.
-        ret["result"]["size"] = Hex::fromBytes(Utils::uintToBytes(block->serializeBlock().size()),true).forRPC();
+        ret["result"]["size"] = Hex::fromBytes(Utils::uintToBytes(block->serializedSize()),true).forRPC();
         ret["result"]["transactions"] = json::array();
         for (const auto& tx : block->getTxs()) {
           if (!includeTransactions) { // Only include the transaction hashes.
@@ -200,17 +200,29 @@ namespace JsonRPC {
       return ret;
     }
 
-    json eth_getBalance(const Address& address, const std::unique_ptr<State>& state) {
+    json eth_getBalance(const std::pair<Address, uint64_t>& addressAndHeight, const std::unique_ptr<State>& state) {
       json ret;
       ret["jsonrpc"] = "2.0";
-      ret["result"] = Hex::fromBytes(Utils::uintToBytes(state->getNativeBalance(address)), true).forRPC();
+      try {
+        const auto& [address, height] = addressAndHeight;
+        ret["result"] = Hex::fromBytes(Utils::uintToBytes(state->getNativeBalance(address, height)), true).forRPC();
+      } catch (std::exception& e) {
+        ret["error"]["code"] = -32000;
+        ret["error"]["message"] = "Internal error: " + std::string(e.what());
+      }
       return ret;
     }
 
-    json eth_getTransactionCount(const Address& address, const std::unique_ptr<State>& state) {
+    json eth_getTransactionCount(const std::pair<Address, uint64_t>& addressAndHeight, const std::unique_ptr<State>& state) {
       json ret;
       ret["jsonrpc"] = "2.0";
-      ret["result"] = Hex::fromBytes(Utils::uintToBytes(state->getNativeNonce(address)), true).forRPC();
+      try {
+        const auto& [address, height] = addressAndHeight;
+        ret["result"] = Hex::fromBytes(Utils::uintToBytes(state->getNativeNonce(address, height)), true).forRPC();
+      } catch (std::exception& e) {
+        ret["error"]["code"] = -32000;
+        ret["error"]["message"] = "Internal error: " + std::string(e.what());
+      }
       return ret;
     }
 
@@ -221,17 +233,15 @@ namespace JsonRPC {
       return ret;
     }
 
-    json eth_sendRawTransaction(const TxBlock& tx, const std::unique_ptr<State>& state, const std::unique_ptr<P2P::ManagerNormal>& p2p) {
+    json eth_sendRawTransaction(Bytes&& rlp, const std::unique_ptr<State>& state) {
       json ret;
       ret["jsonrpc"] = "2.0";
-      auto txHash = tx.hash();
-      // We can't move as we need to broadcast the tx (see below)
-      auto TxInvalid = state->addTx(TxBlock(tx));
-      if (!TxInvalid) {
+      auto [txHash, TxInvalid, known] = state->submitTx(std::move(rlp)).get();
+      if (known) {
+        ret["error"]["code"] = -32000;
+        ret["error"]["message"] = "Transaction already known";
+      } else if (!TxInvalid) {
         ret["result"] = txHash.hex(true);
-        // TODO: Make this use threadpool instead of blocking
-        // TODO: Make tx broadcasting better, the current solution is not good.
-        p2p->broadcastTxBlock(tx);
       } else {
         ret["error"]["code"] = -32000;
         switch (TxInvalid) {
@@ -241,6 +251,9 @@ namespace JsonRPC {
           case TxInvalid::InvalidBalance:
             ret["error"]["message"] = "Invalid balance";
             break;
+          case TxInvalid::Underpriced:
+            ret["error"]["message"] = "Transaction underpriced";
+            break;
         }
       }
       return ret;
@@ -372,6 +385,15 @@ namespace JsonRPC {
       ret["result"] = json::value_t::null;
       return ret;
     }
+
+    json debug_getConsensusTrace(const std::pair<uint64_t,bool>& requestInfo, const std::unique_ptr<State>& state) {
+      json ret;
+      ret["jsonrpc"] = "2.0";
+      const auto& [fromHeight, chromeTrace] = requestInfo;
+      const ConsensusTrace& trace = state->getConsensusTrace();
+      ret["result"] = (chromeTrace) ? trace.toChromeTrace(fromHeight) : trace.toJSON(fromHeight);
+      return ret;
+    }
   }
 }
 
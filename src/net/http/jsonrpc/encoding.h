@@ -162,19 +162,19 @@ namespace JsonRPC {
 
     /**
      * Encode a `eth_getBalance` response.
-     * @param address The address to get the balance from.
+     * @param addressAndHeight The address to get the balance from, and the block height to get it at.
      * @param state Pointer to the blockchain's state.
      * @return The encoded JSON response.
      */
-    json eth_getBalance(const Address& address, const std::unique_ptr<State>& state);
+    json eth_getBalance(const std::pair<Address, uint64_t>& addressAndHeight, const std::unique_ptr<State>& state);
 
     /**
      * Encode a `eth_getTransactionCount` response.
-     * @param address The address to get the transaction count from.
+     * @param addressAndHeight The address to get the transaction count from, and the block height to get it at.
      * @param state Pointer to the blockchain's state.
      * @return The encoded JSON response.
      */
-    json eth_getTransactionCount(const Address& address, const std::unique_ptr<State>& state);
+    json eth_getTransactionCount(const std::pair<Address, uint64_t>& addressAndHeight, const std::unique_ptr<State>& state);
 
     /**
      * Encode a `eth_getCode` response (always returns "0x").
@@ -184,16 +184,15 @@ namespace JsonRPC {
     json eth_getCode(const Address& address);
 
     /**
-     * Encode a `eth_sendRawTransaction` response. Adds the transaction to the mempool.
-     * @param tx The transaction to add.
+     * Encode a `eth_sendRawTransaction` response. Submits the transaction to
+     * the state's admission pipeline and waits for it to be admitted (but not
+     * broadcast, which happens in the background).
+     * @param rlp The raw signed transaction.
      * @param state Pointer to the blockchain's state.
-     * @param p2p Pointer to the P2P connection manager.
      * @return The encoded JSON response.
+     * @throw std::runtime_error if the transaction can't be decoded.
      */
-    // TODO: WAITING FOR BLOCKCHAIN
-    json eth_sendRawTransaction(
-      const TxBlock& tx, const std::unique_ptr<State>& state, const std::unique_ptr<P2P::ManagerNormal>& p2p
-    );
+    json eth_sendRawTransaction(Bytes&& rlp, const std::unique_ptr<State>& state);
 
     /**
      * Encode a `eth_getTransactionByHash` response.
@@ -233,6 +232,15 @@ namespace JsonRPC {
      * @return The encoded JSON response.
      */
     json eth_getTransactionReceipt(const Hash& txHash, const std::unique_ptr<Storage>& storage);
+
+    /**
+     * Encode a `debug_getConsensusTrace` response.
+     * @param requestInfo A pair of lowest block height and whether to use the Chrome trace format.
+     * @param state Pointer to the blockchain's state.
+     * @return The encoded JSON response, with the timeline (see ConsensusTrace::toJSON()
+     *         and ConsensusTrace::toChromeTrace()) as the result.
+     */
+    json debug_getConsensusTrace(const std::pair<uint64_t,bool>& requestInfo, const std::unique_ptr<State>& state);
   }
 }
 
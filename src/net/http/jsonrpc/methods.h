@@ -72,6 +72,7 @@ namespace JsonRPC {
    * eth_getTransactionByBlockHashAndIndex ===== DONE
    * eth_getTransactionByBlockNumberAndIndex === DONE
    * eth_getTransactionReceipt ================= DONE
+   * debug_getConsensusTrace =================== DONE (NOT ETHEREUM, SEE ConsensusTrace)
    * ```
    */
   enum Methods {
@@ -124,7 +125,8 @@ namespace JsonRPC {
     eth_getTransactionByHash,
     eth_getTransactionByBlockHashAndIndex,
     eth_getTransactionByBlockNumberAndIndex,
-    eth_getTransactionReceipt
+    eth_getTransactionReceipt,
+    debug_getConsensusTrace
   };
 
   /// Lookup table for the implemented methods.
@@ -154,7 +156,8 @@ namespace JsonRPC {
     { "eth_getTransactionByHash", eth_getTransactionByHash },
     { "eth_getTransactionByBlockHashAndIndex", eth_getTransactionByBlockHashAndIndex },
     { "eth_getTransactionByBlockNumberAndIndex", eth_getTransactionByBlockNumberAndIndex },
-    { "eth_getTransactionReceipt", eth_getTransactionReceipt }
+    { "eth_getTransactionReceipt", eth_getTransactionReceipt },
+    { "debug_getConsensusTrace", debug_getConsensusTrace }
   };
 }
 
@@ -58,11 +58,59 @@ namespace P2P {
 
   Message RequestEncoder::requestValidatorTxs() {
     Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2);
     Utils::appendBytes(message, Utils::randBytes(8));
     Utils::appendBytes(message, getCommandPrefix(RequestValidatorTxs));
     return Message(std::move(message));
   }
 
+  Message RequestEncoder::requestMissingValidatorTxs(const std::vector<Hash>& known) {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2 + (known.size() * 32));
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestMissingValidatorTxs));
+    for (const Hash& hash : known) Utils::appendBytes(message, hash);
+    return Message(std::move(message));
+  }
+
+  Message RequestEncoder::requestBlocks(const uint64_t& start, const uint64_t& count) {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2 + 8 + 8);
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestBlocks));
+    Utils::appendBytes(message, Utils::uint64ToBytes(start));
+    Utils::appendBytes(message, Utils::uint64ToBytes(count));
+    return Message(std::move(message));
+  }
+
+  Message RequestEncoder::requestHeaders(const uint64_t& start, const uint64_t& count) {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2 + 8 + 8);
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestHeaders));
+    Utils::appendBytes(message, Utils::uint64ToBytes(start));
+    Utils::appendBytes(message, Utils::uint64ToBytes(count));
+    return Message(std::move(message));
+  }
+
+  Message RequestEncoder::requestSnapshotManifest() {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2);
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestSnapshotManifest));
+    return Message(std::move(message));
+  }
+
+  Message RequestEncoder::requestSnapshotChunk(const uint64_t& height, const uint64_t& index) {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2 + 8 + 8);
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestSnapshotChunk));
+    Utils::appendBytes(message, Utils::uint64ToBytes(height));
+    Utils::appendBytes(message, Utils::uint64ToBytes(index));
+    return Message(std::move(message));
+  }
+
   bool RequestDecoder::ping(const Message& message) {
     if (message.size() != 11) { return false; }
     if (message.command() != Ping) { return false; }
@@ -86,11 +134,50 @@ namespace P2P {
   }
 
   bool RequestDecoder::requestValidatorTxs(const Message& message) {
+    if (message.command() == RequestValidatorTxs) return message.size() == 11;
+    if (message.command() != RequestMissingValidatorTxs) { return false; }
+    if (message.size() < 11 || (message.size() - 11) % 32 != 0) { return false; }
+    return true;
+  }
+
+  std::unordered_set<Hash, SafeHash> RequestDecoder::requestValidatorTxsKnown(const Message& message) {
+    std::unordered_set<Hash, SafeHash> known;
+    BytesArrView data = message.message();
+    known.reserve(data.size() / 32);
+    for (size_t index = 0; index + 32 <= data.size(); index += 32) known.emplace(data.subspan(index, 32));
+    return known;
+  }
+
+  std::optional<std::pair<uint64_t, uint64_t>> RequestDecoder::requestBlocks(const Message& message) {
+    if (message.size() != 27) { return std::nullopt; }
+    if (message.command() != RequestBlocks) { return std::nullopt; }
+    return std::make_pair(
+      Utils::bytesToUint64(message.message().subspan(0, 8)), Utils::bytesToUint64(message.message().subspan(8, 8))
+    );
+  }
+
+  std::optional<std::pair<uint64_t, uint64_t>> RequestDecoder::requestHeaders(const Message& message) {
+    if (message.size() != 27) { return std::nullopt; }
+    if (message.command() != RequestHeaders) { return std::nullopt; }
+    return std::make_pair(
+      Utils::bytesToUint64(message.message().subspan(0, 8)), Utils::bytesToUint64(message.message().subspan(8, 8))
+    );
+  }
+
+  bool RequestDecoder::requestSnapshotManifest(const Message& message) {
     if (message.size() != 11) { return false; }
-    if (message.command() != RequestValidatorTxs) { return false; }
+    if (message.command() != RequestSnapshotManifest) { return false; }
     return true;
   }
 
+  std::optional<std::pair<uint64_t, uint64_t>> RequestDecoder::requestSnapshotChunk(const Message& message) {
+    if (message.size() != 27) { return std::nullopt; }
+    if (message.command() != RequestSnapshotChunk) { return std::nullopt; }
+    return std::make_pair(
+      Utils::bytesToUint64(message.message().subspan(0, 8)), Utils::bytesToUint64(message.message().subspan(8, 8))
+    );
+  }
+
   Message AnswerEncoder::ping(const Message& request) {
     Bytes message = getRequestTypePrefix(Answering);
     message.reserve(message.size() + 8 + 2);
@@ -144,8 +231,10 @@ namespace P2P {
   ) {
     Bytes message = getRequestTypePrefix(Answering);
     Utils::appendBytes(message, request.id());
-    Utils::appendBytes(message, getCommandPrefix(RequestValidatorTxs));
+    Utils::appendBytes(message, getCommandPrefix(request.command()));
+    const auto known = RequestDecoder::requestValidatorTxsKnown(request);
     for (const auto& validatorTx : txs) {
+      if (known.contains(validatorTx.first)) continue;
       Bytes rlp = validatorTx.second.rlpSerialize();
       Utils::appendBytes(message, Utils::uint32ToBytes(rlp.size()));
       message.insert(message.end(), rlp.begin(), rlp.end());
@@ -153,6 +242,52 @@ namespace P2P {
     return Message(std::move(message));
   }
 
+  Message AnswerEncoder::requestBlocks(const Message& request,
+    const std::vector<std::shared_ptr<const Block>>& blocks
+  ) {
+    uint64_t size = 11;
+    for (const auto& block : blocks) size += 4 + block->serializedSize();
+    Bytes message = getRequestTypePrefix(Answering);
+    message.reserve(size);
+    Utils::appendBytes(message, request.id());
+    Utils::appendBytes(message, getCommandPrefix(RequestBlocks));
+    for (const auto& block : blocks) {
+      Utils::appendBytes(message, Utils::uint32ToBytes(block->serializedSize()));
+      block->serializeBlock(message);
+    }
+    return Message(std::move(message));
+  }
+
+  Message AnswerEncoder::requestHeaders(const Message& request,
+    const std::vector<std::shared_ptr<const Block>>& blocks
+  ) {
+    // Header = 144 bytes, the block hash is the hash of it (see Block::serializeHeader())
+    Bytes message = getRequestTypePrefix(Answering);
+    message.reserve(message.size() + 8 + 2 + (blocks.size() * 144));
+    Utils::appendBytes(message, request.id());
+    Utils::appendBytes(message, getCommandPrefix(RequestHeaders));
+    for (const auto& block : blocks) Utils::appendBytes(message, block->serializeHeader());
+    return Message(std::move(message));
+  }
+
+  Message AnswerEncoder::requestSnapshotManifest(const Message& request, const Bytes& manifest) {
+    Bytes message = getRequestTypePrefix(Answering);
+    message.reserve(message.size() + 8 + 2 + manifest.size());
+    Utils::appendBytes(message, request.id());
+    Utils::appendBytes(message, getCommandPrefix(RequestSnapshotManifest));
+    Utils::appendBytes(message, manifest);
+    return Message(std::move(message));
+  }
+
+  Message AnswerEncoder::requestSnapshotChunk(const Message& request, const Bytes& chunk) {
+    Bytes message = getRequestTypePrefix(Answering);
+    message.reserve(message.size() + 8 + 2 + chunk.size());
+    Utils::appendBytes(message, request.id());
+    Utils::appendBytes(message, getCommandPrefix(RequestSnapshotChunk));
+    Utils::appendBytes(message, chunk);
+    return Message(std::move(message));
+  }
+
   bool AnswerDecoder::ping(const Message& message) {
     if (message.size() != 11) { return false; }
     if (message.type() != Answering) { return false; }
@@ -210,7 +345,9 @@ namespace P2P {
     const Message& message, const uint64_t& requiredChainId
   ) {
     if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
-    if (message.command() != RequestValidatorTxs) { throw std::runtime_error("Invalid command."); }
+    if (message.command() != RequestValidatorTxs && message.command() != RequestMissingValidatorTxs) {
+      throw std::runtime_error("Invalid command.");
+    }
     std::vector<TxValidator> txs;
     BytesArrView data = message.message();
     size_t index = 0;
@@ -226,34 +363,92 @@ namespace P2P {
     return txs;
   }
 
+  std::vector<BytesArrView> AnswerDecoder::requestBlocks(const Message& message) {
+    if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != RequestBlocks) { throw std::runtime_error("Invalid command."); }
+    std::vector<BytesArrView> blocks;
+    BytesArrView data = message.message();
+    size_t index = 0;
+    while (index < data.size()) {
+      if (data.size() - index < 4) { throw std::runtime_error("Invalid data size."); }
+      uint32_t blockSize = Utils::bytesToUint32(data.subspan(index, 4));
+      index += 4;
+      if (data.size() - index < blockSize) { throw std::runtime_error("Invalid data size."); }
+      blocks.emplace_back(data.subspan(index, blockSize));
+      index += blockSize;
+    }
+    return blocks;
+  }
+
+  std::vector<BlockHeaderInfo> AnswerDecoder::requestHeaders(const Message& message) {
+    if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != RequestHeaders) { throw std::runtime_error("Invalid command."); }
+    BytesArrView data = message.message();
+    if (data.size() % 144 != 0) { throw std::runtime_error("Invalid data size."); }
+    std::vector<BlockHeaderInfo> headers;
+    headers.reserve(data.size() / 144);
+    for (size_t index = 0; index < data.size(); index += 144) {
+      BytesArrView header = data.subspan(index, 144);
+      headers.push_back({
+        Utils::bytesToUint64(header.subspan(136, 8)), Hash(header.subspan(0, 32)), Utils::sha3(header)
+      });
+    }
+    return headers;
+  }
+
+  BytesArrView AnswerDecoder::requestSnapshotManifest(const Message& message) {
+    if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != RequestSnapshotManifest) { throw std::runtime_error("Invalid command."); }
+    return message.message();
+  }
+
+  BytesArrView AnswerDecoder::requestSnapshotChunk(const Message& message) {
+    if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != RequestSnapshotChunk) { throw std::runtime_error("Invalid command."); }
+    return message.message();
+  }
+
   Message BroadcastEncoder::broadcastValidatorTx(const TxValidator& tx) {
-    Bytes message = getRequestTypePrefix(Broadcasting);
+    Bytes message;
+    message.reserve(11 + tx.rlpSize());
+    Utils::appendBytes(message, getRequestTypePrefix(Broadcasting));
+    message.insert(message.end(), 8, 0x00);
+    Utils::appendBytes(message, getCommandPrefix(BroadcastValidatorTx));
+    tx.rlpSerialize(message);
     // We need to use std::hash instead of SafeHash
     // Because hashing with SafeHash will always be different between nodes
-    Utils::appendBytes(message, Utils::uint64ToBytes(FNVHash()(tx.rlpSerialize())));
-    Utils::appendBytes(message, getCommandPrefix(BroadcastValidatorTx));
-    Utils::appendBytes(message, tx.rlpSerialize());
+    BytesArr<8> id = Utils::uint64ToBytes(FNVHash()(BytesArrView(message).subspan(11)));
+    std::memcpy(&message[1], id.data(), 8);
     return Message(std::move(message));
   }
 
   Message BroadcastEncoder::broadcastTx(const TxBlock& tx) {
-    Bytes message = getRequestTypePrefix(Broadcasting);
+    Bytes message;
+    message.reserve(11 + tx.rlpSize());
+    Utils::appendBytes(message, getRequestTypePrefix(Broadcasting));
+    message.insert(message.end(), 8, 0x00);
+    Utils::appendBytes(message, getCommandPrefix(BroadcastTx));
+    tx.rlpSerialize(message);
     // We need to use std::hash instead of SafeHash
     // Because hashing with SafeHash will always be different between nodes
-    Utils::appendBytes(message, Utils::uint64ToBytes(FNVHash()(tx.rlpSerialize())));
-    Utils::appendBytes(message, getCommandPrefix(BroadcastTx));
-    Utils::appendBytes(message, tx.rlpSerialize());
+    BytesArr<8> id = Utils::uint64ToBytes(FNVHash()(BytesArrView(message).subspan(11)));
+    std::memcpy(&message[1], id.data(), 8);
     return Message(std::move(message));
   }
 
-  Message BroadcastEncoder::broadcastBlock(const std::shared_ptr<const Block>& block) {
-    Bytes message = getRequestTypePrefix(Broadcasting);
+  Message BroadcastEncoder::broadcastBlock(const Block& block) {
+    // Serialize the block straight into the message buffer (sized exactly once),
+    // leaving a gap for the id, which is only known after serializing.
+    Bytes message;
+    message.reserve(11 + block.serializedSize());
+    Utils::appendBytes(message, getRequestTypePrefix(Broadcasting));
+    message.insert(message.end(), 8, 0x00);
+    Utils::appendBytes(message, getCommandPrefix(BroadcastBlock));
+    block.serializeBlock(message);
     // We need to use std::hash instead of SafeHash
     // Because hashing with SafeHash will always be different between nodes
-    Bytes serializedBlock = block->serializeBlock();
-    Utils::appendBytes(message, Utils::uint64ToBytes(FNVHash()(serializedBlock)));
-    Utils::appendBytes(message, getCommandPrefix(BroadcastBlock));
-    message.insert(message.end(), serializedBlock.begin(), serializedBlock.end());
+    BytesArr<8> id = Utils::uint64ToBytes(FNVHash()(BytesArrView(message).subspan(11)));
+    std::memcpy(&message[1], id.data(), 8);
     return Message(std::move(message));
   }
 
@@ -271,6 +466,13 @@ namespace P2P {
     return TxBlock(message.message(), requiredChainId);
   }
 
+  Bytes BroadcastDecoder::broadcastRawTx(const P2P::Message &message) {
+    if (message.type() != Broadcasting) { throw std::runtime_error("Invalid message type."); }
+    if (message.id().toUint64() != FNVHash()(message.message())) { throw std::runtime_error("Invalid message id."); }
+    if (message.command() != BroadcastTx) { throw std::runtime_error("Invalid command."); }
+    return Bytes(message.message().begin(), message.message().end());
+  }
+
   Block BroadcastDecoder::broadcastBlock(const P2P::Message &message, const uint64_t &requiredChainId) {
     if (message.type() != Broadcasting) { throw std::runtime_error("Invalid message type."); }
     if (message.id().toUint64() != FNVHash()(message.message())) { throw std::runtime_error("Invalid message id. "); }
@@ -2,6 +2,8 @@
 #define P2P_ENCODING_H
 
 #include <future>
+#include <optional>
+#include <unordered_set>
 
 #include "../../utils/utils.h"
 #include "../../utils/safehash.h"
@@ -38,7 +40,12 @@ namespace P2P {
     RequestValidatorTxs,
     BroadcastValidatorTx,
     BroadcastTx,
-    BroadcastBlock
+    BroadcastBlock,
+    RequestBlocks,
+    RequestHeaders,
+    RequestSnapshotManifest,
+    RequestSnapshotChunk,
+    RequestMissingValidatorTxs
   };
 
   /**
@@ -64,6 +71,11 @@ namespace P2P {
    * - "0004" = BroadcastValidatorTx
    * - "0005" = BroadcastTx
    * - "0006" = BroadcastBlock
+   * - "0007" = RequestBlocks
+   * - "0008" = RequestHeaders
+   * - "0009" = RequestSnapshotManifest
+   * - "000A" = RequestSnapshotChunk
+   * - "000B" = RequestMissingValidatorTxs
    */
   inline extern const std::vector<Bytes> commandPrefixes {
     Bytes{0x00, 0x00}, // Ping
@@ -72,7 +84,12 @@ namespace P2P {
     Bytes{0x00, 0x03}, // RequestValidatorTxs
     Bytes{0x00, 0x04}, // BroadcastValidatorTx
     Bytes{0x00, 0x05}, // BroadcastTx
-    Bytes{0x00, 0x06}  // BroadcastBlock
+    Bytes{0x00, 0x06}, // BroadcastBlock
+    Bytes{0x00, 0x07}, // RequestBlocks
+    Bytes{0x00, 0x08}, // RequestHeaders
+    Bytes{0x00, 0x09}, // RequestSnapshotManifest
+    Bytes{0x00, 0x0A}, // RequestSnapshotChunk
+    Bytes{0x00, 0x0B}  // RequestMissingValidatorTxs
   };
 
   /**
@@ -161,6 +178,18 @@ i       * Constructor.
     }
   };
 
+  /// Struct with the linking information of a block header, as sent in `RequestHeaders` answers.
+  struct BlockHeaderInfo {
+    /// Height of the block.
+    uint64_t height = 0;
+
+    /// %Hash of the previous block.
+    Hash prevHash = Hash();
+
+    /// %Hash of the block.
+    Hash hash = Hash();
+  };
+
   /// Helper class used to create requests.
   class RequestEncoder {
     public:
@@ -192,6 +221,46 @@ i       * Constructor.
        * @return The formatted request.
        */
       static Message requestValidatorTxs();
+
+      /**
+       * Create a `RequestMissingValidatorTxs` request.
+       * It's a separate command so nodes that only know `RequestValidatorTxs`
+       * (which must be empty) never see a payload they'd reject.
+       * @param known Hashes of the Validator transactions the requester already has,
+       *              the answer will only carry the ones missing.
+       * @return The formatted request.
+       */
+      static Message requestMissingValidatorTxs(const std::vector<Hash>& known);
+
+      /**
+       * Create a `RequestBlocks` request.
+       * @param start Height of the first block requested.
+       * @param count Number of consecutive blocks requested.
+       * @return The formatted request.
+       */
+      static Message requestBlocks(const uint64_t& start, const uint64_t& count);
+
+      /**
+       * Create a `RequestHeaders` request.
+       * @param start Height of the first header requested.
+       * @param count Number of consecutive headers requested.
+       * @return The formatted request.
+       */
+      static Message requestHeaders(const uint64_t& start, const uint64_t& count);
+
+      /**
+       * Create a `RequestSnapshotManifest` request.
+       * @return The formatted request.
+       */
+      static Message requestSnapshotManifest();
+
+      /**
+       * Create a `RequestSnapshotChunk` request.
+       * @param height Height of the snapshot the chunk belongs to.
+       * @param index Index of the chunk within the snapshot.
+       * @return The formatted request.
+       */
+      static Message requestSnapshotChunk(const uint64_t& height, const uint64_t& index);
   };
 
   /// Helper class used to parse requests.
@@ -220,11 +289,46 @@ i       * Constructor.
       static bool requestNodes(const Message& message);
 
       /**
-       * Parse a `RequestValidatorTxs` message.
+       * Parse a `RequestValidatorTxs` or `RequestMissingValidatorTxs` message.
        * @param message The message to parse.
        * @return `true` if the message is valid, `false` otherwise.
        */
       static bool requestValidatorTxs(const Message& message);
+
+      /**
+       * Get the hashes of the Validator transactions a requester already has.
+       * @param message The request to parse. Must be valid (see requestValidatorTxs()).
+       * @return The known hashes (always empty for a `RequestValidatorTxs` request).
+       */
+      static std::unordered_set<Hash, SafeHash> requestValidatorTxsKnown(const Message& message);
+
+      /**
+       * Parse a `RequestBlocks` message.
+       * @param message The message to parse.
+       * @return The requested range (first height and count), or an empty optional if the message is invalid.
+       */
+      static std::optional<std::pair<uint64_t, uint64_t>> requestBlocks(const Message& message);
+
+      /**
+       * Parse a `RequestHeaders` message.
+       * @param message The message to parse.
+       * @return The requested range (first height and count), or an empty optional if the message is invalid.
+       */
+      static std::optional<std::pair<uint64_t, uint64_t>> requestHeaders(const Message& message);
+
+      /**
+       * Parse a `RequestSnapshotManifest` message.
+       * @param message The message to parse.
+       * @return `true` if the message is valid, `false` otherwise.
+       */
+      static bool requestSnapshotManifest(const Message& message);
+
+      /**
+       * Parse a `RequestSnapshotChunk` message.
+       * @param message The message to parse.
+       * @return The snapshot height and chunk index, or an empty optional if the message is invalid.
+       */
+      static std::optional<std::pair<uint64_t, uint64_t>> requestSnapshotChunk(const Message& message);
   };
 
   /// Helper class used to create answers to requests.
@@ -260,7 +364,9 @@ i       * Constructor.
       );
 
       /**
-       * Create a `RequestValidatorTxs` answer.
+       * Create a `RequestValidatorTxs` or `RequestMissingValidatorTxs` answer,
+       * with the same command as the request.
+       * Transactions the requester already has are left out.
        * @param request The request message.
        * @param txs The list of transactions to use as reference.
        * @return The formatted answer.
@@ -268,6 +374,42 @@ i       * Constructor.
       static Message requestValidatorTxs(const Message& request,
         const std::unordered_map<Hash, TxValidator, SafeHash>& txs
       );
+
+      /**
+       * Create a `RequestBlocks` answer.
+       * @param request The request message.
+       * @param blocks The requested blocks, in ascending height. May be fewer than requested.
+       * @return The formatted answer.
+       */
+      static Message requestBlocks(const Message& request,
+        const std::vector<std::shared_ptr<const Block>>& blocks
+      );
+
+      /**
+       * Create a `RequestHeaders` answer.
+       * @param request The request message.
+       * @param blocks The blocks whose headers were requested, in ascending height. May be fewer than requested.
+       * @return The formatted answer.
+       */
+      static Message requestHeaders(const Message& request,
+        const std::vector<std::shared_ptr<const Block>>& blocks
+      );
+
+      /**
+       * Create a `RequestSnapshotManifest` answer.
+       * @param request The request message.
+       * @param manifest The serialized manifest of our latest snapshot, empty if we have none.
+       * @return The formatted answer.
+       */
+      static Message requestSnapshotManifest(const Message& request, const Bytes& manifest);
+
+      /**
+       * Create a `RequestSnapshotChunk` answer.
+       * @param request The request message.
+       * @param chunk The requested chunk, empty if we don't have it.
+       * @return The formatted answer.
+       */
+      static Message requestSnapshotChunk(const Message& request, const Bytes& chunk);
   };
 
   /// Helper class used to parse answers to requests.
@@ -305,6 +447,36 @@ i       * Constructor.
       static std::vector<TxValidator> requestValidatorTxs(
         const Message& message, const uint64_t& requiredChainId
       );
+
+      /**
+       * Parse a `RequestBlocks` answer, without decoding the blocks.
+       * Decoding checks every signature, so it's left to the caller
+       * (e.g. to do it off the network thread).
+       * @param message The answer to parse.
+       * @return The raw serialized blocks (views into `message`).
+       */
+      static std::vector<BytesArrView> requestBlocks(const Message& message);
+
+      /**
+       * Parse a `RequestHeaders` answer.
+       * @param message The answer to parse.
+       * @return The headers, in the order they were sent.
+       */
+      static std::vector<BlockHeaderInfo> requestHeaders(const Message& message);
+
+      /**
+       * Parse a `RequestSnapshotManifest` answer.
+       * @param message The answer to parse.
+       * @return The serialized manifest (a view into `message`), empty if the peer has no snapshot.
+       */
+      static BytesArrView requestSnapshotManifest(const Message& message);
+
+      /**
+       * Parse a `RequestSnapshotChunk` answer.
+       * @param message The answer to parse.
+       * @return The chunk (a view into `message`), empty if the peer doesn't have it.
+       */
+      static BytesArrView requestSnapshotChunk(const Message& message);
   };
 
   /// Helper class used to create broadcast messages.
@@ -329,7 +501,7 @@ i       * Constructor.
        * @param block The block to broadcast.
        * @return The formatted message.
        */
-      static Message broadcastBlock(const std::shared_ptr<const Block>& block);
+      static Message broadcastBlock(const Block& block);
   };
 
   /// Helper class used to parse broadcast messages.
@@ -351,6 +523,13 @@ i       * Constructor.
        */
       static TxBlock broadcastTx(const Message& message, const uint64_t& requiredChainId);
 
+      /**
+       * Parse a broadcasted message for a block transaction, without decoding the transaction.
+       * @param message The message that was broadcast.
+       * @return The raw signed transaction.
+       */
+      static Bytes broadcastRawTx(const Message& message);
+
       /**
        * Parse a broadcasted message for a whole block.
        * @param message The message that was broadcast.
@@ -63,7 +63,12 @@ namespace P2P {
     auto session = sessions_[nodeId];
     // We can only request ping, info and requestNode to discovery nodes
     if (session->hostType() == NodeType::DISCOVERY_NODE && (message->command() == CommandType::Info ||
-                                                            message->command() == CommandType::RequestValidatorTxs)) {
+                                                            message->command() == CommandType::RequestValidatorTxs ||
+                                                            message->command() == CommandType::RequestMissingValidatorTxs ||
+                                                            message->command() == CommandType::RequestBlocks ||
+                                                            message->command() == CommandType::RequestHeaders ||
+                                                            message->command() == CommandType::RequestSnapshotManifest ||
+                                                            message->command() == CommandType::RequestSnapshotChunk)) {
       lockSession.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
       Logger::logToDebug(LogType::INFO, Log::P2PManager, __func__, "Session is discovery, cannot send message");
       return nullptr;
@@ -74,6 +79,17 @@ namespace P2P {
     return requests_[message->id()];
   }
 
+  void ManagerBase::releaseRequest(const RequestID& id) {
+    std::unique_lock lock(this->requestsMutex_);
+    if (this->requests_.erase(id) == 0) return;
+    this->releasedRequests_.emplace_back(id);
+    if (this->releasedRequests_.size() > maxReleasedRequests) this->releasedRequests_.pop_front();
+  }
+
+  bool ManagerBase::isReleasedRequest(const RequestID& id) const {
+    return std::find(this->releasedRequests_.cbegin(), this->releasedRequests_.cend(), id) != this->releasedRequests_.cend();
+  }
+
   void ManagerBase::answerSession(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message) {
     if (this->closed_) return;
     std::shared_lock<std::shared_mutex> lockSession(this->sessionsMutex_); // ManagerBase::answerSession doesn't change sessions_ map.
@@ -1,12 +1,15 @@
 #ifndef P2P_MANAGER_BASE
 #define P2P_MANAGER_BASE
 
+#include <deque>
+
 #include "session.h"
 #include "encoding.h"
 #include "server.h"
 #include "client.h"
 #include "discovery.h"
 #include "../../utils/options.h"
+#include "../../utils/flathashmap.h"
 #include "../../libs/BS_thread_pool_light.hpp"
 
 namespace P2P {
@@ -44,12 +47,18 @@ namespace P2P {
       mutable std::shared_mutex requestsMutex_;
 
       /// List of currently active sessions.
-      std::unordered_map<NodeID, std::shared_ptr<Session>, SafeHash> sessions_;
+      FlatHashMap<NodeID, std::shared_ptr<Session>> sessions_;
 
       // TODO: Somehow find a way to clean up requests_ after a certain time/being used.
       /// List of currently active requests.
       std::unordered_map<RequestID, std::shared_ptr<Request>, SafeHash> requests_;
 
+      /// Maximum number of released requests to remember. See releaseRequest().
+      static constexpr size_t maxReleasedRequests = 1024;
+
+      /// IDs of the latest released requests, oldest first, so late answers to them aren't mistaken for bogus ones.
+      std::deque<RequestID> releasedRequests_;
+
       /// Server Object
       const std::unique_ptr<Server> server_;
 
@@ -76,6 +85,21 @@ namespace P2P {
        */
       std::shared_ptr<Request> sendRequestTo(const NodeID &nodeId, const std::shared_ptr<const Message>& message);
 
+      /**
+       * Remove a request from the list once its answer was taken or waiting for it timed out,
+       * so the answer is freed along with the caller's request and future.
+       * Meant for requests with big answers, e.g. blocks.
+       * @param id The ID of the request.
+       */
+      void releaseRequest(const RequestID& id);
+
+      /**
+       * Check if a request was released (see releaseRequest()). `requestsMutex_` must be locked by the caller.
+       * @param id The ID of the request.
+       * @return `true` if the request is among the latest released ones, `false` otherwise.
+       */
+      bool isReleasedRequest(const RequestID& id) const;
+
       /**
        * Answer a message to a given session.
        * @param session The session to answer to.
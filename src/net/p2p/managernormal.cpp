@@ -73,8 +73,21 @@ namespace P2P{
         handleRequestNodesRequest(session, message);
         break;
       case RequestValidatorTxs:
+      case RequestMissingValidatorTxs:
         handleTxValidatorRequest(session, message);
         break;
+      case RequestBlocks:
+        handleRequestBlocksRequest(session, message);
+        break;
+      case RequestHeaders:
+        handleRequestHeadersRequest(session, message);
+        break;
+      case RequestSnapshotManifest:
+        handleSnapshotManifestRequest(session, message);
+        break;
+      case RequestSnapshotChunk:
+        handleSnapshotChunkRequest(session, message);
+        break;
       default:
         if (auto sessionPtr = session.lock()) {
           Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -107,8 +120,15 @@ namespace P2P{
         handleRequestNodesAnswer(session, message);
         break;
       case RequestValidatorTxs:
+      case RequestMissingValidatorTxs:
         handleTxValidatorAnswer(session, message);
         break;
+      case RequestBlocks:
+      case RequestHeaders:
+      case RequestSnapshotManifest:
+      case RequestSnapshotChunk:
+        handleRangeAnswer(session, message);
+        break;
       default:
         if (auto sessionPtr = session.lock()) {
           Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -250,7 +270,122 @@ namespace P2P{
       }
       return;
     }
-    this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestValidatorTxs(*message, this->rdpos_->getMempool())));
+    this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestValidatorTxs(*message, *this->rdpos_->getMempool())));
+  }
+
+  void ManagerNormal::handleRequestBlocksRequest(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    auto range = RequestDecoder::requestBlocks(*message);
+    if (!range) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestBlocks request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestBlocks request from unknown session, closing session."
+        );
+      }
+      return;
+    }
+    // Stop at our latest block, or once the answer is big enough
+    const auto& [start, count] = *range;
+    const uint64_t latest = this->storage_->latest()->getNHeight();
+    const uint64_t available = (start <= latest) ? std::min({count, maxBlocksPerRequest, latest - start + 1}) : 0;
+    std::vector<std::shared_ptr<const Block>> blocks;
+    uint64_t answerSize = 0;
+    for (uint64_t i = 0; i < available; i++) {
+      auto block = this->storage_->getBlock(start + i);
+      if (block == nullptr) break;
+      answerSize += block->serializedSize();
+      if (!blocks.empty() && answerSize > maxBlocksAnswerSize) break;
+      blocks.emplace_back(std::move(block));
+    }
+    this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestBlocks(*message, blocks)));
+  }
+
+  void ManagerNormal::handleRequestHeadersRequest(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    auto range = RequestDecoder::requestHeaders(*message);
+    if (!range) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestHeaders request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestHeaders request from unknown session, closing session."
+        );
+      }
+      return;
+    }
+    const auto& [start, count] = *range;
+    const uint64_t latest = this->storage_->latest()->getNHeight();
+    const uint64_t available = (start <= latest) ? std::min({count, maxHeadersPerRequest, latest - start + 1}) : 0;
+    std::vector<std::shared_ptr<const Block>> blocks;
+    blocks.reserve(available);
+    for (uint64_t i = 0; i < available; i++) {
+      auto block = this->storage_->getBlock(start + i);
+      if (block == nullptr) break;
+      blocks.emplace_back(std::move(block));
+    }
+    this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestHeaders(*message, blocks)));
+  }
+
+  void ManagerNormal::handleSnapshotManifestRequest(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    if (!RequestDecoder::requestSnapshotManifest(*message)) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestSnapshotManifest request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestSnapshotManifest request from unknown session, closing session."
+        );
+      }
+      return;
+    }
+    auto snapshot = this->state_->getSnapshot();
+    this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestSnapshotManifest(
+      *message, (snapshot != nullptr) ? snapshot->getManifest().serialize() : Bytes()
+    )));
+  }
+
+  void ManagerNormal::handleSnapshotChunkRequest(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    auto chunkId = RequestDecoder::requestSnapshotChunk(*message);
+    if (!chunkId) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestSnapshotChunk request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestSnapshotChunk request from unknown session, closing session."
+        );
+      }
+      return;
+    }
+    // An older snapshot may have been replaced meanwhile, the requester then gets nothing and moves on
+    const auto& [height, index] = *chunkId;
+    auto snapshot = this->state_->getSnapshot(height);
+    const Bytes* chunk = (snapshot != nullptr) ? snapshot->getChunk(index) : nullptr;
+    this->answerSession(session, std::make_shared<const Message>(
+      AnswerEncoder::requestSnapshotChunk(*message, (chunk != nullptr) ? *chunk : Bytes())
+    ));
   }
 
   void ManagerNormal::handlePingAnswer(
@@ -366,8 +501,16 @@ namespace P2P{
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
     try {
-      auto tx = BroadcastDecoder::broadcastTx(*message, this->options_->getChainID());
-      if (!this->state_->addTx(std::move(tx))) this->broadcastMessage(message);
+      // Decoded, admitted and gossiped further by the state's admission pipeline
+      this->state_->submitPeerTx(BroadcastDecoder::broadcastRawTx(*message), [this, session](const std::string& error) {
+        if (auto sessionPtr = session.lock()) {
+          Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+            "Invalid txBroadcast from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+            std::to_string(sessionPtr->hostNodeId().second) + " , error: " + error + " closing session."
+          );
+          this->disconnectSession(sessionPtr->hostNodeId());
+        }
+      });
     } catch (std::exception &e) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -386,22 +529,25 @@ namespace P2P{
   void ManagerNormal::handleBlockBroadcast(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
-    // We require a lock here because validateNextBlock **throws** if the block is invalid.
+    // We require a lock here because processNextBlock **throws** if the block is invalid.
     // The reason for locking because for that a processNextBlock race condition can occur,
     // making the same block be accepted, and then rejected, disconnecting the node.
     bool rebroadcast = false;
+    uint64_t height = 0;
     try {
       auto block = BroadcastDecoder::broadcastBlock(*message, this->options_->getChainID());
+      height = block.getNHeight();
       std::unique_lock lock(this->blockBroadcastMutex);
       if (this->storage_->blockExists(block.hash())) {
         // If the block is latest()->getNHeight() - 1, we should still rebroadcast it
         if (this->storage_->latest()->getNHeight() - 1 == block.getNHeight()) rebroadcast = true;
         return;
       }
-      if (this->state_->validateNextBlock(block)) {
-        this->state_->processNextBlock(std::move(block));
-        rebroadcast = true;
-      }
+      this->rdpos_->getTrace().record(height, ConsensusEvent::BlockReceived,
+        Secp256k1::toAddress(block.getValidatorPubKey())
+      );
+      // Validated and processed in a single pass, invalid blocks are simply not rebroadcast
+      if (this->state_->tryProcessNextBlock(std::move(block))) rebroadcast = true;
     } catch (std::exception &e) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -416,13 +562,52 @@ namespace P2P{
       }
       return;
     }
-    if (rebroadcast) this->broadcastMessage(message);
+    if (rebroadcast) {
+      this->broadcastMessage(message);
+      this->rdpos_->getTrace().record(height, ConsensusEvent::BlockRelayed);
+    }
+  }
+
+  void ManagerNormal::handleRangeAnswer(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    std::unique_lock lock(this->requestsMutex_);
+    if (!requests_.contains(message->id())) {
+      // Range and snapshot requests are released as soon as they're answered or time out, so late answers are expected
+      if (this->isReleasedRequest(message->id())) {
+        lock.unlock();
+        Logger::logToDebug(LogType::DEBUG, Log::P2PParser, __func__, "Late answer to a released request, ignoring");
+        return;
+      }
+      lock.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Answer to invalid request from unknown session, closing session."
+        );
+      }
+      return;
+    }
+    requests_[message->id()]->setAnswer(message);
   }
 
   // TODO: Both ping and requestNodes is a blocking call on .wait()
   // Somehow change to wait_for.
   std::vector<TxValidator> ManagerNormal::requestValidatorTxs(const NodeID& nodeId) {
-    auto request = std::make_shared<const Message>(RequestEncoder::requestValidatorTxs());
+    // Tell the node what we already have, so it only answers with what we're missing.
+    // With nothing to tell, the plain request every node understands is enough.
+    const auto mempool = this->rdpos_->getMempool();
+    std::vector<Hash> known;
+    known.reserve(mempool->size());
+    for (const auto& [hash, tx] : *mempool) known.emplace_back(hash);
+    auto request = std::make_shared<const Message>(known.empty()
+      ? RequestEncoder::requestValidatorTxs() : RequestEncoder::requestMissingValidatorTxs(known)
+    );
     Utils::logToFile("Requesting nodes from " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second));
     auto requestPtr = this->sendRequestTo(nodeId, request);
     if (requestPtr == nullptr) {
@@ -479,9 +664,140 @@ namespace P2P{
     }
   }
 
+  std::vector<Bytes> ManagerNormal::requestBlocks(
+    const NodeID& nodeId, const uint64_t& start, const uint64_t& count, const std::chrono::milliseconds& timeout
+  ) {
+    auto request = std::make_shared<const Message>(RequestEncoder::requestBlocks(start, count));
+    auto requestPtr = this->sendRequestTo(nodeId, request);
+    if (requestPtr == nullptr) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed."
+      );
+      return {};
+    }
+    auto answer = requestPtr->answerFuture();
+    auto status = answer.wait_for(timeout);
+    this->releaseRequest(request->id());
+    if (status == std::future_status::timeout) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " timed out."
+      );
+      return {};
+    }
+    try {
+      auto answerPtr = answer.get();
+      std::vector<Bytes> blocks;
+      for (const BytesArrView& block : AnswerDecoder::requestBlocks(*answerPtr)) {
+        blocks.emplace_back(block.begin(), block.end());
+      }
+      return blocks;
+    } catch (std::exception &e) {
+      Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+      );
+      return {};
+    }
+  }
+
+  std::vector<BlockHeaderInfo> ManagerNormal::requestHeaders(
+    const NodeID& nodeId, const uint64_t& start, const uint64_t& count
+  ) {
+    auto request = std::make_shared<const Message>(RequestEncoder::requestHeaders(start, count));
+    auto requestPtr = this->sendRequestTo(nodeId, request);
+    if (requestPtr == nullptr) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed."
+      );
+      return {};
+    }
+    auto answer = requestPtr->answerFuture();
+    auto status = answer.wait_for(std::chrono::seconds(2)); // 2000ms timeout.
+    this->releaseRequest(request->id());
+    if (status == std::future_status::timeout) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " timed out."
+      );
+      return {};
+    }
+    try {
+      auto answerPtr = answer.get();
+      return AnswerDecoder::requestHeaders(*answerPtr);
+    } catch (std::exception &e) {
+      Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+      );
+      return {};
+    }
+  }
+
+  Bytes ManagerNormal::requestSnapshotManifest(const NodeID& nodeId) {
+    auto request = std::make_shared<const Message>(RequestEncoder::requestSnapshotManifest());
+    auto requestPtr = this->sendRequestTo(nodeId, request);
+    if (requestPtr == nullptr) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed."
+      );
+      return {};
+    }
+    auto answer = requestPtr->answerFuture();
+    auto status = answer.wait_for(std::chrono::seconds(2)); // 2000ms timeout.
+    this->releaseRequest(request->id());
+    if (status == std::future_status::timeout) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " timed out."
+      );
+      return {};
+    }
+    try {
+      auto answerPtr = answer.get();
+      BytesArrView manifest = AnswerDecoder::requestSnapshotManifest(*answerPtr);
+      return Bytes(manifest.begin(), manifest.end());
+    } catch (std::exception &e) {
+      Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+      );
+      return {};
+    }
+  }
+
+  Bytes ManagerNormal::requestSnapshotChunk(
+    const NodeID& nodeId, const uint64_t& height, const uint64_t& index, const std::chrono::milliseconds& timeout
+  ) {
+    auto request = std::make_shared<const Message>(RequestEncoder::requestSnapshotChunk(height, index));
+    auto requestPtr = this->sendRequestTo(nodeId, request);
+    if (requestPtr == nullptr) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed."
+      );
+      return {};
+    }
+    auto answer = requestPtr->answerFuture();
+    auto status = answer.wait_for(timeout);
+    this->releaseRequest(request->id());
+    if (status == std::future_status::timeout) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " timed out."
+      );
+      return {};
+    }
+    try {
+      auto answerPtr = answer.get();
+      BytesArrView chunk = AnswerDecoder::requestSnapshotChunk(*answerPtr);
+      return Bytes(chunk.begin(), chunk.end());
+    } catch (std::exception &e) {
+      Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+      );
+      return {};
+    }
+  }
+
   void ManagerNormal::broadcastTxValidator(const TxValidator& tx) {
     auto broadcast = std::make_shared<const Message>(BroadcastEncoder::broadcastValidatorTx(tx));
     this->broadcastMessage(broadcast);
+    this->rdpos_->getTrace().record(tx.getNHeight(), (rdPoS::getTxValidatorFunction(tx) == rdPoS::TxValidatorFunction::RANDOMHASH)
+      ? ConsensusEvent::RandomHashSent : ConsensusEvent::SeedSent, tx.getFrom()
+    );
     return;
   }
 
@@ -491,9 +807,10 @@ namespace P2P{
     return;
   }
 
-  void ManagerNormal::broadcastBlock(const std::shared_ptr<const Block> block) {
+  void ManagerNormal::broadcastBlock(const Block& block) {
     auto broadcast = std::make_shared<const Message>(BroadcastEncoder::broadcastBlock(block));
     this->broadcastMessage(broadcast);
+    this->rdpos_->getTrace().record(block.getNHeight(), ConsensusEvent::BlockBroadcast);
     return;
   }
 };
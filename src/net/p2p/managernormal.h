@@ -89,6 +89,34 @@ namespace P2P {
        */
       void handleTxValidatorRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
 
+      /**
+       * Handle a `RequestBlocks` request.
+       * @param session The session that sent the request.
+       * @param message The request message to handle.
+       */
+      void handleRequestBlocksRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
+      /**
+       * Handle a `RequestHeaders` request.
+       * @param session The session that sent the request.
+       * @param message The request message to handle.
+       */
+      void handleRequestHeadersRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
+      /**
+       * Handle a `RequestSnapshotManifest` request.
+       * @param session The session that sent the request.
+       * @param message The request message to handle.
+       */
+      void handleSnapshotManifestRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
+      /**
+       * Handle a `RequestSnapshotChunk` request.
+       * @param session The session that sent the request.
+       * @param message The request message to handle.
+       */
+      void handleSnapshotChunkRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
       /**
        * Handle a `Ping` answer.
        * @param session The session that sent the answer.
@@ -117,6 +145,14 @@ namespace P2P {
        */
       void handleTxValidatorAnswer(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
 
+      /**
+       * Handle a `RequestBlocks`, `RequestHeaders`, `RequestSnapshotManifest` or `RequestSnapshotChunk` answer.
+       * They're only parsed by whoever made the request.
+       * @param session The session that sent the answer.
+       * @param message The answer message to handle.
+       */
+      void handleRangeAnswer(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
       /**
        * Handle a Validator transaction broadcast message.
        * @param session The node that sent the broadcast.
@@ -139,6 +175,15 @@ namespace P2P {
       void handleBlockBroadcast(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
 
     public:
+      /// Maximum number of blocks sent in a single `RequestBlocks` answer.
+      static constexpr uint64_t maxBlocksPerRequest = 256;
+
+      /// Maximum size of a `RequestBlocks` answer, in bytes. At least one block is always sent.
+      static constexpr uint64_t maxBlocksAnswerSize = 1024 * 1024 * 64;
+
+      /// Maximum number of headers sent in a single `RequestHeaders` answer.
+      static constexpr uint64_t maxHeadersPerRequest = 4096;
+
       /**
        * Constructor.
        * @param hostIp The manager's host IP/address.
@@ -167,8 +212,9 @@ namespace P2P {
 
       /**
        * Request Validator transactions from a given node.
+       * Only the ones missing from our own mempool are sent back.
        * @param nodeId The ID of the node to request.
-       * @return A list of the node's Validator transactions.
+       * @return A list of the node's Validator transactions we don't have.
        */
       std::vector<TxValidator> requestValidatorTxs(const NodeID& nodeId);
 
@@ -179,6 +225,52 @@ namespace P2P {
        */
       NodeInfo requestNodeInfo(const NodeID& nodeId);
 
+      /**
+       * Request a range of blocks from a given node.
+       * The node may answer with fewer blocks than requested (see `maxBlocksPerRequest`
+       * and `maxBlocksAnswerSize`), or none if it doesn't have the first one.
+       * @param nodeId The ID of the node to request.
+       * @param start Height of the first block.
+       * @param count Number of consecutive blocks.
+       * @param timeout How long to wait for the answer.
+       * @return The raw serialized blocks, in ascending height. Empty if the request failed.
+       */
+      std::vector<Bytes> requestBlocks(
+        const NodeID& nodeId, const uint64_t& start, const uint64_t& count,
+        const std::chrono::milliseconds& timeout = std::chrono::seconds(10)
+      );
+
+      /**
+       * Request a range of block headers from a given node.
+       * The node may answer with fewer headers than requested (see `maxHeadersPerRequest`).
+       * @param nodeId The ID of the node to request.
+       * @param start Height of the first header.
+       * @param count Number of consecutive headers.
+       * @return The headers, in ascending height. Empty if the request failed.
+       */
+      std::vector<BlockHeaderInfo> requestHeaders(const NodeID& nodeId, const uint64_t& start, const uint64_t& count);
+
+      /**
+       * Request the manifest of the latest state snapshot of a given node.
+       * @param nodeId The ID of the node to request.
+       * @return The serialized manifest (see StateSnapshot::Manifest). Empty if
+       *         the node has no snapshot or the request failed.
+       */
+      Bytes requestSnapshotManifest(const NodeID& nodeId);
+
+      /**
+       * Request a chunk of a state snapshot from a given node.
+       * @param nodeId The ID of the node to request.
+       * @param height Height of the snapshot.
+       * @param index Index of the chunk.
+       * @param timeout How long to wait for the answer.
+       * @return The chunk. Empty if the node doesn't have it or the request failed.
+       */
+      Bytes requestSnapshotChunk(
+        const NodeID& nodeId, const uint64_t& height, const uint64_t& index,
+        const std::chrono::milliseconds& timeout = std::chrono::seconds(10)
+      );
+
       /**
        * Broadcast a Validator transaction to all connected nodes.
        * @param tx The transaction to broadcast.
@@ -195,7 +287,13 @@ namespace P2P {
        * Broadcast a block to all connected nodes.
        * @param block The block to broadcast.
        */
-      void broadcastBlock(const std::shared_ptr<const Block> block);
+      void broadcastBlock(const std::shared_ptr<const Block> block) { this->broadcastBlock(*block); }
+
+      /**
+       * Broadcast a block to all connected nodes.
+       * @param block The block to broadcast.
+       */
+      void broadcastBlock(const Block& block);
   };
 };
 
@@ -134,25 +134,16 @@ namespace P2P {
       return;
     }
     this->outboundHeader_ = Utils::uint64ToBytes(this->outboundMessage_->_rawMessage.size());
-
-    net::async_write(this->socket_, net::buffer(this->outboundHeader_),
-      net::bind_executor(this->writeStrand_,
-                                 std::bind(&Session::on_write_header, shared_from_this(), std::placeholders::_1, std::placeholders::_2))
-    );
-  }
-
-  void Session::on_write_header(boost::system::error_code ec, std::size_t) {
-    if (ec) {
-      if (this->handle_error(__func__, ec)) {
-        return;
-      }
-    }
-
     this->do_write_message();
   }
 
   void Session::do_write_message() {
-    net::async_write(this->socket_, net::buffer(this->outboundMessage_->_rawMessage, this->outboundMessage_->_rawMessage.size()),
+    // Header and message go out together without being copied into one buffer
+    std::array<net::const_buffer, 2> buffers = {
+      net::buffer(this->outboundHeader_),
+      net::buffer(this->outboundMessage_->_rawMessage, this->outboundMessage_->_rawMessage.size())
+    };
+    net::async_write(this->socket_, buffers,
                              net::bind_executor(this->writeStrand_,
                              std::bind(&Session::on_write_message, shared_from_this(), std::placeholders::_1, std::placeholders::_2))
     );
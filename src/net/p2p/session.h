@@ -109,13 +109,10 @@ namespace P2P {
       /// Callback for reading the message.
       void on_read_message(boost::system::error_code ec, std::size_t);
 
-      /// Write a message to the socket.
+      /// Prepare the header for the outbound message and write both to the socket.
       void do_write_header();
 
-      /// Callback for writing the header.
-      void on_write_header(boost::system::error_code ec, std::size_t);
-
-      /// Write a message to the socket.
+      /// Write the header and the message to the socket in a single gather write.
       void do_write_message();
 
       /// Callback for writing the message.
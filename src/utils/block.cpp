@@ -134,6 +134,20 @@ Block::Block(const BytesArrView bytes, const uint64_t& requiredChainId) {
   }
 }
 
+Block::Block(
+  const Hash& prevBlockHash, const uint64_t& timestamp, const uint64_t& nHeight,
+  std::vector<TxValidator>&& txValidators, std::vector<TxBlock>&& txs,
+  const Hash& validatorMerkleRoot, const Hash& txMerkleRoot, const PrivKey& validatorPrivKey
+) : prevBlockHash(prevBlockHash), validatorMerkleRoot(validatorMerkleRoot), txMerkleRoot(txMerkleRoot),
+  timestamp(timestamp), nHeight(nHeight), txValidators(std::move(txValidators)), txs(std::move(txs))
+{
+  this->blockRandomness = rdPoS::parseTxSeedList(this->txValidators);
+  Hash msgHash = this->hash();
+  this->validatorSig = Secp256k1::sign(msgHash, validatorPrivKey);
+  this->validatorPubKey = Secp256k1::recover(this->validatorSig, msgHash);
+  this->finalized = true;
+}
+
 const Bytes Block::serializeHeader() const {
   // Block header = 144 bytes = {
   //  bytes(prevBlockHash) + bytes(blockRandomness) +
@@ -151,10 +165,18 @@ const Bytes Block::serializeHeader() const {
   return ret;
 }
 
-const Bytes Block::serializeBlock() const {
+Bytes Block::serializeBlock() const {
   Bytes ret;
+  ret.reserve(this->serializedSize());
+  this->serializeBlock(ret);
+  return ret;
+}
+
+void Block::serializeBlock(Bytes& ret) const {
   // Block = bytes(validatorSig) + bytes(BlockHeader) +
   // TxValidatorStart + [TXs] + [TxValidators]
+  // Offsets are relative to the start of the block, not of the buffer
+  const uint64_t blockStart = ret.size();
   ret.insert(ret.end(), this->validatorSig.cbegin(), this->validatorSig.cend());
   Utils::appendBytes(ret, this->serializeHeader());
 
@@ -162,25 +184,36 @@ const Bytes Block::serializeBlock() const {
   uint64_t txValidatorStartLoc = ret.size();
   ret.insert(ret.end(), 8, 0x00);
 
-  // Serialize the transactions [4 Bytes + Tx Bytes]
+  // Serialize the transactions [4 Bytes + Tx Bytes] straight into the buffer,
+  // patching the size prefix afterwards
   for (const auto &tx : this->txs) {
-    Bytes txBytes = tx.rlpSerialize();
-    Utils::appendBytes(ret, Utils::uint32ToBytes(txBytes.size()));
-    ret.insert(ret.end(), txBytes.begin(), txBytes.end());
+    uint64_t sizeLoc = ret.size();
+    ret.insert(ret.end(), 4, 0x00);
+    tx.rlpSerialize(ret);
+    BytesArr<4> txSize = Utils::uint32ToBytes(ret.size() - sizeLoc - 4);
+    std::memcpy(&ret[sizeLoc], txSize.data(), 4);
   }
 
   // Insert the txValidatorStart
-  BytesArr<8> txValidatorStart = Utils::uint64ToBytes(ret.size());
+  BytesArr<8> txValidatorStart = Utils::uint64ToBytes(ret.size() - blockStart);
   std::memcpy(&ret[txValidatorStartLoc], txValidatorStart.data(), 8);
 
   // Serialize the Validator Transactions [4 Bytes + Tx Bytes]
   for (const auto &tx : this->txValidators) {
-    Bytes txBytes = tx.rlpSerialize();
-    Utils::appendBytes(ret, Utils::uint32ToBytes(txBytes.size()));
-    ret.insert(ret.end(), txBytes.begin(), txBytes.end());
+    uint64_t sizeLoc = ret.size();
+    ret.insert(ret.end(), 4, 0x00);
+    tx.rlpSerialize(ret);
+    BytesArr<4> txSize = Utils::uint32ToBytes(ret.size() - sizeLoc - 4);
+    std::memcpy(&ret[sizeLoc], txSize.data(), 4);
   }
+}
 
-  return ret;
+uint64_t Block::serializedSize() const {
+  // Signature + header + txValidatorStart
+  uint64_t size = 217;
+  for (const auto &tx : this->txs) size += 4 + tx.rlpSize();
+  for (const auto &tx : this->txValidators) size += 4 + tx.rlpSize();
+  return size;
 }
 
 const Hash Block::hash() const { return Utils::sha3(this->serializeHeader()); }
@@ -196,6 +229,17 @@ bool Block::appendTx(const TxBlock &tx) {
   return true;
 }
 
+bool Block::appendTx(TxBlock&& tx) {
+  if (this->finalized) {
+    Logger::logToDebug(LogType::ERROR, Log::block, __func__,
+      "Cannot append tx to finalized block"
+    );
+    return false;
+  }
+  this->txs.push_back(std::move(tx));
+  return true;
+}
+
 bool Block::appendTxValidator(const TxValidator &tx) {
   if (this->finalized) {
     Logger::logToDebug(LogType::ERROR, Log::block, __func__,
@@ -230,3 +274,13 @@ bool Block::finalize(const PrivKey& validatorPrivKey, const uint64_t& newTimesta
   return true;
 }
 
+bool Block::appendTxValidator(TxValidator&& tx) {
+  if (this->finalized) {
+    Logger::logToDebug(LogType::ERROR, Log::block, __func__,
+      "Cannot append tx to finalized block"
+    );
+    return false;
+  }
+  this->txValidators.push_back(std::move(tx));
+  return true;
+}
@@ -68,7 +68,7 @@ class Block {
     /// Merkle root for block transactions.
     Hash txMerkleRoot;
 
-    /// Epoch timestamp of the block, in microsseconds.
+    /// Epoch timestamp of the block, in microseconds.
     uint64_t timestamp = 0;
 
     /// Height of the block in chain.
@@ -86,6 +86,27 @@ class Block {
     /// Indicates whether the block is finalized or not. See finalize().
     bool finalized = false;
 
+    /**
+     * Constructor from BlockBuilder.
+     * Takes the already computed roots, so only the header has to be
+     * hashed and signed here.
+     * @param prevBlockHash The previous block hash.
+     * @param timestamp The epoch timestamp of the block.
+     * @param nHeight The height of the block.
+     * @param txValidators The list of Validator transactions.
+     * @param txs The list of block transactions.
+     * @param validatorMerkleRoot The Merkle root of `txValidators`.
+     * @param txMerkleRoot The Merkle root of `txs`.
+     * @param validatorPrivKey The private key of the Validator signing the block.
+     */
+    Block(
+      const Hash& prevBlockHash, const uint64_t& timestamp, const uint64_t& nHeight,
+      std::vector<TxValidator>&& txValidators, std::vector<TxBlock>&& txs,
+      const Hash& validatorMerkleRoot, const Hash& txMerkleRoot, const PrivKey& validatorPrivKey
+    );
+
+    friend class BlockBuilder;
+
   public:
     /**
      * Constructor from network/RPC.
@@ -180,9 +201,26 @@ class Block {
 
     /**
      * Serialize the entire block and its contents.
+     * The buffer is allocated once with the exact size of the block,
+     * and returned as non-const so it can be moved into its destination.
      * @return The serialized block string.
      */
-    const Bytes serializeBlock() const;
+    Bytes serializeBlock() const;
+
+    /**
+     * Serialize the entire block and its contents, appending it to an existing buffer.
+     * Lets callers (e.g. P2P messages) write the block right after their own
+     * prefix without an intermediate copy. Reserve `serializedSize()` beforehand
+     * to avoid reallocations.
+     * @param out The buffer to append to.
+     */
+    void serializeBlock(Bytes& out) const;
+
+    /**
+     * Get the exact size of the serialized block without serializing it.
+     * @return The size of `serializeBlock()`, in bytes.
+     */
+    uint64_t serializedSize() const;
 
     /**
      * SHA3-hash the block header (calls serializeHeader() internally).
@@ -201,6 +239,13 @@ class Block {
      */
     bool appendTx(const TxBlock& tx);
 
+    /**
+     * Append a block transaction to the block, by move.
+     * @param tx The transaction to append.
+     * @return `true` on success, `false` if block is finalized.
+     */
+    bool appendTx(TxBlock&& tx);
+
     /**
      * Append a Validator transaction to the block.
      * @param tx The transaction to append.
@@ -208,6 +253,13 @@ class Block {
      */
     bool appendTxValidator(const TxValidator& tx);
 
+    /**
+     * Append a Validator transaction to the block, by move.
+     * @param tx The transaction to append.
+     * @return `true` on success, `false` if block is finalized.
+     */
+    bool appendTxValidator(TxValidator&& tx);
+
     /**
      * Finalize the block.
      * This means the block will be "closed" to new transactions,
@@ -0,0 +1,34 @@
+#include "blockbuilder.h"
+
+void BlockBuilder::appendTx(TxBlock&& tx) {
+  // Serialize only once, for both the size and the Merkle leaf
+  Bytes txBytes = tx.rlpSerialize();
+  this->txsSize += txBytes.size() + 4;
+  this->serializedSize += txBytes.size() + 4;
+  this->txAccumulator.append(Utils::sha3(txBytes));
+  this->txs.push_back(std::move(tx));
+}
+
+void BlockBuilder::appendTxValidator(TxValidator&& tx) {
+  Bytes txBytes = tx.rlpSerialize();
+  this->serializedSize += txBytes.size() + 4;
+  this->validatorAccumulator.append(Utils::sha3(txBytes));
+  this->txValidators.push_back(std::move(tx));
+}
+
+Block BlockBuilder::finalize(const PrivKey& validatorPrivKey, const uint64_t& newTimestamp) {
+  // Allow rdPoS to improve block time only if new timestamp is better than old timestamp
+  if (this->timestamp > newTimestamp) {
+    Logger::logToDebug(LogType::ERROR, Log::block, __func__,
+      "Block timestamp not satisfiable, expected higher than " +
+      std::to_string(this->timestamp) + " got " + std::to_string(newTimestamp)
+    );
+    throw std::runtime_error(std::string(__func__) + ": Block timestamp not satisfiable");
+  }
+  this->timestamp = newTimestamp;
+  return Block(
+    this->prevBlockHash, this->timestamp, this->nHeight,
+    std::move(this->txValidators), std::move(this->txs),
+    this->validatorAccumulator.getRoot(), this->txAccumulator.getRoot(), validatorPrivKey
+  );
+}
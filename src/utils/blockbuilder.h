@@ -0,0 +1,184 @@
+#ifndef BLOCKBUILDER_H
+#define BLOCKBUILDER_H
+
+#include "utils.h"
+#include "tx.h"
+#include "strings.h"
+#include "merkle.h"
+#include "block.h"
+
+/**
+ * Caps for how much a single block may carry, checked when filling it from the mempool.
+ * Keeping blocks bounded keeps their validation and propagation time bounded too.
+ */
+struct BlockLimits {
+  /// Default maximum size of a serialized block, in bytes.
+  static const uint64_t defaultMaxBytes = 4 * 1024 * 1024;
+
+  /// Default maximum number of block transactions (Validator transactions don't count).
+  static const uint64_t defaultMaxTxs = 10000;
+
+  /// Default maximum estimated execution time of the block transactions, in microseconds.
+  static const uint64_t defaultMaxExecTime = 250000;
+
+  /// Fixed estimated cost of executing any transaction, in microseconds.
+  static const uint64_t execTimePerTx = 5;
+
+  /// Gas executed per microsecond, used to estimate the cost of a transaction from its gas limit.
+  static const uint64_t gasPerMicrosecond = 50;
+
+  uint64_t maxBytes = defaultMaxBytes;          ///< Maximum size of a serialized block, in bytes.
+  uint64_t maxTxs = defaultMaxTxs;              ///< Maximum number of block transactions.
+  uint64_t maxExecTime = defaultMaxExecTime;    ///< Maximum estimated execution time, in microseconds.
+
+  /**
+   * Estimate how long a transaction takes to execute, based on its gas limit.
+   * @param tx The transaction to estimate.
+   * @return The estimated execution time, in microseconds.
+   */
+  static uint64_t estimateExecTime(const TxBlock& tx) {
+    const U256& gasLimit = tx.getGasLimitU256();
+    if (!gasLimit.fitsUint64()) return std::numeric_limits<uint64_t>::max();
+    return execTimePerTx + (uint64_t(gasLimit) / gasPerMicrosecond);
+  }
+};
+
+/// Enum for the reasons a pending transaction was left out of a block.
+enum class BlockSkip {
+  Bytes,      ///< The block would be over `maxBytes`.
+  TxCount,    ///< The block already has `maxTxs` transactions.
+  ExecTime,   ///< The block would be over `maxExecTime`.
+  Balance     ///< The sender can't afford it after its previous transactions in the block.
+};
+
+/**
+ * Summary of filling a block from the mempool.
+ * When a transaction is left out, the later nonces of its sender are left out
+ * too (they can't be executed without it), so only the first one is listed.
+ */
+struct BlockFillReport {
+  uint64_t included = 0;    ///< Number of transactions included in the block.
+  uint64_t leftOut = 0;     ///< Number of pending transactions left in the mempool.
+  uint64_t bytes = 0;       ///< Size of the serialized block after filling it, in bytes.
+  uint64_t execTime = 0;    ///< Estimated execution time of the included transactions, in microseconds.
+  std::vector<std::pair<Hash, BlockSkip>> skipped;  ///< First transaction left out of each sender, and why.
+
+  /**
+   * Count how many senders were left out for a given reason.
+   * @param reason The reason to count.
+   * @return The number of senders left out because of `reason`.
+   */
+  uint64_t count(BlockSkip reason) const {
+    uint64_t ret = 0;
+    for (const auto& [hash, skip] : this->skipped) if (skip == reason) ret++;
+    return ret;
+  }
+};
+
+/**
+ * Helper class for assembling a new block before signing it.
+ *
+ * Transactions are taken by move and hashed only once, when appended:
+ * each one feeds an incremental MerkleAccumulator, so finalizing costs
+ * O(log n) hashes instead of rebuilding both Merkle trees from scratch.
+ * The size the block will have once serialized is also tracked on the go,
+ * so callers can check it against limits without serializing anything.
+ */
+class BlockBuilder {
+  private:
+    /// Previous block hash.
+    Hash prevBlockHash;
+
+    /// Epoch timestamp of the block, in microseconds.
+    uint64_t timestamp = 0;
+
+    /// Height of the block in chain.
+    uint64_t nHeight = 0;
+
+    /// List of Validator transactions.
+    std::vector<TxValidator> txValidators;
+
+    /// List of block transactions.
+    std::vector<TxBlock> txs;
+
+    /// Incremental Merkle root of `txValidators`.
+    MerkleAccumulator validatorAccumulator;
+
+    /// Incremental Merkle root of `txs`.
+    MerkleAccumulator txAccumulator;
+
+    /// Size of the block once serialized (signature + header + txValidatorStart + txs), in bytes.
+    uint64_t serializedSize = 217;
+
+    /// Size of the serialized block transaction range, in bytes.
+    uint64_t txsSize = 0;
+
+  public:
+    /**
+     * Constructor.
+     * @param prevBlockHash The previous block hash.
+     * @param timestamp The epoch timestamp of the block.
+     * @param nHeight The height of the block.
+     */
+    BlockBuilder(const Hash& prevBlockHash, const uint64_t& timestamp, const uint64_t& nHeight)
+      : prevBlockHash(prevBlockHash), timestamp(timestamp), nHeight(nHeight) {}
+
+    /// Getter for `prevBlockHash`.
+    const Hash& getPrevBlockHash() const { return this->prevBlockHash; }
+
+    /// Getter for `timestamp`.
+    uint64_t getTimestamp() const { return this->timestamp; }
+
+    /// Getter for `nHeight`.
+    uint64_t getNHeight() const { return this->nHeight; }
+
+    /// Getter for `txValidators`.
+    const std::vector<TxValidator>& getTxValidators() const { return this->txValidators; }
+
+    /// Getter for `txs`.
+    const std::vector<TxBlock>& getTxs() const { return this->txs; }
+
+    /// Getter for `serializedSize`.
+    uint64_t getSerializedSize() const { return this->serializedSize; }
+
+    /// Getter for `txsSize`.
+    uint64_t getTxsSize() const { return this->txsSize; }
+
+    /// Get the current block transaction Merkle root (O(log n)).
+    const Hash getTxMerkleRoot() const { return this->txAccumulator.getRoot(); }
+
+    /// Get the current Validator transaction Merkle root (O(log n)).
+    const Hash getValidatorMerkleRoot() const { return this->validatorAccumulator.getRoot(); }
+
+    /**
+     * Get the serialized size of a block transaction as it would be in a block.
+     * @param tx The transaction to check.
+     * @return The size of the transaction plus its 4-byte size prefix.
+     */
+    static uint64_t txBlockSize(const TxBlock& tx) { return tx.rlpSize() + 4; }
+
+    /**
+     * Append a block transaction to the block.
+     * @param tx The transaction to append. Will be moved.
+     */
+    void appendTx(TxBlock&& tx);
+
+    /**
+     * Append a Validator transaction to the block.
+     * @param tx The transaction to append. Will be moved.
+     */
+    void appendTxValidator(TxValidator&& tx);
+
+    /**
+     * Finalize and sign the block, moving every transaction into it.
+     * The builder is left empty and should not be reused.
+     * @param validatorPrivKey The private key of the Validator signing the block.
+     * @param newTimestamp The new timestamp of the block. Must not be lower
+     *                     than the one the builder was created with.
+     * @return The finalized block.
+     * @throw std::runtime_error if the timestamp is lower than the builder's.
+     */
+    Block finalize(const PrivKey& validatorPrivKey, const uint64_t& newTimestamp);
+};
+
+#endif // BLOCKBUILDER_H
@@ -58,3 +58,35 @@ std::vector<DBEntry> DB::getBatch(
   return ret;
 }
 
+
+std::optional<DBEntry> DB::getFloor(const BytesArrView key, const Bytes& pfx) const {
+  Bytes keyTmp = pfx;
+  keyTmp.insert(keyTmp.end(), key.begin(), key.end());
+  rocksdb::Slice keySlice(reinterpret_cast<const char*>(keyTmp.data()), keyTmp.size());
+  rocksdb::Slice pfxSlice(reinterpret_cast<const char*>(pfx.data()), pfx.size());
+  std::unique_ptr<rocksdb::Iterator> it(this->db->NewIterator(rocksdb::ReadOptions()));
+  it->SeekForPrev(keySlice);
+  if (!it->Valid() || !it->key().starts_with(pfxSlice)) return std::nullopt;
+  auto foundKey = it->key();
+  foundKey.remove_prefix(pfx.size());
+  return DBEntry(
+    Bytes(foundKey.data(), foundKey.data() + foundKey.size()),
+    Bytes(it->value().data(), it->value().data() + it->value().size())
+  );
+}
+
+std::optional<DBEntry> DB::getCeiling(const BytesArrView key, const Bytes& pfx) const {
+  Bytes keyTmp = pfx;
+  keyTmp.insert(keyTmp.end(), key.begin(), key.end());
+  rocksdb::Slice keySlice(reinterpret_cast<const char*>(keyTmp.data()), keyTmp.size());
+  rocksdb::Slice pfxSlice(reinterpret_cast<const char*>(pfx.data()), pfx.size());
+  std::unique_ptr<rocksdb::Iterator> it(this->db->NewIterator(rocksdb::ReadOptions()));
+  it->Seek(keySlice);
+  if (!it->Valid() || !it->key().starts_with(pfxSlice)) return std::nullopt;
+  auto foundKey = it->key();
+  foundKey.remove_prefix(pfx.size());
+  return DBEntry(
+    Bytes(foundKey.data(), foundKey.data() + foundKey.size()),
+    Bytes(it->value().data(), it->value().data() + it->value().size())
+  );
+}
@@ -4,6 +4,7 @@
 #include <cstring>
 #include <filesystem>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,11 @@ namespace DBPrefix {
   const Bytes rdPoS =  { 0x00, 0x05 };           ///< "rdPoS" = "0005"
   const Bytes contracts =  { 0x00, 0x06 };       ///< "contracts" = "0006"
   const Bytes contractManager =  { 0x00, 0x07 }; ///< "contractManager" = "0007"
+  const Bytes nativeAccountHistory = { 0x00, 0x08 };      ///< "nativeAccountHistory" = "0008"
+  const Bytes nativeAccountHistoryIndex = { 0x00, 0x09 }; ///< "nativeAccountHistoryIndex" = "0009"
+  const Bytes stateRoots = { 0x00, 0x0A };                ///< "stateRoots" = "000A"
+  const Bytes stateTreeNodes = { 0x00, 0x0B };            ///< "stateTreeNodes" = "000B"
+  const Bytes stateTreeLeaves = { 0x00, 0x0C };           ///< "stateTreeLeaves" = "000C"
 };
 
 /// Struct for a database connection/endpoint.
@@ -100,6 +106,22 @@ class DBBatch {
                               rocksdb::Slice(reinterpret_cast<const char*>(puts.back().value.data()), puts.back().value.size()));
     }
 
+    /**
+     * Add an puts entry to the batch, taking ownership of the value (no copy).
+     * Meant for big values that were just serialized, like blocks.
+     * @param key The entry's key.
+     * @param value The entry's value. Will be moved.
+     * @param prefix The entry's prefix.
+     */
+    void push_back(const BytesArrView key, Bytes&& value, const Bytes& prefix) {
+      Bytes tmp = prefix;
+      tmp.reserve(prefix.size() + key.size());
+      tmp.insert(tmp.end(), key.begin(), key.end());
+      puts.emplace_back(std::move(tmp), std::move(value));
+      putsSlices.emplace_back(rocksdb::Slice(reinterpret_cast<const char*>(puts.back().key.data()), puts.back().key.size()),
+                              rocksdb::Slice(reinterpret_cast<const char*>(puts.back().value.data()), puts.back().value.size()));
+    }
+
     /**
      * Add an delete entry to the batch.
      * @param key The entry's key.
@@ -278,6 +300,23 @@ class DB {
       const Bytes& bytesPfx, const std::vector<Bytes>& keys = {}
     ) const;
 
+    /**
+     * Get the entry with the greatest key less than or equal to a given key, within a prefix.
+     * Meant for versioned keys (e.g. an ID followed by a big-endian block height).
+     * @param key The key to search for (without the prefix).
+     * @param pfx The prefix to search within.
+     * @return The entry (key without the prefix), or `std::nullopt` if there's none.
+     */
+    std::optional<DBEntry> getFloor(const BytesArrView key, const Bytes& pfx) const;
+
+    /**
+     * Get the entry with the smallest key greater than or equal to a given key, within a prefix.
+     * @param key The key to search for (without the prefix).
+     * @param pfx The prefix to search within.
+     * @return The entry (key without the prefix), or `std::nullopt` if there's none.
+     */
+    std::optional<DBEntry> getCeiling(const BytesArrView key, const Bytes& pfx) const;
+
     /**
      * Create a Bytes container from a string.
      * @param str The string to convert.
@@ -0,0 +1,503 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "safehash.h"
+
+/**
+ * Open-addressing hash map in the style of a Swiss table, meant as a drop-in
+ * replacement for `std::unordered_map` on hot, hash-keyed maps.
+ *
+ * Entries live in one flat array of slots, next to a parallel array of one-byte
+ * control tags (empty, deleted, or 7 bits of the key's hash). Lookups scan the
+ * tags of 16 slots at once (with SSE2 when available) and only compare keys
+ * whose tag matches, so most lookups touch one tag group and one slot,
+ * instead of chasing a pointer per node like `std::unordered_map` does.
+ * Groups are probed quadratically and the table grows at 7/8 load.
+ *
+ * Differences from `std::unordered_map`:
+ * - Inserting may move entries around (on growth), invalidating every iterator,
+ *   pointer and reference. Erasing only invalidates the erased entry.
+ * - Only the subset of the interface the node actually uses is implemented.
+ *
+ * @tparam Key The key type.
+ * @tparam T The mapped type.
+ * @tparam Hasher The hasher. Its output should be well mixed on every bit (SafeHash is).
+ * @tparam KeyEqual The key comparator.
+ */
+template <typename Key, typename T, typename Hasher = SafeHash, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+  public:
+    using key_type = Key;                         ///< Typedef for the key type.
+    using mapped_type = T;                        ///< Typedef for the mapped type.
+    using value_type = std::pair<const Key, T>;   ///< Typedef for an entry.
+    using size_type = std::size_t;                ///< Typedef for sizes.
+    using hasher = Hasher;                        ///< Typedef for the hasher.
+    using key_equal = KeyEqual;                   ///< Typedef for the key comparator.
+
+  private:
+    /// Control tag of a slot. Full slots keep 7 bits of the key's hash (0 to 127).
+    using ctrl_t = int8_t;
+
+    static constexpr ctrl_t kEmpty = -128;        ///< Tag for a never used slot. Stops probing.
+    static constexpr ctrl_t kDeleted = -2;        ///< Tag for an erased slot (tombstone). Doesn't stop probing.
+    static constexpr size_type groupWidth = 16;   ///< Number of slots scanned at once.
+
+    /// Control tags of `groupWidth` consecutive slots, matched all at once.
+    struct Group {
+#if defined(__SSE2__)
+      __m128i ctrl; ///< The tags.
+
+      /// Constructor. @param pos Pointer to the first tag of the group.
+      explicit Group(const ctrl_t* pos) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+      /// Get a bitmask of the slots whose tag equals `tag`.
+      uint32_t match(ctrl_t tag) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(this->ctrl, _mm_set1_epi8(tag))));
+      }
+
+      /// Get a bitmask of the empty or deleted slots (the only negative tags).
+      uint32_t matchEmptyOrDeleted() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(this->ctrl));
+      }
+#else
+      const ctrl_t* ctrl; ///< The tags.
+
+      /// Constructor. @param pos Pointer to the first tag of the group.
+      explicit Group(const ctrl_t* pos) : ctrl(pos) {}
+
+      /// Get a bitmask of the slots whose tag equals `tag`.
+      uint32_t match(ctrl_t tag) const {
+        uint32_t ret = 0;
+        for (size_type i = 0; i < groupWidth; i++) if (this->ctrl[i] == tag) ret |= (1u << i);
+        return ret;
+      }
+
+      /// Get a bitmask of the empty or deleted slots (the only negative tags).
+      uint32_t matchEmptyOrDeleted() const {
+        uint32_t ret = 0;
+        for (size_type i = 0; i < groupWidth; i++) if (this->ctrl[i] < 0) ret |= (1u << i);
+        return ret;
+      }
+#endif
+
+      /// Get a bitmask of the empty slots.
+      uint32_t matchEmpty() const { return this->match(kEmpty); }
+    };
+
+    std::unique_ptr<ctrl_t[]> ctrl;   ///< Control tags, one per slot.
+    value_type* slots = nullptr;      ///< Slots. Only the ones with a full tag are constructed.
+    size_type capacity = 0;           ///< Number of slots. Zero or a power of two (at least `groupWidth`).
+    size_type entries = 0;            ///< Number of entries.
+    size_type growthLeft = 0;         ///< Empty slots that can still be used before the table has to grow.
+    Hasher hashFn;                    ///< Hasher instance.
+    KeyEqual equalFn;                 ///< Key comparator instance.
+
+    /// Get the maximum number of used slots (entries + tombstones) for a given capacity.
+    static size_type maxLoad(size_type capacity) { return capacity - (capacity / 8); }
+
+    /// Get the tag of a hash.
+    static ctrl_t tagOf(size_type hash) { return static_cast<ctrl_t>(hash & 0x7f); }
+
+    /// Get the first group probed for a hash.
+    size_type firstGroup(size_type hash) const { return (hash >> 7) & ((this->capacity / groupWidth) - 1); }
+
+    /// Get the next group in a probe sequence (triangular, so every group is visited).
+    size_type nextGroup(size_type group, size_type& step) const {
+      return (group + (++step)) & ((this->capacity / groupWidth) - 1);
+    }
+
+    /**
+     * Find the slot of a key.
+     * @param key The key to look for.
+     * @param hash The key's hash.
+     * @return The slot index, or `capacity` if not found.
+     */
+    template <typename K> size_type findIndex(const K& key, size_type hash) const {
+      if (this->capacity == 0) return this->capacity;
+      const ctrl_t tag = tagOf(hash);
+      size_type step = 0;
+      for (size_type group = this->firstGroup(hash); ; group = this->nextGroup(group, step)) {
+        const size_type base = group * groupWidth;
+        Group g(this->ctrl.get() + base);
+        for (uint32_t match = g.match(tag); match != 0; match &= (match - 1)) {
+          size_type idx = base + std::countr_zero(match);
+          if (this->equalFn(this->slots[idx].first, key)) return idx;
+        }
+        // A group with an empty slot was never full, so the key can't be further ahead
+        if (g.matchEmpty() != 0) return this->capacity;
+      }
+    }
+
+    /**
+     * Find the first empty or deleted slot in the probe sequence of a hash.
+     * There's always one, as the table never fills up.
+     * @param hash The hash.
+     * @return The slot index.
+     */
+    size_type findFreeIndex(size_type hash) const {
+      size_type step = 0;
+      for (size_type group = this->firstGroup(hash); ; group = this->nextGroup(group, step)) {
+        const size_type base = group * groupWidth;
+        uint32_t match = Group(this->ctrl.get() + base).matchEmptyOrDeleted();
+        if (match != 0) return base + std::countr_zero(match);
+      }
+    }
+
+    /**
+     * Move every entry into a new table with the given capacity, dropping tombstones.
+     * @param newCapacity The new capacity. Must be a power of two, at least `groupWidth`,
+     *                    and big enough for every entry.
+     */
+    void resize(size_type newCapacity) {
+      std::unique_ptr<ctrl_t[]> oldCtrl = std::move(this->ctrl);
+      value_type* oldSlots = this->slots;
+      size_type oldCapacity = this->capacity;
+
+      this->ctrl = std::make_unique<ctrl_t[]>(newCapacity);
+      std::fill_n(this->ctrl.get(), newCapacity, kEmpty);
+      this->slots = std::allocator<value_type>().allocate(newCapacity);
+      this->capacity = newCapacity;
+      for (size_type i = 0; i < oldCapacity; i++) {
+        if (oldCtrl[i] < 0) continue;
+        size_type hash = this->hashFn(oldSlots[i].first);
+        size_type idx = this->findFreeIndex(hash);
+        this->ctrl[idx] = tagOf(hash);
+        std::construct_at(this->slots + idx, std::move(oldSlots[i]));
+        std::destroy_at(oldSlots + i);
+      }
+      this->growthLeft = maxLoad(newCapacity) - this->entries;
+      if (oldSlots != nullptr) std::allocator<value_type>().deallocate(oldSlots, oldCapacity);
+    }
+
+    /// Make room for one more entry, growing the table (or just dropping tombstones if there are many).
+    void prepareInsert() {
+      if (this->capacity == 0) {
+        this->resize(groupWidth);
+      } else if (this->entries + 1 > maxLoad(this->capacity) / 2) {
+        this->resize(this->capacity * 2);
+      } else {
+        this->resize(this->capacity);
+      }
+    }
+
+    /**
+     * Insert an entry if its key isn't in the map yet.
+     * @param key The entry's key.
+     * @param args Arguments for constructing the entry (`value_type`), used only if inserted.
+     * @return A pair with the entry's slot and whether it was inserted.
+     */
+    template <typename K, typename... Args> std::pair<size_type, bool> emplaceIndex(const K& key, Args&&... args) {
+      size_type hash = this->hashFn(key);
+      size_type idx = this->findIndex(key, hash);
+      if (idx != this->capacity) return {idx, false};
+      if (this->growthLeft == 0) this->prepareInsert();
+      idx = this->findFreeIndex(hash);
+      std::construct_at(this->slots + idx, std::forward<Args>(args)...);
+      if (this->ctrl[idx] == kEmpty) this->growthLeft--;
+      this->ctrl[idx] = tagOf(hash);
+      this->entries++;
+      return {idx, true};
+    }
+
+    /**
+     * Erase the entry in a given slot.
+     * @param idx The slot index. Must be full.
+     */
+    void eraseIndex(size_type idx) {
+      std::destroy_at(this->slots + idx);
+      this->entries--;
+      // Probing never went past a group that still has an empty slot,
+      // so the slot can be marked as empty instead of leaving a tombstone.
+      if (Group(this->ctrl.get() + (idx & ~(groupWidth - 1))).matchEmpty() != 0) {
+        this->ctrl[idx] = kEmpty;
+        this->growthLeft++;
+      } else {
+        this->ctrl[idx] = kDeleted;
+      }
+    }
+
+    /// Destroy every entry and free the table.
+    void destroy() {
+      if (this->slots == nullptr) return;
+      for (size_type i = 0; i < this->capacity; i++) if (this->ctrl[i] >= 0) std::destroy_at(this->slots + i);
+      std::allocator<value_type>().deallocate(this->slots, this->capacity);
+      this->slots = nullptr;
+      this->ctrl.reset();
+      this->capacity = this->entries = this->growthLeft = 0;
+    }
+
+    /// Forward iterator over the full slots.
+    template <bool IsConst> class Iterator {
+      private:
+        using MapPtr = std::conditional_t<IsConst, const FlatHashMap*, FlatHashMap*>;
+        MapPtr map = nullptr;   ///< The map being iterated.
+        size_type idx = 0;      ///< Current slot index.
+
+        /// Move forward to the next full slot (or the end).
+        void skipEmpty() { while (this->idx < this->map->capacity && this->map->ctrl[this->idx] < 0) this->idx++; }
+
+        friend class FlatHashMap;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;   ///< Typedef for the iterator category.
+        using value_type = FlatHashMap::value_type;            ///< Typedef for the value type.
+        using difference_type = std::ptrdiff_t;                ///< Typedef for the difference type.
+        using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;   ///< Typedef for the pointer type.
+        using reference = std::conditional_t<IsConst, const value_type&, value_type&>; ///< Typedef for the reference type.
+
+        /// Default constructor.
+        Iterator() = default;
+
+        /**
+         * Constructor.
+         * @param map The map being iterated.
+         * @param idx The slot to start from. Moves forward to the first full slot.
+         */
+        Iterator(MapPtr map, size_type idx) : map(map), idx(idx) { this->skipEmpty(); }
+
+        /// Conversion from a non-const iterator to a const one.
+        template <bool WasConst> requires (IsConst && !WasConst)
+        Iterator(const Iterator<WasConst>& other) : map(other.map), idx(other.idx) {}
+
+        reference operator*() const { return this->map->slots[this->idx]; }   ///< Dereference operator.
+        pointer operator->() const { return &this->map->slots[this->idx]; }   ///< Member access operator.
+        Iterator& operator++() { this->idx++; this->skipEmpty(); return *this; } ///< Prefix increment.
+        Iterator operator++(int) { Iterator ret = *this; ++(*this); return ret; } ///< Postfix increment.
+        bool operator==(const Iterator& other) const { return this->idx == other.idx; } ///< Equality operator.
+
+        template <bool> friend class Iterator;
+    };
+
+  public:
+    using iterator = Iterator<false>;       ///< Typedef for the iterator.
+    using const_iterator = Iterator<true>;  ///< Typedef for the const iterator.
+
+    /// Default constructor. Allocates nothing until the first insertion.
+    FlatHashMap() = default;
+
+    /// Copy constructor.
+    FlatHashMap(const FlatHashMap& other) : hashFn(other.hashFn), equalFn(other.equalFn) {
+      this->reserve(other.entries);
+      for (const value_type& entry : other) this->emplaceIndex(entry.first, entry);
+    }
+
+    /// Move constructor.
+    FlatHashMap(FlatHashMap&& other) noexcept { this->swap(other); }
+
+    /**
+     * Constructor from a range of entries.
+     * @param first Iterator to the first entry.
+     * @param last Iterator past the last entry.
+     */
+    template <typename InputIt> FlatHashMap(InputIt first, InputIt last) {
+      for (; first != last; ++first) this->insert(*first);
+    }
+
+    /// Constructor from an initializer list.
+    FlatHashMap(std::initializer_list<value_type> list) : FlatHashMap(list.begin(), list.end()) {}
+
+    /// Destructor.
+    ~FlatHashMap() { this->destroy(); }
+
+    /// Copy/move assignment operator.
+    FlatHashMap& operator=(FlatHashMap other) noexcept { this->swap(other); return *this; }
+
+    /**
+     * Equality operator. Maps are equal if they have the same entries, regardless of layout.
+     * @param other The map to compare to.
+     * @return `true` if both maps are equal, `false` otherwise.
+     */
+    bool operator==(const FlatHashMap& other) const requires std::equality_comparable<T> {
+      if (this->entries != other.entries) return false;
+      for (const value_type& entry : *this) {
+        auto it = other.find(entry.first);
+        if (it == other.end() || !(it->second == entry.second)) return false;
+      }
+      return true;
+    }
+
+    /// Swap the contents of two maps.
+    void swap(FlatHashMap& other) noexcept {
+      using std::swap;
+      swap(this->ctrl, other.ctrl);
+      swap(this->slots, other.slots);
+      swap(this->capacity, other.capacity);
+      swap(this->entries, other.entries);
+      swap(this->growthLeft, other.growthLeft);
+      swap(this->hashFn, other.hashFn);
+      swap(this->equalFn, other.equalFn);
+    }
+
+    iterator begin() { return iterator(this, 0); }                   ///< Get an iterator to the first entry.
+    iterator end() { return iterator(this, this->capacity); }        ///< Get an iterator past the last entry.
+    const_iterator begin() const { return const_iterator(this, 0); } ///< Get a const iterator to the first entry.
+    const_iterator end() const { return const_iterator(this, this->capacity); } ///< Get a const iterator past the last entry.
+    const_iterator cbegin() const { return this->begin(); }          ///< Get a const iterator to the first entry.
+    const_iterator cend() const { return this->end(); }              ///< Get a const iterator past the last entry.
+
+    size_type size() const { return this->entries; }          ///< Get the number of entries.
+    bool empty() const { return this->entries == 0; }         ///< Check if the map has no entries.
+    size_type bucket_count() const { return this->capacity; } ///< Get the number of slots.
+
+    /// Remove every entry and free the table.
+    void clear() { this->destroy(); }
+
+    /**
+     * Make room for a given number of entries, so inserting up to that many doesn't grow the table.
+     * @param n The number of entries.
+     */
+    void reserve(size_type n) {
+      size_type newCapacity = groupWidth;
+      while (maxLoad(newCapacity) < n) newCapacity *= 2;
+      if (newCapacity > this->capacity) this->resize(newCapacity);
+    }
+
+    /**
+     * Find an entry.
+     * @param key The key to look for.
+     * @return An iterator to the entry, or `end()` if not found.
+     */
+    iterator find(const Key& key) { return iterator(this, this->findIndex(key, this->hashFn(key))); }
+
+    /**
+     * Find an entry.
+     * @param key The key to look for.
+     * @return A const iterator to the entry, or `end()` if not found.
+     */
+    const_iterator find(const Key& key) const { return const_iterator(this, this->findIndex(key, this->hashFn(key))); }
+
+    /// Check if a key is in the map.
+    bool contains(const Key& key) const { return this->findIndex(key, this->hashFn(key)) != this->capacity; }
+
+    /// Get the number of entries with a given key (0 or 1).
+    size_type count(const Key& key) const { return this->contains(key) ? 1 : 0; }
+
+    /**
+     * Get the value of an entry.
+     * @param key The entry's key.
+     * @return A reference to the value.
+     * @throw std::out_of_range if the key isn't in the map.
+     */
+    T& at(const Key& key) {
+      size_type idx = this->findIndex(key, this->hashFn(key));
+      if (idx == this->capacity) throw std::out_of_range("FlatHashMap::at: key not found");
+      return this->slots[idx].second;
+    }
+
+    /**
+     * Get the value of an entry.
+     * @param key The entry's key.
+     * @return A const reference to the value.
+     * @throw std::out_of_range if the key isn't in the map.
+     */
+    const T& at(const Key& key) const {
+      size_type idx = this->findIndex(key, this->hashFn(key));
+      if (idx == this->capacity) throw std::out_of_range("FlatHashMap::at: key not found");
+      return this->slots[idx].second;
+    }
+
+    /**
+     * Get the value of an entry, inserting a default-constructed one if not found.
+     * Doesn't change the table if the key is already in the map.
+     * @param key The entry's key.
+     * @return A reference to the value.
+     */
+    T& operator[](const Key& key) { return this->try_emplace(key).first->second; }
+
+    /**
+     * Insert an entry if its key isn't in the map yet.
+     * @param key The entry's key.
+     * @param args Arguments for constructing the value, used only if inserted.
+     * @return A pair with an iterator to the entry and whether it was inserted.
+     */
+    template <typename... Args> std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+      auto [idx, inserted] = this->emplaceIndex(key, std::piecewise_construct,
+        std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...)
+      );
+      return {iterator(this, idx), inserted};
+    }
+
+    /**
+     * Insert an entry if its key isn't in the map yet.
+     * @param key The entry's key.
+     * @param value The entry's value, used only if inserted.
+     * @return A pair with an iterator to the entry and whether it was inserted.
+     */
+    template <typename V> std::pair<iterator, bool> emplace(const Key& key, V&& value) {
+      return this->try_emplace(key, std::forward<V>(value));
+    }
+
+    /**
+     * Insert an entry if its key isn't in the map yet.
+     * @param entry The entry.
+     * @return A pair with an iterator to the entry and whether it was inserted.
+     */
+    std::pair<iterator, bool> insert(const value_type& entry) {
+      auto [idx, inserted] = this->emplaceIndex(entry.first, entry);
+      return {iterator(this, idx), inserted};
+    }
+
+    /**
+     * Insert an entry if its key isn't in the map yet.
+     * @param entry The entry. Will be moved only if inserted.
+     * @return A pair with an iterator to the entry and whether it was inserted.
+     */
+    std::pair<iterator, bool> insert(value_type&& entry) {
+      auto [idx, inserted] = this->emplaceIndex(entry.first, std::move(entry));
+      return {iterator(this, idx), inserted};
+    }
+
+    /**
+     * Insert an entry, or assign the value if the key is already in the map.
+     * @param key The entry's key.
+     * @param value The entry's value.
+     * @return A pair with an iterator to the entry and whether it was inserted.
+     */
+    template <typename V> std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value) {
+      auto ret = this->try_emplace(key, std::forward<V>(value));
+      if (!ret.second) ret.first->second = std::forward<V>(value);
+      return ret;
+    }
+
+    /**
+     * Erase an entry.
+     * @param key The entry's key.
+     * @return The number of erased entries (0 or 1).
+     */
+    size_type erase(const Key& key) {
+      size_type idx = this->findIndex(key, this->hashFn(key));
+      if (idx == this->capacity) return 0;
+      this->eraseIndex(idx);
+      return 1;
+    }
+
+    /**
+     * Erase an entry.
+     * @param it Iterator to the entry. Must be valid and not `end()`.
+     * @return An iterator to the next entry.
+     */
+    iterator erase(const_iterator it) {
+      this->eraseIndex(it.idx);
+      return iterator(this, it.idx + 1);
+    }
+
+    /// Erase an entry. Overload for non-const iterators, see above.
+    iterator erase(iterator it) { return this->erase(const_iterator(it)); }
+};
+
+#endif  // FLATHASHMAP_H
@@ -0,0 +1,157 @@
+#include "keccak.h"
+
+#include <cstring>
+
+namespace {
+  /// Keccak-256 rate (block size), in bytes.
+  constexpr size_t rate = 136;
+
+  /// Round constants for the iota step.
+  constexpr uint64_t roundConstants[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+  };
+
+  /// Rotation offsets for the rho step, in pi order.
+  constexpr int rotations[24] = {
+    1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
+  };
+
+  /// Lane permutation for the pi step.
+  constexpr int piLanes[24] = {
+    10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
+  };
+
+  /// 4 x 64-bit lanes (one AVX2 register).
+  typedef uint64_t Lanes4 __attribute__((vector_size(32)));
+
+  /// 8 x 64-bit lanes (one AVX-512 register).
+  typedef uint64_t Lanes8 __attribute__((vector_size(64)));
+
+  /**
+   * Keccak-f[1600] permutation over N parallel states.
+   * Always inlined so it gets compiled with the target of the calling kernel.
+   */
+  template <typename V> [[gnu::always_inline]] inline void permute(V st[25]) {
+    for (int round = 0; round < 24; round++) {
+      // Theta
+      V bc[5];
+      for (int i = 0; i < 5; i++) bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
+      for (int i = 0; i < 5; i++) {
+        V t = bc[(i + 4) % 5] ^ ((bc[(i + 1) % 5] << 1) | (bc[(i + 1) % 5] >> 63));
+        for (int j = 0; j < 25; j += 5) st[j + i] ^= t;
+      }
+      // Rho + Pi
+      V t = st[1];
+      for (int i = 0; i < 24; i++) {
+        int j = piLanes[i];
+        V b = st[j];
+        st[j] = (t << rotations[i]) | (t >> (64 - rotations[i]));
+        t = b;
+      }
+      // Chi
+      for (int j = 0; j < 25; j += 5) {
+        for (int i = 0; i < 5; i++) bc[i] = st[j + i];
+        for (int i = 0; i < 5; i++) st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
+      }
+      // Iota
+      st[0] ^= roundConstants[round];
+    }
+  }
+
+  /**
+   * Absorb N messages (of possibly different sizes) and squeeze 32 bytes out of each.
+   * Lanes that run out of blocks keep being permuted with zeroed input, but their
+   * output was already taken right after their last block, so it doesn't matter.
+   */
+  template <typename V, unsigned N> [[gnu::always_inline]] inline void keccak256xN(
+    const uint8_t* const in[N], const size_t inLen[N], uint8_t* const out[N]
+  ) {
+    V st[25];
+    std::memset(st, 0, sizeof(st));
+    size_t blocks[N];
+    size_t maxBlocks = 0;
+    for (unsigned l = 0; l < N; l++) {
+      blocks[l] = (inLen[l] / rate) + 1; // Padding always adds a block when the size is a multiple of the rate
+      if (blocks[l] > maxBlocks) maxBlocks = blocks[l];
+    }
+
+    alignas(64) uint64_t words[rate / 8][N];
+    uint8_t padded[rate];
+    for (size_t b = 0; b < maxBlocks; b++) {
+      // Transpose the current block of every message into lane order
+      for (unsigned l = 0; l < N; l++) {
+        if (b >= blocks[l]) {
+          for (unsigned w = 0; w < rate / 8; w++) words[w][l] = 0;
+          continue;
+        }
+        const uint8_t* src = in[l] + (b * rate);
+        if (b == blocks[l] - 1) {
+          size_t rem = inLen[l] - (b * rate);
+          std::memset(padded, 0, rate);
+          if (rem > 0) std::memcpy(padded, src, rem);
+          padded[rem] ^= 0x01;
+          padded[rate - 1] ^= 0x80;
+          src = padded;
+        }
+        for (unsigned w = 0; w < rate / 8; w++) std::memcpy(&words[w][l], src + (w * 8), 8);
+      }
+      for (unsigned w = 0; w < rate / 8; w++) {
+        V v;
+        std::memcpy(&v, words[w], sizeof(V));
+        st[w] ^= v;
+      }
+      permute(st);
+      // Squeeze the lanes that just absorbed their last block
+      for (unsigned l = 0; l < N; l++) {
+        if (b != blocks[l] - 1) continue;
+        for (unsigned w = 0; w < 4; w++) {
+          uint64_t word = st[w][l];
+          std::memcpy(out[l] + (w * 8), &word, 8);
+        }
+      }
+    }
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+Keccak::Impl Keccak::detectImpl() {
+  static const Impl impl = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Impl::AVX512;
+    if (__builtin_cpu_supports("avx2")) return Impl::AVX2;
+    return Impl::Scalar;
+  }();
+  return impl;
+}
+
+__attribute__((target("avx2")))
+void Keccak::keccak256x4(const uint8_t* const in[4], const size_t inLen[4], uint8_t* const out[4]) {
+  keccak256xN<Lanes4, 4>(in, inLen, out);
+}
+
+__attribute__((target("avx512f")))
+void Keccak::keccak256x8(const uint8_t* const in[8], const size_t inLen[8], uint8_t* const out[8]) {
+  keccak256xN<Lanes8, 8>(in, inLen, out);
+}
+
+#else
+
+// Non-x86 targets: generic vector code still works, but isn't worth
+// dispatching to, so always report the scalar implementation.
+Keccak::Impl Keccak::detectImpl() { return Impl::Scalar; }
+
+void Keccak::keccak256x4(const uint8_t* const in[4], const size_t inLen[4], uint8_t* const out[4]) {
+  keccak256xN<Lanes4, 4>(in, inLen, out);
+}
+
+void Keccak::keccak256x8(const uint8_t* const in[8], const size_t inLen[8], uint8_t* const out[8]) {
+  keccak256xN<Lanes8, 8>(in, inLen, out);
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef KECCAK_H
+#define KECCAK_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// @file keccak.h
+
+/**
+ * Namespace for multi-lane Keccak-256 kernels.
+ * Each kernel hashes several independent messages at once, one message per
+ * 64-bit lane of a SIMD register, using GCC/Clang vector extensions compiled
+ * for the given instruction set. Callers should go through `Utils::sha3Batch()`,
+ * which picks the widest kernel supported by the running CPU.
+ */
+namespace Keccak {
+  /// Enum for the available kernel implementations.
+  enum class Impl { Scalar, AVX2, AVX512 };
+
+  /**
+   * Detect the widest kernel supported by the running CPU.
+   * Only checked once, the result is cached for the lifetime of the process.
+   * @return The implementation to use.
+   */
+  Impl detectImpl();
+
+  /**
+   * Hash 4 messages at once with an AVX2 Keccak-f[1600] permutation.
+   * MUST only be called if `detectImpl()` returns AVX2 or better.
+   * @param in Pointers to each message.
+   * @param inLen Size of each message, in bytes.
+   * @param out Pointers to each 32-byte output buffer.
+   */
+  void keccak256x4(const uint8_t* const in[4], const size_t inLen[4], uint8_t* const out[4]);
+
+  /**
+   * Hash 8 messages at once with an AVX-512 Keccak-f[1600] permutation.
+   * MUST only be called if `detectImpl()` returns AVX512.
+   * @param in Pointers to each message.
+   * @param inLen Size of each message, in bytes.
+   * @param out Pointers to each 32-byte output buffer.
+   */
+  void keccak256x8(const uint8_t* const in[8], const size_t inLen[8], uint8_t* const out[8]);
+};
+
+#endif  // KECCAK_H
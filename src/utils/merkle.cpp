@@ -1,60 +1,139 @@
 #include "merkle.h"
 
-std::vector<Hash> Merkle::newLayer(const std::vector<Hash>& layer) const {
-  std::vector<Hash> ret;
-  for (uint64_t i = 0; i < layer.size(); i += 2) ret.emplace_back((
-    (i + 1 < layer.size())
-      ? Utils::sha3(
-        // Lambda to concatenate
-        Bytes([&]() -> Bytes {
-          Bytes bytes;
-          bytes.reserve(64);
-          Utils::appendBytes(bytes, std::min(layer[i], layer[i + 1]));
-          Utils::appendBytes(bytes, std::max(layer[i], layer[i + 1]));
-          return bytes;
-        }()
-      ))
-      : layer[i]
-  ));
-  return ret;
+void Merkle::allocate(const uint64_t leafCount) {
+  this->layerOffsets.clear();
+  this->layerOffsets.push_back(0);
+  uint64_t size = leafCount;
+  uint64_t total = 0;
+  while (true) {
+    total += size;
+    this->layerOffsets.push_back(total);
+    if (size <= 1) break;
+    size = (size + 1) / 2;
+  }
+  this->tree.resize(total);
+}
+
+void Merkle::build() {
+  for (uint64_t i = 0; i + 1 < this->getLayerCount(); i++) {
+    newLayer(this->getLayer(i), std::span<Hash>(this->tree).subspan(
+      this->layerOffsets[i + 1], this->layerOffsets[i + 2] - this->layerOffsets[i + 1]
+    ));
+  }
+}
+
+void Merkle::hashPairs(std::span<const Hash> layer, std::span<Hash> out, uint64_t begin, uint64_t end) {
+  // Enough pairs to fill the widest sha3Batch kernel
+  BytesArr<64> pairs[8];
+  BytesArrView views[8];
+  for (uint64_t i = begin; i < end; i += 8) {
+    uint64_t count = std::min<uint64_t>(8, end - i);
+    for (uint64_t j = 0; j < count; j++) {
+      const Hash& a = layer[2 * (i + j)];
+      const Hash& b = layer[(2 * (i + j)) + 1];
+      const Hash& lo = std::min(a, b);
+      const Hash& hi = std::max(a, b);
+      std::copy(lo.cbegin(), lo.cend(), pairs[j].begin());
+      std::copy(hi.cbegin(), hi.cend(), pairs[j].begin() + 32);
+      views[j] = pairs[j];
+    }
+    Utils::sha3Batch(std::span<const BytesArrView>(views, count), out.subspan(i, count));
+  }
+}
+
+void Merkle::newLayer(std::span<const Hash> layer, std::span<Hash> out) {
+  const uint64_t pairCount = layer.size() / 2;
+  unsigned int thrNum = std::thread::hardware_concurrency();
+  if (thrNum <= 1 || pairCount < Merkle::parallelPairThreshold) {
+    hashPairs(layer, out, 0, pairCount);
+  } else {
+    // Divide pairs equally into one-time asyncs, remainder goes to the last one
+    uint64_t pairsPerThr = pairCount / thrNum;
+    std::vector<std::future<void>> f;
+    f.reserve(thrNum);
+    for (uint64_t i = 0; i < thrNum; i++) {
+      uint64_t begin = i * pairsPerThr;
+      uint64_t end = (i == thrNum - 1) ? pairCount : begin + pairsPerThr;
+      f.emplace_back(std::async(std::launch::async, [&layer, &out, begin, end]() {
+        hashPairs(layer, out, begin, end);
+      }));
+    }
+    for (auto& future : f) future.get();
+  }
+  // Odd element is carried over to the next layer as is
+  if (layer.size() % 2 != 0) out.back() = layer.back();
 }
 
 Merkle::Merkle(const std::vector<Hash>& leaves) {
+  this->allocate(leaves.size());
   // Mount the base leaves
-  std::vector<Hash> tmp;
-  for (const Hash& leaf : leaves) tmp.emplace_back(std::move(Utils::sha3(leaf.get())));
-  this->tree.emplace_back(tmp);
+  std::vector<BytesArrView> views;
+  views.reserve(leaves.size());
+  for (const Hash& leaf : leaves) views.emplace_back(leaf.view_const());
+  Utils::sha3Batch(views, std::span<Hash>(this->tree.data(), leaves.size()));
   // Make the layers up to root
-  while (this->tree.back().size() > 1) this->tree.emplace_back(newLayer(this->tree.back()));
+  this->build();
 }
 
 const std::vector<Hash> Merkle::getProof(const uint64_t leafIndex) const {
-  if (leafIndex > this->tree.front().size() - 1) return {};
-  std::vector<Hash> ret;
+  std::vector<Hash> ret(this->getLayerCount() - 1);
+  ret.resize(this->getProof(leafIndex, ret));
+  return ret;
+}
+
+uint64_t Merkle::getProof(const uint64_t leafIndex, std::span<Hash> out) const {
+  if (leafIndex >= this->getLeaves().size()) return 0;
+  if (out.size() < this->getLayerCount() - 1) throw std::invalid_argument(std::string(__func__)
+    + ": Proof buffer too small - expected " + std::to_string(this->getLayerCount() - 1) + ", got " + std::to_string(out.size())
+  );
+  uint64_t written = 0;
   uint64_t pos = leafIndex;
-  // Check if left (even) or right (odd) child, pick its sibling,
-  // move to the next layer, repeat until root layer then skip it
-  for (std::vector<Hash> layer : tree) {
-    if (layer.size() == 1) break;
-    pos = (pos % 2 == 0) ? pos + 1 : pos - 1;
-    ret.push_back(layer[pos]);
-    pos = std::ceil(pos / 2);
+  // Pick the sibling on each layer below the root, then move up to the parent.
+  // Carried-over odd nodes have no sibling, so they don't add to the proof.
+  for (uint64_t i = 0; i + 1 < this->getLayerCount(); i++) {
+    const uint64_t layerSize = this->layerOffsets[i + 1] - this->layerOffsets[i];
+    const uint64_t sibling = pos ^ 1;
+    if (sibling < layerSize) out[written++] = this->tree[this->layerOffsets[i] + sibling];
+    pos /= 2;
   }
-  return ret;
+  return written;
 }
 
-bool Merkle::verify(const std::vector<Hash>& proof, const Hash& leaf, const Hash& root) {
+bool Merkle::verify(std::span<const Hash> proof, const Hash& leaf, const Hash& root) {
   Hash computedHash = leaf;
-  for (const Hash& hash : proof) computedHash = Utils::sha3(
-    // Lambda to concatenate
-    Bytes([&]() -> Bytes {
-      Bytes bytes;
-      bytes.reserve(64);
-      Utils::appendBytes(bytes, std::min(computedHash, hash));
-      Utils::appendBytes(bytes, std::max(computedHash, hash));
-      return bytes;
-    }())
-  );
+  for (const Hash& hash : proof) computedHash = Merkle::hashPair(computedHash, hash);
   return computedHash == root;
 }
 
+Hash Merkle::hashPair(const Hash& a, const Hash& b) {
+  BytesArr<64> pair;
+  const Hash& lo = std::min(a, b);
+  const Hash& hi = std::max(a, b);
+  std::copy(lo.cbegin(), lo.cend(), pair.begin());
+  std::copy(hi.cbegin(), hi.cend(), pair.begin() + 32);
+  return Utils::sha3(pair);
+}
+
+void MerkleAccumulator::append(const Hash& leaf) {
+  // Merge with every full peak below, like a binary counter carry
+  Hash node = Utils::sha3(leaf.view_const());
+  uint64_t height = 0;
+  while (this->leafCount & (uint64_t(1) << height)) {
+    node = Merkle::hashPair(this->peaks[height], node);
+    height++;
+  }
+  if (height >= this->peaks.size()) this->peaks.resize(height + 1);
+  this->peaks[height] = node;
+  this->leafCount++;
+}
+
+const Hash MerkleAccumulator::getRoot() const {
+  // An odd node is carried up until it meets the next peak to its left,
+  // so fold the peaks from the smallest to the biggest
+  std::optional<Hash> root;
+  for (uint64_t height = 0; height < this->peaks.size(); height++) {
+    if (!(this->leafCount & (uint64_t(1) << height))) continue;
+    root = (root) ? Merkle::hashPair(this->peaks[height], *root) : this->peaks[height];
+  }
+  return (root) ? *root : Hash();
+}
@@ -1,6 +1,9 @@
 #ifndef MERKLE_H
 #define MERKLE_H
 
+#include <future>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -16,17 +19,45 @@
  * https://medium.com/coinmonks/implementing-merkle-tree-and-patricia-tree-b8badd6d9591
  *
  * https://lab.miguelmota.com/merkletreejs/example/
+ *
+ * The whole tree lives in a single contiguous array in level order
+ * (leaves first, root last), allocated once at construction.
+ * Pairs are hashed as sorted (min, max) concatenations, and an odd node
+ * at the end of a layer is carried over to the next layer unchanged.
  */
 class Merkle {
   private:
-    std::vector<std::vector<Hash>> tree;  ///< The %Merkle tree itself.
+    std::vector<Hash> tree;               ///< The %Merkle tree itself, flattened in level order.
+    std::vector<uint64_t> layerOffsets;   ///< Start index of each layer within `tree`, plus the end index.
+
+    /// Minimum number of pairs in a layer before it is hashed across multiple threads.
+    static const uint64_t parallelPairThreshold = 4096;
+
+    /**
+     * Compute the layer offsets for a given number of leaves and allocate the tree.
+     * @param leafCount The number of leaves.
+     */
+    void allocate(const uint64_t leafCount);
+
+    /// Build every layer above the leaves, which must already be filled in.
+    void build();
+
+    /**
+     * Hash a range of pairs from a layer into the next one.
+     * Pairs are concatenated into a small stack buffer and hashed in batches.
+     * @param layer The layer to hash.
+     * @param out The next layer (`(layer.size() + 1) / 2` hashes).
+     * @param begin The first pair to hash.
+     * @param end One past the last pair to hash.
+     */
+    static void hashPairs(std::span<const Hash> layer, std::span<Hash> out, uint64_t begin, uint64_t end);
 
     /**
-     * Insert a new layer in the %Merkle tree.
-     * @param layer The list of hashes to convert into a layer.
-     * @return The newly created layer.
+     * Hash a whole layer into the next one, in parallel if big enough.
+     * @param layer The layer to hash.
+     * @param out The next layer (`(layer.size() + 1) / 2` hashes).
      */
-    std::vector<Hash> newLayer(const std::vector<Hash>& layer) const;
+    static void newLayer(std::span<const Hash> layer, std::span<Hash> out);
 
   public:
     /**
@@ -41,25 +72,44 @@ class Merkle {
      * @param txs The list of transactions to create the %Merkle tree from.
      */
     template <typename TxType> Merkle(const std::vector<TxType>& txs) {
-      // Mount the base leaves
-      std::vector<Hash> tmp;
-      for (auto tx : txs) tmp.emplace_back(std::move(Utils::sha3(tx.hash().get())));
-      this->tree.emplace_back(tmp);
-      // Make the layers up to root
-      while (this->tree.back().size() > 1) this->tree.emplace_back(newLayer(this->tree.back()));
+      this->allocate(txs.size());
+      // Hash the txs (same as TxType::hash()) and then the leaves, both in batches
+      std::vector<Bytes> serialized;
+      serialized.reserve(txs.size());
+      for (const TxType& tx : txs) serialized.emplace_back(tx.rlpSerialize());
+      std::vector<BytesArrView> views(serialized.begin(), serialized.end());
+      std::vector<Hash> txHashes(txs.size());
+      Utils::sha3Batch(views, txHashes);
+      for (uint64_t i = 0; i < txHashes.size(); i++) views[i] = txHashes[i].view_const();
+      Utils::sha3Batch(views, std::span<Hash>(this->tree.data(), txs.size()));
+      this->build();
     }
 
-    /// Getter for `tree`.
-    inline const std::vector<std::vector<Hash>>& getTree() const { return this->tree; }
+    /// Getter for `tree`, flattened in level order (leaves first, root last).
+    inline const std::vector<Hash>& getTree() const { return this->tree; }
+
+    /// Get the number of layers in the tree, including leaves and root.
+    inline uint64_t getLayerCount() const { return this->layerOffsets.size() - 1; }
+
+    /**
+     * Get a given layer of the tree, without copying.
+     * @param layer The layer index (0 = leaves, `getLayerCount() - 1` = root).
+     * @return A view of the layer's hashes.
+     */
+    inline std::span<const Hash> getLayer(const uint64_t layer) const {
+      return std::span<const Hash>(this->tree).subspan(
+        this->layerOffsets[layer], this->layerOffsets[layer + 1] - this->layerOffsets[layer]
+      );
+    }
 
     /// Getter for `tree`, but returns only the root.
     inline const Hash getRoot() const {
-      if (this->tree.back().size() == 0) return Hash();
-      return this->tree.back().front();
+      if (this->tree.size() == 0) return Hash();
+      return this->tree.back();
     }
 
     /// Getter for `tree`, but returns only the leaves.
-    inline const std::vector<Hash>& getLeaves() const { return this->tree.front(); }
+    inline std::span<const Hash> getLeaves() const { return this->getLayer(0); }
 
     /**
      * Get the proof for a given leaf in the %Merkle tree.
@@ -70,6 +120,17 @@ class Merkle {
      */
     const std::vector<Hash> getProof(const uint64_t leafIndex) const;
 
+    /**
+     * Get the proof for a given leaf in the %Merkle tree, writing it into a
+     * caller-provided buffer (no allocations).
+     * @param leafIndex The index of the leaf to get the proof from.
+     * @param out The buffer to write the proof to. Must hold at least
+     *            `getLayerCount() - 1` hashes.
+     * @return The number of hashes written to `out` (0 if the leaf doesn't exist).
+     * @throw std::invalid_argument if `out` is too small.
+     */
+    uint64_t getProof(const uint64_t leafIndex, std::span<Hash> out) const;
+
     /**
      * Verify a leaf node's data integrity against its proof and the root hash.
      * @param proof The leaf's proof list as per getProof().
@@ -77,7 +138,42 @@ class Merkle {
      * @param root The tree's root.
      * @return `true` if the leaf node is valid, `false` otherwise.
      */
-    static bool verify(const std::vector<Hash>& proof, const Hash& leaf, const Hash& root);
+    static bool verify(std::span<const Hash> proof, const Hash& leaf, const Hash& root);
+
+    /**
+     * Hash a pair of nodes as a sorted (min, max) concatenation.
+     * @param a The first node.
+     * @param b The second node.
+     * @return The parent node.
+     */
+    static Hash hashPair(const Hash& a, const Hash& b);
+};
+
+/**
+ * Incremental %Merkle root accumulator.
+ * Keeps only the roots of the perfect subtrees ("peaks") built so far,
+ * one per bit set in the leaf count, so appending a leaf costs amortized O(1)
+ * hashes and getting the root costs O(log n) hashes. The resulting root is
+ * always the same as `Merkle(leaves).getRoot()` for the same leaves.
+ */
+class MerkleAccumulator {
+  private:
+    std::vector<Hash> peaks;          ///< Peak for each subtree height (2^i leaves), valid only if bit i of `leafCount` is set.
+    uint64_t leafCount = 0;           ///< Number of leaves appended so far.
+
+  public:
+    /**
+     * Append a leaf to the accumulator. The leaf is hashed the same way
+     * the Merkle constructor does before being merged.
+     * @param leaf The leaf to append.
+     */
+    void append(const Hash& leaf);
+
+    /// Getter for `leafCount`.
+    inline uint64_t size() const { return this->leafCount; }
+
+    /// Get the current root (empty hash if there are no leaves).
+    const Hash getRoot() const;
 };
 
 #endif  // MERKLE_H
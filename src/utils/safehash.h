@@ -1,6 +1,8 @@
 #ifndef HASH_H
 #define HASH_H
 
+#include <bit>
+#include <cstring>
 #include <memory>
 #include <boost/asio/ip/address.hpp>
 #include <boost/container_hash/hash.hpp>
@@ -110,15 +112,19 @@ struct SafeHash {
 
   /**
    * Wrapper for 'splitmix()'
+   * Addresses are already (truncated) Keccak hashes, so there's no need to run
+   * every byte through a generic hash: the words are just folded together
+   * and mixed once with the per-process seed.
    * @param address A Address (FixedBytes<20>) object
    * @returns The same as `splitmix()`
    */
   size_t operator()(const Address& address) const {
     static const uint64_t FIXED_RANDOM = clock::now().time_since_epoch().count();
-    // Faster hashing for 20 bytes of data.
-    uint32_t const* data = reinterpret_cast<uint32_t const*>(address.raw());
-    // 160 / 32 = 5
-    return splitmix(boost::hash_range(data, data + 5) + FIXED_RANDOM);
+    uint64_t a, b; uint32_t c;
+    std::memcpy(&a, address.raw(), 8);
+    std::memcpy(&b, address.raw() + 8, 8);
+    std::memcpy(&c, address.raw() + 16, 4);
+    return splitmix(a ^ std::rotl(b, 21) ^ std::rotl(uint64_t(c), 42) ^ FIXED_RANDOM);
   }
 
   /**
@@ -135,15 +141,20 @@ struct SafeHash {
 
   /**
    * Wrapper for `splitmix()`.
+   * Same as the Address overload, folding the four words of the hash.
    * @param hash A Hash object.
    * @returns The same as `splitmix()`.
    */
   size_t operator()(const Hash& hash) const {
     static const uint64_t FIXED_RANDOM = clock::now().time_since_epoch().count();
-    // Fast compatible object for hashing 32 bytes of data.
-    uint64_t const* data = reinterpret_cast<uint64_t const*>(hash.raw());
-    return splitmix(boost::hash_range(data, data + 4) + FIXED_RANDOM);
+    uint64_t a, b, c, d;
+    std::memcpy(&a, hash.raw(), 8);
+    std::memcpy(&b, hash.raw() + 8, 8);
+    std::memcpy(&c, hash.raw() + 16, 8);
+    std::memcpy(&d, hash.raw() + 24, 8);
+    return splitmix(a ^ std::rotl(b, 16) ^ std::rotl(c, 32) ^ std::rotl(d, 48) ^ FIXED_RANDOM);
   }
+
   /**
    * Wrapper for `splitmix()`.
    * @param tx A TxValidator object.
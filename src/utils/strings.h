@@ -66,6 +66,9 @@ template <unsigned N> class FixedBytes {
     /// Getter for `data`, but returns the C-style string.
     inline const Byte* raw() const { return this->data_.data(); }
 
+    /// Getter for `data`, but returns the mutable C-style string.
+    inline Byte* raw_non_const() { return this->data_.data(); }
+
     /// Create a Bytes object from the data string.
     inline const Bytes asBytes() const { return Bytes(this->data_.begin(), this->data_.end()); }
     /**
@@ -49,13 +49,13 @@ TxBlock::TxBlock(const BytesArrView bytes, const uint64_t& requiredChainId) {
   if (nonceLength != 0) {
     if (nonceLength > 0x37) throw std::runtime_error("Nonce is too large");
     index++; // Index at rlp[1] payload
-    this->nonce = Utils::fromBigEndian<uint64_t>(
+    this->nonce = U256::fromBigEndian(
       txData.subspan(index, nonceLength)
     );
     index += nonceLength; // Index at rlp[2] size
   } else {
     this->nonce = (txData[index] == 0x80)
-                    ? 0 : Utils::fromBigEndian<uint64_t>(txData.subspan(index, 1));
+                    ? 0 : U256::fromBigEndian(txData.subspan(index, 1));
     index++; // Index at rlp[2] size
   }
 
@@ -66,13 +66,13 @@ TxBlock::TxBlock(const BytesArrView bytes, const uint64_t& requiredChainId) {
   if (maxPriorityFeePerGasLength != 0) {
     if (maxPriorityFeePerGasLength > 0x37) throw std::runtime_error("MaxPriorityFeePerGas is too large");
     index++; // Index at rlp[2] payload
-    this->maxPriorityFeePerGas = Utils::fromBigEndian<uint256_t>(
+    this->maxPriorityFeePerGas = U256::fromBigEndian(
       txData.subspan(index, maxPriorityFeePerGasLength)
     );
     index += maxPriorityFeePerGasLength; // Index at rlp[3] size
   } else {
     this->maxPriorityFeePerGas = txData[index] == 0x80
-                  ? 0 : Utils::fromBigEndian<uint256_t>(txData.subspan(index, 1));
+                  ? 0 : U256::fromBigEndian(txData.subspan(index, 1));
     index++; // Index at rlp[3] size
   }
 
@@ -83,13 +83,13 @@ TxBlock::TxBlock(const BytesArrView bytes, const uint64_t& requiredChainId) {
   if (maxFeePerGasLength != 0) {
     if (maxFeePerGasLength > 0x37) throw std::runtime_error("MaxFeePerGas is too large");
     index++; // Index at rlp[3] payload
-    this->maxFeePerGas = Utils::fromBigEndian<uint256_t>(
+    this->maxFeePerGas = U256::fromBigEndian(
       txData.subspan(index, maxFeePerGasLength)
     );
     index += maxFeePerGasLength; // Index at rlp[4] size
   } else {
     this->maxFeePerGas = txData[index] == 0x80
-                                 ? 0 : Utils::fromBigEndian<uint256_t>(txData.subspan(index, 1));
+                                 ? 0 : U256::fromBigEndian(txData.subspan(index, 1));
     index++; // Index at rlp[4] size
   }
 
@@ -100,13 +100,13 @@ TxBlock::TxBlock(const BytesArrView bytes, const uint64_t& requiredChainId) {
   if (gasLimitLength != 0) {
     if (gasLimitLength > 0x37) throw std::runtime_error("GasLimit is too large");
     index++; // Index at rlp[0] payload
-    this->gasLimit = Utils::fromBigEndian<uint64_t>(
+    this->gasLimit = U256::fromBigEndian(
       txData.subspan(index, gasLimitLength)
     );
     index += gasLimitLength; // Index at rlp[1] size
   } else {
     this->gasLimit = txData[index] == 0x80
-                    ? 0 : Utils::fromBigEndian<uint64_t>(txData.subspan(index, 1));
+                    ? 0 : U256::fromBigEndian(txData.subspan(index, 1));
     index++; // Index at rlp[1] size
   }
 
@@ -124,13 +124,13 @@ TxBlock::TxBlock(const BytesArrView bytes, const uint64_t& requiredChainId) {
   if (valueLength != 0) {
     if (valueLength > 0x37) throw std::runtime_error("Value is not a small string");
     index++; // Index at rlp[6] payload
-    this->value = Utils::fromBigEndian<uint256_t>(
+    this->value = U256::fromBigEndian(
       txData.subspan(index, valueLength)
     );
     index += valueLength; // Index at rlp[7] size
   } else {
     this->value = txData[index] == 0x80
-      ? 0 : Utils::fromBigEndian<uint256_t>(txData.subspan(index, 1));
+      ? 0 : U256::fromBigEndian(txData.subspan(index, 1));
     index++; // Index at rlp[7] size
   }
 
@@ -223,8 +223,7 @@ TxBlock::TxBlock(
   }
 }
 
-Bytes TxBlock::rlpSerialize(bool includeSig) const {
-  Bytes ret = { 0x02 };
+uint64_t TxBlock::rlpPayloadSize(bool includeSig) const {
   uint64_t total_size = 0;
   uint64_t reqBytesChainId = Utils::bytesRequired(this->chainId);
   uint64_t reqBytesNonce = Utils::bytesRequired(this->nonce);
@@ -259,14 +258,39 @@ Bytes TxBlock::rlpSerialize(bool includeSig) const {
     total_size += 1 + reqBytesR;
     total_size += 1 + reqBytesS;
   }
+  return total_size;
+}
+
+uint64_t TxBlock::rlpSize(bool includeSig) const {
+  uint64_t total_size = this->rlpPayloadSize(includeSig);
+  return 1 + ((total_size <= 55) ? 1 : 1 + Utils::bytesRequired(total_size)) + total_size;
+}
+
+Bytes TxBlock::rlpSerialize(bool includeSig) const {
+  Bytes ret;
+  ret.reserve(this->rlpSize(includeSig));
+  this->rlpSerialize(ret, includeSig);
+  return ret;
+}
+
+void TxBlock::rlpSerialize(Bytes& ret, bool includeSig) const {
+  ret.insert(ret.end(), 0x02);
+  uint64_t total_size = this->rlpPayloadSize(includeSig);
+  uint64_t reqBytesChainId = Utils::bytesRequired(this->chainId);
+  uint64_t reqBytesNonce = Utils::bytesRequired(this->nonce);
+  uint64_t reqBytesMaxPriorityFeePerGas = Utils::bytesRequired(this->maxPriorityFeePerGas);
+  uint64_t reqBytesMaxFeePerGas = Utils::bytesRequired(this->maxFeePerGas);
+  uint64_t reqBytesGasLimit = Utils::bytesRequired(this->gasLimit);
+  uint64_t reqBytesValue = Utils::bytesRequired(this->value);
+  uint64_t reqBytesData = this->data.size();
+  uint64_t reqBytesR = Utils::bytesRequired(this->r);
+  uint64_t reqBytesS = Utils::bytesRequired(this->s);
 
   // Serialize everything
   if (total_size <= 55) {
-    ret.reserve(total_size + 1);
     ret.insert(ret.end(), char(total_size + 0xc0));
   } else {
     uint64_t sizeBytes = Utils::bytesRequired(total_size);
-    ret.reserve(total_size + sizeBytes + 1);
     ret.insert(ret.end(), char(sizeBytes + 0xf7));
     Utils::appendBytes(ret, Utils::uintToBytes(total_size));
   }
@@ -369,7 +393,6 @@ Bytes TxBlock::rlpSerialize(bool includeSig) const {
     ret.insert(ret.end(), char(reqBytesS + 0x80));
     Utils::appendBytes(ret, Utils::uintToBytes(this->s));
   }
-  return ret;
 }
 
 ethCallInfo TxBlock::txToCallInfo() const {
@@ -522,8 +545,7 @@ TxValidator::TxValidator(
   }
 }
 
-Bytes TxValidator::rlpSerialize(bool includeSig) const {
-  Bytes ret;
+uint64_t TxValidator::rlpPayloadSize(bool includeSig) const {
   uint64_t total_size = 0;
   uint64_t reqBytesData = this->data.size();
   uint64_t reqBytesnHeight = Utils::bytesRequired(this->nHeight);
@@ -550,14 +572,34 @@ Bytes TxValidator::rlpSerialize(bool includeSig) const {
 
   total_size += (!includeSig) ? 1 : 1 + reqBytesR;
   total_size += (!includeSig) ? 1 : 1 + reqBytesS;
+  return total_size;
+}
+
+uint64_t TxValidator::rlpSize(bool includeSig) const {
+  uint64_t total_size = this->rlpPayloadSize(includeSig);
+  return ((total_size <= 55) ? 1 : 1 + Utils::bytesRequired(total_size)) + total_size;
+}
+
+Bytes TxValidator::rlpSerialize(bool includeSig) const {
+  Bytes ret;
+  ret.reserve(this->rlpSize(includeSig));
+  this->rlpSerialize(ret, includeSig);
+  return ret;
+}
+
+void TxValidator::rlpSerialize(Bytes& ret, bool includeSig) const {
+  uint64_t total_size = this->rlpPayloadSize(includeSig);
+  uint64_t reqBytesData = this->data.size();
+  uint64_t reqBytesnHeight = Utils::bytesRequired(this->nHeight);
+  uint64_t reqBytesV = Utils::bytesRequired((includeSig) ? this->v : this->chainId);
+  uint64_t reqBytesR = Utils::bytesRequired(this->r);
+  uint64_t reqBytesS = Utils::bytesRequired(this->s);
 
   // Serialize everything
   if (total_size <= 55) {
-    ret.reserve(total_size + 1);
     ret.insert(ret.end(), total_size + 0xc0);
   } else {
     uint64_t sizeBytes = Utils::bytesRequired(total_size);
-    ret.reserve(total_size + sizeBytes + 1);
     ret.insert(ret.end(), sizeBytes + 0xf7);
     Utils::appendBytes(ret, Utils::uintToBytes(total_size));
   }
@@ -616,7 +658,5 @@ Bytes TxValidator::rlpSerialize(bool includeSig) const {
     ret.insert(ret.end(), reqBytesS + 0x80);
     Utils::appendBytes(ret, Utils::uintToBytes(this->s));
   }
-
-  return ret;
 }
 
@@ -15,16 +15,23 @@ class TxBlock {
     Address from;                   ///< Sender address.
     Bytes data;               ///< Arbitrary data (e.g. for contracts).
     uint64_t chainId;               ///< Chain ID where the tx will be broadcast.
-    uint256_t nonce;                ///< Sender address nonce.
-    uint256_t value;                ///< Value, in Wei.
-    uint256_t maxPriorityFeePerGas; ///< Max priority fee per gas, as per [EIP-1559](https://eips.ethereum.org/EIPS/eip-1559), in Wei.
-    uint256_t maxFeePerGas;         ///< Max fee per gas, as per [EIP-1559](https://eips.ethereum.org/EIPS/eip-1559), in Wei.
-    uint256_t gasLimit;             ///< Gas limit.
+    U256 nonce;                     ///< Sender address nonce.
+    U256 value;                     ///< Value, in Wei.
+    U256 maxPriorityFeePerGas;      ///< Max priority fee per gas, as per [EIP-1559](https://eips.ethereum.org/EIPS/eip-1559), in Wei.
+    U256 maxFeePerGas;              ///< Max fee per gas, as per [EIP-1559](https://eips.ethereum.org/EIPS/eip-1559), in Wei.
+    U256 gasLimit;                  ///< Gas limit.
     void* accessList = nullptr;     ///< Access list (not implemented).
     uint8_t v;                      ///< ECDSA recovery ID.
     uint256_t r;                    ///< ECDSA first half.
     uint256_t s;                    ///< ECDSA second half.
 
+    /**
+     * Get the size of the RLP list payload (everything after the list prefix).
+     * @param includeSig If `true`, includes the transaction signature (v/r/s).
+     * @return The payload size, in bytes.
+     */
+    uint64_t rlpPayloadSize(bool includeSig) const;
+
   public:
     /**
      * Raw constructor.
@@ -99,20 +106,43 @@ class TxBlock {
     /// Getter for `chainId`.
     inline const uint64_t& getChainId() const { return this->chainId; }
 
-    /// Getter for `nonce`.
-    inline const uint256_t& getNonce() const { return this->nonce; }
+    /// Getter for `nonce`, converted to `uint256_t`.
+    inline const uint256_t getNonce() const { return this->nonce.toBoost(); }
+
+    /// Getter for `value`, converted to `uint256_t`.
+    inline const uint256_t getValue() const { return this->value.toBoost(); }
+
+    /// Getter for `maxPriorityFeePerGas`, converted to `uint256_t`.
+    inline const uint256_t getMaxPriorityFeePerGas() const { return this->maxPriorityFeePerGas.toBoost(); }
 
-    /// Getter for `value`.
-    inline const uint256_t& getValue() const { return this->value; }
+    /// Getter for `maxPerGas`, converted to `uint256_t`.
+    inline const uint256_t getMaxFeePerGas() const { return this->maxFeePerGas.toBoost(); }
 
-    /// Getter for `maxPriorityFeePerGas`.
-    inline const uint256_t& getMaxPriorityFeePerGas() const { return this->maxPriorityFeePerGas; }
+    /// Getter for `gasLimit`, converted to `uint256_t`.
+    inline const uint256_t getGasLimit() const { return this->gasLimit.toBoost(); }
 
-    /// Getter for `maxPerGas`.
-    inline const uint256_t& getMaxFeePerGas() const { return this->maxFeePerGas; }
+    /// Getter for `nonce`, native type.
+    inline const U256& getNonceU256() const { return this->nonce; }
 
-    /// Getter for `gasLimit`.
-    inline const uint256_t& getGasLimit() const { return this->gasLimit; }
+    /// Getter for `value`, native type.
+    inline const U256& getValueU256() const { return this->value; }
+
+    /// Getter for `maxPriorityFeePerGas`, native type.
+    inline const U256& getMaxPriorityFeePerGasU256() const { return this->maxPriorityFeePerGas; }
+
+    /// Getter for `maxFeePerGas`, native type.
+    inline const U256& getMaxFeePerGasU256() const { return this->maxFeePerGas; }
+
+    /// Getter for `gasLimit`, native type.
+    inline const U256& getGasLimitU256() const { return this->gasLimit; }
+
+    /**
+     * Get the maximum amount the sender can be charged by this transaction
+     * (`value + (gasLimit * maxFeePerGas)`).
+     * @return The maximum cost of the transaction, in Wei.
+     * @throw std::overflow_error if the cost doesn't fit in 256 bits.
+     */
+    inline const U256 getMaxCost() const { return this->value + (this->gasLimit * this->maxFeePerGas); }
 
     /// Getter for `v`.
     inline const uint8_t& getV() const { return this->v; }
@@ -147,6 +177,23 @@ class TxBlock {
      */
     Bytes rlpSerialize(bool includeSig = true) const;
 
+    /**
+     * Serialize the transaction in RLP format, appending it to an existing buffer.
+     * Lets callers pack several transactions into one buffer without temporaries.
+     * @param out The buffer to append to.
+     * @param includeSig (optional) If `true`, includes the transaction signature (v/r/s).
+     *                   Defaults to `true`.
+     */
+    void rlpSerialize(Bytes& out, bool includeSig = true) const;
+
+    /**
+     * Get the exact size of the RLP-serialized transaction without serializing it.
+     * @param includeSig (optional) If `true`, includes the transaction signature (v/r/s).
+     *                   Defaults to `true`.
+     * @return The size of `rlpSerialize(includeSig)`, in bytes.
+     */
+    uint64_t rlpSize(bool includeSig = true) const;
+
     /**
      * Convert a TxBlock to a ethCallInfo object
      * @param txBlock The TxBlock to convert.
@@ -209,6 +256,13 @@ class TxValidator {
     uint256_t r;        ///< ECDSA first half.
     uint256_t s;        ///< ECDSA second half.
 
+    /**
+     * Get the size of the RLP list payload (everything after the list prefix).
+     * @param includeSig If `true`, includes the transaction signature (v/r/s).
+     * @return The payload size, in bytes.
+     */
+    uint64_t rlpPayloadSize(bool includeSig) const;
+
   public:
     /**
      * Raw constructor.
@@ -302,6 +356,23 @@ class TxValidator {
      */
     Bytes rlpSerialize(bool includeSig = true) const;
 
+    /**
+     * Serialize the transaction in RLP format, appending it to an existing buffer.
+     * Lets callers pack several transactions into one buffer without temporaries.
+     * @param out The buffer to append to.
+     * @param includeSig (optional) If `true`, includes the transaction signature (v/r/s).
+     *                   Defaults to `true`.
+     */
+    void rlpSerialize(Bytes& out, bool includeSig = true) const;
+
+    /**
+     * Get the exact size of the RLP-serialized transaction without serializing it.
+     * @param includeSig (optional) If `true`, includes the transaction signature (v/r/s).
+     *                   Defaults to `true`.
+     * @return The size of `rlpSerialize(includeSig)`, in bytes.
+     */
+    uint64_t rlpSize(bool includeSig = true) const;
+
     /// Copy assignment operator.
     TxValidator& operator=(const TxValidator& other) {
       this->from = other.from;
@@ -0,0 +1,119 @@
+#include "uint256.h"
+
+U256 U256::fromBigEndian(const BytesArrView bytes) {
+  if (bytes.size() > 32) throw std::length_error(std::string(__func__)
+    + ": Invalid bytes size - expected at most 32, got " + std::to_string(bytes.size())
+  );
+  U256 ret;
+  // Walk the string from its least significant byte, filling limbs from the bottom up.
+  unsigned shift = 0;
+  unsigned limb = 0;
+  for (auto it = bytes.rbegin(); it != bytes.rend(); it++) {
+    ret.limbs_[limb] |= uint64_t(*it) << shift;
+    shift += 8;
+    if (shift == 64) { shift = 0; limb++; }
+  }
+  return ret;
+}
+
+BytesArr<32> U256::toBigEndian() const {
+  BytesArr<32> ret;
+  for (unsigned i = 0; i < 4; i++) {
+    const uint64_t& l = this->limbs_[3 - i];
+    for (unsigned j = 0; j < 8; j++) ret[(i * 8) + j] = Byte(l >> (56 - (j * 8)));
+  }
+  return ret;
+}
+
+Bytes U256::toTrimmedBytes() const {
+  BytesArr<32> full = this->toBigEndian();
+  return Bytes(full.end() - this->bytesRequired(), full.end());
+}
+
+U256 U256::fromBoost(const uint256_t& value) {
+  // export_bits writes the most significant chunk first, and only as many chunks as needed.
+  std::array<uint64_t, 4> chunks{};
+  auto end = boost::multiprecision::export_bits(value, chunks.begin(), 64);
+  unsigned count = end - chunks.begin();
+  U256 ret;
+  for (unsigned i = 0; i < count; i++) ret.limbs_[i] = chunks[count - 1 - i];
+  return ret;
+}
+
+uint256_t U256::toBoost() const {
+  uint256_t ret;
+  boost::multiprecision::import_bits(ret, this->limbs_.rbegin(), this->limbs_.rend(), 64);
+  return ret;
+}
+
+uint64_t U256::mod64(uint64_t divisor) const {
+  if (divisor == 0) throw std::domain_error(std::string(__func__) + ": Division by zero");
+  unsigned __int128 rem = 0;
+  for (int i = 3; i >= 0; i--) rem = ((rem << 64) | this->limbs_[i]) % divisor;
+  return uint64_t(rem);
+}
+
+U256& U256::operator+=(const U256& other) {
+  uint64_t carry = 0;
+  for (unsigned i = 0; i < 4; i++) {
+    unsigned __int128 sum = (unsigned __int128)this->limbs_[i] + other.limbs_[i] + carry;
+    this->limbs_[i] = uint64_t(sum);
+    carry = uint64_t(sum >> 64);
+  }
+  if (carry) throw std::overflow_error("U256: Addition overflow");
+  return *this;
+}
+
+U256& U256::operator-=(const U256& other) {
+  if (*this < other) throw std::underflow_error("U256: Subtraction result is negative");
+  uint64_t borrow = 0;
+  for (unsigned i = 0; i < 4; i++) {
+    uint64_t a = this->limbs_[i];
+    uint64_t diff = a - other.limbs_[i] - borrow;
+    borrow = (a < other.limbs_[i]) || (a - other.limbs_[i] < borrow);
+    this->limbs_[i] = diff;
+  }
+  return *this;
+}
+
+U256& U256::operator*=(const U256& other) {
+  // Schoolbook multiplication, keeping the high half to detect overflow.
+  std::array<uint64_t, 8> res{};
+  for (unsigned i = 0; i < 4; i++) {
+    if (this->limbs_[i] == 0) continue;
+    uint64_t carry = 0;
+    for (unsigned j = 0; j < 4; j++) {
+      unsigned __int128 cur = (unsigned __int128)this->limbs_[i] * other.limbs_[j] + res[i + j] + carry;
+      res[i + j] = uint64_t(cur);
+      carry = uint64_t(cur >> 64);
+    }
+    res[i + 4] = carry;
+  }
+  if (res[4] | res[5] | res[6] | res[7]) throw std::overflow_error("U256: Multiplication overflow");
+  for (unsigned i = 0; i < 4; i++) this->limbs_[i] = res[i];
+  return *this;
+}
+
+U256& U256::operator>>=(unsigned shift) {
+  if (shift >= 256) { *this = U256(); return *this; }
+  const unsigned limbShift = shift / 64;
+  const unsigned bitShift = shift % 64;
+  for (unsigned i = 0; i < 4; i++) {
+    uint64_t lo = (i + limbShift < 4) ? this->limbs_[i + limbShift] : 0;
+    uint64_t hi = (i + limbShift + 1 < 4) ? this->limbs_[i + limbShift + 1] : 0;
+    this->limbs_[i] = (bitShift == 0) ? lo : (lo >> bitShift) | (hi << (64 - bitShift));
+  }
+  return *this;
+}
+
+U256& U256::operator<<=(unsigned shift) {
+  if (shift >= 256) { *this = U256(); return *this; }
+  const unsigned limbShift = shift / 64;
+  const unsigned bitShift = shift % 64;
+  for (int i = 3; i >= 0; i--) {
+    uint64_t hi = (i - int(limbShift) >= 0) ? this->limbs_[i - limbShift] : 0;
+    uint64_t lo = (i - int(limbShift) - 1 >= 0) ? this->limbs_[i - limbShift - 1] : 0;
+    this->limbs_[i] = (bitShift == 0) ? hi : (hi << bitShift) | (lo >> (64 - bitShift));
+  }
+  return *this;
+}
@@ -0,0 +1,165 @@
+#ifndef UINT256_H
+#define UINT256_H
+
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "hex.h"
+
+/**
+ * Native fixed-width 256-bit unsigned integer.
+ * Stored as four 64-bit limbs (least significant limb first), trivially copyable
+ * and free of heap/backend overhead, so it is meant for consensus hot paths
+ * (tx fields, account balances, fee math). Arithmetic is *checked*, same as the
+ * boost-based `uint256_t` used everywhere else: overflow/underflow throws.
+ * Convert to/from `uint256_t` with `toBoost()`/`fromBoost()` at API boundaries.
+ */
+class U256 {
+  private:
+    std::array<uint64_t, 4> limbs_; ///< Limbs, least significant first.
+
+  public:
+    /// Default constructor (zero).
+    constexpr U256() : limbs_{0, 0, 0, 0} {}
+
+    /// Constructor from a 64-bit unsigned integer.
+    constexpr U256(uint64_t value) : limbs_{value, 0, 0, 0} {}
+
+    /// Constructor from raw limbs (least significant first).
+    constexpr U256(uint64_t l0, uint64_t l1, uint64_t l2, uint64_t l3) : limbs_{l0, l1, l2, l3} {}
+
+    /// Constructor from the boost type.
+    explicit U256(const uint256_t& value) : U256(U256::fromBoost(value)) {}
+
+    /// Getter for a given limb (0 = least significant).
+    constexpr const uint64_t& limb(unsigned i) const { return this->limbs_[i]; }
+
+    /// Check if the value is zero.
+    constexpr bool isZero() const {
+      return (this->limbs_[0] | this->limbs_[1] | this->limbs_[2] | this->limbs_[3]) == 0;
+    }
+
+    /// Check if the value fits within 64 bits.
+    constexpr bool fitsUint64() const {
+      return (this->limbs_[1] | this->limbs_[2] | this->limbs_[3]) == 0;
+    }
+
+    /// Explicit bool conversion, `true` if non-zero.
+    constexpr explicit operator bool() const { return !this->isZero(); }
+
+    /// Explicit integral conversion. Truncates to the lowest bits, same as `uint256_t`.
+    template <typename T> requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    constexpr explicit operator T() const { return static_cast<T>(this->limbs_[0]); }
+
+    /// Number of significant bytes (0 for zero).
+    constexpr unsigned bytesRequired() const {
+      for (int i = 3; i >= 0; i--) {
+        if (this->limbs_[i] != 0) {
+          return (i * 8) + ((64 - std::countl_zero(this->limbs_[i]) + 7) / 8);
+        }
+      }
+      return 0;
+    }
+
+    /**
+     * Load a big-endian bytes string (up to 32 bytes).
+     * @param bytes The bytes to load.
+     * @return The loaded integer.
+     * @throw std::length_error if the string is larger than 32 bytes.
+     */
+    static U256 fromBigEndian(const BytesArrView bytes);
+
+    /// Store as a 32-byte big-endian array (zero-padded).
+    BytesArr<32> toBigEndian() const;
+
+    /// Store as a big-endian bytes string without leading zeroes (empty for zero).
+    Bytes toTrimmedBytes() const;
+
+    /// Convert from the boost type.
+    static U256 fromBoost(const uint256_t& value);
+
+    /// Convert to the boost type.
+    uint256_t toBoost() const;
+
+    /// Decimal string representation.
+    std::string str() const { return this->toBoost().str(); }
+
+    /**
+     * Modulo by a 64-bit divisor, without going through a full division.
+     * @param divisor The divisor.
+     * @return The remainder.
+     * @throw std::domain_error if divisor is zero.
+     */
+    uint64_t mod64(uint64_t divisor) const;
+
+    /// Checked addition. @throw std::overflow_error on overflow.
+    U256& operator+=(const U256& other);
+
+    /// Checked subtraction. @throw std::underflow_error if the result would be negative.
+    U256& operator-=(const U256& other);
+
+    /// Checked multiplication. @throw std::overflow_error on overflow.
+    U256& operator*=(const U256& other);
+
+    /// Right shift.
+    U256& operator>>=(unsigned shift);
+
+    /// Left shift (bits shifted past 256 are discarded).
+    U256& operator<<=(unsigned shift);
+
+    /// Prefix increment (checked).
+    U256& operator++() { return *this += U256(1); }
+
+    /// Checked addition.
+    friend U256 operator+(U256 lhs, const U256& rhs) { lhs += rhs; return lhs; }
+
+    /// Checked subtraction.
+    friend U256 operator-(U256 lhs, const U256& rhs) { lhs -= rhs; return lhs; }
+
+    /// Checked multiplication.
+    friend U256 operator*(U256 lhs, const U256& rhs) { lhs *= rhs; return lhs; }
+
+    /// Right shift.
+    friend U256 operator>>(U256 lhs, unsigned shift) { lhs >>= shift; return lhs; }
+
+    /// Left shift.
+    friend U256 operator<<(U256 lhs, unsigned shift) { lhs <<= shift; return lhs; }
+
+    /// Bitwise AND with a 64-bit mask.
+    friend constexpr U256 operator&(const U256& lhs, uint64_t mask) { return U256(lhs.limbs_[0] & mask); }
+
+    /// Equality operator.
+    friend constexpr bool operator==(const U256& lhs, const U256& rhs) = default;
+
+    /// Equality operator against a 64-bit value.
+    friend constexpr bool operator==(const U256& lhs, uint64_t rhs) {
+      return lhs.fitsUint64() && lhs.limbs_[0] == rhs;
+    }
+
+    /// Three-way comparison, from the most significant limb down.
+    friend constexpr std::strong_ordering operator<=>(const U256& lhs, const U256& rhs) {
+      for (int i = 3; i >= 0; i--) {
+        if (lhs.limbs_[i] != rhs.limbs_[i]) return lhs.limbs_[i] <=> rhs.limbs_[i];
+      }
+      return std::strong_ordering::equal;
+    }
+
+    /// Three-way comparison against a 64-bit value.
+    friend constexpr std::strong_ordering operator<=>(const U256& lhs, uint64_t rhs) {
+      if (!lhs.fitsUint64()) return std::strong_ordering::greater;
+      return lhs.limbs_[0] <=> rhs;
+    }
+
+    /// Maximum representable value.
+    static constexpr U256 max() { return U256(UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX); }
+};
+
+static_assert(std::is_trivially_copyable_v<U256>, "U256 must be trivially copyable");
+static_assert(sizeof(U256) == 32, "U256 must be exactly 256 bits wide");
+
+#endif  // UINT256_H
@@ -1,4 +1,5 @@
 #include "utils.h"
+#include "keccak.h"
 
 std::mutex log_lock;
 std::mutex debug_mutex;
@@ -10,6 +11,24 @@ void fail(const std::string& cl, std::string&& func, boost::beast::error_code ec
   Logger::logToDebug(LogType::ERROR, cl, std::move(func), std::string("HTTP Fail ") + what + " : " + ec.message());
 }
 
+Account::Account(const BytesArrView bytes) {
+  if (bytes.size() != Account::serializedSize) throw std::runtime_error(std::string(__func__)
+    + ": Invalid account size - expected " + std::to_string(Account::serializedSize)
+    + ", got " + std::to_string(bytes.size())
+  );
+  this->balance = U256::fromBigEndian(bytes.subspan(0, 32));
+  this->nonce = Utils::bytesToUint64(bytes.subspan(32, 8));
+}
+
+BytesArr<40> Account::serialize() const {
+  BytesArr<40> ret;
+  BytesArr<32> balanceBytes = this->balance.toBigEndian();
+  BytesArr<8> nonceBytes = Utils::uint64ToBytes(this->nonce);
+  std::copy(balanceBytes.cbegin(), balanceBytes.cend(), ret.begin());
+  std::copy(nonceBytes.cbegin(), nonceBytes.cend(), ret.begin() + 32);
+  return ret;
+}
+
 void Utils::logToFile(std::string_view str) {
   // Lock to prevent multiple memory writes
   std::lock_guard lock(log_lock);
@@ -31,6 +50,33 @@ Hash Utils::sha3(const BytesArrView input) {
   return std::move(ret);
 }
 
+void Utils::sha3Batch(std::span<const BytesArrView> inputs, std::span<Hash> out) {
+  if (out.size() < inputs.size()) throw std::invalid_argument(std::string(__func__)
+    + ": Output size " + std::to_string(out.size()) + " is smaller than input size " + std::to_string(inputs.size())
+  );
+  const Keccak::Impl impl = Keccak::detectImpl();
+  size_t i = 0;
+  if (impl == Keccak::Impl::AVX512) {
+    for (; i + 8 <= inputs.size(); i += 8) {
+      const uint8_t* in[8]; size_t inLen[8]; uint8_t* res[8];
+      for (unsigned l = 0; l < 8; l++) {
+        in[l] = inputs[i + l].data(); inLen[l] = inputs[i + l].size(); res[l] = out[i + l].raw_non_const();
+      }
+      Keccak::keccak256x8(in, inLen, res);
+    }
+  }
+  if (impl == Keccak::Impl::AVX512 || impl == Keccak::Impl::AVX2) {
+    for (; i + 4 <= inputs.size(); i += 4) {
+      const uint8_t* in[4]; size_t inLen[4]; uint8_t* res[4];
+      for (unsigned l = 0; l < 4; l++) {
+        in[l] = inputs[i + l].data(); inLen[l] = inputs[i + l].size(); res[l] = out[i + l].raw_non_const();
+      }
+      Keccak::keccak256x4(in, inLen, res);
+    }
+  }
+  for (; i < inputs.size(); i++) out[i] = Utils::sha3(inputs[i]);
+}
+
 BytesArr<32> Utils::uint256ToBytes(const uint256_t& i) {
   BytesArr<32> ret;
   Bytes tmp;
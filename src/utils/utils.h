@@ -21,6 +21,7 @@
 #include <openssl/rand.h>
 
 #include "strings.h"
+#include "uint256.h"
 #include "logger.h"
 
 #include "json.hpp"
@@ -95,17 +96,31 @@ enum Networks { Mainnet, Testnet, LocalTestnet };
  * See `nativeAccounts` on State for more info.
  */
 struct Account {
-  uint256_t balance = 0;  ///< Account balance.
+  U256 balance = 0;       ///< Account balance.
   uint64_t nonce = 0;     ///< Account nonce.
 
   /// Default Constructor.
   Account() {}
 
-  /// Copy Constructor.
-  Account(const uint256_t& balance, const uint64_t& nonce) : balance(balance), nonce(nonce) {}
+  /// Constructor.
+  Account(const U256& balance, const uint64_t& nonce) : balance(balance), nonce(nonce) {}
 
-  /// Move Constructor.
-  Account(uint256_t&& balance, uint64_t&& nonce) : balance(std::move(balance)), nonce(std::move(nonce)) {}
+  /// Size of a serialized account, in bytes (32 bytes for the balance + 8 bytes for the nonce).
+  static const uint64_t serializedSize = 40;
+
+  /**
+   * Constructor from fixed-width bytes (see serialize()).
+   * @param bytes The serialized account.
+   * @throw std::runtime_error if `bytes` isn't exactly `serializedSize` bytes long.
+   */
+  explicit Account(const BytesArrView bytes);
+
+  /**
+   * Serialize the account in a fixed-width encoding, as stored in the database:
+   * 32-byte big-endian balance + 8-byte big-endian nonce.
+   * @return The serialized account.
+   */
+  BytesArr<40> serialize() const;
 };
 
 /// Namespace for utility functions.
@@ -146,6 +161,17 @@ namespace Utils {
    */
   Hash sha3(const BytesArrView input);
 
+  /**
+   * %Hash multiple independent inputs using SHA3, several at a time.
+   * Uses a multi-lane Keccak kernel (AVX-512 or AVX2, picked at runtime
+   * based on the CPU) and falls back to sha3() for leftovers or when
+   * neither is available. Results are identical to calling sha3() on each input.
+   * @param inputs The strings to hash.
+   * @param out The output hashes, in the same order as `inputs`.
+   * @throw std::invalid_argument if `out` is smaller than `inputs`.
+   */
+  void sha3Batch(std::span<const BytesArrView> inputs, std::span<Hash> out);
+
   /**
    * Convert a 256-bit unsigned integer to a bytes string.
    * Use `Hex()` to properly print it.
@@ -375,6 +401,12 @@ namespace Utils {
     return ret;
   }
 
+  /// Overload of bytesRequired() for U256, counting limbs instead of shifting byte by byte.
+  inline unsigned bytesRequired(const U256& i) { return i.bytesRequired(); }
+
+  /// Overload of uintToBytes() for U256, storing the limbs directly.
+  inline Bytes uintToBytes(const U256& i) { return i.toTrimmedBytes(); }
+
   /**
   * Get the real type name of a type.
   * For example, `getRealTypeName<std::string>()` will return "std::basic_string<char, std::char_traits<char>, std::allocator<char> >"
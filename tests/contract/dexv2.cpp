@@ -396,6 +396,15 @@ namespace TDEXV2 {
           std::cout << "Contract type " << contracts.first << " is deployed at Address: " << contracts.second.hex() << std::endl;
         }
 
+        // The pair was saved with the block that added the liquidity, its LP token balances included
+        Address pair;
+        for (const auto& [name, address] : state->getContracts()) if (name == "DEXV2Pair") pair = address;
+        REQUIRE(pair != Address());
+        Bytes balancesPrefix = DBPrefix::contracts;
+        Utils::appendBytes(balancesPrefix, pair);
+        Utils::appendBytes(balancesPrefix, Utils::stringToBytes("_balances"));
+        REQUIRE(Utils::fromBigEndian<uint256_t>(db->get(owner.get(), balancesPrefix)) > 0);
+
 
 
 
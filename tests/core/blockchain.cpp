@@ -264,17 +264,17 @@ namespace TBlockchain {
           /// Commment this out and IT WILL NOT WORK.
           /// Waiting for rdPoSWorker rework.
           auto rdPoSmempoolFuture = std::async(std::launch::async, [&]() {
-            while (blockchainValidator1->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainValidator2->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainValidator3->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainValidator4->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainValidator5->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainNode1->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainNode2->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainNode3->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainNode4->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainNode5->getrdPoS()->getMempool().size() != 8 ||
-                   blockchainNode6->getrdPoS()->getMempool().size() != 8) {
+            while (blockchainValidator1->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainValidator2->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainValidator3->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainValidator4->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainValidator5->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainNode1->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainNode2->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainNode3->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainNode4->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainNode5->getrdPoS()->getMempool()->size() != 8 ||
+                   blockchainNode6->getrdPoS()->getMempool()->size() != 8) {
               std::this_thread::sleep_for(std::chrono::milliseconds(100));
             }
           });
@@ -389,6 +389,19 @@ namespace TBlockchain {
           REQUIRE(blockchainValidator1->getStorage()->latest()->hash() == blockchainNode6->getStorage()->latest()->hash());
         }
         bestBlock = blockchainValidator1->getStorage()->latest();
+
+        /// The creator of each block recorded the phases of its round, the last one being the latest block.
+        uint64_t lastRound = 0;
+        for (const Blockchain* validator : {blockchainValidator1.get(), blockchainValidator2.get(),
+          blockchainValidator3.get(), blockchainValidator4.get(), blockchainValidator5.get()}) {
+          BlockRoundLatency latency = validator->getSyncer()->getLastBlockRound();
+          if (latency.height == 0) continue;
+          REQUIRE(latency.total >= latency.waitTxValidators + latency.assemble + latency.sign
+            + latency.process + latency.broadcast + latency.finish);
+          lastRound = std::max(lastRound, latency.height);
+        }
+        REQUIRE(lastRound == blocks);
+
         /// Stop the nodes
         p2pDiscovery->stop();
         blockchainValidator1->stop();
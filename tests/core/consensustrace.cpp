@@ -0,0 +1,56 @@
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/core/consensustrace.h"
+
+namespace TConsensusTrace {
+  TEST_CASE("ConsensusTrace Class", "[core][consensustrace]") {
+    SECTION("Ring buffer keeps the latest events, oldest first") {
+      ConsensusTrace trace(5);
+      REQUIRE(trace.getEntries().empty());
+      for (uint64_t i = 1; i <= 8; i++) trace.record(i, ConsensusEvent::TipSeen);
+      auto entries = trace.getEntries();
+      REQUIRE(entries.size() == 5);
+      for (uint64_t i = 0; i < 5; i++) REQUIRE(entries[i].height == i + 4);
+      for (uint64_t i = 1; i < 5; i++) REQUIRE(entries[i].timestamp >= entries[i - 1].timestamp);
+      REQUIRE(trace.getEntries(7).size() == 2);
+      REQUIRE(trace.getEntries(9).empty());
+    }
+
+    SECTION("JSON and Chrome trace exports") {
+      Address validatorA(Utils::randBytes(20));
+      Address validatorB(Utils::randBytes(20));
+      ConsensusTrace trace;
+      trace.record(10, ConsensusEvent::TipSeen);
+      trace.record(10, ConsensusEvent::RandomHashReceived, validatorA);
+      trace.record(10, ConsensusEvent::RandomHashReceived, validatorB);
+      trace.record(10, ConsensusEvent::SeedsComplete);
+      trace.record(11, ConsensusEvent::BlockReceived, validatorA);
+      trace.record(11, ConsensusEvent::BlockRelayed);
+
+      json rounds = trace.toJSON();
+      REQUIRE(rounds.size() == 2);
+      REQUIRE(rounds[0]["height"] == 10);
+      REQUIRE(rounds[0]["events"].size() == 4);
+      REQUIRE(rounds[0]["events"][0]["event"] == "tipSeen");
+      REQUIRE(rounds[0]["events"][0]["elapsed"] == 0);
+      REQUIRE(!rounds[0]["events"][0].contains("validator"));
+      REQUIRE(rounds[0]["events"][1]["event"] == "randomHashReceived");
+      REQUIRE(rounds[0]["events"][1]["validator"] == validatorA.hex(true).get());
+      REQUIRE(rounds[0]["duration"].get<uint64_t>() == rounds[0]["events"][3]["elapsed"].get<uint64_t>());
+      REQUIRE(rounds[1]["height"] == 11);
+      REQUIRE(rounds[1]["events"][1]["event"] == "blockRelayed");
+      REQUIRE(trace.toJSON(11).size() == 1);
+
+      json chrome = trace.toChromeTrace();
+      REQUIRE(chrome["displayTimeUnit"] == "ms");
+      uint64_t spans = 0, instants = 0, tracks = 0;
+      for (const json& event : chrome["traceEvents"]) {
+        if (event["ph"] == "X") spans++;
+        if (event["ph"] == "i") instants++;
+        if (event["ph"] == "M") tracks++;
+      }
+      REQUIRE(spans == 2);
+      REQUIRE(instants == 6);
+      REQUIRE(tracks == 3);  // Rounds, plus one per validator
+    }
+  }
+}
@@ -0,0 +1,146 @@
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/core/mempool.h"
+
+namespace TMempool {
+  // Build a signed transaction from the given key with the given nonce and fee.
+  TxBlock makeTx(const PrivKey& privKey, const uint64_t& nonce, const uint64_t& fee, const uint64_t& value = 0) {
+    return TxBlock(
+      Address(Hex::toBytes("0x1234567890123456789012345678901234567890")),
+      Secp256k1::toAddress(Secp256k1::toUPub(privKey)),
+      Bytes(), 8080, nonce, value, fee, fee, 21000, privKey
+    );
+  }
+
+  // Add a transaction to the pool, using its own hash.
+  TxInvalid addTx(Mempool& mempool, TxBlock tx, const uint64_t& accountNonce) {
+    Hash txHash = tx.hash();
+    return mempool.add(std::move(tx), txHash, accountNonce);
+  }
+
+  // Collect every transaction pick() would give, in order.
+  std::vector<TxBlock> pickAll(const Mempool& mempool) {
+    std::vector<TxBlock> ret;
+    mempool.pick([&](const TxBlock& tx) { ret.push_back(tx); return Mempool::Pick::Take; });
+    return ret;
+  }
+
+  TEST_CASE("Mempool Class", "[core][mempool]") {
+    PrivKey keyA(Hex::toBytes("0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867"));
+    PrivKey keyB(Hex::toBytes("0x0a0415d68a5ec2df57aab65efc2a7231b59b029bae7ff1bd2e40df9af96418c8"));
+    PrivKey keyC(Hex::toBytes("0xb254f12b4ca3f0120f305cabf1188fe74f0bd38e58c932a3df79c4c55df8fa66"));
+    Address addrA = Secp256k1::toAddress(Secp256k1::toUPub(keyA));
+
+    SECTION("Pending and future transactions") {
+      Mempool mempool;
+      REQUIRE(addTx(mempool, makeTx(keyA, 0, 10), 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(mempool, makeTx(keyA, 2, 10), 0) == TxInvalid::NotInvalid);
+      REQUIRE(mempool.size() == 2);
+      REQUIRE(mempool.getPendingCount() == 1);
+      REQUIRE(mempool.getFutureCount() == 1);
+
+      // Filling the gap makes every transaction pending
+      REQUIRE(addTx(mempool, makeTx(keyA, 1, 10), 0) == TxInvalid::NotInvalid);
+      REQUIRE(mempool.getPendingCount() == 3);
+      REQUIRE(mempool.getFutureCount() == 0);
+
+      // Stale and too far ahead nonces are rejected
+      REQUIRE(addTx(mempool, makeTx(keyB, 4, 10), 5) == TxInvalid::InvalidNonce);
+      REQUIRE(addTx(mempool, makeTx(keyB, 5 + Mempool::defaultMaxNonceGap + 1, 10), 5) == TxInvalid::InvalidNonce);
+      REQUIRE(mempool.size() == 3);
+
+      // Removing a transaction turns the higher nonces into future ones
+      TxBlock tx = makeTx(keyA, 1, 10);
+      REQUIRE(mempool.remove(tx.hash()));
+      REQUIRE(!mempool.remove(tx.hash()));
+      REQUIRE(mempool.getPendingCount() == 1);
+      REQUIRE(mempool.getFutureCount() == 1);
+      REQUIRE(mempool.getBytes() == makeTx(keyA, 0, 10).rlpSize() + makeTx(keyA, 2, 10).rlpSize());
+    }
+
+    SECTION("Picking by fee while keeping nonce order") {
+      Mempool mempool;
+      // A pays little for its first tx but a lot for the next ones, B pays in between
+      REQUIRE(addTx(mempool, makeTx(keyA, 0, 1), 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(mempool, makeTx(keyA, 1, 100), 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(mempool, makeTx(keyB, 0, 50), 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(mempool, makeTx(keyC, 0, 70), 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(mempool, makeTx(keyC, 2, 200), 0) == TxInvalid::NotInvalid); // Future, never picked
+
+      std::vector<TxBlock> picked = pickAll(mempool);
+      REQUIRE(picked.size() == 4);
+      REQUIRE(picked[0] == makeTx(keyC, 0, 70));
+      REQUIRE(picked[1] == makeTx(keyB, 0, 50));
+      REQUIRE(picked[2] == makeTx(keyA, 0, 1));
+      REQUIRE(picked[3] == makeTx(keyA, 1, 100));
+
+      // Skipping a sender skips its later nonces too, stopping ends it right away
+      uint64_t visited = 0;
+      mempool.pick([&](const TxBlock& tx) {
+        visited++;
+        return (tx.getFrom() == addrA) ? Mempool::Pick::SkipSender : Mempool::Pick::Take;
+      });
+      REQUIRE(visited == 3);
+      visited = 0;
+      mempool.pick([&](const TxBlock&) { visited++; return Mempool::Pick::Stop; });
+      REQUIRE(visited == 1);
+    }
+
+    SECTION("Replacing a transaction requires a higher fee") {
+      Mempool mempool;
+      REQUIRE(addTx(mempool, makeTx(keyA, 0, 10), 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(mempool, makeTx(keyA, 0, 10, 1), 0) == TxInvalid::Underpriced);
+      REQUIRE(addTx(mempool, makeTx(keyA, 0, 5), 0) == TxInvalid::Underpriced);
+      REQUIRE(addTx(mempool, makeTx(keyA, 0, 11), 0) == TxInvalid::NotInvalid);
+      REQUIRE(mempool.size() == 1);
+      REQUIRE(mempool.getPendingCount() == 1);
+      REQUIRE(!mempool.contains(makeTx(keyA, 0, 10).hash()));
+      REQUIRE(mempool.find(makeTx(keyA, 0, 11).hash()) != nullptr);
+    }
+
+    SECTION("Evicting the lowest fee when full") {
+      Mempool mempool(3);
+      REQUIRE(addTx(mempool, makeTx(keyA, 0, 5), 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(mempool, makeTx(keyA, 1, 50), 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(mempool, makeTx(keyB, 0, 20), 0) == TxInvalid::NotInvalid);
+
+      // Not better than the cheapest, rejected
+      REQUIRE(addTx(mempool, makeTx(keyC, 0, 5), 0) == TxInvalid::Underpriced);
+      REQUIRE(mempool.size() == 3);
+
+      // Evicts A's nonce 0 and, as it can't be executed anymore, A's nonce 1 too
+      REQUIRE(addTx(mempool, makeTx(keyC, 0, 30), 0) == TxInvalid::NotInvalid);
+      REQUIRE(mempool.size() == 2);
+      REQUIRE(!mempool.contains(makeTx(keyA, 0, 5).hash()));
+      REQUIRE(!mempool.contains(makeTx(keyA, 1, 50).hash()));
+      REQUIRE(mempool.getPendingCount() == 2);
+
+      // Byte limit works the same way
+      TxBlock tx = makeTx(keyA, 0, 10);
+      Mempool small(100, tx.rlpSize() + 8);
+      REQUIRE(addTx(small, tx, 0) == TxInvalid::NotInvalid);
+      REQUIRE(addTx(small, makeTx(keyB, 0, 9), 0) == TxInvalid::Underpriced);
+      REQUIRE(addTx(small, makeTx(keyB, 0, 11), 0) == TxInvalid::NotInvalid);
+      REQUIRE(small.size() == 1);
+      REQUIRE(small.getBytes() <= tx.rlpSize() + 8);
+    }
+
+    SECTION("Updating a sender after its account changed") {
+      Mempool mempool;
+      for (uint64_t i = 0; i < 4; i++) REQUIRE(addTx(mempool, makeTx(keyA, i, 10, i * 1000), 0) == TxInvalid::NotInvalid);
+      REQUIRE(mempool.getPendingCount() == 4);
+
+      // Nonces 0 and 1 were included, and the tx with nonce 3 is now too expensive
+      uint64_t maxAffordable = uint64_t(makeTx(keyA, 2, 10, 2000).getMaxCost());
+      REQUIRE(mempool.updateSender(addrA, 2, maxAffordable) == 3);
+      REQUIRE(mempool.size() == 1);
+      REQUIRE(mempool.getPendingCount() == 1);
+      REQUIRE(mempool.contains(makeTx(keyA, 2, 10, 2000).hash()));
+
+      // Once nothing is left, the sender is forgotten
+      REQUIRE(mempool.updateSender(addrA, 3, maxAffordable) == 1);
+      REQUIRE(mempool.size() == 0);
+      REQUIRE(mempool.getSenders().empty());
+      REQUIRE(mempool.updateSender(addrA, 3, maxAffordable) == 0);
+    }
+  }
+}
@@ -98,8 +98,8 @@ void initialize(std::unique_ptr<DB>& db,
 // Should not be used during network/thread testing, as it will automatically sign all TxValidator transactions within the block
 // And that is not the purpose of network/thread testing.
 Block createValidBlock(std::unique_ptr<rdPoS>& rdpos, std::unique_ptr<Storage>& storage, const std::vector<TxBlock>& txs = {}) {
-  auto validators = rdpos->getValidators();
-  auto randomList = rdpos->getRandomList();
+  auto validators = *rdpos->getValidators();
+  auto randomList = *rdpos->getRandomList();
 
   Hash blockSignerPrivKey;           // Private key for the block signer.
   std::vector<Hash> orderedPrivKeys; // Private keys for the rdPoS in the order of the random list, limited to rdPoS::minValidators.
@@ -167,8 +167,8 @@ Block createValidBlock(std::unique_ptr<rdPoS>& rdpos, std::unique_ptr<Storage>&
   }
 
   // Check rdPoS mempool.
-  auto rdPoSmempool = rdpos->getMempool();
-  REQUIRE(rdpos->getMempool().size() == 8);
+  auto rdPoSmempool = *rdpos->getMempool();
+  REQUIRE(rdpos->getMempool()->size() == 8);
   for (const auto& tx : randomHashTxs) {
     REQUIRE(rdPoSmempool.contains(tx.hash()));
   }
@@ -196,8 +196,8 @@ namespace TRdPoS {
         std::unique_ptr<State> state;
         initialize(db, storage, p2p, validatorKey, rdpos, options, state, 8080, true, "rdPoSStartup");
 
-        auto validators = rdpos->getValidators();
-        REQUIRE(rdpos->getValidators().size() == 8);
+        auto validators = *rdpos->getValidators();
+        REQUIRE(rdpos->getValidators()->size() == 8);
         REQUIRE(validators.contains(Address(Hex::toBytes("1531bfdf7d48555a0034e4647fa46d5a04c002c3"))));
         REQUIRE(validators.contains(Address(Hex::toBytes("e3dff2cc3f367df7d0254c834a0c177064d7c7f5"))));
         REQUIRE(validators.contains(Address(Hex::toBytes("24e10d8ebe80abd3d3fddd89a26f08f3888d1380"))));
@@ -208,8 +208,8 @@ namespace TRdPoS {
         REQUIRE(validators.contains(Address(Hex::toBytes("6e67067edc1b4837b67c0b1def689eddee257521"))));
         REQUIRE(rdpos->getBestRandomSeed() == Hash()); // Genesis blocks randomness is 0.
 
-        auto randomList = rdpos->getRandomList();
-        validatorsList = rdpos->getValidators();
+        auto randomList = *rdpos->getRandomList();
+        validatorsList = *rdpos->getValidators();
         REQUIRE(randomList.size() == 8);
         for (const auto& i : randomList) {
           REQUIRE(validatorsList.contains(i));
@@ -235,7 +235,7 @@ namespace TRdPoS {
       std::unique_ptr<State> state;
       initialize(db, storage, p2p, validatorKey, rdpos, options, state, 8080, false, "rdPoSStartup");
 
-      auto validators = rdpos->getValidators();
+      auto validators = *rdpos->getValidators();
       REQUIRE(validators == validatorsList);
     }
 
@@ -286,7 +286,7 @@ namespace TRdPoS {
         REQUIRE(latestBlock->getNHeight() == 10);
         REQUIRE(latestBlock->getBlockRandomness() == rdpos->getBestRandomSeed());
 
-        expectedRandomList = rdpos->getRandomList();
+        expectedRandomList = *rdpos->getRandomList();
         expectedRandomnessFromBestBlock = rdpos->getBestRandomSeed();
       }
 
@@ -301,7 +301,7 @@ namespace TRdPoS {
       initialize(db, storage, p2p, validatorKey, rdpos, options, state, 8080, false, "rdPoSValidateBlockTenBlocks");
 
       REQUIRE(rdpos->getBestRandomSeed() == expectedRandomnessFromBestBlock);
-      REQUIRE(rdpos->getRandomList() == expectedRandomList);
+      REQUIRE(*rdpos->getRandomList() == expectedRandomList);
     }
   }
 
@@ -337,8 +337,8 @@ namespace TRdPoS {
 
       // Create valid TxValidator transactions (8 in total), append them to node 1's storage.
       // After appending to node 1's storage, broadcast them to all nodes.
-      auto validators = rdpos1->getValidators();
-      auto randomList = rdpos1->getRandomList();
+      auto validators = *rdpos1->getValidators();
+      auto randomList = *rdpos1->getRandomList();
 
       Hash blockSignerPrivKey;           // Private key for the block signer.
       std::vector<Hash> orderedPrivKeys; // Private keys for the rdPoS in the order of the random list, limited to rdPoS::minValidators.
@@ -400,8 +400,8 @@ namespace TRdPoS {
 
       std::this_thread::sleep_for(std::chrono::milliseconds(250));
 
-      auto node1Mempool = rdpos1->getMempool();
-      auto node2Mempool = rdpos2->getMempool();
+      auto node1Mempool = *rdpos1->getMempool();
+      auto node2Mempool = *rdpos2->getMempool();
 
       // As transactions were broadcasted, they should be included in both nodes.
       REQUIRE(node1Mempool == node2Mempool);
@@ -409,12 +409,23 @@ namespace TRdPoS {
       // Clear mempool from node 1.
       rdpos1->clearMempool();
 
-      // Request the transactions from node 1 to node 2
+      // With nothing to tell, node 1 sends the plain (empty) request and gets everything.
       std::vector<P2P::NodeID> nodesIds = p2p1->getSessionsIDs();
       REQUIRE(nodesIds.size() == 1);
+      REQUIRE(P2P::RequestEncoder::requestValidatorTxs().size() == 11);
+      REQUIRE(p2p1->requestValidatorTxs(nodesIds[0]).size() == node2Mempool.size());
+
+      // Give node 1 back a few transactions, so it only misses the rest.
+      uint64_t kept = 0;
+      for (const auto& [hash, tx] : node2Mempool) {
+        if (kept++ == 3) break;
+        REQUIRE(rdpos1->addValidatorTx(tx));
+      }
+
+      // Request the transactions from node 1 to node 2, only the missing ones should come back.
       auto transactionList = p2p1->requestValidatorTxs(nodesIds[0]);
 
-      REQUIRE(transactionList.size() == 8);
+      REQUIRE(transactionList.size() == 5);
 
       // Append transactions back to node 1 mempool.
       for (const auto& tx : transactionList) {
@@ -422,8 +433,11 @@ namespace TRdPoS {
       }
 
       // Check that the mempool is the same as before.
-      node1Mempool = rdpos1->getMempool();
+      node1Mempool = *rdpos1->getMempool();
       REQUIRE(node1Mempool == node2Mempool);
+
+      // Nothing is missing anymore, so nothing comes back.
+      REQUIRE(p2p1->requestValidatorTxs(nodesIds[0]).empty());
     }
 
     SECTION("Ten NormalNodes and one DiscoveryNode, test broadcast") {
@@ -624,8 +638,8 @@ namespace TRdPoS {
 
       // Create valid TxValidator transactions (8 in total), append them to node 1's storage.
       // After appending to node 1's storage, broadcast them to all nodes.
-      auto validators = rdpos1->getValidators();
-      auto randomList = rdpos1->getRandomList();
+      auto validators = *rdpos1->getValidators();
+      auto randomList = *rdpos1->getRandomList();
 
       Hash blockSignerPrivKey;           // Private key for the block signer.
       std::vector<Hash> orderedPrivKeys; // Private keys for the rdPoS in the order of the random list, limited to rdPoS::minValidators.
@@ -685,18 +699,18 @@ namespace TRdPoS {
       }
 
       /// Wait till transactions are broadcasted
-      auto finalMempool = rdpos1->getMempool();
+      auto finalMempool = *rdpos1->getMempool();
 
       auto broadcastFuture = std::async(std::launch::async, [&]() {
-        while(rdpos2->getMempool() != rdpos1->getMempool() ||
-              rdpos3->getMempool() != rdpos1->getMempool() ||
-            rdpos4->getMempool() != rdpos1->getMempool() ||
-            rdpos5->getMempool() != rdpos1->getMempool() ||
-            rdpos6->getMempool() != rdpos1->getMempool() ||
-            rdpos7->getMempool() != rdpos1->getMempool() ||
-            rdpos8->getMempool() != rdpos1->getMempool() ||
-            rdpos9->getMempool() != rdpos1->getMempool() ||
-            rdpos10->getMempool() != rdpos1->getMempool()) {
+        while(*rdpos2->getMempool() != *rdpos1->getMempool() ||
+              *rdpos3->getMempool() != *rdpos1->getMempool() ||
+            *rdpos4->getMempool() != *rdpos1->getMempool() ||
+            *rdpos5->getMempool() != *rdpos1->getMempool() ||
+            *rdpos6->getMempool() != *rdpos1->getMempool() ||
+            *rdpos7->getMempool() != *rdpos1->getMempool() ||
+            *rdpos8->getMempool() != *rdpos1->getMempool() ||
+            *rdpos9->getMempool() != *rdpos1->getMempool() ||
+            *rdpos10->getMempool() != *rdpos1->getMempool()) {
           std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
       });
@@ -704,16 +718,16 @@ namespace TRdPoS {
       REQUIRE(broadcastFuture.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
 
       // Check if all mempools matchs
-      auto node1Mempool = rdpos1->getMempool();
-      auto node2Mempool = rdpos2->getMempool();
-      auto node3Mempool = rdpos3->getMempool();
-      auto node4Mempool = rdpos4->getMempool();
-      auto node5Mempool = rdpos5->getMempool();
-      auto node6Mempool = rdpos6->getMempool();
-      auto node7Mempool = rdpos7->getMempool();
-      auto node8Mempool = rdpos8->getMempool();
-      auto node9Mempool = rdpos9->getMempool();
-      auto node10Mempool = rdpos10->getMempool();
+      auto node1Mempool = *rdpos1->getMempool();
+      auto node2Mempool = *rdpos2->getMempool();
+      auto node3Mempool = *rdpos3->getMempool();
+      auto node4Mempool = *rdpos4->getMempool();
+      auto node5Mempool = *rdpos5->getMempool();
+      auto node6Mempool = *rdpos6->getMempool();
+      auto node7Mempool = *rdpos7->getMempool();
+      auto node8Mempool = *rdpos8->getMempool();
+      auto node9Mempool = *rdpos9->getMempool();
+      auto node10Mempool = *rdpos10->getMempool();
 
       REQUIRE(node1Mempool == node2Mempool);
       REQUIRE(node2Mempool == node3Mempool);
@@ -931,7 +945,7 @@ namespace TRdPoS {
     uint64_t blocks = 0;
     while (blocks < 10) {
       auto rdPoSmempoolFuture = std::async(std::launch::async, [&]() {
-        while (rdpos1->getMempool().size() != 8) {
+        while (rdpos1->getMempool()->size() != 8) {
           std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
       });
@@ -941,8 +955,8 @@ namespace TRdPoS {
       for (auto &blockCreator: rdPoSreferences) {
         if (blockCreator.get()->canCreateBlock()) {
           // Create the block.
-          auto mempool = blockCreator.get()->getMempool();
-          auto randomList = blockCreator.get()->getRandomList();
+          auto mempool = *blockCreator.get()->getMempool();
+          auto randomList = *blockCreator.get()->getRandomList();
           // Order the transactions in the proper manner.
           std::vector<TxValidator> randomHashTxs;
           std::vector<TxValidator> randomnessTxs;
@@ -971,6 +985,12 @@ namespace TRdPoS {
             }
           }
 
+          // The mempool index hands out the same order.
+          auto blockTxValidators = blockCreator.get()->getBlockTxValidators();
+          REQUIRE(blockTxValidators);
+          REQUIRE(std::equal(randomHashTxs.begin(), randomHashTxs.end(), blockTxValidators->begin()));
+          REQUIRE(std::equal(randomnessTxs.begin(), randomnessTxs.end(), blockTxValidators->begin() + rdPoS::minValidators));
+
           // Create the block and append to all chains, we can use any storage for latestblock
           auto latestBlock = storage1->latest();
           Block block(latestBlock->hash(), latestBlock->getTimestamp(), latestBlock->getNHeight() + 1);
@@ -1032,5 +1052,18 @@ namespace TRdPoS {
     rdpos8->stoprdPoSWorker();
     // Sleep so it can conclude the last operations.
     std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    // Every round is in the trace: each Validator transaction came in, then the round was complete.
+    for (uint64_t height = 1; height <= blocks; height++) {
+      uint64_t received = 0;
+      bool complete = false;
+      for (const auto& entry : rdpos1->getTrace().getEntries(height)) {
+        if (entry.height != height) continue;
+        if (entry.event == ConsensusEvent::RandomHashReceived || entry.event == ConsensusEvent::SeedReceived) received++;
+        if (entry.event == ConsensusEvent::SeedsComplete) complete = true;
+      }
+      REQUIRE(received == rdPoS::minValidators * 2);
+      REQUIRE(complete);
+    }
   }
 };
\ No newline at end of file
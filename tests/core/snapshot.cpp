@@ -0,0 +1,97 @@
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/core/snapshot.h"
+
+namespace TSnapshot {
+  TEST_CASE("StateSnapshot Class", "[core][snapshot]") {
+    SECTION("Manifest serialization") {
+      StateSnapshot::Manifest manifest;
+      manifest.height = 12345;
+      manifest.block = Utils::randBytes(300);
+      manifest.stateRoot = Hash::random();
+      for (uint64_t i = 0; i < 5; i++) manifest.chunkHashes.emplace_back(Hash::random());
+      Bytes raw = manifest.serialize();
+      REQUIRE(raw.size() == 8 + 32 + 4 + 300 + 4 + (5 * 32));
+
+      auto decoded = StateSnapshot::Manifest::deserialize(raw);
+      REQUIRE(decoded.has_value());
+      REQUIRE(decoded->height == manifest.height);
+      REQUIRE(decoded->block == manifest.block);
+      REQUIRE(decoded->stateRoot == manifest.stateRoot);
+      REQUIRE(decoded->chunkHashes == manifest.chunkHashes);
+
+      REQUIRE(!StateSnapshot::Manifest::deserialize(BytesArrView(raw).subspan(0, 40)).has_value());
+      REQUIRE(!StateSnapshot::Manifest::deserialize(BytesArrView(raw).subspan(0, raw.size() - 1)).has_value());
+      raw.emplace_back(0x00);
+      REQUIRE(!StateSnapshot::Manifest::deserialize(raw).has_value());
+    }
+
+    SECTION("Chunks round trip and match the manifest") {
+      std::map<Bytes, Bytes> entries;
+      for (uint64_t i = 0; i < 300; i++) {
+        Bytes key = DBPrefix::nativeAccounts;
+        Utils::appendBytes(key, Utils::randBytes(20));
+        entries[key] = Utils::randBytes(10000);  // ~3MB in total
+      }
+      Bytes contractKey = DBPrefix::contracts;
+      Utils::appendBytes(contractKey, Utils::randBytes(24));
+      entries[contractKey] = Utils::randBytes(32);
+
+      Hash stateRoot = Hash::random();
+      StateSnapshot snapshot(1000, Utils::randBytes(250), stateRoot, entries);
+      REQUIRE(snapshot.getHeight() == 1000);
+      REQUIRE(snapshot.getManifest().stateRoot == stateRoot);
+      REQUIRE(snapshot.getChunkCount() > 1);
+      REQUIRE(snapshot.getManifest().chunkHashes.size() == snapshot.getChunkCount());
+      REQUIRE(snapshot.getManifestHash() == Utils::sha3(snapshot.getManifest().serialize()));
+      REQUIRE(snapshot.getChunk(snapshot.getChunkCount()) == nullptr);
+
+      std::vector<DBEntry> decoded;
+      for (uint64_t i = 0; i < snapshot.getChunkCount(); i++) {
+        const Bytes* chunk = snapshot.getChunk(i);
+        REQUIRE(chunk != nullptr);
+        REQUIRE(Utils::sha3(*chunk) == snapshot.getManifest().chunkHashes[i]);
+        for (DBEntry& entry : StateSnapshot::decodeChunk(*chunk)) decoded.emplace_back(std::move(entry));
+      }
+      REQUIRE(decoded.size() == entries.size());
+      auto it = entries.begin();
+      for (const DBEntry& entry : decoded) {
+        REQUIRE(entry.key == it->first);
+        REQUIRE(entry.value == it->second);
+        it++;
+      }
+
+      // Same entries, same chunks
+      StateSnapshot other(1000, snapshot.getManifest().block, stateRoot, entries);
+      REQUIRE(other.getManifestHash() == snapshot.getManifestHash());
+
+      // Empty state still has one (empty) chunk
+      StateSnapshot empty(1, Bytes(), stateRoot, {});
+      REQUIRE(empty.getChunkCount() == 1);
+      REQUIRE(StateSnapshot::decodeChunk(*empty.getChunk(0)).empty());
+    }
+
+    SECTION("Malformed chunks and foreign keys") {
+      Bytes key = DBPrefix::rdPoS;
+      Utils::appendBytes(key, Utils::uint64ToBytes(0));
+      REQUIRE(StateSnapshot::isSnapshotKey(key));
+      REQUIRE(!StateSnapshot::isSnapshotKey(DBPrefix::rdPoS));
+      Bytes blockKey = DBPrefix::blocks;
+      Utils::appendBytes(blockKey, Hash::random());
+      REQUIRE(!StateSnapshot::isSnapshotKey(blockKey));
+
+      std::map<Bytes, Bytes> entries = {{key, Utils::randBytes(20)}};
+      StateSnapshot snapshot(1, Bytes(), Hash(), entries);
+      const Bytes& chunk = *snapshot.getChunk(0);
+      REQUIRE(StateSnapshot::decodeChunk(chunk).size() == 1);
+      REQUIRE_THROWS(StateSnapshot::decodeChunk(BytesArrView(chunk).subspan(0, chunk.size() - 1)));
+      REQUIRE_THROWS(StateSnapshot::decodeChunk(BytesArrView(chunk).subspan(0, 3)));
+
+      Bytes foreign;
+      Utils::appendBytes(foreign, Utils::uint32ToBytes(blockKey.size()));
+      Utils::appendBytes(foreign, blockKey);
+      Utils::appendBytes(foreign, Utils::uint32ToBytes(1));
+      foreign.emplace_back(0x01);
+      REQUIRE_THROWS(StateSnapshot::decodeChunk(foreign));
+    }
+  }
+}
@@ -2,6 +2,8 @@
 #include "../../src/core/rdpos.h"
 #include "../../src/core/storage.h"
 #include "../../src/core/state.h"
+#include "../../src/core/blocksync.h"
+#include "../../src/core/snapshotsync.h"
 #include "../../src/utils/db.h"
 #include "../../src/net/p2p/managernormal.h"
 #include "../../src/net/p2p/managerdiscovery.h"
@@ -248,14 +250,19 @@ namespace TState {
         auto newBestBlock = createValidBlock(rdpos, storage, transactions);
         REQUIRE(state->validateNextBlock(newBestBlock));
 
+        /// A view pinned before the block keeps seeing the state as it was
+        std::shared_ptr<const StateView> viewBefore = state->getView();
         state->processNextBlock(std::move(newBestBlock));
+        REQUIRE(state->getView()->getHeight() == viewBefore->getHeight() + 1);
 
         for (const auto &[privkey, val]: randomAccounts) {
           auto me = Secp256k1::toAddress(Secp256k1::toUPub(privkey));
           REQUIRE(state->getNativeBalance(me) == val.first);
           REQUIRE(state->getNativeNonce(me) == val.second);
+          REQUIRE(viewBefore->getNativeNonce(me) == val.second - 1);
         }
         REQUIRE(state->getNativeBalance(targetOfTransactions) == targetExpectedValue);
+        REQUIRE(viewBefore->getNativeBalance(targetOfTransactions) == 0);
       }
     }
 
@@ -300,7 +307,7 @@ namespace TState {
           state->addTx(std::move(tx));
         }
 
-        auto mempoolCopy = state->getMempool();
+        auto mempoolCopy = *state->getMempool();
         REQUIRE(mempoolCopy.size() == 500);
         std::vector<TxBlock> txCopy;
         for (const auto &[key, value]: mempoolCopy) {
@@ -321,6 +328,68 @@ namespace TState {
       }
     }
 
+    SECTION("Test State transaction admission pipeline") {
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<Options> options;
+      initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, true, "stateTxAdmissionTest");
+
+      /// 100 senders with 3 txs each, submitted concurrently, plus duplicates and invalid ones
+      Address targetOfTransactions = Address(Utils::randBytes(20));
+      std::vector<Bytes> rawTxs;
+      std::vector<Hash> hashes;
+      for (uint64_t i = 0; i < 100; ++i) {
+        PrivKey privKey(Utils::randBytes(32));
+        Address me = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+        state->addBalance(me);
+        for (uint64_t nonce = 0; nonce < 3; ++nonce) {
+          TxBlock tx(targetOfTransactions, me, Bytes(), 8080, nonce, 1000000000000000000, 21000, 1000000000, 1000000000, privKey);
+          rawTxs.emplace_back(tx.rlpSerialize());
+          hashes.emplace_back(tx.hash());
+        }
+      }
+      std::vector<std::future<TxAdmission::Result>> results;
+      for (const Bytes& rawTx : rawTxs) results.emplace_back(state->submitTx(Bytes(rawTx)));
+      for (const Bytes& rawTx : rawTxs) results.emplace_back(state->submitTx(Bytes(rawTx)));
+      for (uint64_t i = 0; i < results.size(); ++i) {
+        auto [hash, status, known] = results[i].get();
+        REQUIRE(hash == hashes[i % hashes.size()]);
+        REQUIRE(status == TxInvalid::NotInvalid);
+        REQUIRE(known == (i >= hashes.size()));  // Second copies are reported as already known
+      }
+      REQUIRE(state->getMempoolSize() == 300);
+      REQUIRE(state->areTxsInMempool(hashes) == std::vector<bool>(300, true));
+
+      /// Snapshots are shared until what they copy changes, and never change themselves
+      auto mempoolSnapshot = state->getMempool();
+      auto accountsSnapshot = state->getAccounts();
+      REQUIRE(mempoolSnapshot->size() == 300);
+      REQUIRE(state->getMempool() == mempoolSnapshot);
+      REQUIRE(state->getAccounts() == accountsSnapshot);
+      state->addBalance(targetOfTransactions);
+      REQUIRE(state->getAccounts() != accountsSnapshot);
+      REQUIRE(state->getAccounts()->contains(targetOfTransactions));
+      REQUIRE(!accountsSnapshot->contains(targetOfTransactions));
+
+      /// A sender without balance is rejected, a malformed tx throws
+      PrivKey poorKey(Utils::randBytes(32));
+      TxBlock poorTx(
+        targetOfTransactions, Secp256k1::toAddress(Secp256k1::toUPub(poorKey)), Bytes(), 8080, 0,
+        1000000000000000000, 21000, 1000000000, 1000000000, poorKey
+      );
+      REQUIRE(state->submitTx(poorTx.rlpSerialize()).get().status == TxInvalid::InvalidBalance);
+      REQUIRE_THROWS(state->submitTx(Bytes{0x01, 0x00}).get());
+
+      /// Txs from peers report malformed ones instead
+      std::promise<std::string> malformedError;
+      state->submitPeerTx(Bytes{0x02, 0x00}, [&](const std::string& error) { malformedError.set_value(error); });
+      REQUIRE(!malformedError.get_future().get().empty());
+      REQUIRE(state->getMempoolSize() == 300);
+    }
+
     SECTION("Test State mempool refresh") {
       /// The block included will only have transactions where the address starts with \x08 or lower
       /// where the mempool will have 500 transactions, including the \x08 addresses txs.
@@ -379,9 +448,9 @@ namespace TState {
 
         state->processNextBlock(std::move(newBestBlock));
 
-        REQUIRE(state->getMempool().size() == notOnBlock.size());
+        REQUIRE(state->getMempool()->size() == notOnBlock.size());
 
-        auto mempoolCopy = state->getMempool();
+        auto mempoolCopy = *state->getMempool();
         for (const auto &tx: notOnBlock) {
           REQUIRE(mempoolCopy.contains(tx.hash()));
         }
@@ -396,6 +465,266 @@ namespace TState {
 
     }
 
+    SECTION("Test State block limits") {
+      /// 50 accounts with 2 transactions each (nonces 0 and 1) in the mempool.
+      /// Blocks are filled up to the limits, keeping each sender's nonce order.
+      std::vector<PrivKey> randomAccounts;
+      for (uint64_t i = 0; i < 50; ++i) randomAccounts.emplace_back(PrivKey(Utils::randBytes(32)));
+      {
+        std::unique_ptr<DB> db;
+        std::unique_ptr<Storage> storage;
+        std::unique_ptr<P2P::ManagerNormal> p2p;
+        std::unique_ptr<rdPoS> rdpos;
+        std::unique_ptr<State> state;
+        std::unique_ptr<Options> options;
+        initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, true, "stateBlockLimitsTest");
+
+        uint64_t txSize = 0;
+        for (const auto& privkey : randomAccounts) {
+          Address me = Secp256k1::toAddress(Secp256k1::toUPub(privkey));
+          state->addBalance(me);
+          for (uint64_t nonce = 0; nonce < 2; ++nonce) {
+            TxBlock tx(Address(Utils::randBytes(20)), me, Bytes(), 8080, nonce, 1000000000000000000, 21000, 1000000000, 21000, privkey);
+            txSize = std::max(txSize, BlockBuilder::txBlockSize(tx));
+            REQUIRE(state->addTx(std::move(tx)) == TxInvalid::NotInvalid);
+          }
+        }
+        REQUIRE(state->getMempoolPendingCount() == 100);
+
+        // No limits reached
+        BlockBuilder fullBuilder(Hash::random(), 0, 1);
+        BlockFillReport fullReport = state->fillBlockWithTransactions(fullBuilder);
+        REQUIRE(fullReport.included == 100);
+        REQUIRE(fullReport.leftOut == 0);
+        REQUIRE(fullReport.skipped.empty());
+        REQUIRE(fullReport.bytes == fullBuilder.getSerializedSize());
+        REQUIRE(fullReport.execTime == 100 * BlockLimits::estimateExecTime(fullBuilder.getTxs()[0]));
+
+        // Each sender's nonce 0 always comes before its nonce 1
+        std::unordered_map<Address, uint64_t, SafeHash> nextNonce;
+        for (const auto& tx : fullBuilder.getTxs()) REQUIRE(tx.getNonce() == nextNonce[tx.getFrom()]++);
+
+        // Tx count limit: every sender not taken is reported
+        BlockLimits limits;
+        limits.maxTxs = 30;
+        state->setBlockLimits(limits);
+        BlockBuilder countBuilder(Hash::random(), 0, 1);
+        BlockFillReport countReport = state->fillBlockWithTransactions(countBuilder);
+        REQUIRE(countBuilder.getTxs().size() == 30);
+        REQUIRE(countReport.included == 30);
+        REQUIRE(countReport.leftOut == 70);
+        REQUIRE(countReport.count(BlockSkip::TxCount) == countReport.skipped.size());
+        REQUIRE(countReport.skipped.size() >= 35);
+
+        // Byte limit
+        limits = BlockLimits();
+        limits.maxBytes = 217 + (txSize * 10);
+        state->setBlockLimits(limits);
+        BlockBuilder bytesBuilder(Hash::random(), 0, 1);
+        BlockFillReport bytesReport = state->fillBlockWithTransactions(bytesBuilder);
+        REQUIRE(bytesBuilder.getSerializedSize() <= limits.maxBytes);
+        REQUIRE(bytesReport.included >= 9);
+        REQUIRE(bytesReport.included <= 10);
+        REQUIRE(bytesReport.count(BlockSkip::Bytes) > 0);
+
+        // Execution time limit
+        limits = BlockLimits();
+        limits.maxExecTime = BlockLimits::estimateExecTime(fullBuilder.getTxs()[0]) * 5;
+        state->setBlockLimits(limits);
+        BlockBuilder timeBuilder(Hash::random(), 0, 1);
+        BlockFillReport timeReport = state->fillBlockWithTransactions(timeBuilder);
+        REQUIRE(timeReport.included == 5);
+        REQUIRE(timeReport.execTime == limits.maxExecTime);
+        REQUIRE(timeReport.count(BlockSkip::ExecTime) == timeReport.skipped.size());
+
+        // Filling a block doesn't touch the mempool
+        REQUIRE(state->getMempoolPendingCount() == 100);
+      }
+    }
+
+    SECTION("Test State block validation with many senders and repeated senders") {
+      /// Over 2000 txs, so validation runs in parallel by sender.
+      /// The last sender has 3 txs in the same block, which must be sequential and affordable.
+      std::vector<PrivKey> randomAccounts;
+      for (uint64_t i = 0; i < 2500; ++i) randomAccounts.emplace_back(PrivKey(Utils::randBytes(32)));
+      {
+        std::unique_ptr<DB> db;
+        std::unique_ptr<Storage> storage;
+        std::unique_ptr<P2P::ManagerNormal> p2p;
+        std::unique_ptr<rdPoS> rdpos;
+        std::unique_ptr<State> state;
+        std::unique_ptr<Options> options;
+        initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, true, "stateParallelValidationTest");
+
+        auto makeTx = [&](const PrivKey& privkey, uint64_t nonce) {
+          Address me = Secp256k1::toAddress(Secp256k1::toUPub(privkey));
+          return TxBlock(Address(Utils::randBytes(20)), me, Bytes(), 8080, nonce, 1000000000000000000, 21000, 1000000000, 21000, privkey);
+        };
+        std::vector<TxBlock> txs;
+        for (const auto& privkey : randomAccounts) {
+          state->addBalance(Secp256k1::toAddress(Secp256k1::toUPub(privkey)));
+          txs.emplace_back(makeTx(privkey, 0));
+        }
+        txs.emplace_back(makeTx(randomAccounts.back(), 1));
+        txs.emplace_back(makeTx(randomAccounts.back(), 2));
+
+        auto block = createValidBlock(rdpos, storage, txs);
+        REQUIRE(state->validateNextBlock(block));
+
+        // Same block, but with other txs, signed by the same validator
+        Hash blockSignerPrivKey;
+        for (const auto& privKey : validatorPrivKeys) {
+          if (Secp256k1::toAddress(Secp256k1::toUPub(privKey)) == (*rdpos->getRandomList())[0]) blockSignerPrivKey = privKey;
+        }
+        auto rebuildBlock = [&](const std::vector<TxBlock>& newTxs) {
+          Block newBlock(block.getPrevBlockHash(), block.getTimestamp(), block.getNHeight());
+          for (const auto& tx : block.getTxValidators()) newBlock.appendTxValidator(tx);
+          for (const auto& tx : newTxs) newBlock.appendTx(tx);
+          newBlock.finalize(PrivKey(blockSignerPrivKey.get()), block.getTimestamp());
+          return newBlock;
+        };
+
+        // Nonce gap within the same sender
+        std::vector<TxBlock> gapTxs = txs;
+        gapTxs.back() = makeTx(randomAccounts.back(), 3);
+        REQUIRE(!state->validateNextBlock(rebuildBlock(gapTxs)));
+
+        // Same nonce twice from the same sender
+        std::vector<TxBlock> repeatedTxs = txs;
+        repeatedTxs.back() = makeTx(randomAccounts.back(), 1);
+        REQUIRE(!state->validateNextBlock(rebuildBlock(repeatedTxs)));
+
+        // Processing an invalid block fails midway and leaves every account as it was
+        REQUIRE(!state->tryProcessNextBlock(rebuildBlock(repeatedTxs)));
+        REQUIRE_THROWS(state->processNextBlock(rebuildBlock(gapTxs)));
+        REQUIRE(state->getNativeNonce(Secp256k1::toAddress(Secp256k1::toUPub(randomAccounts.front()))) == 0);
+        REQUIRE(state->getNativeBalance(txs.front().getTo()) == 0);
+        REQUIRE(!state->getAccounts()->contains(txs.front().getTo()));
+        REQUIRE(storage->latest()->getNHeight() == 0);
+
+        state->processNextBlock(std::move(block));
+        REQUIRE(state->getNativeNonce(Secp256k1::toAddress(Secp256k1::toUPub(randomAccounts.back()))) == 3);
+        REQUIRE(state->getNativeNonce(Secp256k1::toAddress(Secp256k1::toUPub(randomAccounts.front()))) == 1);
+      }
+    }
+
+    SECTION("Test State parallel native transfers match serial processing") {
+      /// Over 2000 native transfers, so they're processed in parallel groups.
+      /// Every 10th sender pays the next sender and some senders pay each other,
+      /// so groups have several txs that depend on each other.
+      std::vector<PrivKey> randomAccounts;
+      for (uint64_t i = 0; i < 3000; ++i) randomAccounts.emplace_back(PrivKey(Utils::randBytes(32)));
+      {
+        std::unique_ptr<DB> db;
+        std::unique_ptr<Storage> storage;
+        std::unique_ptr<P2P::ManagerNormal> p2p;
+        std::unique_ptr<rdPoS> rdpos;
+        std::unique_ptr<State> state;
+        std::unique_ptr<Options> options;
+        initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, true, "stateParallelTransfersTest");
+
+        std::vector<Address> addresses;
+        std::unordered_map<Address, uint256_t, SafeHash> expectedBalances;
+        for (const auto& privkey : randomAccounts) {
+          Address me = Secp256k1::toAddress(Secp256k1::toUPub(privkey));
+          state->addBalance(me);
+          addresses.push_back(me);
+          expectedBalances[me] = state->getNativeBalance(me);
+        }
+        std::vector<TxBlock> txs;
+        for (uint64_t i = 0; i < randomAccounts.size(); ++i) {
+          Address to = (i % 10 == 0) ? addresses[(i + 1) % addresses.size()] : Address(Utils::randBytes(20));
+          if (i % 7 == 0) to = addresses[(i * 13) % addresses.size()];
+          txs.emplace_back(to, addresses[i], Bytes(), 8080, 0, 1000000000000000000, 21000, 1000000000, 21000, randomAccounts[i]);
+          // Serial processing, as it would be done one by one
+          expectedBalances[addresses[i]] -= txs.back().getValue() + (txs.back().getMaxFeePerGas() * txs.back().getGasLimit());
+          expectedBalances[to] += txs.back().getValue();
+        }
+
+        auto block = createValidBlock(rdpos, storage, txs);
+        REQUIRE(state->validateNextBlock(block));
+        state->processNextBlock(std::move(block));
+        for (const auto& [address, balance] : expectedBalances) REQUIRE(state->getNativeBalance(address) == balance);
+        for (const auto& address : addresses) REQUIRE(state->getNativeNonce(address) == 1);
+
+        // Every changed account was saved along with the block, in the fixed-width encoding
+        for (const auto& address : {addresses.front(), txs.front().getTo()}) {
+          Bytes saved = db->get(address.get(), DBPrefix::nativeAccounts);
+          REQUIRE(saved.size() == Account::serializedSize);
+          REQUIRE(Account(saved).balance == U256(state->getNativeBalance(address)));
+          REQUIRE(Account(saved).nonce == state->getNativeNonce(address));
+        }
+        REQUIRE(db->has(storage->latest()->hash().get(), DBPrefix::blocks));
+      }
+    }
+
+    SECTION("Test State payable contract calls between transfers to new accounts") {
+      /// The account map grows several times within the block, around payable calls
+      /// from the same sender, which must still see (and update) the right account.
+      PrivKey ownerPrivKey(Hex::toBytes("0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867"));
+      Address owner = Secp256k1::toAddress(Secp256k1::toUPub(ownerPrivKey));
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<Options> options;
+      initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, true, "statePayableCallTest");
+
+      ABI::Encoder createWrapperEncoder({std::string("WrappedToken"), std::string("WTKN"), uint256_t(18)});
+      Bytes createWrapperData = Hex::toBytes("0xb296fad4");
+      Utils::appendBytes(createWrapperData, createWrapperEncoder.getData());
+      auto block = createValidBlock(rdpos, storage, {TxBlock(
+        ProtocolContractAddresses.at("ContractManager"), owner, createWrapperData, 8080, 0, 0, 0, 0, 0, ownerPrivKey
+      )});
+      state->processNextBlock(std::move(block));
+      Address wrapper = state->getContracts()[0].second;
+
+      uint256_t deposited("500000000000000000");
+      uint256_t withdrawn("200000000000000000");
+      uint256_t transferred("1000000000000000");
+      uint256_t fee = uint256_t(1000000000) * 21000;
+      uint256_t expectedBalance = state->getNativeBalance(owner);
+      uint64_t nonce = 1;
+      std::vector<TxBlock> txs;
+      std::vector<Address> recipients;
+      auto transfers = [&](uint64_t count) {
+        for (uint64_t i = 0; i < count; i++) {
+          recipients.emplace_back(Utils::randBytes(20));
+          txs.emplace_back(recipients.back(), owner, Bytes(), 8080, nonce++, transferred, 1000000000, 1000000000, 21000, ownerPrivKey);
+          expectedBalance -= transferred + fee;
+        }
+      };
+      txs.emplace_back(wrapper, owner, Hex::toBytes("0xd0e30db0"), 8080, nonce++, deposited, 1000000000, 1000000000, 21000, ownerPrivKey);
+      expectedBalance -= deposited + fee;
+      transfers(300);
+      ABI::Encoder withdrawEncoder({withdrawn}, "withdraw(uint256)");
+      Bytes withdrawData = Hex::toBytes("0x2e1a7d4d");
+      Utils::appendBytes(withdrawData, withdrawEncoder.getData());
+      txs.emplace_back(wrapper, owner, withdrawData, 8080, nonce++, 0, 1000000000, 1000000000, 21000, ownerPrivKey);
+      expectedBalance += withdrawn;
+      expectedBalance -= fee;
+      transfers(300);
+
+      block = createValidBlock(rdpos, storage, txs);
+      REQUIRE(state->validateNextBlock(block));
+      state->processNextBlock(std::move(block));
+      REQUIRE(state->getNativeBalance(owner) == expectedBalance);
+      REQUIRE(state->getNativeNonce(owner) == nonce);
+      REQUIRE(state->getNativeBalance(wrapper) == deposited - withdrawn);
+      for (const Address& recipient : recipients) REQUIRE(state->getNativeBalance(recipient) == transferred);
+      Bytes saved = db->get(owner.get(), DBPrefix::nativeAccounts);
+      REQUIRE(Account(saved).balance == U256(expectedBalance));
+      REQUIRE(Account(saved).nonce == nonce);
+
+      // The wrapper was saved with the blocks that changed it, not only on shutdown
+      REQUIRE(Utils::bytesToString(db->get(wrapper.get(), DBPrefix::contractManager)) == "NativeWrapper");
+      Bytes balancesPrefix = DBPrefix::contracts;
+      Utils::appendBytes(balancesPrefix, wrapper);
+      Utils::appendBytes(balancesPrefix, Utils::stringToBytes("_balances"));
+      REQUIRE(Utils::fromBigEndian<uint256_t>(db->get(owner.get(), balancesPrefix)) == deposited - withdrawn);
+    }
+
     SECTION("Test 10 blocks forward on State (100 Transactions per block)") {
       std::unordered_map<PrivKey, std::pair<uint256_t, uint64_t>, SafeHash> randomAccounts;
       for (uint64_t i = 0; i < 100; ++i) {
@@ -476,6 +805,180 @@ namespace TState {
       REQUIRE(state->getNativeBalance(targetOfTransactions) == targetExpectedValue);
     }
 
+    SECTION("Test State historical account queries") {
+      PrivKey privKey(Utils::randBytes(32));
+      Address me = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+      Address targetOfTransactions = Address(Utils::randBytes(20));
+      std::vector<std::pair<uint256_t, uint64_t>> senderByHeight;   // Sender's balance and nonce after each block
+      std::vector<uint256_t> targetByHeight;                         // Target's balance after each block
+      {
+        std::unique_ptr<DB> db;
+        std::unique_ptr<Storage> storage;
+        std::unique_ptr<P2P::ManagerNormal> p2p;
+        std::unique_ptr<rdPoS> rdpos;
+        std::unique_ptr<State> state;
+        std::unique_ptr<Options> options;
+        initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, true, "stateHistoryTest");
+        REQUIRE(state->getHistoryStart() == 0);
+        state->addBalance(me);
+        senderByHeight.emplace_back(state->getNativeBalance(me), 0);
+        targetByHeight.emplace_back(0);
+
+        for (uint64_t index = 0; index < 10; ++index) {
+          std::vector<TxBlock> txs = {TxBlock(
+            targetOfTransactions, me, Bytes(), 8080, state->getNativeNonce(me),
+            1000000000000000000, 21000, 1000000000, 1000000000, privKey
+          )};
+          state->processNextBlock(createValidBlock(rdpos, storage, txs));
+          senderByHeight.emplace_back(state->getNativeBalance(me), state->getNativeNonce(me));
+          targetByHeight.emplace_back(state->getNativeBalance(targetOfTransactions));
+        }
+
+        for (uint64_t height = 0; height <= 10; ++height) {
+          REQUIRE(state->getNativeBalance(me, height) == senderByHeight[height].first);
+          REQUIRE(state->getNativeNonce(me, height) == senderByHeight[height].second);
+          REQUIRE(state->getNativeBalance(targetOfTransactions, height) == targetByHeight[height]);
+        }
+        REQUIRE_THROWS(state->getNativeBalance(me, 11));
+
+        /// Shrinking the window prunes older blocks with the next one.
+        /// Lookups racing the pruning either see the old value or throw, never an empty account.
+        state->setHistoryRetention(3);
+        std::vector<TxBlock> txs = {TxBlock(
+          targetOfTransactions, me, Bytes(), 8080, state->getNativeNonce(me),
+          1000000000000000000, 21000, 1000000000, 1000000000, privKey
+        )};
+        std::atomic<bool> pruned = false;
+        std::atomic<uint64_t> wrongLookups = 0;
+        std::thread reader([&]() {
+          while (!pruned) {
+            try {
+              if (state->getNativeBalance(me, 5) != senderByHeight[5].first) wrongLookups++;
+            } catch (const std::exception&) {}
+          }
+        });
+        state->processNextBlock(createValidBlock(rdpos, storage, txs));
+        pruned = true;
+        reader.join();
+        REQUIRE(wrongLookups == 0);
+        senderByHeight.emplace_back(state->getNativeBalance(me), state->getNativeNonce(me));
+        targetByHeight.emplace_back(state->getNativeBalance(targetOfTransactions));
+        REQUIRE(state->getHistoryStart() == 8);
+        REQUIRE_THROWS(state->getNativeNonce(me, 7));
+      }
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<Options> options;
+      initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, false, "stateHistoryTest");
+
+      /// The retained window survives a restart
+      REQUIRE(state->getHistoryStart() == 8);
+      for (uint64_t height = 8; height <= 11; ++height) {
+        REQUIRE(state->getNativeBalance(me, height) == senderByHeight[height].first);
+        REQUIRE(state->getNativeNonce(me, height) == senderByHeight[height].second);
+        REQUIRE(state->getNativeBalance(targetOfTransactions, height) == targetByHeight[height]);
+      }
+    }
+
+    SECTION("Test State root and account proofs") {
+      PrivKey privKey(Utils::randBytes(32));
+      Address me = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+      Address targetOfTransactions = Address(Utils::randBytes(20));
+      std::vector<Hash> rootByHeight;
+      Bytes balanceKey;
+      {
+        std::unique_ptr<DB> db;
+        std::unique_ptr<Storage> storage;
+        std::unique_ptr<P2P::ManagerNormal> p2p;
+        std::unique_ptr<rdPoS> rdpos;
+        std::unique_ptr<State> state;
+        std::unique_ptr<Options> options;
+        initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, true, "stateRootTest");
+        REQUIRE(!db->getBatch(DBPrefix::stateTreeNodes).empty());
+        state->addBalance(me);
+        rootByHeight.emplace_back(state->getStateRoot());
+
+        for (uint64_t index = 0; index < 5; ++index) {
+          std::vector<TxBlock> txs = {TxBlock(
+            targetOfTransactions, me, Bytes(), 8080, state->getNativeNonce(me),
+            1000000000000000000, 21000, 1000000000, 1000000000, privKey
+          )};
+          state->processNextBlock(createValidBlock(rdpos, storage, txs));
+          Hash root = state->getStateRoot();
+          REQUIRE(root != rootByHeight.back());
+          rootByHeight.emplace_back(root);
+        }
+
+        /// Contract variables are committed to as well
+        ABI::Encoder createWrapperEncoder({std::string("WrappedToken"), std::string("WTKN"), uint256_t(18)});
+        Bytes createWrapperData = Hex::toBytes("0xb296fad4");
+        Utils::appendBytes(createWrapperData, createWrapperEncoder.getData());
+        state->processNextBlock(createValidBlock(rdpos, storage, {TxBlock(
+          ProtocolContractAddresses.at("ContractManager"), me, createWrapperData, 8080, state->getNativeNonce(me), 0, 0, 0, 0, privKey
+        )}));
+        rootByHeight.emplace_back(state->getStateRoot());
+        Address wrapper = state->getContracts()[0].second;
+        uint256_t deposited("500000000000000000");
+        state->processNextBlock(createValidBlock(rdpos, storage, {TxBlock(
+          wrapper, me, Hex::toBytes("0xd0e30db0"), 8080, state->getNativeNonce(me), deposited, 1000000000, 1000000000, 21000, privKey
+        )}));
+        REQUIRE(state->getStateRoot() != rootByHeight.back());
+        rootByHeight.emplace_back(state->getStateRoot());
+        balanceKey = DBPrefix::contracts;
+        Utils::appendBytes(balanceKey, wrapper);
+        Utils::appendBytes(balanceKey, Utils::stringToBytes("_balances"));
+        Utils::appendBytes(balanceKey, me);
+        auto balanceProof = state->getStateProof(balanceKey);
+        REQUIRE(balanceProof);
+        REQUIRE(StateTree::verify(*balanceProof, balanceKey, db->get(balanceKey), rootByHeight[7]));
+        REQUIRE(!StateTree::verify(*balanceProof, balanceKey, Utils::uintToBytes(uint256_t(1)), rootByHeight[7]));
+
+        for (uint64_t height = 0; height <= 7; ++height) REQUIRE(state->getStateRoot(height) == rootByHeight[height]);
+        REQUIRE_THROWS(state->getStateRoot(8));
+
+        auto proof = state->getAccountProof(targetOfTransactions);
+        REQUIRE(proof);
+        REQUIRE(StateTree::verify(*proof, targetOfTransactions,
+          Account(U256(state->getNativeBalance(targetOfTransactions)), 0), rootByHeight[7]
+        ));
+        REQUIRE(!StateTree::verify(*proof, targetOfTransactions, Account(U256(0), 0), rootByHeight[7]));
+        REQUIRE(!state->getAccountProof(Address(Utils::randBytes(20))));
+      }
+      {
+        std::unique_ptr<DB> db;
+        std::unique_ptr<Storage> storage;
+        std::unique_ptr<P2P::ManagerNormal> p2p;
+        std::unique_ptr<rdPoS> rdpos;
+        std::unique_ptr<State> state;
+        std::unique_ptr<Options> options;
+        initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, false, "stateRootTest");
+
+        /// The tree loaded on startup matches the saved root
+        REQUIRE(state->getStateRoot() == rootByHeight[7]);
+        REQUIRE(state->getStateProof(balanceKey));
+
+        /// Drop the saved tree, as if the node stopped before it was saved
+        DBBatch batch;
+        StateTree::erase(*db, batch);
+        REQUIRE(db->putBatch(batch));
+      }
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<Options> options;
+      initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, false, "stateRootTest");
+
+      /// The tree rebuilt from the whole state matches the one updated block by block
+      REQUIRE(state->getStateRoot() == rootByHeight[7]);
+      REQUIRE(state->getStateRoot(3) == rootByHeight[3]);
+      REQUIRE(!db->getBatch(DBPrefix::stateTreeNodes).empty());
+    }
+
     SECTION("State test with networking capabilities, 8 nodes, rdPoS fully active, test Tx Broadcast") {
       // Initialize 8 different node instances, with different ports and DBs.
       std::vector<PrivKey> randomAccounts;
@@ -721,30 +1224,30 @@ namespace TState {
         p2p1->broadcastTxBlock(tx);
       }
 
-      REQUIRE(state1->getMempool().size() == 100);
+      REQUIRE(state1->getMempool()->size() == 100);
       /// Wait for the transactions to be broadcasted.
       auto broadcastFuture = std::async(std::launch::async, [&]() {
-        while (state1->getMempool().size() != 100 ||
-               state2->getMempool().size() != 100 ||
-               state3->getMempool().size() != 100 ||
-               state4->getMempool().size() != 100 ||
-               state5->getMempool().size() != 100 ||
-               state6->getMempool().size() != 100 ||
-               state7->getMempool().size() != 100 ||
-               state8->getMempool().size() != 100) {
+        while (state1->getMempool()->size() != 100 ||
+               state2->getMempool()->size() != 100 ||
+               state3->getMempool()->size() != 100 ||
+               state4->getMempool()->size() != 100 ||
+               state5->getMempool()->size() != 100 ||
+               state6->getMempool()->size() != 100 ||
+               state7->getMempool()->size() != 100 ||
+               state8->getMempool()->size() != 100) {
           std::this_thread::sleep_for(std::chrono::microseconds(10));
         }
       });
 
       REQUIRE(broadcastFuture.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
 
-      REQUIRE(state1->getMempool() == state2->getMempool());
-      REQUIRE(state1->getMempool() == state3->getMempool());
-      REQUIRE(state1->getMempool() == state4->getMempool());
-      REQUIRE(state1->getMempool() == state5->getMempool());
-      REQUIRE(state1->getMempool() == state6->getMempool());
-      REQUIRE(state1->getMempool() == state7->getMempool());
-      REQUIRE(state1->getMempool() == state8->getMempool());
+      REQUIRE(*state1->getMempool() == *state2->getMempool());
+      REQUIRE(*state1->getMempool() == *state3->getMempool());
+      REQUIRE(*state1->getMempool() == *state4->getMempool());
+      REQUIRE(*state1->getMempool() == *state5->getMempool());
+      REQUIRE(*state1->getMempool() == *state6->getMempool());
+      REQUIRE(*state1->getMempool() == *state7->getMempool());
+      REQUIRE(*state1->getMempool() == *state8->getMempool());
 
       // Sleep so it can conclude the last operations.
       std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -969,18 +1472,26 @@ namespace TState {
       rdpos7->startrdPoSWorker();
       rdpos8->startrdPoSWorker();
 
+      // Genesis account, it deploys a wrapper and deposits into it along the way,
+      // so the snapshot has contract variables as well.
+      PrivKey genesisKey(Hex::toBytes("0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867"));
+      Address genesisAddress = Secp256k1::toAddress(Secp256k1::toUPub(genesisKey));
+      ABI::Encoder createWrapperEncoder({std::string("WrappedToken"), std::string("WTKN"), uint256_t(18)});
+      Bytes createWrapperData = Hex::toBytes("0xb296fad4");
+      Utils::appendBytes(createWrapperData, createWrapperEncoder.getData());
+
       // Loop for block creation.
       uint64_t blocks = 0;
       while (blocks < 10) {
-        while (rdpos1->getMempool().size() != 8) {
+        while (rdpos1->getMempool()->size() != 8) {
           std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
 
         for (auto &blockCreator: rdPoSreferences) {
           if (blockCreator.get()->canCreateBlock()) {
             // Create the block.
-            auto mempool = blockCreator.get()->getMempool();
-            auto randomList = blockCreator.get()->getRandomList();
+            auto mempool = *blockCreator.get()->getMempool();
+            auto randomList = *blockCreator.get()->getRandomList();
             // Order the transactions in the proper manner.
             std::vector<TxValidator> randomHashTxs;
             std::vector<TxValidator> randomnessTxs;
@@ -1019,6 +1530,18 @@ namespace TState {
             for (const auto &tx: randomnessTxs) {
               block.appendTxValidator(tx);
             }
+            if (blocks == 2) {
+              block.appendTx(TxBlock(
+                ProtocolContractAddresses.at("ContractManager"), genesisAddress, createWrapperData, 8080,
+                state1->getNativeNonce(genesisAddress), 0, 0, 0, 0, genesisKey
+              ));
+            } else if (blocks == 3) {
+              block.appendTx(TxBlock(
+                state1->getContracts()[0].second, genesisAddress, Hex::toBytes("0xd0e30db0"), 8080,
+                state1->getNativeNonce(genesisAddress), uint256_t("500000000000000000"),
+                1000000000, 1000000000, 21000, genesisKey
+              ));
+            }
 
             blockCreator.get()->signBlock(block);
             // Validate the block.
@@ -1056,6 +1579,148 @@ namespace TState {
       rdpos8->stoprdPoSWorker();
       // Sleep so it can conclude the last operations.
       std::this_thread::sleep_for(std::chrono::seconds(1));
+
+      // A fresh node should catch up by downloading from three of them at once.
+      std::unique_ptr<DB> db9;
+      std::unique_ptr<Storage> storage9;
+      std::unique_ptr<P2P::ManagerNormal> p2p9;
+      std::unique_ptr<rdPoS> rdpos9;
+      std::unique_ptr<State> state9;
+      std::unique_ptr<Options> options9;
+      initialize(db9, storage9, p2p9, rdpos9, state9, options9, PrivKey(), 8088, true,
+                 "stateNode9NetworkCapabilities");
+      p2p9->start();
+      p2p9->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8080);
+      p2p9->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8081);
+      p2p9->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8082);
+      auto syncConnectionsFuture = std::async(std::launch::async, [&]() {
+        while (p2p9->getSessionsIDs().size() != 3) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      });
+      REQUIRE(syncConnectionsFuture.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
+
+      std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash> syncNodes;
+      for (const auto& nodeId : p2p9->getSessionsIDs()) syncNodes[nodeId] = p2p9->requestNodeInfo(nodeId);
+      REQUIRE(p2p9->requestHeaders(syncNodes.begin()->first, 1, 100).size() == 10);
+      REQUIRE(p2p9->requestBlocks(syncNodes.begin()->first, 11, 1).empty());
+
+      BlockSync blockSync(p2p9, storage9, state9, options9);
+      std::atomic<bool> stopSync = false;
+      REQUIRE(blockSync.sync(syncNodes, stopSync) == 10);
+      REQUIRE(storage9->latest()->hash() == storage1->latest()->hash());
+      REQUIRE(blockSync.sync(syncNodes, stopSync) == 0);  // Nothing left
+
+      // A 10th node bootstraps from the snapshot the others serve, no blocks to replay
+      REQUIRE(p2p9->requestSnapshotManifest(syncNodes.begin()->first).empty());
+      auto snapshot1 = state1->takeSnapshot();
+      REQUIRE(state2->takeSnapshot()->getManifestHash() == snapshot1->getManifestHash());
+      REQUIRE(state3->takeSnapshot()->getManifestHash() == snapshot1->getManifestHash());
+      REQUIRE(snapshot1->getHeight() == 10);
+      REQUIRE(snapshot1->getManifest().stateRoot == state1->getStateRoot());
+      REQUIRE(p2p9->requestSnapshotChunk(syncNodes.begin()->first, 10, snapshot1->getChunkCount()).empty());
+
+      std::unique_ptr<DB> db10;
+      std::unique_ptr<Storage> storage10;
+      std::unique_ptr<P2P::ManagerNormal> p2p10;
+      std::unique_ptr<rdPoS> rdpos10;
+      std::unique_ptr<State> state10;
+      std::unique_ptr<Options> options10;
+      initialize(db10, storage10, p2p10, rdpos10, state10, options10, PrivKey(), 8089, true,
+                 "stateNode10NetworkCapabilities");
+      p2p10->start();
+      p2p10->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8080);
+      p2p10->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8081);
+      p2p10->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8082);
+      auto snapshotConnectionsFuture = std::async(std::launch::async, [&]() {
+        while (p2p10->getSessionsIDs().size() != 3) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      });
+      REQUIRE(snapshotConnectionsFuture.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
+
+      std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash> snapshotNodes;
+      for (const auto& nodeId : p2p10->getSessionsIDs()) snapshotNodes[nodeId] = p2p10->requestNodeInfo(nodeId);
+      SnapshotSync snapshotSync(p2p10, storage10, state10);
+      REQUIRE(snapshotSync.sync(snapshotNodes, stopSync) == 0);  // Not far enough ahead for the default
+      REQUIRE(snapshotSync.sync(snapshotNodes, stopSync, 1, 4) == 0);  // Offered by fewer peers than the quorum
+      REQUIRE(snapshotSync.sync(snapshotNodes, stopSync, 1) == 10);
+      REQUIRE(storage10->latest()->hash() == storage1->latest()->hash());
+      REQUIRE(state10->getStateRoot() == state1->getStateRoot());
+      REQUIRE(state10->getStateRoot(10) == state1->getStateRoot(10));
+      REQUIRE(state10->getHistoryStart() == 10);
+      auto accounts1 = state1->getAccounts();
+      auto accounts10 = state10->getAccounts();
+      REQUIRE(accounts10->size() == accounts1->size());
+      for (const auto& [address, account] : *accounts1) {
+        auto synced = accounts10->find(address);
+        REQUIRE(synced != accounts10->end());
+        REQUIRE(synced->second.serialize() == account.serialize());
+      }
+      REQUIRE(*rdpos10->getValidators() == *rdpos1->getValidators());
+      REQUIRE(state1->getContracts().size() == 1);
+      REQUIRE(state10->getContracts() == state1->getContracts());
+      Bytes wrapperPrefix = DBPrefix::contracts;
+      Utils::appendBytes(wrapperPrefix, state1->getContracts()[0].second);
+      auto wrapperEntries1 = db1->getBatch(wrapperPrefix);
+      auto wrapperEntries10 = db10->getBatch(wrapperPrefix);
+      REQUIRE(!wrapperEntries1.empty());
+      REQUIRE(wrapperEntries10.size() == wrapperEntries1.size());
+      for (uint64_t i = 0; i < wrapperEntries1.size(); ++i) {
+        REQUIRE(wrapperEntries10[i].key == wrapperEntries1[i].key);
+        REQUIRE(wrapperEntries10[i].value == wrapperEntries1[i].value);
+      }
+      Bytes balanceKey = Utils::stringToBytes("_balances");
+      Utils::appendBytes(balanceKey, genesisAddress);
+      REQUIRE(db10->get(balanceKey, wrapperPrefix) == Utils::uintToBytes(uint256_t("500000000000000000")));
+      REQUIRE(storage10->getBlock(5) == nullptr);  // Never synced
+      BlockSync tailSync(p2p10, storage10, state10, options10);
+      REQUIRE(tailSync.sync(snapshotNodes, stopSync) == 0);  // Nothing past the snapshot
+
+      // Misbehaving peers: a fork ahead of the network (so it's asked for the headers
+      // first) and a node claiming blocks it doesn't have. Neither can stop the sync.
+      std::unique_ptr<DB> dbFork;
+      std::unique_ptr<Storage> storageFork;
+      std::unique_ptr<P2P::ManagerNormal> p2pFork;
+      std::unique_ptr<rdPoS> rdposFork;
+      std::unique_ptr<State> stateFork;
+      std::unique_ptr<Options> optionsFork;
+      initialize(dbFork, storageFork, p2pFork, rdposFork, stateFork, optionsFork, validatorPrivKeys[0], 8090, true,
+                 "stateNodeForkNetworkCapabilities");
+      for (uint64_t i = 0; i < 12; ++i) stateFork->processNextBlock(createValidBlock(rdposFork, storageFork));
+      p2pFork->start();
+
+      std::unique_ptr<DB> dbEmpty;
+      std::unique_ptr<Storage> storageEmpty;
+      std::unique_ptr<P2P::ManagerNormal> p2pEmpty;
+      std::unique_ptr<rdPoS> rdposEmpty;
+      std::unique_ptr<State> stateEmpty;
+      std::unique_ptr<Options> optionsEmpty;
+      initialize(dbEmpty, storageEmpty, p2pEmpty, rdposEmpty, stateEmpty, optionsEmpty, PrivKey(), 8091, true,
+                 "stateNodeEmptyNetworkCapabilities");
+      p2pEmpty->start();
+
+      std::unique_ptr<DB> db11;
+      std::unique_ptr<Storage> storage11;
+      std::unique_ptr<P2P::ManagerNormal> p2p11;
+      std::unique_ptr<rdPoS> rdpos11;
+      std::unique_ptr<State> state11;
+      std::unique_ptr<Options> options11;
+      initialize(db11, storage11, p2p11, rdpos11, state11, options11, PrivKey(), 8092, true,
+                 "stateNode11NetworkCapabilities");
+      p2p11->start();
+      for (uint64_t port : {8080, 8081, 8082, 8090, 8091}) {
+        p2p11->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), port);
+      }
+      auto badPeersConnectionsFuture = std::async(std::launch::async, [&]() {
+        while (p2p11->getSessionsIDs().size() != 5) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      });
+      REQUIRE(badPeersConnectionsFuture.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
+
+      std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash> badPeersNodes;
+      for (const auto& nodeId : p2p11->getSessionsIDs()) {
+        badPeersNodes[nodeId] = p2p11->requestNodeInfo(nodeId);
+        if (nodeId.second == 8091) badPeersNodes[nodeId].latestBlockHeight = 10;  // Lies about its height
+      }
+      BlockSync badPeersSync(p2p11, storage11, state11, options11);
+      REQUIRE(badPeersSync.sync(badPeersNodes, stopSync) == 10);
+      REQUIRE(storage11->latest()->hash() == storage1->latest()->hash());
     }
 
     SECTION("State test with networking capabilities, 8 nodes, rdPoS fully active, 100 transactions per block") {
@@ -1306,7 +1971,7 @@ namespace TState {
       uint64_t blocks = 0;
       while (blocks < 10) {
         auto rdPoSmempoolFuture = std::async(std::launch::async, [&]() {
-          while (rdpos1->getMempool().size() != 8) {
+          while (rdpos1->getMempool()->size() != 8) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
           }
         });
@@ -1315,8 +1980,8 @@ namespace TState {
         for (auto &blockCreator: rdPoSreferences) {
           if (blockCreator.get()->canCreateBlock()) {
             // Create the block.
-            auto mempool = blockCreator.get()->getMempool();
-            auto randomList = blockCreator.get()->getRandomList();
+            auto mempool = *blockCreator.get()->getMempool();
+            auto randomList = *blockCreator.get()->getRandomList();
             // Order the transactions in the proper manner.
             std::vector<TxValidator> randomHashTxs;
             std::vector<TxValidator> randomnessTxs;
@@ -1677,7 +2342,7 @@ namespace TState {
       uint64_t blocks = 0;
       while (blocks < 10) {
         auto rdPoSmempoolFuture = std::async(std::launch::async, [&]() {
-          while (rdpos1->getMempool().size() != 8) {
+          while (rdpos1->getMempool()->size() != 8) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
           }
         });
@@ -1687,8 +2352,8 @@ namespace TState {
         for (auto &blockCreator: rdPoSreferences) {
           if (blockCreator.get()->canCreateBlock()) {
             // Create the block.
-            auto mempool = blockCreator.get()->getMempool();
-            auto randomList = blockCreator.get()->getRandomList();
+            auto mempool = *blockCreator.get()->getMempool();
+            auto randomList = *blockCreator.get()->getRandomList();
             // Order the transactions in the proper manner.
             std::vector<TxValidator> randomHashTxs;
             std::vector<TxValidator> randomnessTxs;
@@ -2067,7 +2732,7 @@ namespace TState {
       uint64_t blocks = 0;
       while (blocks < 10) {
         auto rdPoSmempoolFuture = std::async(std::launch::async, [&]() {
-          while (rdpos1->getMempool().size() != 8) {
+          while (rdpos1->getMempool()->size() != 8) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
           }
         });
@@ -2077,8 +2742,8 @@ namespace TState {
         for (auto &blockCreator: rdPoSreferences) {
           if (blockCreator.get()->canCreateBlock()) {
             // Create the block.
-            auto mempool = blockCreator.get()->getMempool();
-            auto randomList = blockCreator.get()->getRandomList();
+            auto mempool = *blockCreator.get()->getMempool();
+            auto randomList = *blockCreator.get()->getRandomList();
             // Order the transactions in the proper manner.
             std::vector<TxValidator> randomHashTxs;
             std::vector<TxValidator> randomnessTxs;
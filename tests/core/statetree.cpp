@@ -0,0 +1,172 @@
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/core/statetree.h"
+
+#include <filesystem>
+
+namespace TStateTree {
+  // Address for a given index.
+  Address makeAddress(const uint64_t& i) { return Address(Utils::sha3(Utils::uint64ToBytes(i)).view_const(0, 20)); }
+
+  // Key of a contract variable for a given index, longer than an account's.
+  Bytes makeContractKey(const uint64_t& i) {
+    Bytes key = DBPrefix::contracts;
+    Utils::appendBytes(key, makeAddress(i % 10));
+    Utils::appendBytes(key, Utils::stringToBytes("_balances"));
+    Utils::appendBytes(key, makeAddress(i));
+    return key;
+  }
+
+  // Value of a contract variable.
+  Bytes makeValue(const uint64_t& i) {
+    BytesArr<32> value = Utils::uint256ToBytes(i);
+    return Bytes(value.cbegin(), value.cend());
+  }
+
+  // Serialized account, as the tree has it.
+  Bytes accountValue(const Account& account) {
+    BytesArr<Account::serializedSize> serialized = account.serialize();
+    return Bytes(serialized.cbegin(), serialized.cend());
+  }
+
+  TEST_CASE("StateTree Class", "[core][statetree]") {
+    SECTION("Empty tree and single entry") {
+      StateTree tree;
+      Hash emptyRoot = tree.getRoot();
+      REQUIRE(emptyRoot != Hash());
+      REQUIRE(tree.size() == 0);
+      REQUIRE(!tree.getProof(StateTree::accountKey(makeAddress(0))));
+
+      tree.update({{StateTree::accountKey(makeAddress(0)), accountValue(Account(U256(10), 1))}});
+      REQUIRE(tree.size() == 1);
+      REQUIRE(tree.getRoot() != emptyRoot);
+      auto proof = tree.getProof(StateTree::accountKey(makeAddress(0)));
+      REQUIRE(proof);
+      REQUIRE(proof->siblings.size() == StateTree::depth);
+      REQUIRE(StateTree::verify(*proof, makeAddress(0), Account(U256(10), 1), tree.getRoot()));
+      REQUIRE(!StateTree::verify(*proof, makeAddress(0), Account(U256(11), 1), tree.getRoot()));
+      REQUIRE(!StateTree::verify(*proof, makeAddress(0), Account(U256(10), 1), emptyRoot));
+
+      // Saving the entry again with the same value changes nothing
+      Hash root = tree.getRoot();
+      tree.update({{StateTree::accountKey(makeAddress(0)), accountValue(Account(U256(10), 1))}});
+      REQUIRE(tree.getRoot() == root);
+
+      // Removing the only entry brings back the empty root
+      tree.update({{StateTree::accountKey(makeAddress(0)), std::nullopt}});
+      REQUIRE(tree.size() == 0);
+      REQUIRE(tree.getRoot() == emptyRoot);
+    }
+
+    SECTION("Incremental updates match a full rebuild") {
+      std::map<Bytes, Bytes> entries;
+      for (uint64_t i = 0; i < 10000; i++) {
+        entries[StateTree::accountKey(makeAddress(i))] = accountValue(Account(U256(i), i));
+        entries[makeContractKey(i)] = makeValue(i);
+      }
+      StateTree tree(entries);
+      REQUIRE(tree.size() == 20000);
+      REQUIRE(tree.getRoot() == StateTree(entries).getRoot());
+
+      // Every "block" changes, creates and removes a few entries
+      for (uint64_t block = 1; block <= 20; block++) {
+        StateTree::Changes changes;
+        for (uint64_t i = 0; i < 100; i++) {
+          Bytes changed = StateTree::accountKey(makeAddress((block * 7919 + i * 104729) % 10000));
+          if (std::find_if(changes.begin(), changes.end(),
+            [&](const auto& change) { return change.first == changed; }
+          ) != changes.end()) continue;
+          entries[changed] = accountValue(Account(U256(block * 1000 + i), block));
+          changes.emplace_back(changed, entries[changed]);
+        }
+        Bytes created = makeContractKey(10000 + block);
+        entries[created] = makeValue(block);
+        changes.emplace_back(created, entries[created]);
+        Bytes removed = makeContractKey(10000 + block - 1);
+        if (entries.erase(removed)) changes.emplace_back(removed, std::nullopt);
+        tree.update(changes);
+        REQUIRE(tree.size() == entries.size());
+      }
+      Hash root = tree.getRoot();
+      REQUIRE(root == StateTree(entries).getRoot());
+
+      // Every entry has a valid proof, a missing or stale one doesn't
+      for (uint64_t i = 0; i < 10000; i += 97) {
+        Bytes key = StateTree::accountKey(makeAddress(i));
+        auto proof = tree.getProof(key);
+        REQUIRE(proof);
+        REQUIRE(StateTree::verify(*proof, key, entries[key], root));
+        proof = tree.getProof(makeContractKey(i));
+        REQUIRE(proof);
+        REQUIRE(StateTree::verify(*proof, makeContractKey(i), makeValue(i), root));
+      }
+      REQUIRE(!tree.getProof(makeContractKey(10000 + 5)));
+      auto proof = tree.getProof(makeContractKey(10000 + 20));
+      REQUIRE(proof);
+      REQUIRE(!StateTree::verify(*proof, makeContractKey(10000 + 20), makeValue(0), root));
+    }
+
+    SECTION("Persisted tree loads back the same") {
+      if (std::filesystem::exists("stateTreeTests")) std::filesystem::remove_all("stateTreeTests");
+      DB db("stateTreeTests/db");
+      StateTree tree;
+      std::map<Bytes, Bytes> entries;
+      for (uint64_t block = 0; block < 10; block++) {
+        StateTree::Changes changes;
+        for (uint64_t i = block * 500; i < (block + 1) * 500; i++) {
+          entries[makeContractKey(i)] = makeValue(i);
+          changes.emplace_back(makeContractKey(i), entries[makeContractKey(i)]);
+        }
+        if (block > 0) {
+          entries.erase(makeContractKey(block));
+          changes.emplace_back(makeContractKey(block), std::nullopt);
+        }
+        DBBatch batch;
+        tree.update(changes, batch);
+        REQUIRE(db.putBatch(batch));
+        StateTree loaded(db);
+        REQUIRE(loaded.getRoot() == tree.getRoot());
+        REQUIRE(loaded.size() == tree.size());
+      }
+      REQUIRE(tree.getRoot() == StateTree(entries).getRoot());
+
+      // The loaded tree keeps being updated like the original
+      StateTree loaded(db);
+      StateTree::Changes changes = {{makeContractKey(0), makeValue(42)}, {makeContractKey(1000), std::nullopt}};
+      tree.update(changes);
+      loaded.update(changes);
+      REQUIRE(loaded.getRoot() == tree.getRoot());
+      auto proof = loaded.getProof(makeContractKey(0));
+      REQUIRE(proof);
+      REQUIRE(StateTree::verify(*proof, makeContractKey(0), makeValue(42), tree.getRoot()));
+
+      // A rebuilt tree replaces the persisted one as a whole
+      DBBatch batch;
+      StateTree rebuilt(std::map<Bytes, Bytes>{{makeContractKey(0), makeValue(0)}});
+      StateTree::erase(db, batch);
+      rebuilt.dump(batch);
+      REQUIRE(db.putBatch(batch));
+      StateTree reloaded(db);
+      REQUIRE(reloaded.getRoot() == rebuilt.getRoot());
+      REQUIRE(reloaded.size() == 1);
+    }
+
+    SECTION("Updates big enough to be hashed in parallel") {
+      std::map<Bytes, Bytes> entries;
+      StateTree::Changes changes;
+      StateTree tree;
+      for (uint64_t i = 0; i < 50000; i++) {
+        entries[StateTree::accountKey(makeAddress(i))] = accountValue(Account(U256(i), 0));
+        changes.emplace_back(StateTree::accountKey(makeAddress(i)), accountValue(Account(U256(i), 0)));
+      }
+      tree.update(changes);
+      REQUIRE(tree.getRoot() == StateTree(entries).getRoot());
+      changes.clear();
+      for (uint64_t i = 0; i < 50000; i += 2) {
+        entries[StateTree::accountKey(makeAddress(i))] = accountValue(Account(U256(i), 1));
+        changes.emplace_back(StateTree::accountKey(makeAddress(i)), accountValue(Account(U256(i), 1)));
+      }
+      tree.update(changes);
+      REQUIRE(tree.getRoot() == StateTree(entries).getRoot());
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/core/stateview.h"
+
+namespace TStateView {
+  // Address for a given index.
+  Address makeAddress(const uint64_t& i) { return Address(Utils::sha3(Utils::uint64ToBytes(i)).view_const(0, 20)); }
+
+  TEST_CASE("StateView Class", "[core][stateview]") {
+    SECTION("Views see their own block, layered over the base") {
+      StateView::Accounts accounts;
+      for (uint64_t i = 0; i < 100; i++) accounts.insert({makeAddress(i), Account(U256(i), i)});
+      auto genesis = std::make_shared<const StateView>(0, std::make_shared<const StateView::Accounts>(accounts));
+
+      // Block 1 changes one account and creates another
+      accounts[makeAddress(5)] = Account(U256(500), 6);
+      accounts[makeAddress(100)] = Account(U256(1), 1);
+      StateView::Accounts changes;
+      changes.insert({makeAddress(5), accounts[makeAddress(5)]});
+      changes.insert({makeAddress(100), accounts[makeAddress(100)]});
+      auto view1 = genesis->next(1, std::move(changes), accounts);
+
+      REQUIRE(view1->getHeight() == 1);
+      REQUIRE(view1->getLayerCount() == 1);
+      REQUIRE(view1->getNativeBalance(makeAddress(5)) == 500);
+      REQUIRE(view1->getNativeNonce(makeAddress(5)) == 6);
+      REQUIRE(view1->getNativeNonce(makeAddress(100)) == 1);
+      REQUIRE(view1->getNativeNonce(makeAddress(7)) == 7);
+      REQUIRE(view1->find(makeAddress(101)) == nullptr);
+
+      // The older view is untouched
+      REQUIRE(genesis->getNativeBalance(makeAddress(5)) == 5);
+      REQUIRE(genesis->getNativeNonce(makeAddress(100)) == 0);
+
+      // Collecting a view gives every account as of its block
+      StateView::Accounts collected = view1->collect();
+      REQUIRE(collected.size() == accounts.size());
+      for (const auto& [address, account] : accounts) {
+        REQUIRE(collected.at(address).serialize() == account.serialize());
+      }
+      REQUIRE(genesis->collect().size() == 100);
+    }
+
+    SECTION("Layers are merged and the base is rebuilt as blocks go by") {
+      const uint64_t accountCount = 5000, perBlock = 300, blocks = 100;
+      StateView::Accounts accounts;
+      for (uint64_t i = 0; i < accountCount; i++) accounts.insert({makeAddress(i), Account(U256(0), 0)});
+      std::shared_ptr<const StateView> view = std::make_shared<const StateView>(
+        0, std::make_shared<const StateView::Accounts>(accounts)
+      );
+      std::vector<std::shared_ptr<const StateView>> history = {view};
+      bool rebuilt = false;
+      for (uint64_t height = 1; height <= blocks; height++) {
+        // Every block sets the nonce of the next `perBlock` accounts to its height
+        StateView::Accounts changes;
+        for (uint64_t i = 0; i < perBlock; i++) {
+          Address address = makeAddress((height * perBlock + i) % accountCount);
+          accounts[address].nonce = height;
+          changes.insert_or_assign(address, accounts[address]);
+        }
+        view = view->next(height, std::move(changes), accounts);
+        REQUIRE(view->getLayerCount() <= StateView::maxLayers);
+        if (view->getLayerCount() == 0) rebuilt = true;
+        history.push_back(view);
+      }
+      REQUIRE(rebuilt);
+
+      // Every view still agrees with the nonces as of its own block
+      for (uint64_t height = 0; height <= blocks; height++) {
+        for (uint64_t i = 0; i < accountCount; i++) {
+          uint64_t expected = 0;
+          for (uint64_t h = height; h > 0; h--) {
+            if ((i + accountCount - (h * perBlock) % accountCount) % accountCount < perBlock) { expected = h; break; }
+          }
+          REQUIRE(history[height]->getNativeNonce(makeAddress(i)) == expected);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,72 @@
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/core/syncpeer.h"
+
+#include <deque>
+
+namespace TSyncPeer {
+  TEST_CASE("SyncPeer and runSyncWorker", "[core][syncpeer]") {
+    SECTION("Failures in a row drop a peer, a delivery resets them") {
+      SyncPeer peer({boost::asio::ip::address::from_string("127.0.0.1"), 8080});
+      REQUIRE(!peer.failed());
+      REQUIRE(!peer.failed());
+      peer.delivered(5);
+      REQUIRE(peer.failures == 0);
+      REQUIRE(peer.downloaded == 5);
+      for (uint64_t i = 1; i < SyncPeer::maxFailures; i++) REQUIRE(!peer.failed());
+      REQUIRE(peer.failed());
+      peer.alive = false;
+      REQUIRE(peer.describe() == "127.0.0.1:8080=5(dropped)");
+      REQUIRE(SyncPeer::describe(std::vector<SyncPeer>{peer, peer}) == " 127.0.0.1:8080=5(dropped) 127.0.0.1:8080=5(dropped)");
+    }
+
+    SECTION("Jobs a peer fails are handed to the others") {
+      std::mutex mutex;
+      std::condition_variable cv;
+      std::atomic<bool> stop = false;
+      std::deque<uint64_t> pending = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+      uint64_t remaining = pending.size();
+      std::vector<uint64_t> doneBy(pending.size(), 0);
+      std::vector<SyncPeer> peers = {
+        SyncPeer({boost::asio::ip::address::from_string("127.0.0.1"), 8080}),
+        SyncPeer({boost::asio::ip::address::from_string("127.0.0.1"), 8081})
+      };
+
+      // The first peer fails every job, the second one delivers every job
+      auto worker = [&](const uint64_t index) {
+        runSyncWorker(mutex, cv, stop,
+          [&]() { return remaining == 0; },
+          [&]() -> std::optional<uint64_t> {
+            if (pending.empty()) return std::nullopt;
+            uint64_t job = pending.front();
+            pending.pop_front();
+            return job;
+          },
+          [&](const uint64_t&) { return index == 1; },
+          [&](const uint64_t& job, bool&& ok) {
+            SyncPeer& peer = peers[index];
+            if (!ok) {
+              pending.emplace_back(job);
+              if (peer.failed()) peer.alive = false;
+            } else {
+              peer.delivered(1);
+              doneBy[job] = index;
+              remaining--;
+            }
+            return peer.alive;
+          }
+        );
+      };
+      worker(0);  // Alone, so it's dropped before anyone else takes the jobs
+      REQUIRE(!peers[0].alive);
+      REQUIRE(peers[0].failures == SyncPeer::maxFailures);
+      REQUIRE(pending.size() == 10);
+      worker(1);
+
+      REQUIRE(remaining == 0);
+      REQUIRE(peers[0].downloaded == 0);
+      REQUIRE(peers[1].alive);
+      REQUIRE(peers[1].downloaded == 10);
+      for (const uint64_t& index : doneBy) REQUIRE(index == 1);
+    }
+  }
+}
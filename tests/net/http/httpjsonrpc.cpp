@@ -378,6 +378,14 @@ namespace THTTPJsonRPC{
 
       json eth_sendRawTransactionResponse = requestMethod("eth_sendRawTransaction", json::array({Hex::fromBytes(txToSend.rlpSerialize(),true).forRPC()}));
       REQUIRE(eth_sendRawTransactionResponse["result"] == txToSend.hash().hex(true));
+      eth_sendRawTransactionResponse = requestMethod("eth_sendRawTransaction", json::array({Hex::fromBytes(txToSend.rlpSerialize(),true).forRPC()}));
+      REQUIRE(eth_sendRawTransactionResponse["error"]["message"] == "Transaction already known");
+
+      json debug_getConsensusTraceResponse = requestMethod("debug_getConsensusTrace", json::array({"0x1"}));
+      REQUIRE(debug_getConsensusTraceResponse["result"].is_array());
+      REQUIRE(debug_getConsensusTraceResponse["result"][0]["height"] == 1);
+      debug_getConsensusTraceResponse = requestMethod("debug_getConsensusTrace", json::array({"0x0", "chrome"}));
+      REQUIRE(debug_getConsensusTraceResponse["result"].contains("traceEvents"));
 
       for (uint64_t i = 0; i < transactions.size(); ++i) {
         json eth_getTransactionByHash = requestMethod("eth_getTransactionByHash", json::array({transactions[i].hash().hex(true)}));
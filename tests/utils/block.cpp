@@ -573,5 +573,48 @@ namespace TBlock {
       REQUIRE(newBlock.getTxs().size() == 0);
       REQUIRE(newBlock.isFinalized() == false);
     }
+
+    SECTION("Block serialization with exact size and into an existing buffer") {
+      PrivKey blockValidatorPrivKey = PrivKey::random();
+      uint64_t nHeight = 12345;
+      Block newBlock = Block(Hash::random(), 1678400201858, nHeight);
+      for (uint64_t i = 0; i < 100; ++i) {
+        PrivKey txPrivKey = PrivKey::random();
+        TxBlock tx(
+          Address(Utils::randBytes(20)),
+          Secp256k1::toAddress(Secp256k1::toUPub(txPrivKey)),
+          Utils::randBytes(i * 3), // Covers both short and long RLP data
+          8080,
+          uint256_t(i),
+          uint256_t(Utils::bytesToUint64(Utils::randBytes(8))),
+          uint256_t(Utils::bytesToUint32(Utils::randBytes(4))),
+          uint256_t(Utils::bytesToUint32(Utils::randBytes(4))),
+          uint256_t(Utils::bytesToUint32(Utils::randBytes(4))),
+          txPrivKey
+        );
+        REQUIRE(tx.rlpSize() == tx.rlpSerialize().size());
+        REQUIRE(tx.rlpSize(false) == tx.rlpSerialize(false).size());
+        newBlock.appendTx(std::move(tx));
+      }
+      for (uint64_t i = 0; i < 8; ++i) {
+        PrivKey txValidatorPrivKey = PrivKey::random();
+        Bytes data = Hex::toBytes("0xcfffe746");
+        Utils::appendBytes(data, Hash::random());
+        TxValidator tx(Secp256k1::toAddress(Secp256k1::toUPub(txValidatorPrivKey)), data, 8080, nHeight, txValidatorPrivKey);
+        REQUIRE(tx.rlpSize() == tx.rlpSerialize().size());
+        newBlock.appendTxValidator(std::move(tx));
+      }
+      newBlock.finalize(blockValidatorPrivKey, 1678400201859);
+
+      Bytes serialized = newBlock.serializeBlock();
+      REQUIRE(newBlock.serializedSize() == serialized.size());
+      REQUIRE(Block(serialized, 8080).hash() == newBlock.hash());
+
+      // Offsets inside the block must not depend on what is already in the buffer
+      Bytes prefixed = {0xde, 0xad, 0xbe, 0xef};
+      newBlock.serializeBlock(prefixed);
+      REQUIRE(prefixed.size() == serialized.size() + 4);
+      REQUIRE(Bytes(prefixed.begin() + 4, prefixed.end()) == serialized);
+    }
   }
 }
@@ -0,0 +1,92 @@
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/utils.h"
+#include "../../src/utils/tx.h"
+#include "../../src/utils/block.h"
+#include "../../src/utils/blockbuilder.h"
+
+using Catch::Matchers::Equals;
+
+namespace TBlockBuilder {
+  TEST_CASE("BlockBuilder Class", "[utils][blockbuilder]") {
+    SECTION("BlockBuilder with no transactions") {
+      PrivKey validatorPrivKey(Hex::toBytes("0x4d5db4107d237df6a3d58ee5f70ae63d73d765d8a1214214d8a13340d0f2750d"));
+      Hash nPrevBlockHash(Hex::toBytes("22143e16db549af9ccfd3b746ea4a74421847fa0fe7e0e278626a4e7307ac0f6"));
+      uint64_t timestamp = 1678400201858;
+      uint64_t nHeight = 92137812;
+      BlockBuilder builder(nPrevBlockHash, timestamp, nHeight);
+      REQUIRE(builder.getSerializedSize() == 217);
+      REQUIRE(builder.getTxMerkleRoot() == Hash());
+      REQUIRE(builder.getValidatorMerkleRoot() == Hash());
+
+      // Same block as "Block creation with no transactions" in tests/utils/block.cpp
+      Block newBlock = builder.finalize(validatorPrivKey, timestamp + 1);
+      REQUIRE(newBlock.isFinalized());
+      REQUIRE(newBlock.getValidatorSig() == Signature(Hex::toBytes("18395ff0c8ee38a250b9e7aeb5733c437fed8d6ca2135fa634367bb288a3830a3c624e33401a1798ce09f049fb6507adc52b085d0a83dacc43adfa519c1228e701")));
+      REQUIRE(newBlock.getValidatorPubKey() == UPubKey(Hex::toBytes("046ab1f056c30ae181f92e97d0cbb73f4a8778e926c35f10f0c4d1626d8dfd51672366413809a48589aa103e1865e08bd6ddfd0559e095841eb1bd3021d9cc5e62")));
+      REQUIRE(newBlock.serializeBlock().size() == 217);
+    }
+
+    SECTION("BlockBuilder matches Block::finalize with 500 transactions and 64 validator transactions") {
+      PrivKey blockValidatorPrivKey = PrivKey::random();
+      Hash nPrevBlockHash = Hash::random();
+      uint64_t timestamp = 64545214243;
+      uint64_t nHeight = 6414363551;
+      Block expectedBlock(nPrevBlockHash, timestamp, nHeight);
+      BlockBuilder builder(nPrevBlockHash, timestamp, nHeight);
+
+      for (uint64_t i = 0; i < 500; ++i) {
+        PrivKey txPrivKey = PrivKey::random();
+        TxBlock tx(
+          Address(Utils::randBytes(20)),
+          Secp256k1::toAddress(Secp256k1::toUPub(txPrivKey)),
+          Utils::randBytes(32),
+          8080,
+          uint256_t(Utils::bytesToUint32(Utils::randBytes(4))),
+          uint256_t(Utils::bytesToUint64(Utils::randBytes(8))),
+          uint256_t(Utils::bytesToUint32(Utils::randBytes(4))),
+          uint256_t(Utils::bytesToUint32(Utils::randBytes(4))),
+          uint256_t(Utils::bytesToUint32(Utils::randBytes(4))),
+          txPrivKey
+        );
+        expectedBlock.appendTx(tx);
+        builder.appendTx(std::move(tx));
+        REQUIRE(builder.getTxs().size() == i + 1);
+      }
+
+      std::vector<Hash> randomSeeds(32, Hash::random());
+      for (const auto &seed : randomSeeds) {
+        PrivKey txValidatorPrivKey = PrivKey::random();
+        Address validatorAddress = Secp256k1::toAddress(Secp256k1::toUPub(txValidatorPrivKey));
+        Bytes hashTxData = Hex::toBytes("0xcfffe746");
+        Utils::appendBytes(hashTxData, Utils::sha3(seed.get()));
+        TxValidator hashTx(validatorAddress, hashTxData, 8080, nHeight, txValidatorPrivKey);
+        expectedBlock.appendTxValidator(hashTx);
+        builder.appendTxValidator(std::move(hashTx));
+        Bytes seedTxData = Hex::toBytes("0x6fc5a2d6");
+        Utils::appendBytes(seedTxData, seed);
+        TxValidator seedTx(validatorAddress, seedTxData, 8080, nHeight, txValidatorPrivKey);
+        expectedBlock.appendTxValidator(seedTx);
+        builder.appendTxValidator(std::move(seedTx));
+      }
+
+      // Roots and size are known before finalizing
+      REQUIRE(builder.getTxMerkleRoot() == Merkle(expectedBlock.getTxs()).getRoot());
+      REQUIRE(builder.getValidatorMerkleRoot() == Merkle(expectedBlock.getTxValidators()).getRoot());
+
+      expectedBlock.finalize(blockValidatorPrivKey, timestamp + 1);
+      uint64_t expectedSize = builder.getSerializedSize();
+      REQUIRE_THROWS(builder.finalize(blockValidatorPrivKey, timestamp - 1));
+      Block newBlock = builder.finalize(blockValidatorPrivKey, timestamp + 1);
+
+      Bytes serialized = newBlock.serializeBlock();
+      REQUIRE(serialized.size() == expectedSize);
+      REQUIRE(serialized == expectedBlock.serializeBlock());
+      REQUIRE(newBlock.hash() == expectedBlock.hash());
+      REQUIRE(newBlock.getBlockRandomness() == expectedBlock.getBlockRandomness());
+      REQUIRE(newBlock.getValidatorPubKey() == expectedBlock.getValidatorPubKey());
+      REQUIRE(newBlock.getTxs() == expectedBlock.getTxs());
+      REQUIRE(newBlock.getTxValidators() == expectedBlock.getTxValidators());
+      REQUIRE(Block(serialized, 8080).hash() == newBlock.hash());
+    }
+  }
+}
@@ -0,0 +1,163 @@
+#include <cstring>
+#include <unordered_map>
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/flathashmap.h"
+
+namespace TFlatHashMap {
+  // Deterministic, well spread address for a given index.
+  Address makeAddress(const uint64_t& i) {
+    BytesArr<20> arr;
+    uint64_t a = SafeHash::splitmix(i), b = SafeHash::splitmix(a), c = SafeHash::splitmix(b);
+    std::memcpy(arr.data(), &a, 8);
+    std::memcpy(arr.data() + 8, &b, 8);
+    std::memcpy(arr.data() + 16, &c, 4);
+    return Address(arr);
+  }
+
+  TEST_CASE("FlatHashMap Class", "[utils][flathashmap]") {
+    SECTION("Insert, find and erase") {
+      FlatHashMap<Address, uint64_t> map;
+      REQUIRE(map.empty());
+      REQUIRE(map.find(makeAddress(0)) == map.end());
+      REQUIRE(map.erase(makeAddress(0)) == 0);
+
+      REQUIRE(map.try_emplace(makeAddress(0), 10).second);
+      REQUIRE(!map.try_emplace(makeAddress(0), 20).second);
+      REQUIRE(map.at(makeAddress(0)) == 10);
+      REQUIRE(map.insert({makeAddress(1), 11}).second);
+      REQUIRE(!map.insert({makeAddress(1), 12}).second);
+      REQUIRE(map.insert_or_assign(makeAddress(1), 13).first->second == 13);
+      map[makeAddress(2)] += 5;
+      REQUIRE(map[makeAddress(2)] == 5);
+      REQUIRE(map.size() == 3);
+      REQUIRE(map.contains(makeAddress(1)));
+      REQUIRE(map.count(makeAddress(3)) == 0);
+      REQUIRE_THROWS(map.at(makeAddress(3)));
+
+      REQUIRE(map.erase(makeAddress(1)) == 1);
+      REQUIRE(!map.contains(makeAddress(1)));
+      REQUIRE(map.size() == 2);
+      map.clear();
+      REQUIRE(map.empty());
+      REQUIRE(!map.contains(makeAddress(0)));
+    }
+
+    SECTION("Growing, erasing and reusing slots keeps every entry") {
+      FlatHashMap<Address, uint64_t> map;
+      std::unordered_map<Address, uint64_t, SafeHash> reference;
+      for (uint64_t i = 0; i < 100000; i++) {
+        map[makeAddress(i)] = i;
+        reference[makeAddress(i)] = i;
+      }
+      // Erase every odd entry, then insert new ones over the tombstones
+      for (uint64_t i = 1; i < 100000; i += 2) {
+        REQUIRE(map.erase(makeAddress(i)) == 1);
+        reference.erase(makeAddress(i));
+      }
+      for (uint64_t i = 100000; i < 150000; i++) {
+        map[makeAddress(i)] = i;
+        reference[makeAddress(i)] = i;
+      }
+      REQUIRE(map.size() == reference.size());
+      for (const auto& [key, value] : reference) {
+        auto it = map.find(key);
+        REQUIRE(it != map.end());
+        REQUIRE(it->second == value);
+      }
+      for (uint64_t i = 1; i < 100000; i += 2) REQUIRE(!map.contains(makeAddress(i)));
+
+      // Iteration visits every entry exactly once
+      uint64_t visited = 0;
+      for (const auto& [key, value] : map) {
+        REQUIRE(reference.at(key) == value);
+        visited++;
+      }
+      REQUIRE(visited == reference.size());
+    }
+
+    SECTION("Erasing while iterating") {
+      FlatHashMap<Hash, uint64_t> map;
+      for (uint64_t i = 0; i < 1000; i++) map[Hash(Utils::sha3(Utils::uint64ToBytes(i)))] = i;
+      for (auto it = map.begin(); it != map.end();) {
+        if (it->second % 3 == 0) it = map.erase(it); else ++it;
+      }
+      REQUIRE(map.size() == 666);
+      for (const auto& [key, value] : map) REQUIRE(value % 3 != 0);
+    }
+
+    SECTION("Copying, moving and const values") {
+      FlatHashMap<Hash, const std::shared_ptr<const uint64_t>> map;
+      for (uint64_t i = 0; i < 100; i++) {
+        map.insert({Hash(Utils::sha3(Utils::uint64ToBytes(i))), std::make_shared<const uint64_t>(i)});
+      }
+      FlatHashMap<Hash, const std::shared_ptr<const uint64_t>> copy(map);
+      REQUIRE(copy.size() == 100);
+      REQUIRE(*copy.find(Hash(Utils::sha3(Utils::uint64ToBytes(42))))->second == 42);
+      REQUIRE(copy.find(Hash(Utils::sha3(Utils::uint64ToBytes(42))))->second
+        == map.find(Hash(Utils::sha3(Utils::uint64ToBytes(42))))->second
+      );
+
+      FlatHashMap<Hash, const std::shared_ptr<const uint64_t>> moved(std::move(map));
+      REQUIRE(moved.size() == 100);
+      REQUIRE(map.empty());
+      map = copy;
+      REQUIRE(map.size() == 100);
+      REQUIRE(map.erase(Hash(Utils::sha3(Utils::uint64ToBytes(42)))) == 1);
+      REQUIRE(copy.contains(Hash(Utils::sha3(Utils::uint64ToBytes(42)))));
+      REQUIRE(moved == copy);
+      REQUIRE(!(map == copy));
+    }
+  }
+
+  TEST_CASE("FlatHashMap Benchmarks", "[.][utils][flathashmap][benchmark]") {
+    // Same workload as the node's account map: 10M accounts keyed by address
+    const uint64_t accounts = 10000000;
+    const uint64_t batch = 1000;
+    FlatHashMap<Address, uint64_t> flat;
+    std::unordered_map<Address, uint64_t, SafeHash> node;
+    flat.reserve(accounts);
+    node.reserve(accounts);
+    for (uint64_t i = 0; i < accounts; i++) {
+      flat[makeAddress(i)] = i;
+      node[makeAddress(i)] = i;
+    }
+    std::vector<Address> hits, misses;
+    for (uint64_t i = 0; i < batch; i++) {
+      hits.emplace_back(makeAddress(SafeHash::splitmix(i) % accounts));
+      misses.emplace_back(makeAddress(accounts + i));
+    }
+
+    BENCHMARK("FlatHashMap 10M lookup 1000 hits") {
+      uint64_t sum = 0;
+      for (const Address& add : hits) sum += flat.find(add)->second;
+      return sum;
+    };
+    BENCHMARK("std::unordered_map 10M lookup 1000 hits") {
+      uint64_t sum = 0;
+      for (const Address& add : hits) sum += node.find(add)->second;
+      return sum;
+    };
+    BENCHMARK("FlatHashMap 10M lookup 1000 misses") {
+      uint64_t found = 0;
+      for (const Address& add : misses) found += flat.contains(add);
+      return found;
+    };
+    BENCHMARK("std::unordered_map 10M lookup 1000 misses") {
+      uint64_t found = 0;
+      for (const Address& add : misses) found += node.contains(add);
+      return found;
+    };
+    // Insert new accounts and erase them again, so the map stays at 10M entries
+    BENCHMARK("FlatHashMap 10M insert+erase 1000") {
+      for (const Address& add : misses) flat.try_emplace(add, 0);
+      for (const Address& add : misses) flat.erase(add);
+      return flat.size();
+    };
+    BENCHMARK("std::unordered_map 10M insert+erase 1000") {
+      for (const Address& add : misses) node.try_emplace(add, 0);
+      for (const Address& add : misses) node.erase(add);
+      return node.size();
+    };
+  }
+}
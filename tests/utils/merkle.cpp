@@ -77,6 +77,80 @@ namespace TMerkle {
       REQUIRE(Merkle::verify(proof, leaf, root));
       REQUIRE(!Merkle::verify(proof, badLeaf, root));
     }
+
+    SECTION("Flat Merkle Tree Layout And Odd Leaves") {
+      std::vector<Hash> hashedLeafs;
+      for (uint64_t i = 0; i < 11; i++) hashedLeafs.emplace_back(Hash::random());
+
+      Merkle tree(hashedLeafs);
+      // 11 -> 6 -> 3 -> 2 -> 1
+      REQUIRE(tree.getLayerCount() == 5);
+      REQUIRE(tree.getTree().size() == 11 + 6 + 3 + 2 + 1);
+      REQUIRE(tree.getLayer(0).size() == 11);
+      REQUIRE(tree.getLayer(4).size() == 1);
+      REQUIRE(tree.getLayer(4)[0] == tree.getRoot());
+      REQUIRE(tree.getLayer(1)[5] == tree.getLayer(0)[10]); // Odd leaf carried over
+
+      // Every leaf must be provable, including carried-over ones
+      for (uint64_t i = 0; i < hashedLeafs.size(); i++) {
+        std::vector<Hash> proof = tree.getProof(i);
+        REQUIRE(Merkle::verify(proof, tree.getLeaves()[i], tree.getRoot()));
+        std::array<Hash, 4> buffer;
+        uint64_t proofSize = tree.getProof(i, buffer);
+        REQUIRE(proofSize == proof.size());
+        REQUIRE(Merkle::verify(std::span<const Hash>(buffer.data(), proofSize), tree.getLeaves()[i], tree.getRoot()));
+      }
+      REQUIRE(tree.getProof(11).empty());
+      std::array<Hash, 2> smallBuffer;
+      REQUIRE_THROWS(tree.getProof(0, smallBuffer));
+    }
+
+    SECTION("Empty And Single Leaf Merkle Tree") {
+      Merkle empty(std::vector<Hash>{});
+      REQUIRE(empty.getRoot() == Hash());
+      REQUIRE(empty.getLeaves().empty());
+
+      Hash single = Hash::random();
+      Merkle tree(std::vector<Hash>{single});
+      REQUIRE(tree.getRoot() == Utils::sha3(single.get()));
+      REQUIRE(tree.getProof(0).empty());
+    }
+
+    SECTION("Large Merkle Tree (Parallel Layers)") {
+      std::vector<Hash> hashedLeafs;
+      for (uint64_t i = 0; i < 10001; i++) hashedLeafs.emplace_back(Hash::random());
+
+      Merkle tree(hashedLeafs);
+      for (uint64_t i = 0; i < hashedLeafs.size(); i += 1111) {
+        REQUIRE(Merkle::verify(tree.getProof(i), tree.getLeaves()[i], tree.getRoot()));
+      }
+      REQUIRE(!Merkle::verify(tree.getProof(0), tree.getLeaves()[1], tree.getRoot()));
+    }
+
+    SECTION("Merkle Accumulator Matches Full Tree") {
+      MerkleAccumulator accumulator;
+      REQUIRE(accumulator.getRoot() == Hash());
+      std::vector<Hash> hashedLeafs;
+      for (uint64_t i = 0; i < 130; i++) {
+        hashedLeafs.emplace_back(Hash::random());
+        accumulator.append(hashedLeafs.back());
+        REQUIRE(accumulator.size() == hashedLeafs.size());
+        REQUIRE(accumulator.getRoot() == Merkle(hashedLeafs).getRoot());
+      }
+    }
+  }
+
+  TEST_CASE("Merkle Benchmarks", "[.][utils][merkle][benchmark]") {
+    std::vector<Hash> hashedLeafs;
+    for (uint64_t i = 0; i < 10000; i++) hashedLeafs.emplace_back(Hash::random());
+    Merkle tree(hashedLeafs);
+    BENCHMARK("Merkle 10000 leaves") { return Merkle(hashedLeafs).getRoot(); };
+    BENCHMARK("Merkle proof") { return tree.getProof(4321); };
+    BENCHMARK("MerkleAccumulator 10000 leaves") {
+      MerkleAccumulator accumulator;
+      for (const Hash& leaf : hashedLeafs) accumulator.append(leaf);
+      return accumulator.getRoot();
+    };
   }
 }
 
@@ -0,0 +1,71 @@
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/utils.h"
+#include "../../src/utils/uint256.h"
+
+using Catch::Matchers::Equals;
+
+namespace TU256 {
+  TEST_CASE("U256 Class", "[utils][uint256]") {
+    SECTION("U256 boost conversion") {
+      uint256_t big("91830918212381802449294565349763096207758814059154440393436864477986483867239");
+      U256 native(big);
+      REQUIRE(native.toBoost() == big);
+      REQUIRE(U256::fromBoost(uint256_t(0)) == U256(0));
+      REQUIRE(U256::fromBoost(std::numeric_limits<uint256_t>::max()) == U256::max());
+      REQUIRE(U256::max().toBoost() == std::numeric_limits<uint256_t>::max());
+      REQUIRE(native.str() == big.str());
+    }
+
+    SECTION("U256 big-endian load/store") {
+      uint256_t big("91830918212381802449294565349763096207758814059154440393436864477986483867239");
+      U256 native(big);
+      REQUIRE(native.toBigEndian() == Utils::uint256ToBytes(big));
+      BytesArr<32> arr = native.toBigEndian();
+      REQUIRE(U256::fromBigEndian(arr) == native);
+      REQUIRE(U256::fromBigEndian(Bytes{0x01, 0x00}) == U256(256));
+      REQUIRE(U256::fromBigEndian(Bytes{}) == U256(0));
+      REQUIRE_THROWS(U256::fromBigEndian(Bytes(33, 0x01)));
+      REQUIRE(U256(0x1234).toTrimmedBytes() == Bytes{0x12, 0x34});
+      REQUIRE(U256(0).toTrimmedBytes().empty());
+      REQUIRE(Utils::uintToBytes(native) == Utils::uintToBytes(big));
+      REQUIRE(Utils::bytesRequired(native) == Utils::bytesRequired(big));
+    }
+
+    SECTION("U256 checked arithmetic") {
+      uint256_t a("1927831865120318940191371489123952378115126713");
+      uint256_t b("3855663730240637880382742978247904756230253426");
+      REQUIRE((U256(a) + U256(b)).toBoost() == a + b);
+      REQUIRE((U256(b) - U256(a)).toBoost() == b - a);
+      REQUIRE((U256(a) * U256(uint64_t(1000000007))).toBoost() == a * 1000000007);
+      REQUIRE(U256(UINT64_MAX) + U256(1) == U256(0, 1, 0, 0));
+      REQUIRE_THROWS_AS(U256::max() + U256(1), std::overflow_error);
+      REQUIRE_THROWS_AS(U256(a) - U256(b), std::underflow_error);
+      REQUIRE_THROWS_AS(U256(a) * U256(b), std::overflow_error);
+    }
+
+    SECTION("U256 comparison and modulo") {
+      uint256_t a("1927831865120318940191371489123952378115126713");
+      uint256_t b("3855663730240637880382742978247904756230253426");
+      REQUIRE(U256(a) < U256(b));
+      REQUIRE(U256(b) > U256(a));
+      REQUIRE(U256(a) != U256(b));
+      REQUIRE(U256(a) > 0x80);
+      REQUIRE(U256(0x7f) < 0x80);
+      REQUIRE(U256(5) == 5);
+      REQUIRE(U256(a).mod64(12345) == uint64_t(a % 12345));
+      REQUIRE_THROWS(U256(a).mod64(0));
+    }
+  }
+
+  TEST_CASE("U256 Benchmarks", "[.][utils][uint256][benchmark]") {
+    uint256_t value("1000000000000000000");
+    uint256_t gasLimit("21000");
+    uint256_t maxFeePerGas("1000000000");
+    U256 nValue(value), nGasLimit(gasLimit), nMaxFeePerGas(maxFeePerGas);
+
+    BENCHMARK("uint256_t fee math") { return value + (gasLimit * maxFeePerGas); };
+    BENCHMARK("U256 fee math") { return nValue + (nGasLimit * nMaxFeePerGas); };
+    BENCHMARK("uint256_t big-endian load") { return Utils::bytesToUint256(Utils::uint256ToBytes(value)); };
+    BENCHMARK("U256 big-endian load") { return U256::fromBigEndian(nValue.toBigEndian()); };
+  }
+}
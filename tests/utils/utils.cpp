@@ -14,6 +14,32 @@ namespace TUtils {
       REQUIRE(sha3Output == sha3ExpectedOutput);
     }
 
+    SECTION("Sha3Batch Test") {
+      // Mix of sizes around the Keccak rate (136 bytes) to exercise padding on every lane
+      std::vector<Bytes> inputs;
+      for (uint64_t i = 0; i < 37; i++) inputs.emplace_back(Bytes((i * 17) % 300, uint8_t(i)));
+      inputs.emplace_back(Bytes(136, 0xff));
+      inputs.emplace_back(Bytes(272, 0xaa));
+      std::vector<BytesArrView> views(inputs.begin(), inputs.end());
+      std::vector<Hash> outputs(inputs.size());
+      Utils::sha3Batch(views, outputs);
+      for (uint64_t i = 0; i < inputs.size(); i++) REQUIRE(outputs[i] == Utils::sha3(inputs[i]));
+      std::vector<Hash> tooSmall(inputs.size() - 1);
+      REQUIRE_THROWS(Utils::sha3Batch(views, tooSmall));
+    }
+
+    SECTION("Account Serialization Test") {
+      Account account(U256(uint256_t("91830918212381802449294565349763096207758814059154440393436864477986483867239")), 0x0102030405060708);
+      BytesArr<40> serialized = account.serialize();
+      REQUIRE(Hex::fromBytes(serialized).get() == "cb06753290ffac167205d0f53b64acfd80be11edbb26a224bed9239ae6740e670102030405060708");
+      Account deserialized(serialized);
+      REQUIRE(deserialized.balance == account.balance);
+      REQUIRE(deserialized.nonce == account.nonce);
+      REQUIRE(Account(Account().serialize()).balance == 0);
+      REQUIRE_THROWS(Account(Bytes(39, 0x00)));
+      REQUIRE_THROWS(Account(Bytes(41, 0x00)));
+    }
+
     SECTION("uint256ToBytes Test") {
       uint256_t uint256Input = uint256_t("91830918212381802449294565349763096207758814059154440393436864477986483867239");
       auto uint256Output = Utils::uint256ToBytes(uint256Input);
@@ -266,5 +292,20 @@ namespace TUtils {
       REQUIRE(b2 == Bytes{0x30, 0x42, 0x34, 0x48, 0x52, 0x36, 0x33, 0x39});
     }
   }
+
+  TEST_CASE("Utils Sha3 Benchmarks", "[.][utils][benchmark]") {
+    // 64-byte inputs, same as Merkle pair hashing
+    std::vector<Bytes> inputs(4096, Bytes(64, 0x42));
+    std::vector<BytesArrView> views(inputs.begin(), inputs.end());
+    std::vector<Hash> outputs(inputs.size());
+    BENCHMARK("sha3 x4096") {
+      for (uint64_t i = 0; i < inputs.size(); i++) outputs[i] = Utils::sha3(inputs[i]);
+      return outputs.back();
+    };
+    BENCHMARK("sha3Batch x4096") {
+      Utils::sha3Batch(views, outputs);
+      return outputs.back();
+    };
+  }
 }
 